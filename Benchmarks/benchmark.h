@@ -0,0 +1,149 @@
+/***********************************************************************//**
+ * @file		benchmark.h
+ * @brief		minimal micro-benchmark harness for host and target
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "system_configuration.h"
+#include "profiling.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if UNIX == 1
+#include <chrono>
+#endif
+
+#define BENCHMARK_MIN_CYCLES 	(1 << 26) //!< measure at least this many cycles per kernel
+#define BENCHMARK_MAX_ENTRIES 	64
+
+//! keep the compiler from discarding a result
+template <class type> inline void do_not_optimize( const type &value)
+{
+  asm volatile( "" : : "m"( value) : "memory");
+}
+
+//! keep the compiler from assuming an input is constant
+template <class type> inline void clobber( type &value)
+{
+  asm volatile( "" : "+m"( value) : : "memory");
+}
+
+//! handed to every benchmark, the kernel shall be executed "iterations" times
+class benchmark_state_t
+{
+public:
+  benchmark_state_t( uint32_t _iterations)
+    : iterations( _iterations)
+  {}
+  uint32_t iterations;
+};
+
+typedef void (*benchmark_function_t)( benchmark_state_t &state);
+
+//! registry of all benchmarks, filled by static objects before main()
+class benchmark_registry_t
+{
+public:
+  static benchmark_registry_t & instance( void)
+  {
+    static benchmark_registry_t registry;
+    return registry;
+  }
+
+  void add( const char *name, benchmark_function_t function)
+  {
+    if( n_entries < BENCHMARK_MAX_ENTRIES)
+      {
+	entry[n_entries].name = name;
+	entry[n_entries].function = function;
+	++n_entries;
+      }
+  }
+
+  //! run all benchmarks whose name contains filter (NULL = all)
+  void run_all( const char *filter = 0) const
+  {
+    printf( "%-40s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "cycles/op");
+    for( unsigned i = 0; i < n_entries; ++i)
+      if( filter == 0 || strstr( entry[i].name, filter))
+	run( entry[i]);
+  }
+
+private:
+  struct entry_t
+  {
+    const char *name;
+    benchmark_function_t function;
+  };
+
+  benchmark_registry_t( void)
+    : n_entries( 0)
+  {}
+
+  //! double the iteration count until the measurement is long enough
+  static void run( const entry_t &e)
+  {
+    uint32_t iterations = 1;
+    uint32_t cycles;
+    double nanoseconds = 0.0;
+
+    for( ;;)
+      {
+	benchmark_state_t state( iterations);
+#if UNIX == 1
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+#endif
+	uint32_t start = read_cycle_counter();
+	e.function( state);
+	cycles = read_cycle_counter() - start;
+#if UNIX == 1
+	nanoseconds = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin).count();
+#endif
+	if( cycles >= BENCHMARK_MIN_CYCLES || iterations >= (1u << 30))
+	  break;
+	iterations *= 2;
+      }
+
+    printf( "%-40s %12lu %12.2f %12.2f\n", e.name, (unsigned long)iterations,
+	    nanoseconds / iterations, (double)cycles / iterations);
+  }
+
+  entry_t entry[BENCHMARK_MAX_ENTRIES];
+  unsigned n_entries;
+};
+
+//! helper to register a benchmark from a static initializer
+class benchmark_registrar_t
+{
+public:
+  benchmark_registrar_t( const char *name, benchmark_function_t function)
+  {
+    benchmark_registry_t::instance().add( name, function);
+  }
+};
+
+#define BENCHMARK( function) static benchmark_registrar_t benchmark_registrar_##function( #function, function)
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,180 @@
+/***********************************************************************//**
+ * @file		flight_corpus.h
+ * @brief		synthetic flight profiles for the end-to-end replay benchmark
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef FLIGHT_CORPUS_H_
+#define FLIGHT_CORPUS_H_
+
+#include "data_structures.h"
+#include "NAV_tuning_parameters.h"
+#include <math.h>
+
+//! flight phases of the corpus, each one engages different algorithm branches
+enum flight_phase_t
+{
+  PHASE_STRAIGHT_GLIDE, //!< straight flight, D-GNSS heading
+  PHASE_THERMALLING,	//!< circling and climbing, D-GNSS heading
+  PHASE_DGNSS_LOSS,	//!< circling, GNSS fix without heading: magnetic AHRS path
+  PHASE_NO_GNSS,	//!< straight flight without any fix
+  N_FLIGHT_PHASES
+};
+
+static const char * const FLIGHT_PHASE_NAME[N_FLIGHT_PHASES] =
+  { "straight glide", "thermalling", "D-GNSS loss", "no GNSS"};
+
+//! duration of the phases in the corpus / s
+static const unsigned FLIGHT_PHASE_DURATION[N_FLIGHT_PHASES] = { 120, 180, 90, 60};
+
+/**
+ * @brief deterministic synthetic flight
+ *
+ * Consistent IMU, magnetometer, pressure and GNSS data of a glider at 28 m/s TAS
+ * in 4 m/s wind. GNSS data are updated at 10 Hz and held in between.
+ * A little pseudo-random sensor noise lets the filters work on realistic data.
+ */
+class flight_corpus_t
+{
+public:
+  flight_corpus_t( void)
+    : heading( 0.0f),
+      altitude( 1200.0f),
+      north( 0.0f),
+      east( 0.0f),
+      noise_state( 12345)
+  {}
+
+  //! number of samples of the complete corpus
+  static unsigned get_size( void)
+  {
+    unsigned size = 0;
+    for( unsigned phase = 0; phase < N_FLIGHT_PHASES; ++phase)
+      size += FLIGHT_PHASE_DURATION[phase] * FAST_SAMPLING_FREQUENCY;
+    return size;
+  }
+
+  //! fill the corpus, phase[i] receives the flight phase of sample i
+  void generate( observations_type *observations, uint8_t *phase_of_sample)
+  {
+    coordinates_t gnss = coordinates_t();
+    unsigned sample = 0;
+    for( unsigned phase = 0; phase < N_FLIGHT_PHASES; ++phase)
+      for( unsigned i = 0; i < FLIGHT_PHASE_DURATION[phase] * FAST_SAMPLING_FREQUENCY; ++i, ++sample)
+	{
+	  bool new_GNSS_epoch = sample % FAST_SLOW_DECIMATION == 0;
+	  generate_sample( (flight_phase_t)phase, observations[sample], gnss, new_GNSS_epoch);
+	  phase_of_sample[sample] = (uint8_t)phase;
+	}
+  }
+
+private:
+  float noise( float amplitude)
+  {
+    noise_state = noise_state * 1664525UL + 1013904223UL;
+    return amplitude * ( (float)( noise_state >> 8) * ( 2.0f / 16777216.0f) - 1.0f);
+  }
+
+  void generate_sample( flight_phase_t phase, observations_type &o, coordinates_t &gnss, bool new_GNSS_epoch)
+  {
+    const float TAS = 28.0f;
+    const float wind_N = -3.0f, wind_E = 2.6f;
+    bool circling = phase == PHASE_THERMALLING || phase == PHASE_DGNSS_LOSS;
+    float turn_rate = circling ? 0.3f : 0.0f; // rad/s, 21 s per circle
+    float bank = ATAN2( TAS * turn_rate, GRAVITY);
+    float vario = circling ? 1.5f : -1.0f;
+
+    heading += turn_rate * FAST_SAMPLING_TIME;
+    if( heading > M_PI_F)
+      heading -= 2.0f * M_PI_F;
+    altitude += vario * FAST_SAMPLING_TIME;
+
+    float sin_heading = SIN( heading), cos_heading = COS( heading);
+    float sin_bank = SIN( bank), cos_bank = COS( bank);
+
+    o.m = measurement_data_t();
+    o.m.acc[FRONT]  = noise( 0.05f);
+    o.m.acc[RIGHT]  = noise( 0.05f);
+    o.m.acc[BOTTOM] = - GRAVITY / cos_bank + noise( 0.05f);
+    o.m.gyro[FRONT]  = noise( 0.002f);
+    o.m.gyro[RIGHT]  = turn_rate * sin_bank + noise( 0.002f);
+    o.m.gyro[BOTTOM] = turn_rate * cos_bank + noise( 0.002f);
+
+    // earth induction rotated into the body frame: yaw, then roll
+    const float induction_N = 0.2f, induction_D = 0.43f;
+    float x1 =   cos_heading * induction_N;
+    float y1 = - sin_heading * induction_N;
+    o.m.mag[FRONT]  = x1;
+    o.m.mag[RIGHT]  = cos_bank * y1 + sin_bank * induction_D;
+    o.m.mag[BOTTOM] = - sin_bank * y1 + cos_bank * induction_D;
+
+    float density = 1.225f * ( 1.0f - altitude * 9.5e-5f);
+    o.m.static_pressure = 101325.0f * powf( 1.0f - 2.25577e-5f * altitude, 5.25588f) + noise( 1.0f);
+    o.m.pitot_pressure  = 0.5f * density * TAS * TAS + noise( 0.5f);
+    o.m.static_sensor_temperature = 20.0f;
+    o.m.supply_voltage = 12.5f;
+
+    float velocity_N = TAS * cos_heading + wind_N;
+    float velocity_E = TAS * sin_heading + wind_E;
+    north += velocity_N * FAST_SAMPLING_TIME;
+    east  += velocity_E * FAST_SAMPLING_TIME;
+
+    if( new_GNSS_epoch)
+      {
+	gnss.velocity[NORTH] = velocity_N + noise( 0.05f);
+	gnss.velocity[EAST]  = velocity_E + noise( 0.05f);
+	gnss.velocity[DOWN]  = - vario + noise( 0.05f);
+	gnss.acceleration[NORTH] = - TAS * turn_rate * sin_heading;
+	gnss.acceleration[EAST]  =   TAS * turn_rate * cos_heading;
+	gnss.acceleration[DOWN]  = ZERO;
+	gnss.position[NORTH] = north;
+	gnss.position[EAST]  = east;
+	gnss.position[DOWN]  = - altitude;
+	gnss.speed_motion = SQRT( velocity_N * velocity_N + velocity_E * velocity_E);
+	gnss.heading_motion = ATAN2( velocity_E, velocity_N) * ( 180.0f / M_PI_F);
+	gnss.relPosHeading = heading;
+	gnss.latitude = 50.5;
+	gnss.longitude = 8.25;
+	gnss.SATS_number = 12;
+#if INCLUDING_NANO
+	gnss.nano += 100000000; // epoch time stamp, 10 Hz
+	if( gnss.nano >= 1000000000)
+	  {
+	    gnss.nano -= 1000000000;
+	    gnss.second = (uint8_t)( ( gnss.second + 1) % 60);
+	  }
+#endif
+      }
+    gnss.sat_fix_type =
+	  phase == PHASE_NO_GNSS    ? SAT_FIX_NONE
+	: phase == PHASE_DGNSS_LOSS ? SAT_FIX
+	: SAT_FIX | SAT_HEADING;
+    o.c = gnss;
+  }
+
+  float heading;
+  float altitude;
+  float north;
+  float east;
+  uint32_t noise_state;
+};
+
+#endif /* FLIGHT_CORPUS_H_ */
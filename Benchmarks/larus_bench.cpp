@@ -0,0 +1,841 @@
+/***********************************************************************//**
+ * @file		larus_bench.cpp
+ * @brief		micro-benchmarks for the hot algorithm kernels
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "benchmark.h"
+#include "quaternion.h"
+#include "float3matrix.h"
+#include "float3vector.h"
+#include "pt2.h"
+#include "pt2_bank.h"
+#include "fixed_point.h"
+#include "imu_preintegrator.h"
+#include "IMU_frontend.h"
+#include "KalmanVario_fixed.h"
+#include "ram_budget.h"
+#include "fir_decimator.h"
+#include "soaring_flight_averager.h"
+#include "Linear_Least_Square_Fit.h"
+#include "air_density_observer.h"
+#include "atmosphere.h"
+#include "NMEA_format.h"
+#include "binary_telemetry.h"
+#include "CAN_gateway.h"
+#include "CAN_dispatcher.h"
+#include "fast_math.h"
+#include "spsc_queue.h"
+#include "ringbuffer.h"
+#include "column_log.h"
+#include "EEPROM_journal.h"
+#include "event_trace.h"
+#include "UBX_parser.h"
+#include "flight_smoother.h"
+#include "segment_index.h"
+#include <math.h>
+
+static void quaternion_rotate( benchmark_state_t &state)
+{
+  quaternion<float> q;
+  float p = 0.001f, n = -0.002f, r = 0.003f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( p);
+      q.rotate( p, n, r); // includes normalize()
+      do_not_optimize( q);
+    }
+}
+BENCHMARK( quaternion_rotate);
+
+//! sensor mapping of all IMU vectors, with IMU_FUSION=1 including the fusion of both IMUs
+static void IMU_frontend_update( benchmark_state_t &state)
+{
+  IMU_frontend_t frontend;
+  quaternion<float> q;
+  q.from_euler( 0.01f, -0.02f, 0.03f);
+  float3matrix mapping;
+  q.get_rotation_matrix( mapping);
+  frontend.set_mapping( mapping);
+  float3vector v;
+  v[0] = 0.1f; v[1] = -0.2f; v[2] = -9.81f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( v);
+      v[0] += 1e-6f; // not stuck
+      for( unsigned k = 0; k < IMU_FRONTEND_VECTORS; ++k)
+	frontend.set_input( k, v);
+      frontend.update();
+      do_not_optimize( frontend.get_acc());
+    }
+}
+BENCHMARK( IMU_frontend_update);
+
+//! one 100 Hz AHRS tick worth of 400 Hz FIFO samples
+static void imu_preintegrator_4_samples( benchmark_state_t &state)
+{
+  imu_preintegrator_t preintegrator;
+  float3vector gyro, acc;
+  gyro[0] = 0.01f; gyro[1] = -0.02f; gyro[2] = 0.3f;
+  acc[2] = -9.81f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( gyro);
+      for( unsigned k = 0; k < 4; ++k)
+	preintegrator.add_sample( gyro, acc, IMU_SAMPLING_TIME);
+      float3vector rate = preintegrator.get_mean_rate();
+      float3vector force = preintegrator.get_mean_specific_force();
+      preintegrator.reset();
+      do_not_optimize( rate);
+      do_not_optimize( force);
+    }
+}
+BENCHMARK( imu_preintegrator_4_samples);
+
+static void quaternion_normalize( benchmark_state_t &state)
+{
+  quaternion<float> q;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( q);
+      q.normalize();
+      do_not_optimize( q);
+    }
+}
+BENCHMARK( quaternion_normalize);
+
+static void quaternion_get_rotation_matrix( benchmark_state_t &state)
+{
+  quaternion<float> q;
+  q.from_euler( 0.1f, -0.2f, 1.0f);
+  float3matrix m;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( q);
+      q.get_rotation_matrix( m);
+      do_not_optimize( m);
+    }
+}
+BENCHMARK( quaternion_get_rotation_matrix);
+
+static void quaternion_to_euler( benchmark_state_t &state)
+{
+  quaternion<float> q;
+  q.from_euler( 0.1f, -0.2f, 1.0f);
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( q);
+      eulerangle<float> euler = q;
+      do_not_optimize( euler);
+    }
+}
+BENCHMARK( quaternion_to_euler);
+
+static void matrix_times_vector( benchmark_state_t &state)
+{
+  quaternion<float> q;
+  q.from_euler( 0.1f, -0.2f, 1.0f);
+  float3matrix m;
+  q.get_rotation_matrix( m);
+  float3vector v;
+  v[0] = 1.0f; v[1] = 2.0f; v[2] = 3.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( v);
+      float3vector result = m * v;
+      do_not_optimize( result);
+    }
+}
+BENCHMARK( matrix_times_vector);
+
+static void matrix_reverse_map( benchmark_state_t &state)
+{
+  quaternion<float> q;
+  q.from_euler( 0.1f, -0.2f, 1.0f);
+  float3matrix m;
+  q.get_rotation_matrix( m);
+  float3vector v;
+  v[0] = 1.0f; v[1] = 2.0f; v[2] = 3.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( v);
+      float3vector result = m.reverse_map( v);
+      do_not_optimize( result);
+    }
+}
+BENCHMARK( matrix_reverse_map);
+
+static void pt2_float( benchmark_state_t &state)
+{
+  pt2<float, float> filter( 0.01f);
+  float x = 1.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      do_not_optimize( filter.respond( x));
+    }
+}
+BENCHMARK( pt2_float);
+
+static void pt2_float3vector( benchmark_state_t &state)
+{
+  pt2<float3vector, float> filter( 0.01f);
+  float3vector x;
+  x[0] = 1.0f; x[1] = 2.0f; x[2] = 3.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      do_not_optimize( filter.respond( x));
+    }
+}
+BENCHMARK( pt2_float3vector);
+
+static void pt2_fixed16( benchmark_state_t &state)
+{
+  pt2_coefficients_t<float> design( 0.01f);
+  pt2<fixed16_t, fixed30_t> filter( pt2_coefficients_t<fixed30_t>( design.b0, design.b1, design.b2, design.a1, design.a2));
+  fixed16_t x = 1;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      do_not_optimize( filter.respond( x));
+    }
+}
+BENCHMARK( pt2_fixed16);
+
+//! zero input, the state decays through the denormal range
+template <class policy> static void pt2_decay( benchmark_state_t &state)
+{
+  pt2<float,float,policy> filter( pt2<float,float,policy>::template design< 1, 100>());
+  filter.settle( 1e-30f);
+  float input = 0.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( input);
+      do_not_optimize( filter.respond( input));
+      if( ( i & 0xfff) == 0)
+	filter.settle( 1e-36f);
+    }
+}
+
+static void pt2_float_decay_denormal( benchmark_state_t &state)
+{
+  pt2_decay<keep_denormals_t>( state);
+}
+BENCHMARK( pt2_float_decay_denormal);
+
+static void pt2_float_decay_flushed( benchmark_state_t &state)
+{
+  pt2_decay<flush_denormals_t>( state);
+}
+BENCHMARK( pt2_float_decay_flushed);
+
+static void pt2_float_decay_FTZ( benchmark_state_t &state)
+{
+  scoped_flush_denormals_t flush_denormals;
+  pt2_decay<keep_denormals_t>( state);
+}
+BENCHMARK( pt2_float_decay_FTZ);
+
+static void KalmanVario_float( benchmark_state_t &state)
+{
+  KalmanVario_t filter;
+  float altitude = 1000.0f, acceleration = 0.1f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( altitude);
+      do_not_optimize( filter.update( altitude, acceleration));
+    }
+}
+BENCHMARK( KalmanVario_float);
+
+static void KalmanVario_fixed16( benchmark_state_t &state)
+{
+  static const KalmanVario_fixed_gain_t<KalmanVario_gain_t> gain( KalmanVario_t::default_gain);
+  KalmanVario_Q16_t filter( gain);
+  fixed16_t altitude = 1000, acceleration = 0.1f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( altitude);
+      do_not_optimize( filter.update( altitude, acceleration));
+    }
+}
+BENCHMARK( KalmanVario_fixed16);
+
+//! per input sample, the convolution runs every 10th sample only
+static void fir_decimator_float3vector_60_10( benchmark_state_t &state)
+{
+  static constexpr fir_coefficients_t<float, 60> design = design_fir_lowpass<float, 60>( 0.015);
+  fir_decimator<float3vector, float, 60, 10> filter( design);
+  float3vector x;
+  x[0] = 1.0f; x[1] = 2.0f; x[2] = 3.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      do_not_optimize( filter.respond( x));
+    }
+  do_not_optimize( filter.get_output());
+}
+BENCHMARK( fir_decimator_float3vector_60_10);
+
+static void pt2_float_times_8( benchmark_state_t &state)
+{
+  pt2<float, float> filter[8] = { 0.01f, 0.01f, 0.01f, 0.01f, 0.02f, 0.02f, 0.02f, 0.02f};
+  float x = 1.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      for( unsigned k = 0; k < 8; ++k)
+	filter[k].respond( x);
+      do_not_optimize( filter);
+    }
+}
+BENCHMARK( pt2_float_times_8);
+
+static void pt2_bank_8( benchmark_state_t &state)
+{
+  pt2_bank<8> bank;
+  for( unsigned k = 0; k < 8; ++k)
+    bank.register_channel( k < 4 ? 0.01f : 0.02f);
+  float x = 1.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      for( unsigned k = 0; k < 8; ++k)
+	bank.set_input( k, x);
+      bank.update();
+      do_not_optimize( bank);
+    }
+}
+BENCHMARK( pt2_bank_8);
+
+static void soaring_flight_averager_circling( benchmark_state_t &state)
+{
+  soaring_flight_averager< float3vector, true> averager( 0.01f);
+  float3vector wind;
+  wind[0] = 3.0f; wind[1] = -2.0f; wind[2] = 0.0f;
+  float heading = 0.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      heading += 0.01f;
+      if( heading > M_PI)
+	heading -= PI_TIMES_2;
+      averager.update( wind, heading, CIRCLING);
+      do_not_optimize( averager.get_value());
+    }
+}
+BENCHMARK( soaring_flight_averager_circling);
+
+static void soaring_flight_averager_circling_32( benchmark_state_t &state)
+{
+  soaring_flight_averager< float3vector, true, true, 32> averager( 0.01f);
+  float3vector wind;
+  wind[0] = 3.0f; wind[1] = -2.0f; wind[2] = 0.0f;
+  float heading = 0.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      heading += 0.01f;
+      if( heading > M_PI)
+	heading -= PI_TIMES_2;
+      averager.update( wind, heading, CIRCLING);
+      do_not_optimize( averager.get_value());
+    }
+}
+BENCHMARK( soaring_flight_averager_circling_32);
+
+template <typename sample_type> static void linear_least_square_fit_add_value( benchmark_state_t &state)
+{
+  linear_least_square_fit<sample_type> fit;
+  sample_type x = 0, y = 3;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( y);
+      fit.add_value( x, y);
+      x += 1;
+      do_not_optimize( fit);
+    }
+}
+
+static void linear_least_square_fit_int64( benchmark_state_t &state)
+{
+  linear_least_square_fit_add_value<int64_t>( state);
+}
+BENCHMARK( linear_least_square_fit_int64);
+
+static void linear_least_square_fit_uint64( benchmark_state_t &state)
+{
+  linear_least_square_fit_add_value<uint64_t>( state);
+}
+BENCHMARK( linear_least_square_fit_uint64);
+
+static void linear_least_square_fit_float( benchmark_state_t &state)
+{
+  linear_least_square_fit_add_value<float>( state);
+}
+BENCHMARK( linear_least_square_fit_float);
+
+template <class observer_type> static void density_observer_feed( benchmark_state_t &state)
+{
+  observer_type observer;
+  observer.initialize( 1000.0f);
+  float altitude = 1000.0f, pressure = 89875.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( altitude);
+      air_data_result result = observer.feed_metering( pressure, altitude);
+      altitude += ( i & 0x1000) ? -0.2f : 0.2f;
+      pressure = 89875.0f - 11.0f * ( altitude - 1000.0f);
+      do_not_optimize( result);
+    }
+}
+
+static void density_observer_batch( benchmark_state_t &state)
+{
+  density_observer_feed<air_density_observer>( state);
+}
+BENCHMARK( density_observer_batch);
+
+static void density_observer_recursive( benchmark_state_t &state)
+{
+  density_observer_feed<air_density_observer_recursive>( state);
+}
+BENCHMARK( density_observer_recursive);
+
+//! one 100 Hz pressure sample: altitude, density and TAS
+static void atmosphere_pressure_path( benchmark_state_t &state)
+{
+  static atmosphere_t atmosphere( 89875.0f);
+  float pressure = 89875.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( pressure);
+      atmosphere.set_pressure( pressure);
+      do_not_optimize( atmosphere.get_negative_altitude());
+      do_not_optimize( atmosphere.get_density());
+      do_not_optimize( atmosphere.get_TAS_from_dynamic_pressure( 250.0f));
+      do_not_optimize( atmosphere.get_negative_altitude()); // second consumer
+      pressure += ( i & 0x100) ? -0.5f : 0.5f;
+    }
+}
+BENCHMARK( atmosphere_pressure_path);
+
+static void NMEA_string( benchmark_state_t &state)
+{
+  static output_data_t output_data; // zero-initialized
+  static string_buffer_t NMEA_buf;
+  output_data.TAS = 25.0f;
+  output_data.vario = 1.5f;
+  output_data.integrator_vario = 0.8f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( output_data);
+      format_NMEA_string( output_data, NMEA_buf);
+      do_not_optimize( NMEA_buf);
+    }
+}
+BENCHMARK( NMEA_string);
+
+//! default rates, GNSS fix @ 5 Hz
+static void NMEA_string_scheduled( benchmark_state_t &state)
+{
+  static output_data_t output_data; // zero-initialized
+  static string_buffer_t NMEA_buf;
+  NMEA_scheduler_t scheduler;
+  scheduler.configure( configuration_snapshot_t());
+  output_data.TAS = 25.0f;
+  output_data.vario = 1.5f;
+  output_data.integrator_vario = 0.8f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      output_data.c.second = (uint8_t)( i / 2 % 60);
+      clobber( output_data);
+      scheduler.tick( output_data.c);
+      format_NMEA_string( output_data, NMEA_buf, scheduler);
+      do_not_optimize( NMEA_buf);
+    }
+}
+BENCHMARK( NMEA_string_scheduled);
+
+static void binary_telemetry_frame( benchmark_state_t &state)
+{
+  static output_data_t output_data; // zero-initialized
+  static uint8_t frame[BINARY_TELEMETRY_FRAME_SIZE];
+  binary_telemetry_encoder_t encoder;
+  output_data.TAS = 25.0f;
+  output_data.vario = 1.5f;
+  output_data.integrator_vario = 0.8f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( output_data);
+      encoder.encode( output_data, frame, sizeof( frame));
+      do_not_optimize( frame);
+    }
+}
+BENCHMARK( binary_telemetry_frame);
+
+//! one CAN_output cycle worth of frames
+static void CAN_gateway_v1_packets_14( benchmark_state_t &state)
+{
+  CANpacket packets[14];
+  for( unsigned i = 0; i < 14; ++i)
+    packets[i] = CANpacket( 0x101 + i, 8, 0x0123456789abcdefULL * ( i + 1));
+  uint16_t buffer[14 * sizeof( CAN_gateway_packet) / 2];
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( packets);
+      for( unsigned k = 0; k < 14; ++k)
+	{
+	  CAN_gateway_packet gateway_packet( packets[k]);
+	  memcpy( buffer + k * sizeof( CAN_gateway_packet) / 2, &gateway_packet, sizeof( gateway_packet));
+	}
+      do_not_optimize( buffer);
+    }
+}
+BENCHMARK( CAN_gateway_v1_packets_14);
+
+static void CAN_gateway_v2_burst_14( benchmark_state_t &state)
+{
+  CANpacket packets[14];
+  for( unsigned i = 0; i < 14; ++i)
+    packets[i] = CANpacket( 0x101 + i, 8, 0x0123456789abcdefULL * ( i + 1));
+  uint8_t buffer[CAN_GATEWAY_FRAME_SIZE( 14)];
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( packets);
+      CAN_gateway_encode( packets, 14, buffer, sizeof( buffer));
+      do_not_optimize( buffer);
+    }
+}
+BENCHMARK( CAN_gateway_v2_burst_14);
+
+class CAN_bench_context_t
+{
+public:
+  float value[8];
+};
+
+template <unsigned I> static void CAN_bench_handler( CAN_bench_context_t &context, const CANpacket &packet)
+{
+  context.value[I] = CAN_payload<float>( packet);
+}
+
+constexpr CAN_receive_entry_t<CAN_bench_context_t> CAN_BENCH_ENTRIES[] =
+  {
+    { 0x120, 4, &CAN_bench_handler<0>}, { 0x121, 4, &CAN_bench_handler<1>},
+    { 0x122, 4, &CAN_bench_handler<2>}, { 0x123, 4, &CAN_bench_handler<3>},
+    { 0x280, 4, &CAN_bench_handler<4>}, { 0x281, 4, &CAN_bench_handler<5>},
+    { 0x500, 4, &CAN_bench_handler<6>}, { 0x7f0, 4, &CAN_bench_handler<7>}
+  };
+constexpr CAN_dispatcher_t<CAN_bench_context_t, 8> CAN_BENCH_DISPATCHER( CAN_BENCH_ENTRIES);
+
+//! 16 frames through the RX FIFO, 8 table entries, every 4th frame unknown
+static void CAN_dispatch_drain_16( benchmark_state_t &state)
+{
+  static spsc_queue<CANpacket, 32> fifo;
+  CAN_bench_context_t context;
+  CANpacket p( 0, 4);
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      for( unsigned k = 0; k < 16; ++k)
+	{
+	  p.id = ( k & 3) == 3 ? 0x300 : CAN_BENCH_ENTRIES[k & 7].id;
+	  p.data_f[0] = (float)k;
+	  fifo.push( p);
+	}
+      do_not_optimize( CAN_BENCH_DISPATCHER.drain( context, fifo));
+      clobber( context);
+    }
+}
+BENCHMARK( CAN_dispatch_drain_16);
+
+static void libm_atan2( benchmark_state_t &state)
+{
+  float y = 0.3f, x = -0.7f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( y);
+      do_not_optimize( ATAN2( y, x));
+    }
+}
+BENCHMARK( libm_atan2);
+
+static void fast_atan2( benchmark_state_t &state)
+{
+  float y = 0.3f, x = -0.7f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( y);
+      do_not_optimize( fast_atan2f( y, x));
+    }
+}
+BENCHMARK( fast_atan2);
+
+static void libm_sin( benchmark_state_t &state)
+{
+  float x = 0.3f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      do_not_optimize( SIN( x));
+    }
+}
+BENCHMARK( libm_sin);
+
+static void fast_sin( benchmark_state_t &state)
+{
+  float x = 0.3f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( x);
+      do_not_optimize( fast_sinf( x));
+    }
+}
+BENCHMARK( fast_sin);
+
+static void spsc_queue_push_pop_batch( benchmark_state_t &state)
+{
+  static spsc_queue<timestamped_t<float3vector>, 16> queue;
+  timestamped_t<float3vector> sample, batch[10];
+  sample.value[0] = 0.1f;
+  sample.value[1] = 0.2f;
+  sample.value[2] = 9.81f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      for( unsigned k = 0; k < 10; ++k)
+	{
+	  sample.timestamp = k;
+	  queue.push( sample);
+	}
+      do_not_optimize( queue.pop( batch, 10));
+      clobber( batch);
+    }
+}
+BENCHMARK( spsc_queue_push_pop_batch);
+
+static void ringbuffer_window_sum_10( benchmark_state_t &state)
+{
+  static RingBuffer<float, 10> history;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      history.pushValue( (float)i);
+      float sum = 0.0f;
+      for( unsigned k = 0; k < 10; ++k)
+	sum += history.getPreviousAt( k);
+      do_not_optimize( sum);
+    }
+}
+BENCHMARK( ringbuffer_window_sum_10);
+
+static void mirrored_ringbuffer_window_sum_10( benchmark_state_t &state)
+{
+  static MirroredRingBuffer<float, 10> history;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      history.pushValue( (float)i);
+      const float *window = history.getWindow( 10);
+      float sum = 0.0f;
+      for( unsigned k = 0; k < 10; ++k)
+	sum += window[k];
+      do_not_optimize( sum);
+    }
+}
+BENCHMARK( mirrored_ringbuffer_window_sum_10);
+
+//! cost per logged record including the block compression
+static void column_log_append( benchmark_state_t &state)
+{
+  static observations_type observations; // zero-initialized
+  static column_log_writer_t<observations_type> writer( OBSERVATIONS_LOG_SCHEMA);
+  static uint8_t block[16384];
+  observations.m.static_pressure = 95000.0f;
+  observations.m.acc.e[2] = -9.81f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      observations.m.static_pressure += 0.01f;
+      observations.m.acc.e[0] = (float)( i & 0xff) * 1e-3f;
+      clobber( observations);
+      writer.append( observations, block, sizeof( block));
+      do_not_optimize( block);
+    }
+}
+BENCHMARK( column_log_append);
+
+//! the magnetic calibration set through the codec table
+static void EEPROM_encode_calibration( benchmark_state_t &state)
+{
+  float value = 0.1f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( value);
+      EEPROM_data_t raw[7];
+      for( unsigned k = 0; k < 6; ++k)
+	EEPROM_encode( (EEPROM_PARAMETER_ID)( MAG_X_OFF + k), value, raw[k]);
+      EEPROM_encode( MAG_STD_DEVIATION, value * 0.01f, raw[6]);
+      do_not_optimize( raw);
+    }
+}
+BENCHMARK( EEPROM_encode_calibration);
+
+//! one journal record for the magnetic calibration set, including the page erases
+static void EEPROM_journal_commit_calibration( benchmark_state_t &state)
+{
+  static RAM_flash_driver_t<2, EEPROM_JOURNAL_PAGE_SIZE> flash;
+  static EEPROM_journal_t journal( flash);
+  journal.mount();
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      for( unsigned k = 0; k < 6; ++k)
+	journal.stage( (EEPROM_PARAMETER_ID)( MAG_X_OFF + k), (uint16_t)( i + k));
+      journal.stage( MAG_STD_DEVIATION, (uint16_t)i);
+      bool error = journal.commit();
+      do_not_optimize( error);
+    }
+}
+BENCHMARK( EEPROM_journal_commit_calibration);
+
+//! one trace event, the ring is drained every 32 events
+static void event_trace_emit( benchmark_state_t &state)
+{
+  static event_trace_t trace;
+  trace_event_t events[32];
+  float value = 1.0f;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( value);
+      trace.emit( TRACE_AIR_DENSITY, trace_float( value), i);
+      if( ( i & 31) == 31)
+	do_not_optimize( trace.drain( events, 32));
+    }
+}
+BENCHMARK( event_trace_emit);
+
+//! append one UBX message to a capture
+static uint8_t * UBX_frame( uint8_t *p, uint8_t id, const void *payload, uint16_t length)
+{
+  uint8_t *start = p;
+  *p++ = 0xb5;
+  *p++ = 0x62;
+  *p++ = 0x01; // NAV
+  *p++ = id;
+  *p++ = (uint8_t)length;
+  *p++ = (uint8_t)( length >> 8);
+  memcpy( p, payload, length);
+  p += length;
+  uint8_t a = 0, b = 0;
+  for( uint8_t *q = start + 2; q < p; ++q)
+    {
+      a += *q;
+      b += a;
+    }
+  *p++ = a;
+  *p++ = b;
+  return p;
+}
+
+//! one D-GNSS epoch: NAV-PVT + NAV-RELPOSNED, fed in DMA-sized chunks
+static void UBX_parser_epoch( benchmark_state_t &state)
+{
+  static uBlox_pvt pvt; // zero-initialized
+  static uBlox_relpos_NED relpos;
+  pvt.fix_type = 3;
+  pvt.fix_flags = 1;
+  pvt.latitude = 500000000;
+  relpos.flags = 0x337;
+  uint8_t capture[2 * 8 + sizeof( pvt) + sizeof( relpos)];
+  uint8_t *end = UBX_frame( capture, 0x07, &pvt, sizeof( pvt));
+  end = UBX_frame( end, 0x3c, &relpos, sizeof( relpos));
+
+  static coordinates_t coordinates;
+  UBX_parser_t parser( coordinates);
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( capture);
+      for( uint8_t *p = capture; p < end; p += 32)
+	parser.feed( p, end - p < 32 ? end - p : 32);
+      do_not_optimize( coordinates);
+    }
+}
+BENCHMARK( UBX_parser_epoch);
+
+//! forward and backward pass over 10 s of flight, GNSS fix @ 100 Hz
+static void flight_smoother_1000_samples( benchmark_state_t &state)
+{
+  static flight_observer_input_t inputs[1000];
+  static flight_smoother_t smoother;
+  for( unsigned k = 0; k < 1000; ++k)
+    {
+      inputs[k].pressure_altitude = -1000.0f - 0.01f * k;
+      inputs[k].GNSS_altitude = inputs[k].pressure_altitude;
+      inputs[k].gnss_velocity[NORTH] = 20.0f;
+      inputs[k].gnss_velocity[DOWN] = -1.0f;
+      inputs[k].ahrs_acceleration[DOWN] = -9.81f;
+      inputs[k].heading_vector[NORTH] = 1.0f;
+      inputs[k].TAS = 20.0f;
+      inputs[k].GNSS_fix_avaliable = true;
+    }
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      clobber( inputs);
+      smoother.process( inputs, 1000);
+      do_not_optimize( smoother.get( flight_smoother_t::PRESSURE_VARIO)[500]);
+    }
+}
+BENCHMARK( flight_smoother_1000_samples);
+
+//! one output record, circle state changing every 20 s
+static void segment_indexer_update( benchmark_state_t &state)
+{
+  static output_data_t output; // zero-initialized
+  segment_indexer_t indexer;
+  flight_segment_t segment;
+  output.integrator_vario = 1.5f;
+  output.c.sat_fix_type = SAT_FIX;
+  for( uint32_t i = 0; i < state.iterations; ++i)
+    {
+      output.circle_mode = ( i / 2000) % 3;
+      clobber( output);
+      do_not_optimize( indexer.update( output, i, segment));
+    }
+  do_not_optimize( segment);
+}
+BENCHMARK( segment_indexer_update);
+
+//! usage: larus_bench [name filter]
+static void report_ram_budget( void)
+{
+  printf( "%-20s %8s %8s\n", "static RAM", "bytes", "budget");
+  for( unsigned i = 0; i < RAM_BUDGET_ENTRIES; ++i)
+    {
+      printf( "%-20s %8lu", RAM_BUDGET_TABLE[i].name, (unsigned long)RAM_BUDGET_TABLE[i].size);
+      if( RAM_BUDGET_TABLE[i].budget)
+	printf( " %8lu", (unsigned long)RAM_BUDGET_TABLE[i].budget);
+      printf( "\n");
+    }
+  printf( "\n");
+}
+
+int main( int argc, char *argv[])
+{
+  initialize_cycle_counter();
+  report_ram_budget();
+  benchmark_registry_t::instance().run_all( argc > 1 ? argv[1] : 0);
+  return 0;
+}
@@ -0,0 +1,214 @@
+/***********************************************************************//**
+ * @file		replay_bench.cpp
+ * @brief		end-to-end replay benchmark on a synthetic flight corpus
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "benchmark.h"
+#include "flight_corpus.h"
+#include "replay_engine.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_BENCH_PASSES 		3	//!< the corpus is replayed several times, the fastest pass counts
+#define REPLAY_BENCH_THRESHOLD		10.0f	//!< default regression threshold / percent
+#define REPLAY_BENCH_CPU_CLOCK		168e6f	//!< STM32F407 core clock, cycles per tick budget
+
+//! timing per flight phase in cycles
+class phase_timing_t
+{
+public:
+  phase_timing_t( void)
+    : samples( 0),
+      total( 0),
+      worst( 0)
+  {}
+  void add( uint32_t cycles)
+  {
+    ++samples;
+    total += cycles;
+    if( cycles > worst)
+      worst = cycles;
+  }
+  double get_mean( void) const
+  {
+    return samples ? (double)total / samples : 0.0;
+  }
+  unsigned samples;
+  uint64_t total;
+  uint32_t worst;
+};
+
+//! one fast tick per record, output ignored, timing per flight phase and per tick slot
+static void replay_corpus( const observations_type *corpus, const uint8_t *phase, unsigned size,
+			   phase_timing_t *timing, phase_timing_t *slot_timing, double &nanoseconds)
+{
+  // fresh state every pass, no calibration write back
+  replay_engine_t *engine = new replay_engine_t( EEPROM_configuration(), false);
+  output_data_t output;
+
+#if UNIX == 1
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+#endif
+  for( unsigned i = 0; i < size; ++i)
+    {
+      uint32_t start = read_cycle_counter();
+      engine->run( corpus + i, &output, 1);
+      uint32_t cycles = read_cycle_counter() - start;
+      timing[phase[i]].add( cycles);
+      slot_timing[i % FAST_SLOW_DECIMATION].add( cycles);
+    }
+#if UNIX == 1
+  nanoseconds = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin).count();
+#else
+  nanoseconds = 0.0;
+#endif
+  delete engine;
+}
+
+//! baseline file: one line per phase "<mean cycles> <worst cycles>"
+static bool read_baseline( const char *file_name, double *mean, double *worst)
+{
+  FILE *file = fopen( file_name, "r");
+  if( file == 0)
+    return true;
+  bool error = false;
+  for( unsigned phase = 0; phase < N_FLIGHT_PHASES; ++phase)
+    if( fscanf( file, "%lf %lf", mean + phase, worst + phase) != 2)
+      error = true;
+  fclose( file);
+  return error;
+}
+
+static bool write_baseline( const char *file_name, const phase_timing_t *timing)
+{
+  FILE *file = fopen( file_name, "w");
+  if( file == 0)
+    return true;
+  for( unsigned phase = 0; phase < N_FLIGHT_PHASES; ++phase)
+    fprintf( file, "%.1f %lu\n", timing[phase].get_mean(), (unsigned long)timing[phase].worst);
+  fclose( file);
+  return false;
+}
+
+/**
+ * usage: replay_bench [-b baseline] [-w new_baseline] [-t threshold_percent]
+ *
+ * Reports throughput, per phase and per tick slot mean and worst tick time,
+ * the slots show how the 10 Hz work is spread, see TICK_SCHEDULER.
+ * With a baseline the exit code is 1 if the mean of any phase got slower than the threshold.
+ * The worst case is reported only, it is too noisy on a host for a pass / fail decision.
+ */
+int main( int argc, char *argv[])
+{
+  const char *baseline_file = 0;
+  const char *new_baseline_file = 0;
+  float threshold = REPLAY_BENCH_THRESHOLD;
+  for( int i = 1; i + 1 < argc; i += 2)
+    {
+      if( strcmp( argv[i], "-b") == 0)
+	baseline_file = argv[i + 1];
+      else if( strcmp( argv[i], "-w") == 0)
+	new_baseline_file = argv[i + 1];
+      else if( strcmp( argv[i], "-t") == 0)
+	threshold = (float)atof( argv[i + 1]);
+    }
+
+  initialize_cycle_counter();
+
+  unsigned size = flight_corpus_t::get_size();
+  observations_type *corpus = new observations_type[size];
+  uint8_t *phase = new uint8_t[size];
+  flight_corpus_t().generate( corpus, phase);
+
+  phase_timing_t best[N_FLIGHT_PHASES];
+  phase_timing_t best_slot[FAST_SLOW_DECIMATION];
+  double best_nanoseconds = 0.0;
+  for( unsigned pass = 0; pass < REPLAY_BENCH_PASSES; ++pass)
+    {
+      phase_timing_t timing[N_FLIGHT_PHASES];
+      phase_timing_t slot_timing[FAST_SLOW_DECIMATION];
+      double nanoseconds;
+      replay_corpus( corpus, phase, size, timing, slot_timing, nanoseconds);
+      if( pass == 0 || nanoseconds < best_nanoseconds)
+	{
+	  best_nanoseconds = nanoseconds;
+	  for( unsigned p = 0; p < N_FLIGHT_PHASES; ++p)
+	    best[p] = timing[p];
+	  for( unsigned slot = 0; slot < FAST_SLOW_DECIMATION; ++slot)
+	    best_slot[slot] = slot_timing[slot];
+	}
+    }
+
+  uint32_t worst = 0;
+  for( unsigned p = 0; p < N_FLIGHT_PHASES; ++p)
+    if( best[p].worst > worst)
+      worst = best[p].worst;
+
+  printf( "corpus: %u samples = %u s @ %u Hz\n", size, size / FAST_SAMPLING_FREQUENCY, FAST_SAMPLING_FREQUENCY);
+#if UNIX == 1
+  printf( "throughput: %.0f samples/s, %.0f x real time\n",
+	  size / best_nanoseconds * 1e9, size / best_nanoseconds * 1e9 / FAST_SAMPLING_FREQUENCY);
+#endif
+#if UNIX == 1
+  // time stamp counter of the host, no measure for the target budget
+  printf( "worst tick: %lu host cycles\n\n", (unsigned long)worst);
+#else
+  printf( "worst tick: %lu cycles = %.1f%% of the %.0f cycle tick budget @ %.0f MHz\n\n",
+	  (unsigned long)worst, worst * 100.0f / ( REPLAY_BENCH_CPU_CLOCK / FAST_SAMPLING_FREQUENCY),
+	  REPLAY_BENCH_CPU_CLOCK / FAST_SAMPLING_FREQUENCY, REPLAY_BENCH_CPU_CLOCK * 1e-6f);
+#endif
+
+  double baseline_mean[N_FLIGHT_PHASES], baseline_worst[N_FLIGHT_PHASES];
+  bool have_baseline = false;
+  if( baseline_file)
+    {
+      have_baseline = ! read_baseline( baseline_file, baseline_mean, baseline_worst);
+      if( ! have_baseline)
+	printf( "baseline %s not readable, ignored\n", baseline_file);
+    }
+
+  bool regression = false;
+  printf( "%-16s %10s %14s %14s %10s\n", "phase", "samples", "mean cycles", "worst cycles", "change");
+  for( unsigned p = 0; p < N_FLIGHT_PHASES; ++p)
+    {
+      printf( "%-16s %10u %14.1f %14lu", FLIGHT_PHASE_NAME[p], best[p].samples, best[p].get_mean(), (unsigned long)best[p].worst);
+      if( have_baseline && baseline_mean[p] > 0.0)
+	{
+	  double change = ( best[p].get_mean() / baseline_mean[p] - 1.0) * 100.0;
+	  bool slower = change > threshold;
+	  regression |= slower;
+	  printf( " %+9.1f%%%s", change, slower ? "  REGRESSION" : "");
+	}
+      printf( "\n");
+    }
+
+  printf( "\n%-16s %10s %14s %14s\n", "tick slot", "samples", "mean cycles", "worst cycles");
+  for( unsigned slot = 0; slot < FAST_SLOW_DECIMATION; ++slot)
+    printf( "%-16u %10u %14.1f %14lu\n", slot, best_slot[slot].samples, best_slot[slot].get_mean(), (unsigned long)best_slot[slot].worst);
+
+  if( new_baseline_file && write_baseline( new_baseline_file, best))
+    printf( "baseline %s not writable\n", new_baseline_file);
+
+  delete[] corpus;
+  delete[] phase;
+  return regression ? 1 : 0;
+}
@@ -26,12 +26,13 @@
 #define HP_LP_FUSION_H_
 
 #include "embedded_math.h"
+#include "denormal.h"
 
-//! template for a highpass + lowpass data fusion filter
-template<typename type, typename basetype> class HP_LP_fusion
+//! template for a highpass + lowpass data fusion filter, denormal_policy see pt2.h
+template<typename type, typename basetype, typename denormal_policy = keep_denormals_t> class HP_LP_fusion
 {
 public:
-  HP_LP_fusion( basetype feedback_tap) // feedback_tap shall be positive !
+  constexpr HP_LP_fusion( basetype feedback_tap) // feedback_tap shall be positive !
     : a1( -feedback_tap),
 	  old_output(0),
 	  old_HP_input(0)
@@ -44,6 +45,7 @@ public:
 	  - HP_input * a1
 	  + old_HP_input * a1
 	  - old_output * a1 ;
+    denormal_policy::apply( new_output);
     old_HP_input = HP_input;
     old_output = new_output;
     return new_output;
@@ -54,6 +56,26 @@ public:
       return old_output;
     }
 
+  //! dynamic state for checkpoints, without the feedback tap
+  class state_t
+  {
+  public:
+    type old_output;
+    type old_HP_input;
+  };
+
+  void save_state( state_t &state) const
+  {
+    state.old_output = old_output;
+    state.old_HP_input = old_HP_input;
+  }
+
+  void restore_state( const state_t &state)
+  {
+    old_output = state.old_output;
+    old_HP_input = state.old_HP_input;
+  }
+
 private:
   basetype a1; // a1, value usually negative
   type old_output;
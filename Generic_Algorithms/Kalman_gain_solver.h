@@ -0,0 +1,226 @@
+/***********************************************************************//**
+ * @file		Kalman_gain_solver.h
+ * @brief		steady-state Kalman gain by Riccati iteration
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef KALMAN_GAIN_SOLVER_H_
+#define KALMAN_GAIN_SOLVER_H_
+
+#include <math.h>
+
+//! Gauss-Jordan elimination, S is destroyed, @return true if S is singular
+template <int L> bool invert_matrix( double S[L][L], double Si[L][L])
+{
+  for( int i = 0; i < L; ++i)
+    for( int k = 0; k < L; ++k)
+      Si[i][k] = ( i == k) ? 1.0 : 0.0;
+  for( int col = 0; col < L; ++col)
+    {
+      int pivot = col;
+      for( int row = col + 1; row < L; ++row)
+	if( fabs( S[row][col]) > fabs( S[pivot][col]))
+	  pivot = row;
+      if( S[pivot][col] == 0.0)
+	return true; // singular
+      for( int k = 0; k < L; ++k)
+	{
+	  double tmp = S[col][k];  S[col][k]  = S[pivot][k];  S[pivot][k]  = tmp;
+	  tmp        = Si[col][k]; Si[col][k] = Si[pivot][k]; Si[pivot][k] = tmp;
+	}
+      double scale = 1.0 / S[col][col];
+      for( int k = 0; k < L; ++k)
+	{
+	  S[col][k]  *= scale;
+	  Si[col][k] *= scale;
+	}
+      for( int row = 0; row < L; ++row)
+	if( row != col)
+	  {
+	    double factor = S[row][col];
+	    for( int k = 0; k < L; ++k)
+	      {
+		S[row][k]  -= factor * S[col][k];
+		Si[row][k] -= factor * Si[col][k];
+	      }
+	  }
+    }
+  return false;
+}
+
+/**
+ * @brief steady-state Kalman gain of a discrete time-invariant system
+ *
+ * Iterates the discrete Riccati equation like Filter_Design/\*.m do:
+ * P = A P A' + Q; K = P C' (C P C' + R)^-1; P = (I - K C) P;
+ * until K does not change any more.
+ * Evaluation is done in double precision, only the result is float.
+ * Intended for startup or on demand, not for the sampling loop.
+ *
+ * @param N number of states
+ * @param L number of measurement channels
+ * @param P receives the steady-state error covariance after the correction
+ * @return true on error: singular innovation covariance or no convergence
+ */
+template <int N, int L>
+bool solve_steady_state_Kalman_filter(
+    const double A[N][N], const double C[L][N],
+    const double Q[N][N], const double R[L][L],
+    float K[N][L], double P[N][N],
+    unsigned max_iterations = 100000, double tolerance = 1e-10)
+{
+  double T[N][N], PCt[N][L], S[L][L], Si[L][L], G[N][L];
+
+  // P = Q as initial error covariance, the first prediction makes it A Q A' + Q
+  for( int i = 0; i < N; ++i)
+    for( int k = 0; k < N; ++k)
+      P[i][k] = Q[i][k];
+
+  for( unsigned iteration = 0; iteration < max_iterations; ++iteration)
+    {
+      // prediction: P = A P A' + Q
+      for( int i = 0; i < N; ++i)
+	for( int k = 0; k < N; ++k)
+	  {
+	    T[i][k] = 0.0;
+	    for( int j = 0; j < N; ++j)
+	      T[i][k] += A[i][j] * P[j][k];
+	  }
+      for( int i = 0; i < N; ++i)
+	for( int k = 0; k < N; ++k)
+	  {
+	    P[i][k] = Q[i][k];
+	    for( int j = 0; j < N; ++j)
+	      P[i][k] += T[i][j] * A[k][j];
+	  }
+
+      // S = C P C' + R
+      for( int i = 0; i < N; ++i)
+	for( int k = 0; k < L; ++k)
+	  {
+	    PCt[i][k] = 0.0;
+	    for( int j = 0; j < N; ++j)
+	      PCt[i][k] += P[i][j] * C[k][j];
+	  }
+      for( int i = 0; i < L; ++i)
+	for( int k = 0; k < L; ++k)
+	  {
+	    S[i][k] = R[i][k];
+	    for( int j = 0; j < N; ++j)
+	      S[i][k] += C[i][j] * PCt[j][k];
+	  }
+
+      // Si = S^-1
+      if( invert_matrix<L>( S, Si))
+	return true; // singular
+
+      // K = P C' S^-1
+      double change = 0.0;
+      for( int i = 0; i < N; ++i)
+	for( int k = 0; k < L; ++k)
+	  {
+	    double gain = 0.0;
+	    for( int j = 0; j < L; ++j)
+	      gain += PCt[i][j] * Si[j][k];
+	    if( iteration > 0)
+	      change = fmax( change, fabs( gain - G[i][k]));
+	    G[i][k] = gain;
+	  }
+
+      // update: P = (I - K C) P
+      for( int i = 0; i < N; ++i)
+	for( int k = 0; k < N; ++k)
+	  {
+	    T[i][k] = P[i][k];
+	    for( int j = 0; j < L; ++j)
+	      T[i][k] -= G[i][j] * PCt[k][j]; // P symmetric: (C P)[j][k] = PCt[k][j]
+	  }
+      for( int i = 0; i < N; ++i) // keep P symmetric, otherwise rounding errors make the iteration diverge
+	for( int k = 0; k < N; ++k)
+	  P[i][k] = 0.5 * ( T[i][k] + T[k][i]);
+
+      if( iteration > 0 && change < tolerance)
+	{
+	  for( int i = 0; i < N; ++i)
+	    for( int k = 0; k < L; ++k)
+	      K[i][k] = (float)G[i][k];
+	  return false; // OK
+	}
+    }
+  return true; // no convergence
+}
+
+//! steady-state Kalman gain only, see solve_steady_state_Kalman_filter()
+template <int N, int L>
+bool solve_steady_state_Kalman_gain(
+    const double A[N][N], const double C[L][N],
+    const double Q[N][N], const double R[L][L],
+    float K[N][L],
+    unsigned max_iterations = 100000, double tolerance = 1e-10)
+{
+  double P[N][N];
+  return solve_steady_state_Kalman_filter<N,L>( A, C, Q, R, K, P, max_iterations, tolerance);
+}
+
+/**
+ * @brief steady-state Rauch-Tung-Striebel smoother gain
+ *
+ * J = P A' (A P A' + Q)^-1 with P from solve_steady_state_Kalman_filter().
+ * Backward pass: x_smoothed[k] = x[k] + J ( x_smoothed[k+1] - A x[k])
+ * @return true on error: singular prediction covariance
+ */
+template <int N>
+bool solve_steady_state_smoother_gain(
+    const double A[N][N], const double Q[N][N], const double P[N][N],
+    float J[N][N])
+{
+  double PAt[N][N], S[N][N], Si[N][N];
+
+  for( int i = 0; i < N; ++i)
+    for( int k = 0; k < N; ++k)
+      {
+	PAt[i][k] = 0.0;
+	for( int j = 0; j < N; ++j)
+	  PAt[i][k] += P[i][j] * A[k][j];
+      }
+  for( int i = 0; i < N; ++i)
+    for( int k = 0; k < N; ++k)
+      {
+	S[i][k] = Q[i][k];
+	for( int j = 0; j < N; ++j)
+	  S[i][k] += A[i][j] * PAt[j][k];
+      }
+
+  if( invert_matrix<N>( S, Si))
+    return true;
+
+  for( int i = 0; i < N; ++i)
+    for( int k = 0; k < N; ++k)
+      {
+	double gain = 0.0;
+	for( int j = 0; j < N; ++j)
+	  gain += PAt[i][j] * Si[j][k];
+	J[i][k] = (float)gain;
+      }
+  return false;
+}
+
+#endif /* KALMAN_GAIN_SOLVER_H_ */
@@ -117,4 +117,97 @@ template<typename sample_type, typename evaluation_type=sample_type>
     sample_type n;
   };
 
+/**
+ * @brief linear least square fit for  y = a + b * x using float state only
+ *
+ * Welford-type update of the means and co-moments, the means are kept with Kahan compensation.
+ * The residual sum of squares is accumulated directly from the prediction errors,
+ * so it can not become negative by cancellation.
+ * Same interface as linear_least_square_fit and about the same accuracy as 64-bit integer sums
+ * but no 64-bit multiply-accumulates and no integer -> float conversion.
+ */
+template<typename evaluation_type=float>
+  class linear_least_square_fit_welford
+  {
+  public:
+    linear_least_square_fit_welford (void)
+    {
+      reset ();
+    }
+    void
+    add_value (const evaluation_type x, const evaluation_type y)
+    {
+      ++n;
+      evaluation_type inv_n = (evaluation_type)ONE / n;
+      evaluation_type weight = (evaluation_type)ONE - inv_n;
+      evaluation_type dx = x - mean_x;
+      evaluation_type dy = y - mean_y;
+
+      evaluation_type slope = Qx > ZERO ? Qxy / Qx : ZERO;
+      evaluation_type prediction_error = dy - slope * dx;
+      evaluation_type new_Qx = Qx + weight * dx * dx;
+      if( new_Qx > ZERO)
+	residual_square_sum += weight * SQR( prediction_error) * Qx / new_Qx;
+
+      Qx = new_Qx;
+      Qxy += weight * dx * dy;
+      compensated_add( mean_x, compensation_x, dx * inv_n);
+      compensated_add( mean_y, compensation_y, dy * inv_n);
+    }
+    void
+    reset (void)
+    {
+      mean_x = mean_y = compensation_x = compensation_y = Qx = Qxy = residual_square_sum = ZERO;
+      n = 0;
+    }
+    void
+    evaluate (evaluation_type &a, evaluation_type &b, evaluation_type &variance_a, evaluation_type &variance_b) const
+    {
+      evaluation_type inv_n = (evaluation_type)ONE / n;
+      evaluation_type invQx = (evaluation_type)ONE / Qx;
+      evaluation_type Vyx = residual_square_sum / (n - TWO);
+
+      b = Qxy * invQx;
+      a = mean_y - b * mean_x;
+
+      variance_a = Vyx * (inv_n + SQR( mean_x) * invQx);
+      variance_b = Vyx * invQx;
+    }
+    void
+    evaluate (linear_least_square_result<evaluation_type> &r) const
+    {
+      evaluate (r.y_offset, r.slope, r.variance_offset, r.variance_slope);
+    }
+    unsigned
+    get_count (void) const
+    {
+      return n;
+    }
+    evaluation_type get_mean_y( void) const
+    {
+      return mean_y;
+    }
+    evaluation_type get_mean_x( void) const
+    {
+      return mean_x;
+    }
+  private:
+    //! Kahan summation step
+    static void compensated_add( evaluation_type &sum, evaluation_type &compensation, evaluation_type value)
+    {
+      evaluation_type corrected = value - compensation;
+      evaluation_type new_sum = sum + corrected;
+      compensation = (new_sum - sum) - corrected;
+      sum = new_sum;
+    }
+    evaluation_type mean_x;
+    evaluation_type mean_y;
+    evaluation_type compensation_x;
+    evaluation_type compensation_y;
+    evaluation_type Qx;  //!< sum of squared x deviations
+    evaluation_type Qxy; //!< sum of x * y deviations
+    evaluation_type residual_square_sum;
+    unsigned n;
+  };
+
 #endif /* LINEAR_LEAST_SQUARE_FIT_H_ */
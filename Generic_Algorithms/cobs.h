@@ -0,0 +1,94 @@
+/***********************************************************************//**
+ * @file		cobs.h
+ * @brief		consistent overhead byte stuffing (COBS) framing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+
+//! worst case encoded size of size bytes, without the 0x00 delimiter
+#define COBS_ENCODED_SIZE( size) ( ( size) + ( size) / 254 + 1)
+
+/**
+ * @brief COBS encoder, the result contains no zero bytes
+ *
+ * target must provide COBS_ENCODED_SIZE( size) bytes and must not overlap source.
+ * The frame delimiter 0x00 is not appended.
+ * @return encoded length
+ */
+inline unsigned cobs_encode( const uint8_t *source, unsigned size, uint8_t *target)
+{
+  uint8_t *code = target; // position of the current code byte
+  uint8_t *next = target + 1;
+  uint8_t count = 1;
+  for( unsigned i = 0; i < size; ++i)
+    {
+      if( source[i] == 0)
+	{
+	  *code = count;
+	  code = next++;
+	  count = 1;
+	  continue;
+	}
+      *next++ = source[i];
+      if( ++count == 0xff)
+	{
+	  *code = count;
+	  code = next++;
+	  count = 1;
+	}
+    }
+  *code = count;
+  return next - target;
+}
+
+/**
+ * @brief COBS decoder, target may be identical to source (in-place decoding)
+ *
+ * source is one frame without the 0x00 delimiter.
+ * @return true on error: zero byte within the frame or truncated block
+ */
+inline bool cobs_decode( const uint8_t *source, unsigned size, uint8_t *target, unsigned &length)
+{
+  const uint8_t *end = source + size;
+  uint8_t *next = target;
+  while( source < end)
+    {
+      uint8_t code = *source++;
+      if( code == 0 || source + code - 1 > end)
+	return true;
+      for( uint8_t i = 1; i < code; ++i)
+	{
+	  if( *source == 0)
+	    return true;
+	  *next++ = *source++;
+	}
+      if( code != 0xff && source < end)
+	*next++ = 0;
+    }
+  length = next - target;
+  return false;
+}
+
+#endif /* COBS_H_ */
@@ -0,0 +1,122 @@
+/***********************************************************************//**
+ * @file		constexpr_math.h
+ * @brief		trigonometric functions usable at compile time
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef CONSTEXPR_MATH_H_
+#define CONSTEXPR_MATH_H_
+
+//! double precision taylor series, meant for filter design, not for the signal path
+#define CONSTEXPR_PI 	3.14159265358979323846
+#define CONSTEXPR_PI_2 	1.57079632679489661923
+
+//! sine, argument reduced to [-PI/2, PI/2], error < 1e-16
+constexpr double constexpr_sin( double x)
+{
+  // reduce to [-PI, PI]
+  long turns = (long)( x / ( 2.0 * CONSTEXPR_PI) + ( x < 0.0 ? -0.5 : 0.5));
+  x -= 2.0 * CONSTEXPR_PI * (double)turns;
+
+  // reflect to [-PI/2, PI/2]
+  if( x > CONSTEXPR_PI_2)
+    x = CONSTEXPR_PI - x;
+  else if( x < -CONSTEXPR_PI_2)
+    x = -CONSTEXPR_PI - x;
+
+  double x2 = x * x;
+  double term = x;
+  double sum = x;
+  for( int n = 1; n < 12; ++n)
+    {
+      term *= -x2 / ( ( 2 * n) * ( 2 * n + 1));
+      sum += term;
+    }
+  return sum;
+}
+
+constexpr double constexpr_cos( double x)
+{
+  return constexpr_sin( x + CONSTEXPR_PI_2);
+}
+
+constexpr double constexpr_tan( double x)
+{
+  return constexpr_sin( x) / constexpr_cos( x);
+}
+
+#define CONSTEXPR_LN2	0.69314718055994530942
+
+//! natural logarithm, x > 0, reduced to [0.5, 2], error < 1e-16
+constexpr double constexpr_log( double x)
+{
+  int exponent = 0;
+  while( x > 2.0)
+    {
+      x *= 0.5;
+      ++exponent;
+    }
+  while( x < 0.5)
+    {
+      x *= 2.0;
+      --exponent;
+    }
+
+  // ln x = 2 artanh( (x-1) / (x+1)), |z| <= 1/3
+  double z = ( x - 1.0) / ( x + 1.0);
+  double z2 = z * z;
+  double term = z;
+  double sum = 0.0;
+  for( int n = 0; n < 20; ++n)
+    {
+      sum += term / ( 2 * n + 1);
+      term *= z2;
+    }
+  return 2.0 * sum + exponent * CONSTEXPR_LN2;
+}
+
+//! exponential function, reduced to |x| <= ln(2) / 2, relative error < 1e-16
+constexpr double constexpr_exp( double x)
+{
+  long exponent = (long)( x / CONSTEXPR_LN2 + ( x < 0.0 ? -0.5 : 0.5));
+  x -= exponent * CONSTEXPR_LN2;
+
+  double term = 1.0;
+  double sum = 1.0;
+  for( int n = 1; n < 18; ++n)
+    {
+      term *= x / n;
+      sum += term;
+    }
+  for( ; exponent > 0; --exponent)
+    sum *= 2.0;
+  for( ; exponent < 0; ++exponent)
+    sum *= 0.5;
+  return sum;
+}
+
+//! x^y for x > 0
+constexpr double constexpr_pow( double x, double y)
+{
+  return constexpr_exp( y * constexpr_log( x));
+}
+
+#endif /* CONSTEXPR_MATH_H_ */
@@ -0,0 +1,55 @@
+/***********************************************************************//**
+ * @file		crc16.h
+ * @brief		table-driven CRC-16/CCITT
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+
+#define CRC16_INITIAL_VALUE 0xffff	//!< CRC-16/CCITT-FALSE, polynomial 0x1021
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const uint16_t CRC16_TABLE[256];
+
+//! continue a CRC over size bytes, start with CRC16_INITIAL_VALUE
+inline uint16_t crc16_update( uint16_t crc, const uint8_t *data, unsigned size)
+{
+  for( unsigned i = 0; i < size; ++i)
+    crc = (uint16_t)( ( crc << 8) ^ CRC16_TABLE[( crc >> 8) ^ data[i]]);
+  return crc;
+}
+
+inline uint16_t crc16( const uint8_t *data, unsigned size)
+{
+  return crc16_update( CRC16_INITIAL_VALUE, data, size);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC16_H_ */
@@ -0,0 +1,88 @@
+/***********************************************************************//**
+ * @file		deferred_job.h
+ * @brief		single-slot job handshake between the real-time loop and a background task
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef DEFERRED_JOB_H_
+#define DEFERRED_JOB_H_
+
+#include <stdint.h>
+
+/**
+ * @brief one job slot owned alternately by the real-time loop and a background task
+ *
+ * The real-time side fills a job in with prepare() and submit(),
+ * the background side processes it between get_submitted() and complete(),
+ * then the real-time side takes the results with get_completed() and release().
+ * Whoever owns the slot by its state may touch the job, there is no lock.
+ * A completed job may be submitted again for a second processing step.
+ */
+template <class job_type> class deferred_job_t
+{
+public:
+  deferred_job_t( void)
+    : state( IDLE)
+  {}
+
+  //! real-time side: the job to fill in, 0 if the slot is busy
+  job_type * prepare( void)
+  {
+    return __atomic_load_n( &state, __ATOMIC_ACQUIRE) == IDLE ? &job : 0;
+  }
+
+  //! real-time side: hand the job to the background task
+  void submit( void)
+  {
+    __atomic_store_n( &state, SUBMITTED, __ATOMIC_RELEASE);
+  }
+
+  //! background side: the job to process, 0 if none is pending
+  job_type * get_submitted( void)
+  {
+    return __atomic_load_n( &state, __ATOMIC_ACQUIRE) == SUBMITTED ? &job : 0;
+  }
+
+  //! background side: post the results back
+  void complete( void)
+  {
+    __atomic_store_n( &state, COMPLETED, __ATOMIC_RELEASE);
+  }
+
+  //! real-time side: the processed job, 0 if there is none
+  job_type * get_completed( void)
+  {
+    return __atomic_load_n( &state, __ATOMIC_ACQUIRE) == COMPLETED ? &job : 0;
+  }
+
+  //! real-time side: results consumed, the slot is free again
+  void release( void)
+  {
+    __atomic_store_n( &state, IDLE, __ATOMIC_RELEASE);
+  }
+
+private:
+  enum { IDLE, SUBMITTED, COMPLETED};
+  uint32_t state;
+  job_type job;
+};
+
+#endif /* DEFERRED_JOB_H_ */
@@ -25,29 +25,32 @@
 #ifndef DELAY_LINE_H_
 #define DELAY_LINE_H_
 
-//! delay line for testing purposes (template)
+//! delay line for testing purposes (template), uses masking for power-of-two lengths
 template <class data_t, unsigned length> class delay_line
 {
 public:
   delay_line( void)
     :storage{0},
-     ptr(storage)
+     index(0)
     {};
   data_t respond( const data_t &right)
   {
-    data_t retv=*ptr;
-    *ptr=right;
+    data_t retv=storage[index];
+    storage[index]=right;
 
-    ++ptr;
+    ++index;
 
-    if( ptr >= storage + length)
-      ptr=storage;
+    if( POWER_OF_TWO)
+      index &= MASK;
+    else if( index >= length)
+      index=0;
 
     return retv;
   }
 private:
+  enum { POWER_OF_TWO = ( length & ( length - 1)) == 0, MASK = length - 1};
   data_t storage[length];
-  data_t * ptr;
+  unsigned index;
 };
 
 #endif /* DELAY_LINE_H_ */
@@ -0,0 +1,116 @@
+/***********************************************************************//**
+ * @file		denormal.h
+ * @brief		denormal flushing for filter states and scoped FTZ / DAZ mode
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef DENORMAL_H_
+#define DENORMAL_H_
+
+#include "system_configuration.h"
+#include "vector.h"
+#include <float.h>
+#include <math.h>
+#if defined( __SSE__)
+#include <xmmintrin.h>
+#endif
+
+//! replace a denormal value by zero, NAN and INF pass unchanged
+inline void flush_denormal( float &x)
+{
+  if( fabsf( x) < FLT_MIN)
+    x = 0.0f;
+}
+
+inline void flush_denormal( double &x)
+{
+  if( fabs( x) < DBL_MIN)
+    x = 0.0;
+}
+
+template <class datatype, int size> void flush_denormal( vector<datatype, size> &x)
+{
+  for( int i = 0; i < size; ++i)
+    flush_denormal( x.e[i]);
+}
+
+//! filter template policy: IEEE arithmetic, as the hardware does it
+class keep_denormals_t
+{
+public:
+  template <class datatype> static void apply( datatype &)
+  {}
+};
+
+//! filter template policy: feedback states decaying below FLT_MIN become zero
+class flush_denormals_t
+{
+public:
+  template <class datatype> static void apply( datatype &x)
+  {
+    flush_denormal( x);
+  }
+};
+
+/**
+ * @brief flush-to-zero and denormals-are-zero for the lifetime of the object, calling thread only
+ *
+ * The previous mode is restored on destruction.
+ * x86 (SSE) and AArch64 hosts, no-op elsewhere:
+ * the Cortex-M4 FPU processes denormals at full speed.
+ */
+class scoped_flush_denormals_t
+{
+public:
+  scoped_flush_denormals_t( void)
+  {
+#if defined( __SSE__)
+    saved = _mm_getcsr();
+    _mm_setcsr( saved | FTZ_DAZ);
+#elif defined( __aarch64__)
+    __asm__ __volatile__( "mrs %0, fpcr" : "=r"( saved));
+    __asm__ __volatile__( "msr fpcr, %0" : : "r"( saved | FTZ_DAZ));
+#endif
+  }
+
+  ~scoped_flush_denormals_t( void)
+  {
+#if defined( __SSE__)
+    _mm_setcsr( saved);
+#elif defined( __aarch64__)
+    __asm__ __volatile__( "msr fpcr, %0" : : "r"( saved));
+#endif
+  }
+
+private:
+  scoped_flush_denormals_t( const scoped_flush_denormals_t &) = delete;
+  scoped_flush_denormals_t & operator = ( const scoped_flush_denormals_t &) = delete;
+
+#if defined( __SSE__)
+  enum { FTZ_DAZ = 0x8040 }; //!< MXCSR bits 15 (FTZ) and 6 (DAZ)
+  unsigned saved;
+#elif defined( __aarch64__)
+  enum { FTZ_DAZ = 1 << 24 }; //!< FPCR.FZ, flushes inputs and results
+  unsigned long saved;
+#endif
+};
+
+#endif /* DENORMAL_H_ */
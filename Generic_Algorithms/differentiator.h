@@ -33,8 +33,8 @@ template <class basetype, class datatype>
    {
 public:
 //! constructor taking sampling-time and initial value
-   differentiator( basetype Tdiff, basetype Tsampling, const datatype& init_value = 0)
-      : time_constant( Tdiff / Tsampling), old_value( init_value)
+   constexpr differentiator( basetype Tdiff, basetype Tsampling, const datatype& init_value = 0)
+      : time_constant( Tdiff / Tsampling), old_value( init_value), differentiation( init_value), output( init_value)
       {};
 
    //! update differentiator taking next input value
@@ -57,6 +57,26 @@ public:
       return get_value();
       };
 
+//! dynamic state for checkpoints
+    class state_t
+      {
+    public:
+      datatype old_value;
+      datatype output;
+      };
+
+    void save_state( state_t &state) const
+      {
+      state.old_value = old_value;
+      state.output = output;
+      }
+
+    void restore_state( const state_t &state)
+      {
+      old_value = state.old_value;
+      output = state.output;
+      }
+
 private:
 //! sampling time
    const basetype time_constant;
@@ -0,0 +1,134 @@
+/***********************************************************************//**
+ * @file		fast_math.h
+ * @brief		polynomial approximations for transcendental functions
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef FAST_MATH_H_
+#define FAST_MATH_H_
+
+#include "embedded_math.h"
+
+/**
+ * Two classes of call sites:
+ * Attitude-critical code keeps using ATAN2, ASIN, SQRT, SIN, COS from embedded_math.h.
+ * Display and output code uses the DISPLAY_xxx macros below,
+ * which map to the approximations if FAST_MATH_FOR_DISPLAY is set.
+ *
+ * Maximum absolute errors measured against libm (asserted by Tests/fast_math_test.cpp):
+ *   fast_atan2f  2.0e-6 rad
+ *   fast_asinf   3.0e-7 rad
+ *   fast_sinf    3.4e-6	(argument range +/- 2 PI, grows slowly outside)
+ *   fast_cosf    3.4e-6
+ *   fast_sqrtf   exact, maps to VSQRT.F32 on the M4F
+ */
+#ifndef FAST_MATH_FOR_DISPLAY
+#define FAST_MATH_FOR_DISPLAY 1 //!< if 1: use approximations for display and output data
+#endif
+
+#define FAST_MATH_PI_2 	1.57079632679f
+#define FAST_MATH_PI 	3.14159265359f
+#define FAST_MATH_2_PI 	6.28318530718f
+
+//! arctan on [-1, 1], minimax polynomial in x^2
+inline float fast_atan_unity( float x)
+{
+  float x2 = x * x;
+  return x * ( 0.99997726f + x2 * ( -0.33262347f + x2 * ( 0.19354346f
+	 + x2 * ( -0.11643287f + x2 * ( 0.05265332f + x2 * -0.01172120f)))));
+}
+
+//! four-quadrant arctan(y/x)
+inline float fast_atan2f( float y, float x)
+{
+  float abs_x = x < 0.0f ? -x : x;
+  float abs_y = y < 0.0f ? -y : y;
+  if( abs_x == 0.0f && abs_y == 0.0f)
+    return 0.0f;
+
+  float result;
+  if( abs_y <= abs_x)
+      result = fast_atan_unity( abs_y / abs_x);
+  else
+      result = FAST_MATH_PI_2 - fast_atan_unity( abs_x / abs_y);
+
+  if( x < 0.0f)
+    result = FAST_MATH_PI - result;
+  return y < 0.0f ? -result : result;
+}
+
+//! arcsin, Abramowitz/Stegun 4.4.46
+inline float fast_asinf( float x)
+{
+  float abs_x = x < 0.0f ? -x : x;
+  if( abs_x > 1.0f)
+    abs_x = 1.0f;
+  float result = FAST_MATH_PI_2 - __builtin_sqrtf( 1.0f - abs_x) *
+      ( 1.5707963050f + abs_x * ( -0.2145988016f + abs_x * ( 0.0889789874f
+      + abs_x * ( -0.0501743046f + abs_x * ( 0.0308918810f + abs_x * ( -0.0170881256f
+      + abs_x * ( 0.0066700901f + abs_x * -0.0012624911f)))))));
+  return x < 0.0f ? -result : result;
+}
+
+//! sine, reduction to [-PI/2, PI/2] and odd polynomial of 9th order
+inline float fast_sinf( float x)
+{
+  // reduce to [-PI, PI]
+  x -= FAST_MATH_2_PI * (float)(int)( x * ( 1.0f / FAST_MATH_2_PI) + ( x < 0.0f ? -0.5f : 0.5f));
+
+  // reflect to [-PI/2, PI/2]
+  if( x > FAST_MATH_PI_2)
+    x = FAST_MATH_PI - x;
+  else if( x < -FAST_MATH_PI_2)
+    x = -FAST_MATH_PI - x;
+
+  float x2 = x * x;
+  return x * ( 1.0f + x2 * ( -1.6666667e-1f + x2 * ( 8.3333110e-3f
+	 + x2 * ( -1.9840874e-4f + x2 * 2.7525562e-6f))));
+}
+
+//! cosine via phase shift
+inline float fast_cosf( float x)
+{
+  return fast_sinf( x + FAST_MATH_PI_2);
+}
+
+//! square root, hardware instruction if available
+inline float fast_sqrtf( float x)
+{
+  return __builtin_sqrtf( x);
+}
+
+#if FAST_MATH_FOR_DISPLAY
+#define DISPLAY_ATAN2(y, x)	fast_atan2f( (y), (x))
+#define DISPLAY_ASIN(x)		fast_asinf( x)
+#define DISPLAY_SIN(x)		fast_sinf( x)
+#define DISPLAY_COS(x)		fast_cosf( x)
+#define DISPLAY_SQRT(x)		fast_sqrtf( x)
+#else
+#define DISPLAY_ATAN2(y, x)	ATAN2( (y), (x))
+#define DISPLAY_ASIN(x)		ASIN( x)
+#define DISPLAY_SIN(x)		SIN( x)
+#define DISPLAY_COS(x)		COS( x)
+#define DISPLAY_SQRT(x)		SQRT( x)
+#endif
+
+#endif /* FAST_MATH_H_ */
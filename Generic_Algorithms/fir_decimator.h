@@ -0,0 +1,145 @@
+/***********************************************************************//**
+ * @file		fir_decimator.h
+ * @brief		linear phase FIR decimation filter (template)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef FIR_DECIMATOR_H_
+#define FIR_DECIMATOR_H_
+
+#include "constexpr_math.h"
+#include "ringbuffer.h"
+
+//! symmetric FIR impulse response
+template <class basetype, unsigned TAPS> class fir_coefficients_t
+{
+public:
+  basetype h[TAPS];
+};
+
+/**
+ * @brief windowed-sinc lowpass for Fc/Fs, -6dB @ Fc, hamming window, DC gain = 1.0
+ *
+ * Stopband attenuation > 50 dB, transition width about 3.3 * Fs / TAPS.
+ */
+template <class basetype, unsigned TAPS>
+constexpr fir_coefficients_t<basetype, TAPS> design_fir_lowpass( double fcutoff)
+{
+  fir_coefficients_t<basetype, TAPS> result = {};
+  double h[TAPS] = {};
+  double sum = 0.0;
+  for( unsigned k = 0; k < TAPS; ++k)
+    {
+      double t = (double)k - 0.5 * ( TAPS - 1);
+      double x = 2.0 * CONSTEXPR_PI * fcutoff * t;
+      double sinc = t == 0.0 ? 2.0 * fcutoff : constexpr_sin( x) / ( CONSTEXPR_PI * t);
+      double window = 0.54 - 0.46 * constexpr_cos( 2.0 * CONSTEXPR_PI * k / ( TAPS - 1));
+      h[k] = sinc * window;
+      sum += h[k];
+    }
+  for( unsigned k = 0; k < TAPS; ++k)
+    result.h[k] = (basetype)( h[k] / sum);
+  return result;
+}
+
+/**
+ * @brief FIR lowpass decimating by FACTOR
+ *
+ * respond() is called at the input rate and only stores the sample,
+ * the convolution runs once per FACTOR samples at the output rate.
+ * The impulse response is symmetric, so the folded form needs TAPS / 2 multiplications.
+ * Group delay is ( TAPS - 1) / 2 input samples.
+ */
+template <class datatype, class basetype, unsigned TAPS, unsigned FACTOR> class fir_decimator
+{
+  static_assert( TAPS >= 2, "at least two taps required");
+public:
+  fir_decimator( const fir_coefficients_t<basetype, TAPS> &_coefficients)
+  : coefficients( _coefficients),
+    counter( 0),
+    output( datatype())
+  {}
+
+  //! fill the history with a constant input
+  void settle( const datatype &present_input)
+  {
+    history.setAllValues( present_input);
+    output = present_input;
+    counter = 0;
+  }
+
+  //! returns true if a new output has been computed
+  bool respond( const datatype &input)
+  {
+    history.pushValue( input);
+    if( ++counter < FACTOR)
+      return false;
+    counter = 0;
+
+    const datatype *x = history.getWindow( TAPS);
+    datatype sum = ( x[0] + x[TAPS - 1]) * coefficients.h[0];
+    for( unsigned k = 1; k < TAPS / 2; ++k)
+      sum = sum + ( x[k] + x[TAPS - 1 - k]) * coefficients.h[k];
+    if( TAPS & 1)
+      sum = sum + x[TAPS / 2] * coefficients.h[TAPS / 2];
+    output = sum;
+    return true;
+  }
+
+  datatype get_output( void) const
+  {
+    return output;
+  }
+
+  //! dynamic state for checkpoints: the last TAPS inputs, without the coefficients
+  class state_t
+  {
+  public:
+    datatype history[TAPS];
+    unsigned counter;
+    datatype output;
+  };
+
+  void save_state( state_t &state) const
+  {
+    const datatype *x = history.getWindow( TAPS);
+    for( unsigned k = 0; k < TAPS; ++k)
+      state.history[k] = x[k];
+    state.counter = counter;
+    state.output = output;
+  }
+
+  void restore_state( const state_t &state)
+  {
+    for( unsigned k = 0; k < TAPS; ++k)
+      history.pushValue( state.history[k]);
+    counter = state.counter;
+    output = state.output;
+  }
+
+private:
+  fir_coefficients_t<basetype, TAPS> coefficients;
+  MirroredRingBuffer<datatype, TAPS> history;
+  unsigned counter;
+  datatype output;
+};
+
+#endif /* FIR_DECIMATOR_H_ */
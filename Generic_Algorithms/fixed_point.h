@@ -0,0 +1,184 @@
+/***********************************************************************//**
+ * @file		fixed_point.h
+ * @brief		saturating Q-format fixed-point number (template)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef FIXED_POINT_H_
+#define FIXED_POINT_H_
+
+#include <stdint.h>
+
+/**
+ * @brief signed 32 bit fixed-point number with FRACTION fractional bits
+ *
+ * Drop-in datatype / basetype for the pt2, HP_LP_fusion, integrator, differentiator
+ * and vector templates on cores without FPU.
+ * All operations saturate instead of wrapping, products use a 64 bit intermediate
+ * and are rounded to nearest.
+ * Floats convert implicitly (constants in the templates), the way back is explicit.
+ * A product with a different format keeps the format of the left operand:
+ * data in Q16 times coefficient in Q30 gives Q16.
+ */
+template <int FRACTION> class fixed_point
+{
+  static_assert( FRACTION > 0 && FRACTION < 31, "FRACTION out of range");
+public:
+  enum { FRACTION_BITS = FRACTION };
+
+  constexpr fixed_point( void)
+    : raw( 0)
+  {}
+  constexpr fixed_point( int value)
+    : raw( saturate( (int64_t)value * ( (int64_t)1 << FRACTION)))
+  {}
+  constexpr fixed_point( float value)
+    : raw( from_double( value))
+  {}
+  constexpr fixed_point( double value)
+    : raw( from_double( value))
+  {}
+  //! format conversion, explicit to keep the operators unambiguous
+  template <int OTHER> explicit constexpr fixed_point( const fixed_point<OTHER> &right)
+    : raw( OTHER > FRACTION
+	   ? saturate( ( (int64_t)right.get_raw() + ( (int64_t)1 << ( OTHER > FRACTION ? OTHER - FRACTION - 1 : 0))) >> ( OTHER > FRACTION ? OTHER - FRACTION : 0))
+	   : saturate( (int64_t)right.get_raw() * ( (int64_t)1 << ( OTHER < FRACTION ? FRACTION - OTHER : 0))))
+  {}
+
+  static constexpr fixed_point from_raw( int32_t value)
+  {
+    fixed_point result;
+    result.raw = value;
+    return result;
+  }
+  constexpr int32_t get_raw( void) const
+  {
+    return raw;
+  }
+
+  explicit constexpr operator float( void) const
+  {
+    return (float)raw * ( 1.0f / (float)( (int64_t)1 << FRACTION));
+  }
+  explicit constexpr operator double( void) const
+  {
+    return (double)raw * ( 1.0 / (double)( (int64_t)1 << FRACTION));
+  }
+
+  constexpr fixed_point operator -( void) const
+  {
+    return from_raw( saturate( - (int64_t)raw));
+  }
+
+  friend constexpr fixed_point operator +( const fixed_point &left, const fixed_point &right)
+  {
+    return from_raw( saturate( (int64_t)left.raw + right.raw));
+  }
+  friend constexpr fixed_point operator -( const fixed_point &left, const fixed_point &right)
+  {
+    return from_raw( saturate( (int64_t)left.raw - right.raw));
+  }
+  friend constexpr fixed_point operator *( const fixed_point &left, const fixed_point &right)
+  {
+    return left.multiply( right);
+  }
+  friend constexpr fixed_point operator /( const fixed_point &left, const fixed_point &right)
+  {
+    return from_raw( right.raw == 0
+		     ? ( left.raw < 0 ? INT32_MIN : INT32_MAX)
+		     : saturate( ( (int64_t)left.raw * ( (int64_t)1 << FRACTION)) / right.raw));
+  }
+
+  //! mixed format product, result in this format
+  template <int OTHER> constexpr fixed_point operator *( const fixed_point<OTHER> &right) const
+  {
+    return multiply( right);
+  }
+
+  fixed_point & operator +=( const fixed_point &right)
+  {
+    return *this = *this + right;
+  }
+  fixed_point & operator -=( const fixed_point &right)
+  {
+    return *this = *this - right;
+  }
+  fixed_point & operator *=( const fixed_point &right)
+  {
+    return *this = *this * right;
+  }
+  template <int OTHER> fixed_point & operator *=( const fixed_point<OTHER> &right)
+  {
+    return *this = multiply( right);
+  }
+  fixed_point & operator /=( const fixed_point &right)
+  {
+    return *this = *this / right;
+  }
+
+  friend constexpr bool operator ==( const fixed_point &left, const fixed_point &right)
+  {
+    return left.raw == right.raw;
+  }
+  friend constexpr bool operator !=( const fixed_point &left, const fixed_point &right)
+  {
+    return left.raw != right.raw;
+  }
+  friend constexpr bool operator <( const fixed_point &left, const fixed_point &right)
+  {
+    return left.raw < right.raw;
+  }
+  friend constexpr bool operator >( const fixed_point &left, const fixed_point &right)
+  {
+    return left.raw > right.raw;
+  }
+  friend constexpr bool operator <=( const fixed_point &left, const fixed_point &right)
+  {
+    return left.raw <= right.raw;
+  }
+  friend constexpr bool operator >=( const fixed_point &left, const fixed_point &right)
+  {
+    return left.raw >= right.raw;
+  }
+
+private:
+  static constexpr int32_t saturate( int64_t value)
+  {
+    return value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : (int32_t)value;
+  }
+  static constexpr int32_t from_double( double value)
+  {
+    return value >=  2147483647.0 / (double)( (int64_t)1 << FRACTION) ? INT32_MAX
+	 : value <= -2147483648.0 / (double)( (int64_t)1 << FRACTION) ? INT32_MIN
+	 : (int32_t)( value * (double)( (int64_t)1 << FRACTION) + ( value < 0.0 ? -0.5 : 0.5));
+  }
+  template <int OTHER> constexpr fixed_point multiply( const fixed_point<OTHER> &right) const
+  {
+    return from_raw( saturate( ( (int64_t)raw * right.get_raw() + ( (int64_t)1 << ( OTHER - 1))) >> OTHER));
+  }
+
+  int32_t raw;
+};
+
+typedef fixed_point<16> fixed16_t; //!< Q15.16: +/- 32768, resolution 1.5e-5, measurement data and states
+typedef fixed_point<30> fixed30_t; //!< Q1.30: +/- 2, resolution 9.3e-10, filter gains and coefficients
+
+#endif /* FIXED_POINT_H_ */
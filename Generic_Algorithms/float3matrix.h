@@ -15,4 +15,6 @@
 //! matrix of 3 * 3 float values
 typedef matrix<float, 3> float3matrix;
 
+static_assert( std::is_trivially_copyable<float3matrix>::value, "float3matrix must be copied by memcpy");
+
 #endif /* FLOAT3MATRIX_H_ */
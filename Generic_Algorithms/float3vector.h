@@ -8,7 +8,10 @@
 #ifndef FLOAT3VECTOR_H_
 #define FLOAT3VECTOR_H_
 #include "vector.h"
+#include <type_traits>
 
 typedef vector< float, 3> float3vector;
 
+static_assert( std::is_trivially_copyable<float3vector>::value, "float3vector must be copied by memcpy");
+
 #endif /* FLOAT3VECTOR_H_ */
@@ -41,11 +41,11 @@ public:
       //! constructor from array data
       //! elements are assumed to come line by line
    matrix( const datatype data[size][size]);
-//! copy constructor
-   matrix( const matrix & right);
+//! copy constructor, trivial
+   matrix( const matrix & right) = default;
 
-//! copy assignment operator
-   matrix & operator =  ( const matrix & right);
+//! copy assignment operator, trivial
+   matrix & operator =  ( const matrix & right) = default;
    //! multiplication (matrix times vector) -> vector
  vector <datatype, size> operator *( const vector <datatype, size> & right) const;
  //! multiplication (matrix times vector) -> vector
@@ -91,22 +91,6 @@ template<class datatype, int size>
 	  e[k][i] = *data++;
   }
    
-// copy constructor
-template <class datatype, int size> matrix <datatype, size>::matrix( const matrix <datatype, size> & right)
-   {
-   for( int k=0; k<size; ++k)
-      for( int i=0; i<size; ++i)
-         e[i][k]=right.e[i][k];
-   }
-
-template <class datatype, int size> matrix <datatype, size> & matrix <datatype, size>::operator =( const matrix <datatype, size> & right)
-   {
-   for( int i=0; i<size; ++i)
-      for( int k=0; k<size; ++k)
-         e[i][k]=right.e[i][k];
-   return *this;
-   }
-
 template <class datatype, int size>
  vector <datatype, size> matrix <datatype, size>::operator *( const vector <datatype, size> & right) const   //returns a vector<datatype, size> and
    {                                                                      //actual object is matrix<datatype, size>
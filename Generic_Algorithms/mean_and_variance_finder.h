@@ -43,4 +43,45 @@ private:
   unsigned samples;
 };
 
+//! Welford-type mean and variance finder, float state, no large sums
+template <class sample_data>class mean_and_variance_welford_t
+{
+public:
+  mean_and_variance_welford_t( void)
+  : mean(0),
+    square_deviation_sum(0),
+    samples(0)
+  {}
+  void reset( void)
+  {
+    mean = 0;
+    square_deviation_sum = 0;
+    samples = 0;
+  }
+  void feed( sample_data value)
+  {
+    ++samples;
+    sample_data delta = value - mean;
+    mean += delta / samples;
+    square_deviation_sum += delta * ( value - mean);
+  }
+  unsigned get_samples( void ) const
+  {
+    return samples;
+  }
+  float get_mean( void) const
+  {
+    return mean;
+  }
+  float get_variance( void) const
+  {
+    return square_deviation_sum / samples;
+  }
+
+private:
+  sample_data mean;
+  sample_data square_deviation_sum;
+  unsigned samples;
+};
+
 #endif /* GENERIC_ALGORITHMS_MEAN_AND_VARIANCE_FINDER_H_ */
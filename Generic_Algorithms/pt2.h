@@ -27,6 +27,8 @@
 
 #include <ringbuffer.h>
 #include "embedded_math.h"
+#include "constexpr_math.h"
+#include "denormal.h"
 
 // butterworth filter prototype parameters at Fcutoff/Fsampling = 0.25
 // B coefficients -> nominator
@@ -38,17 +40,19 @@
 #define A2 0.171572875253810
 #define DESIGN_FREQUENCY 0.25
 
-//! Second order IIR filter
-template <class datatype, class basetype> class pt2
+//! second order filter coefficients, A0 = 1, butterworth design for Fc/Fs, usable at compile time
+template <class basetype> class pt2_coefficients_t
 {
 public:
-	pt2( basetype fcutoff) //! constructor taking Fc/Fs
-	: input( datatype()),
-	  output( datatype()),
-	  old( datatype()),
-	  very_old( datatype())
+	constexpr pt2_coefficients_t( void)
+	{}
+	constexpr pt2_coefficients_t( basetype _b0, basetype _b1, basetype _b2, basetype _a1, basetype _a2)
+	: b0( _b0), b1( _b1), b2( _b2), a1( _a1), a2( _a2)
+	{}
+	explicit constexpr pt2_coefficients_t( basetype fcutoff) //! constructor taking Fc/Fs
 	{
-		basetype delta = SIN( M_PI * (DESIGN_FREQUENCY - fcutoff)) / SIN( M_PI * (fcutoff + DESIGN_FREQUENCY));
+		basetype delta = (basetype)constexpr_sin( (basetype)( M_PI * (DESIGN_FREQUENCY - fcutoff)))
+			       / (basetype)constexpr_sin( (basetype)( M_PI * (fcutoff + DESIGN_FREQUENCY)));
 		basetype a0x = A2 * SQR(delta) - A1 + ONE;
 		basetype a1x = -2.0 * delta * A2 + (SQR(delta) + ONE) * A1 - 2.0 * delta;
 		basetype a2x = A2 - delta * A1 + SQR(delta);
@@ -70,6 +74,45 @@ public:
 		b1 *= delta;
 		b2 *= delta;
 	}
+	basetype b0 = 0, b1 = 0, b2 = 0, a1 = 0, a2 = 0;    //!< z-transformed transfer-function (b=nominator)
+};
+
+//! compile-time design for Fc/Fs = numerator / denominator, the coefficients are ROM constants
+template <class basetype, int numerator, int denominator> struct pt2_design_t
+{
+  static constexpr pt2_coefficients_t<basetype> value = pt2_coefficients_t<basetype>( (basetype)numerator / (basetype)denominator);
+};
+template <class basetype, int numerator, int denominator>
+  constexpr pt2_coefficients_t<basetype> pt2_design_t<basetype, numerator, denominator>::value;
+
+/**
+ * @brief Second order IIR filter
+ *
+ * denormal_policy = flush_denormals_t: the feedback state decaying towards zero
+ * is flushed at FLT_MIN, use where the input may stay zero for a long time
+ */
+template <class datatype, class basetype, class denormal_policy = keep_denormals_t> class pt2
+{
+public:
+	pt2( basetype fcutoff) //! constructor taking Fc/Fs
+	: pt2( pt2_coefficients_t<basetype>( fcutoff))
+	{}
+	pt2( const pt2_coefficients_t<basetype> &coefficients) //! constructor taking a (compile-time) design
+	: input( datatype()),
+	  output( datatype()),
+	  old( datatype()),
+	  very_old( datatype()),
+	  b0( coefficients.b0),
+	  b1( coefficients.b1),
+	  b2( coefficients.b2),
+	  a1( coefficients.a1),
+	  a2( coefficients.a2)
+	{}
+	//! usage: pt2<float,float> filter( pt2<float,float>::design<1, 100>()); for Fc/Fs = 0.01
+	template <int numerator, int denominator> static constexpr const pt2_coefficients_t<basetype> & design( void)
+	{
+		return pt2_design_t<basetype, numerator, denominator>::value;
+	}
 	void settle( const datatype &present_input)
 	{
 		basetype tuning = ONE  / ( ONE + a1 + a2);
@@ -83,6 +126,7 @@ public:
 		output = x * b0 + old * b1 + very_old * b2;
 		very_old = old;
 		old = x;
+		denormal_policy::apply( old);
 		return output;
 	}
 	datatype get_output( void) const
@@ -93,6 +137,26 @@ public:
 	{
 	  return input;
 	}
+	//! dynamic state for checkpoints, without the coefficients
+	class state_t
+	{
+	public:
+	  datatype input, output, old, very_old;
+	};
+	void save_state( state_t &state) const
+	{
+	  state.input = input;
+	  state.output = output;
+	  state.old = old;
+	  state.very_old = very_old;
+	}
+	void restore_state( const state_t &state)
+	{
+	  input = state.input;
+	  output = state.output;
+	  old = state.old;
+	  very_old = state.very_old;
+	}
 private:
 	datatype input;
 	datatype output;
@@ -0,0 +1,157 @@
+/***********************************************************************//**
+ * @file		pt2_bank.h
+ * @brief		bank of independent second order IIR filters, SoA layout
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef PT2_BANK_H_
+#define PT2_BANK_H_
+
+#include "pt2.h"
+#include "my_assert.h"
+
+/**
+ * @brief N float pt2 filters sampled at the same rate
+ *
+ * Inputs are staged per channel with set_input(), then update() runs all
+ * channels in one loop that the compiler vectorizes (SSE / NEON on the host).
+ * Per channel the arithmetic is the same as pt2<float,float>::respond().
+ */
+template <unsigned N> class pt2_bank
+{
+public:
+  pt2_bank( void)
+    : channels( 0)
+  {
+    for( unsigned i = 0; i < N; ++i)
+      {
+	b0[i] = b1[i] = b2[i] = a1[i] = a2[i] = 0.0f;
+	input[i] = output[i] = old[i] = very_old[i] = 0.0f;
+      }
+  }
+
+  //! add a channel with cutoff Fc/Fs, returns the channel index
+  unsigned register_channel( float fcutoff)
+  {
+    ASSERT( channels < N);
+    unsigned channel = channels;
+    configure( channel, fcutoff); // increments channels
+    return channel;
+  }
+
+  //! set cutoff Fc/Fs for a fixed channel index
+  void configure( unsigned channel, float fcutoff)
+  {
+    configure( channel, pt2_coefficients_t<float>( fcutoff));
+  }
+
+  //! set (compile-time) design for a fixed channel index
+  void configure( unsigned channel, const pt2_coefficients_t<float> &coefficients)
+  {
+    b0[channel] = coefficients.b0;
+    b1[channel] = coefficients.b1;
+    b2[channel] = coefficients.b2;
+    a1[channel] = coefficients.a1;
+    a2[channel] = coefficients.a2;
+    if( channel >= channels)
+      channels = channel + 1;
+  }
+
+  void set_input( unsigned channel, float value)
+  {
+    input[channel] = value;
+  }
+
+  //! run all channels with the staged inputs
+  void update( void)
+  {
+    for( unsigned i = 0; i < N; ++i)
+      {
+	float x = input[i] - old[i] * a1[i] - very_old[i] * a2[i];
+	output[i] = x * b0[i] + old[i] * b1[i] + very_old[i] * b2[i];
+	very_old[i] = old[i];
+	old[i] = x;
+      }
+  }
+
+  void settle( unsigned channel, float present_input)
+  {
+    float tuning = ONE  / ( ONE + a1[channel] + a2[channel]);
+    very_old[channel] = old[channel] = present_input * tuning;
+    input[channel] = output[channel] = present_input;
+  }
+
+  float get_output( unsigned channel) const
+  {
+    return output[channel];
+  }
+
+  float get_last_input( unsigned channel) const
+  {
+    return input[channel];
+  }
+
+  //! dynamic state for checkpoints, without the coefficients
+  class state_t
+  {
+  public:
+    float input[N];
+    float output[N];
+    float old[N];
+    float very_old[N];
+  };
+
+  void save_state( state_t &state) const
+  {
+    for( unsigned i = 0; i < N; ++i)
+      {
+	state.input[i] = input[i];
+	state.output[i] = output[i];
+	state.old[i] = old[i];
+	state.very_old[i] = very_old[i];
+      }
+  }
+
+  void restore_state( const state_t &state)
+  {
+    for( unsigned i = 0; i < N; ++i)
+      {
+	input[i] = state.input[i];
+	output[i] = state.output[i];
+	old[i] = state.old[i];
+	very_old[i] = state.very_old[i];
+      }
+  }
+
+private:
+  alignas(16) float input[N];
+  alignas(16) float output[N];
+  alignas(16) float old[N];
+  alignas(16) float very_old[N];
+  alignas(16) float b0[N];
+  alignas(16) float b1[N];
+  alignas(16) float b2[N];
+  alignas(16) float a1[N];
+  alignas(16) float a2[N];
+  unsigned channels;
+};
+
+#endif /* PT2_BANK_H_ */
@@ -0,0 +1,170 @@
+/***********************************************************************//**
+ * @file		pt2_cascade.h
+ * @brief		higher order butterworth and bessel lowpass filters as pt2 cascades
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef PT2_CASCADE_H_
+#define PT2_CASCADE_H_
+
+#include "pt2.h"
+
+//! coefficients of a cascade of second order sections
+template <class basetype, unsigned SECTIONS> class cascade_coefficients_t
+{
+public:
+  pt2_coefficients_t<basetype> section[SECTIONS];
+};
+
+/**
+ * @brief lowpass section from analog prototype (omega / omega_cutoff, Q), bilinear transform
+ *
+ * K = tan( PI * Fc/Fs) is the pre-warped cutoff
+ */
+template <class basetype>
+constexpr pt2_coefficients_t<basetype> design_lowpass_section( double K, double frequency_scale, double Q)
+{
+  double Kx = K * frequency_scale;
+  double norm = 1.0 / ( 1.0 + Kx / Q + Kx * Kx);
+  basetype a1 = (basetype)( 2.0 * ( Kx * Kx - 1.0) * norm);
+  basetype a2 = (basetype)( ( 1.0 - Kx / Q + Kx * Kx) * norm);
+  double b0 = ( 1.0 + a1 + a2) * 0.25; // DC gain = 1.0 using the rounded denominator
+  return pt2_coefficients_t<basetype>( (basetype)b0, (basetype)( 2.0 * b0), (basetype)b0, a1, a2);
+}
+
+//! butterworth lowpass of even ORDER for Fc/Fs, -3dB @ Fc
+template <class basetype, unsigned ORDER>
+constexpr cascade_coefficients_t<basetype, ORDER / 2> design_butterworth( double fcutoff)
+{
+  static_assert( ORDER % 2 == 0 && ORDER > 0, "even filter order required");
+  cascade_coefficients_t<basetype, ORDER / 2> result;
+  double K = constexpr_tan( CONSTEXPR_PI * fcutoff);
+  for( unsigned k = 0; k < ORDER / 2; ++k)
+    {
+      double theta = CONSTEXPR_PI * ( 2 * k + 1) / ( 2 * ORDER);
+      result.section[k] = design_lowpass_section<basetype>( K, 1.0, 0.5 / constexpr_cos( theta));
+    }
+  return result;
+}
+
+//! bessel lowpass (maximally flat group delay) of ORDER 2, 4 or 6 for Fc/Fs, -3dB @ Fc
+template <class basetype, unsigned ORDER>
+constexpr cascade_coefficients_t<basetype, ORDER / 2> design_bessel( double fcutoff)
+{
+  static_assert( ORDER == 2 || ORDER == 4 || ORDER == 6, "bessel design available for order 2, 4, 6");
+
+  // section frequency scale factors and Q values, normalized to -3dB @ omega = 1
+  const double fsf_2[] = { 1.2736};
+  const double q_2[]   = { 0.5773};
+  const double fsf_4[] = { 1.4192, 1.5912};
+  const double q_4[]   = { 0.5219, 0.8055};
+  const double fsf_6[] = { 1.6060, 1.6913, 1.9071};
+  const double q_6[]   = { 0.5103, 0.6112, 1.0234};
+
+  const double *fsf = ORDER == 2 ? fsf_2 : ORDER == 4 ? fsf_4 : fsf_6;
+  const double *q   = ORDER == 2 ? q_2   : ORDER == 4 ? q_4   : q_6;
+
+  cascade_coefficients_t<basetype, ORDER / 2> result;
+  double K = constexpr_tan( CONSTEXPR_PI * fcutoff);
+  for( unsigned k = 0; k < ORDER / 2; ++k)
+    result.section[k] = design_lowpass_section<basetype>( K, fsf[k], q[k]);
+  return result;
+}
+
+//! cascade of SECTIONS second order IIR filters, direct form II as pt2
+template <class datatype, class basetype, unsigned SECTIONS> class pt2_cascade
+{
+public:
+  pt2_cascade( const cascade_coefficients_t<basetype, SECTIONS> &_coefficients)
+  : coefficients( _coefficients),
+    output( datatype())
+  {
+    for( unsigned k = 0; k < SECTIONS; ++k)
+      old[k] = very_old[k] = datatype();
+  }
+
+  void settle( const datatype &present_input)
+  {
+    for( unsigned k = 0; k < SECTIONS; ++k)
+      {
+	const pt2_coefficients_t<basetype> &c = coefficients.section[k];
+	very_old[k] = old[k] = present_input * ( ONE  / ( ONE + c.a1 + c.a2));
+      }
+    output = present_input;
+  }
+
+  datatype respond( const datatype &input)
+  {
+    datatype signal = input;
+    for( unsigned k = 0; k < SECTIONS; ++k)
+      {
+	const pt2_coefficients_t<basetype> &c = coefficients.section[k];
+	datatype x = signal - old[k] * c.a1 - very_old[k] * c.a2;
+	signal = x * c.b0 + old[k] * c.b1 + very_old[k] * c.b2;
+	very_old[k] = old[k];
+	old[k] = x;
+      }
+    output = signal;
+    return output;
+  }
+
+  datatype get_output( void) const
+  {
+    return output;
+  }
+
+  //! dynamic state for checkpoints, without the coefficients
+  class state_t
+  {
+  public:
+    datatype output;
+    datatype old[SECTIONS];
+    datatype very_old[SECTIONS];
+  };
+
+  void save_state( state_t &state) const
+  {
+    state.output = output;
+    for( unsigned k = 0; k < SECTIONS; ++k)
+      {
+	state.old[k] = old[k];
+	state.very_old[k] = very_old[k];
+      }
+  }
+
+  void restore_state( const state_t &state)
+  {
+    output = state.output;
+    for( unsigned k = 0; k < SECTIONS; ++k)
+      {
+	old[k] = state.old[k];
+	very_old[k] = state.very_old[k];
+      }
+  }
+
+private:
+  cascade_coefficients_t<basetype, SECTIONS> coefficients;
+  datatype output;
+  datatype old[SECTIONS];
+  datatype very_old[SECTIONS];
+};
+
+#endif /* PT2_CASCADE_H_ */
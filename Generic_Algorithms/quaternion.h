@@ -96,6 +96,15 @@ public:
 		datatype e3 = vector<datatype, 4>::e[3];
 		return TWO * (e0*e2 - e3*e1);
 	}
+	//! euler roll angle, same as eulerangle::r
+	inline datatype get_roll( void) const
+	{
+		datatype e0 = vector<datatype, 4>::e[0];
+		datatype e1 = vector<datatype, 4>::e[1];
+		datatype e2 = vector<datatype, 4>::e[2];
+		datatype e3 = vector<datatype, 4>::e[3];
+		return ATAN2(  TWO * (e0*e1 + e2*e3) , e0*e0 - e1*e1 - e2*e2 + e3*e3 );
+	}
 	//! euler component e2
 	inline datatype get_e2( void) const
 	{
@@ -0,0 +1,137 @@
+/***********************************************************************//**
+ * @file		recursive_least_square_fit.h
+ * @brief		recursive linear fit with exponential forgetting
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef RECURSIVE_LEAST_SQUARE_FIT_H_
+#define RECURSIVE_LEAST_SQUARE_FIT_H_
+
+#include "embedded_math.h"
+#include "Linear_Least_Square_Fit.h"
+
+/**
+ * @brief recursive least square fit for y = a + b * x with forgetting factor
+ *
+ * O(1) work per sample, the result is available at any time.
+ * The effective window length is 1 / (1 - forgetting_factor) samples.
+ * Interface of evaluate() and get_count() as linear_least_square_fit.
+ */
+template<typename evaluation_type=float>
+  class recursive_linear_fit_t
+  {
+  public:
+    recursive_linear_fit_t ( evaluation_type _forgetting_factor = (evaluation_type)0.9999,
+			     evaluation_type initial_offset = ZERO,
+			     evaluation_type initial_slope = ONE)
+    : forgetting_factor( _forgetting_factor),
+      slope_covariance_limit( ZERO)
+    {
+      reset( initial_offset, initial_slope);
+    }
+
+    void
+    reset ( evaluation_type initial_offset = ZERO, evaluation_type initial_slope = ONE)
+    {
+      offset = initial_offset;
+      slope = initial_slope;
+      P00 = P11 = INITIAL_COVARIANCE;
+      P01 = ZERO;
+      residual_variance = ZERO;
+      n = 0;
+    }
+
+    void
+    add_value (const evaluation_type x, const evaluation_type y)
+    {
+      // P * phi with phi = { 1, x }
+      evaluation_type P_phi_0 = P00 + P01 * x;
+      evaluation_type P_phi_1 = P01 + P11 * x;
+      evaluation_type denominator = forgetting_factor + P_phi_0 + P_phi_1 * x;
+      evaluation_type inv_denominator = ONE / denominator;
+
+      evaluation_type K0 = P_phi_0 * inv_denominator;
+      evaluation_type K1 = P_phi_1 * inv_denominator;
+
+      evaluation_type error = y - offset - slope * x;
+      offset += K0 * error;
+      slope  += K1 * error;
+
+      // P = ( P - K * phi' * P ) / lambda, symmetric by construction
+      evaluation_type inv_lambda = ONE / forgetting_factor;
+      P00 = ( P00 - K0 * P_phi_0) * inv_lambda;
+      P01 = ( P01 - K0 * P_phi_1) * inv_lambda;
+      P11 = ( P11 - K1 * P_phi_1) * inv_lambda;
+
+      // without excitation in x the slope covariance grows by 1 / lambda per sample (wind-up)
+      if( slope_covariance_limit > ZERO && P11 > slope_covariance_limit)
+	{
+	  // congruence scaling keeps P positive definite
+	  evaluation_type ratio = slope_covariance_limit / P11;
+	  P01 *= SQRT( ratio);
+	  P11 = slope_covariance_limit;
+	}
+
+      // a-priori times a-posteriori error, exponentially averaged
+      evaluation_type weight = n < WARMUP ? ONE / (n + 1) : ONE - forgetting_factor;
+      residual_variance += weight * ( error * error * forgetting_factor * inv_denominator - residual_variance);
+
+      if( n < UINT32_MAX)
+	++n;
+    }
+
+    void
+    evaluate (evaluation_type &a, evaluation_type &b, evaluation_type &variance_a, evaluation_type &variance_b) const
+    {
+      a = offset;
+      b = slope;
+      variance_a = residual_variance * P00;
+      variance_b = residual_variance * P11;
+    }
+    void
+    evaluate (linear_least_square_result<evaluation_type> &r) const
+    {
+      evaluate (r.y_offset, r.slope, r.variance_offset, r.variance_slope);
+    }
+    unsigned
+    get_count (void) const
+    {
+      return n;
+    }
+    //! bound the slope covariance to its initial value, 0 = no limit
+    void
+    limit_slope_covariance ( bool enable = true)
+    {
+      slope_covariance_limit = enable ? INITIAL_COVARIANCE : ZERO;
+    }
+  private:
+    enum { WARMUP = 100}; //!< use plain average for the first residuals
+    static constexpr evaluation_type INITIAL_COVARIANCE = (evaluation_type)1e4;
+    evaluation_type forgetting_factor;
+    evaluation_type offset;
+    evaluation_type slope;
+    evaluation_type P00, P01, P11; //!< symmetric 2 * 2 parameter covariance / residual variance
+    evaluation_type residual_variance;
+    evaluation_type slope_covariance_limit;
+    uint32_t n;
+  };
+
+#endif /* RECURSIVE_LEAST_SQUARE_FIT_H_ */
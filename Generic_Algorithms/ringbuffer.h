@@ -25,7 +25,7 @@
 #ifndef RINGBUFER_H
 #define RINGBUFER_H
 
-//! ring buffer helper class (template)
+//! ring buffer helper class (template), uses masking for power-of-two sizes
 template <class datatype, unsigned size> class RingBuffer
    {
 public:
@@ -36,26 +36,28 @@ public:
 				values[i] = initial_value;
         }
 
-    datatype getValueAt(unsigned point)
+    const datatype & getValueAt(unsigned point) const
         {
         return values[map(point)];
         }
 
-    datatype getPreviousAt(unsigned position)
+    const datatype & getPreviousAt(unsigned position) const
         {
         return values[mapback(position)];
         }
 
-    inline datatype operator [] (unsigned position)
+    inline const datatype & operator [] (unsigned position) const
     {
         return getValueAt( position);
     }
 
-    void pushValue(datatype value)
+    void pushValue(const datatype &value)
         {
         setValueAt(0, value);
         ++pointer;
-        if (pointer >= size)
+        if( POWER_OF_TWO)
+            pointer &= MASK;
+        else if (pointer >= size)
             pointer = 0;
         }
 
@@ -65,17 +67,23 @@ void setAllValues(const datatype &value)
     		setValueAt(i, value);
         }
 
-    unsigned GetSize( void)
+    unsigned GetSize( void) const
         {
         return size;
         }
 private:
-    unsigned map(unsigned pos)
+    enum { POWER_OF_TWO = ( size & ( size - 1)) == 0, MASK = size - 1};
+
+    unsigned map(unsigned pos) const
     {
+        if( POWER_OF_TWO)
+            return (pos + pointer) & MASK;
         return (pos + pointer) % size;
     }
-    unsigned mapback(unsigned position)
+    unsigned mapback(unsigned position) const
     {
+        if( POWER_OF_TWO)
+            return (pointer - position - 1) & MASK;
         int index = pointer - position -1;
         if( index < 0)
             index += size;
@@ -90,4 +98,57 @@ private:
     datatype values[size];
     };
 
+/**
+ * @brief ring buffer with mirrored backing store (template)
+ *
+ * Every value is stored twice, so the last n <= size values
+ * are always available as one contiguous array, oldest value first.
+ * FIR filters, median and block statistics can run over the history
+ * without copying and without index wrapping in the inner loop.
+ */
+template <class datatype, unsigned size> class MirroredRingBuffer
+   {
+public:
+    MirroredRingBuffer( datatype initial_value = datatype())
+        {
+        pointer = 0;
+        setAllValues( initial_value);
+        }
+
+    void pushValue(const datatype &value)
+        {
+        values[pointer] = value;
+        values[pointer + size] = value;
+        ++pointer;
+        if (pointer >= size)
+            pointer = 0;
+        }
+
+    //! last n values, window[n-1] is the newest one
+    const datatype * getWindow(unsigned n) const
+        {
+        return values + pointer + size - n;
+        }
+
+    //! position 0 is the newest value
+    const datatype & getPreviousAt(unsigned position) const
+        {
+        return values[pointer + size - position - 1];
+        }
+
+    void setAllValues(const datatype &value)
+        {
+        for( unsigned i=0; i < 2 * size; ++i)
+            values[i] = value;
+        }
+
+    unsigned GetSize( void) const
+        {
+        return size;
+        }
+private:
+    unsigned pointer; //!< next write position
+    datatype values[2 * size];
+    };
+
 #endif
@@ -27,15 +27,19 @@
 
 void serial_output::puti( int value, int base)
 {
-	char buffer[20];
-	itoa(  value, buffer, base);
-	puts( buffer);
+	char buffer[36];
+	if( base == 10)
+	  write( buffer, format_integer( buffer, value) - buffer);
+	else
+	  {
+	    itoa(  value, buffer, base);
+	    puts( buffer);
+	  }
 }
 void serial_output::putx( int32_t value, uint8_t digits)
 {
 	char buffer[20];
-	utox( buffer, value, digits);
-	puts( buffer);
+	write( buffer, utox( buffer, value, digits) - buffer);
 }
 void serial_output::putf( float value)
 {
@@ -45,12 +49,11 @@ void serial_output::putf( float value)
 }
 void serial_output::puts( const char * data)
 {
-	while (*data != 0)
-		put( *data++);
+	write( data, strlen( data));
 }
 void serial_output::newline( void)
 {
-	puts((char *)"\r\n");
+	write( "\r\n", 2);
 }
 void serial_output::blank( void)
 {
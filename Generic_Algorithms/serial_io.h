@@ -26,6 +26,8 @@
 #define SERIAL_IO_H_
 
 #include "ascii_support.h"
+#include <stddef.h>
+#include <string.h>
 
 //! abstraction for serial input device
 class serial_input
@@ -53,6 +55,12 @@ public:
 	virtual void put( char) // another stub
 	{
 	}
+	//! block output, drivers override this with DMA or FIFO bulk transfers
+	virtual void write( const char *data, size_t length)
+	{
+	  for( size_t i = 0; i < length; ++i)
+	    put( data[i]);
+	}
 	void puti( int value, int base=10);
 	void putx( int32_t value, uint8_t digits = 8);
 	void putf( float value);
@@ -82,11 +90,15 @@ public:
     *p++ = c;
     *p = 0;
   }
-  void puts( char *c)
+  //! bounded copy, the content is truncated when the buffer is full
+  void write( const char *data, size_t length)
   {
-    while( (buf+size-p) >= 2)
-      *p++=*c++;
-    *p=0;
+    size_t space = buf + size - 1 - p;
+    if( length > space)
+      length = space;
+    memcpy( p, data, length);
+    p += length;
+    *p = 0;
   }
   void putf( float value)
   {
@@ -0,0 +1,114 @@
+/***********************************************************************//**
+ * @file		spsc_queue.h
+ * @brief		wait-free single producer / single consumer queue (template)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include "system_configuration.h"
+#include <stdint.h>
+
+#if UNIX == 1
+#define SPSC_CACHE_LINE 64 	//!< keep producer and consumer index in different cache lines
+#else
+#define SPSC_CACHE_LINE 4 	//!< Cortex-M4: no data cache
+#endif
+
+//! sample with capture time, typically the DWT cycle counter or a microsecond tick
+template <class datatype> class timestamped_t
+{
+public:
+  uint32_t timestamp;
+  datatype value;
+};
+
+/**
+ * @brief lock-free queue for one producer (ISR / parser thread) and one consumer (algorithm task)
+ *
+ * SIZE must be a power of two, the capacity is SIZE - 1.
+ * The indices run free and are masked, there is no division.
+ * Each side writes only its own index, using release / acquire ordering.
+ */
+template <class datatype, unsigned SIZE> class spsc_queue
+{
+  static_assert( SIZE >= 2 && ( SIZE & ( SIZE - 1)) == 0, "SIZE must be a power of two");
+public:
+  spsc_queue( void)
+    : head( 0),
+      dropped( 0),
+      tail( 0)
+  {}
+
+  //! producer side: returns true if the queue is full and the value has been dropped
+  bool push( const datatype &value)
+  {
+    uint32_t h = head; // only the producer writes head
+    if( h - __atomic_load_n( &tail, __ATOMIC_ACQUIRE) >= SIZE - 1)
+      {
+	++dropped;
+	return true;
+      }
+    buffer[h & MASK] = value;
+    __atomic_store_n( &head, h + 1, __ATOMIC_RELEASE);
+    return false;
+  }
+
+  //! consumer side: returns true if the queue is empty
+  bool pop( datatype &value)
+  {
+    return pop( &value, 1) == 0;
+  }
+
+  //! consumer side: fetch up to max_count values, returns the number of values fetched
+  unsigned pop( datatype *target, unsigned max_count)
+  {
+    uint32_t t = tail; // only the consumer writes tail
+    uint32_t available = __atomic_load_n( &head, __ATOMIC_ACQUIRE) - t;
+    unsigned count = available < max_count ? available : max_count;
+    for( unsigned i = 0; i < count; ++i)
+      target[i] = buffer[( t + i) & MASK];
+    __atomic_store_n( &tail, t + count, __ATOMIC_RELEASE);
+    return count;
+  }
+
+  //! number of queued values, exact on the consumer side
+  unsigned get_count( void) const
+  {
+    return __atomic_load_n( &head, __ATOMIC_ACQUIRE) - __atomic_load_n( &tail, __ATOMIC_ACQUIRE);
+  }
+
+  //! number of values lost due to overflow
+  unsigned get_dropped( void) const
+  {
+    return dropped;
+  }
+
+private:
+  enum { MASK = SIZE - 1};
+  alignas( SPSC_CACHE_LINE) uint32_t head; //!< written by the producer
+  uint32_t dropped;			   //!< written by the producer
+  alignas( SPSC_CACHE_LINE) uint32_t tail; //!< written by the consumer
+  alignas( SPSC_CACHE_LINE) datatype buffer[SIZE];
+};
+
+#endif /* SPSC_QUEUE_H_ */
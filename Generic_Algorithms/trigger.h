@@ -35,6 +35,7 @@ public:
   bool initialize( float value, bool _going_up=true)
   {
     minimax = value;
+    going_up = _going_up;
     return true;
   }
   bool process( float value)
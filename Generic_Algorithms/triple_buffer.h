@@ -0,0 +1,98 @@
+/***********************************************************************//**
+ * @file		triple_buffer.h
+ * @brief		lock-free triple buffer for one writer and one reader (template)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef TRIPLE_BUFFER_H_
+#define TRIPLE_BUFFER_H_
+
+#include <stdint.h>
+
+/**
+ * @brief latest-value exchange between a producer task and a consumer (DMA / ISR)
+ *
+ * The writer fills the back buffer and publishes it,
+ * the reader takes the most recently published buffer as its front buffer.
+ * Publishing and taking are single atomic exchanges, neither side ever waits
+ * and the buffer owned by one side is never touched by the other.
+ * A published buffer that is replaced before the reader took it is counted as overrun.
+ */
+template <class buffer_type> class triple_buffer_t
+{
+public:
+  triple_buffer_t( void)
+    : back( 0),
+      middle( 1),
+      front( 2),
+      overruns( 0)
+  {}
+
+  //! writer side: buffer to be filled
+  buffer_type &get_back( void)
+  {
+    return buffer[back];
+  }
+
+  //! writer side: hand over the back buffer, returns true if an untaken buffer has been dropped
+  bool publish( void)
+  {
+    uint32_t previous = __atomic_exchange_n( &middle, back | FRESH, __ATOMIC_ACQ_REL);
+    back = previous & INDEX;
+    if( previous & FRESH)
+      {
+	++overruns;
+	return true;
+      }
+    return false;
+  }
+
+  //! reader side: take the latest published buffer, returns true if nothing new has been published
+  bool acquire( void)
+  {
+    if( ( __atomic_load_n( &middle, __ATOMIC_ACQUIRE) & FRESH) == 0)
+      return true;
+    front = __atomic_exchange_n( &middle, front, __ATOMIC_ACQ_REL) & INDEX;
+    return false;
+  }
+
+  //! reader side: buffer taken by the last successful acquire()
+  const buffer_type &get_front( void) const
+  {
+    return buffer[front];
+  }
+
+  //! number of published buffers that have never been taken
+  uint32_t get_overruns( void) const
+  {
+    return overruns;
+  }
+
+private:
+  enum { INDEX = 3, FRESH = 4};
+  buffer_type buffer[3];
+  uint32_t back; 	//!< owned by the writer
+  uint32_t middle; 	//!< exchanged, buffer index + FRESH flag
+  uint32_t front; 	//!< owned by the reader
+  uint32_t overruns; 	//!< written by the writer
+};
+
+#endif /* TRIPLE_BUFFER_H_ */
@@ -0,0 +1,85 @@
+/***********************************************************************//**
+ * @file		varint.h
+ * @brief		zigzag and LEB128 variable length integer coding
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef VARINT_H_
+#define VARINT_H_
+
+#include <stdint.h>
+
+#define VARINT_MAX_SIZE_32 5 	//!< bytes needed for any uint32_t
+#define VARINT_MAX_SIZE_64 10 	//!< bytes needed for any uint64_t
+
+//! map signed to unsigned: 0, -1, 1, -2 ... -> 0, 1, 2, 3 ...
+inline uint32_t zigzag_encode( int32_t value)
+{
+  return ( (uint32_t)value << 1) ^ (uint32_t)( value >> 31);
+}
+
+inline int32_t zigzag_decode( uint32_t value)
+{
+  return (int32_t)( value >> 1) ^ -(int32_t)( value & 1);
+}
+
+inline uint64_t zigzag_encode( int64_t value)
+{
+  return ( (uint64_t)value << 1) ^ (uint64_t)( value >> 63);
+}
+
+inline int64_t zigzag_decode( uint64_t value)
+{
+  return (int64_t)( value >> 1) ^ -(int64_t)( value & 1);
+}
+
+//! 7 bits per byte, low bits first, bit 7 = continuation, returns the new end
+template <class unsigned_type> inline uint8_t * varint_encode( uint8_t *target, unsigned_type value)
+{
+  while( value >= 0x80)
+    {
+      *target++ = (uint8_t)( value | 0x80);
+      value >>= 7;
+    }
+  *target++ = (uint8_t)value;
+  return target;
+}
+
+//! returns true on error: truncated or too long
+template <class unsigned_type> inline bool varint_decode( const uint8_t * &source, const uint8_t *end, unsigned_type &value)
+{
+  unsigned_type result = 0;
+  for( unsigned shift = 0; shift < sizeof( unsigned_type) * 8; shift += 7)
+    {
+      if( source >= end)
+	return true;
+      uint8_t byte = *source++;
+      result |= (unsigned_type)( byte & 0x7f) << shift;
+      if( ( byte & 0x80) == 0)
+	{
+	  value = result;
+	  return false;
+	}
+    }
+  return true;
+}
+
+#endif /* VARINT_H_ */
@@ -48,7 +48,7 @@ public:
 	      e[i]=ZERO;
 	}
 	vector( const datatype *data);
-	vector( const vector & right);
+	vector( const vector & right) = default; //!< trivial copy
 
 	datatype scalar_multiply( const vector & right) const //!< scalar product
 	{
@@ -82,7 +82,7 @@ public:
 		return (datatype) SQRT( squaresum);
 	};
 
-	vector & operator =  ( const vector & right);
+	vector & operator =  ( const vector & right) = default; //!< trivial copy
 	//! set all elements to zero
 	void zero( void)
 	{
@@ -109,7 +109,15 @@ public:
 	}
 	vector & operator *= ( const datatype & right) //!< scale vector by scalar
 	{
-		*this = *this * right;
+		for( int i=0; i < size; ++i)
+			e[i] *= right;
+		return *this;
+	}
+	//! fused this += a * x without temporary
+	vector & axpy( const datatype & a, const vector & x)
+	{
+		for( int i=0; i < size; ++i)
+			e[i] += a * x.e[i];
 		return *this;
 	}
 	//! subscription operator
@@ -134,13 +142,6 @@ public:
 	datatype e[size];
 };
 
-//! copy constructor
-template <class datatype, int size> vector <datatype, size>::vector( const vector <datatype, size> & right)
-{
-	for( int i=0; i<size; ++i)
-		e[i]=right.e[i];
-}
-
 //! constructor from datatype []
 template <class datatype, int size> vector <datatype, size>::vector( const datatype * init)
 {
@@ -223,13 +224,12 @@ template <class datatype, int size> vector <datatype, size> vector <datatype, si
 	return tmp;
 }
 
-//! vector copy operator - size checked through template
+//! fused multiply-add x * a + y computed in one loop
 template <class datatype, int size>
-vector <datatype, size> & vector <datatype, size>::operator =( const vector <datatype, size> & right)
+inline vector <datatype, size> mul_add( const vector <datatype, size> & x, const datatype & a, const vector <datatype, size> & y)
 {
-	for( int i=0; i<size; ++i)
-		e[i]=right.e[i];
-	return *this;
+	vector <datatype, size> tmp( y);
+	return tmp.axpy( a, x);
 }
 
 #endif
@@ -28,6 +28,8 @@
 #include "magnetic_induction_report.h"
 #include "embedded_memory.h"
 #include "NAV_tuning_parameters.h"
+#include "fast_math.h"
+#include "event_trace.h"
 
 #if USE_HARDWARE_EEPROM	== 0
 #include "EEPROM_emulation.h"
@@ -36,8 +38,9 @@
 /**
  * @brief initial attitude setup from observables
  */
+template <class pipeline>
 void
-AHRS_type::attitude_setup (const float3vector &acceleration,
+AHRS_t<pipeline>::attitude_setup (const float3vector &acceleration,
 			   const float3vector &mag)
 {
   float3vector north, east, down;
@@ -71,27 +74,30 @@ AHRS_type::attitude_setup (const float3vector &acceleration,
   float3matrix coordinates (fcoordinates);
   attitude.from_rotation_matrix (coordinates);
   attitude.get_rotation_matrix (body2nav);
-  euler = attitude;
+  euler_valid = false;
 }
 
 /**
  * @brief  decide about circling state
  */
+template <class pipeline>
 circle_state_t
-AHRS_type::update_circling_state ()
+AHRS_t<pipeline>::update_circling_state ()
 {
 #if DISABLE_CIRCLING_STATE
   return STRAIGHT_FLIGHT;
 #else
-  float turn_rate_abs = abs (turn_rate_averager.get_output());
+  float turn_rate_abs = abs (averagers.get_output( TURN_RATE));
+  circle_state_t old_state = circling_state;
 
+  // counted in fast ticks, one update covers decimation ticks
   if (circling_counter < CIRCLE_LIMIT)
     if (turn_rate_abs > HIGH_TURN_RATE)
-      ++circling_counter;
+      circling_counter = circling_counter + decimation < CIRCLE_LIMIT ? circling_counter + decimation : CIRCLE_LIMIT;
 
   if (circling_counter > 0)
     if (turn_rate_abs < LOW_TURN_RATE)
-      --circling_counter;
+      circling_counter = circling_counter > decimation ? circling_counter - decimation : 0;
 
   if (circling_counter == 0)
     circling_state = STRAIGHT_FLIGHT;
@@ -100,59 +106,84 @@ AHRS_type::update_circling_state ()
   else
     circling_state = TRANSITION;
 
+  if( circling_state != old_state)
+    TRACE_EVENT( TRACE_CIRCLING_STATE, old_state, circling_state);
+
   return circling_state;
 #endif
 }
 
-void AHRS_type::feed_magnetic_induction_observer(const float3vector &mag_sensor)
+template <class pipeline>
+void AHRS_t<pipeline>::feed_magnetic_induction_observer(const float3vector &mag_sensor)
 {
   float3vector expected_body_induction = body2nav.reverse_map(expected_nav_induction);
 
+#if MAG_CONTINUOUS_CALIBRATION
+  for (unsigned i = 0; i < 3; ++i)
+    mag_calibration_estimator[i].add_value ( expected_body_induction.e[i], mag_sensor.e[i]);
+  if( automatic_magnetic_calibration && compass_calibration.update_continuously( mag_calibration_estimator))
+    {
+      magnetic_calibration_written = true;
+#if DEFERRED_MAG_CALIBRATION
+      EEPROM_write_pending = true;
+#endif
+    }
+#else
   for (unsigned i = 0; i < 3; ++i)
-    mag_calibration_data_collector[i].add_value ( MAG_SCALE * expected_body_induction.e[i], MAG_SCALE * mag_sensor.e[i]);
+    mag_calibration_data_collector[i].add_value ( statistics_t::scale() * expected_body_induction.e[i], statistics_t::scale() * mag_sensor.e[i]);
+#endif
 
   // measurement of earth induction to find the local earth field parameters
-  earth_induction_data_collector.feed( induction_nav_frame, turn_rate_averager.get_output() > 0.0f);
+  earth_induction_data_collector.feed( induction_nav_frame, averagers.get_output( TURN_RATE) > 0.0f);
 }
 
-AHRS_type::AHRS_type (float sampling_time)
+template <class pipeline>
+AHRS_t<pipeline>::AHRS_t (float sampling_time, configuration_snapshot_t &configuration)
 :
+  circling_state( STRAIGHT_FLIGHT),
+  gyro_integrator({0}),
+  euler_valid( false),
   Ts(sampling_time),
   Ts_div_2 (sampling_time / 2.0f),
-  gyro_integrator({0}),
   circling_counter(0),
-  slip_angle_averager( ANGLE_F_BY_FS),
-  nick_angle_averager( ANGLE_F_BY_FS),
-  turn_rate_averager( ANGLE_F_BY_FS),
-  G_load_averager(     G_LOAD_F_BY_FS),
-  antenna_DOWN_correction(  configuration( ANT_SLAVE_DOWN)  / configuration( ANT_BASELENGTH)),
-  antenna_RIGHT_correction( configuration( ANT_SLAVE_RIGHT) / configuration( ANT_BASELENGTH)),
-  circling_state( STRAIGHT_FLIGHT),
-  heading_difference_AHRS_DGNSS(0.0f),
+  decimation( 1),
+  compass_calibration( configuration),
+  earth_induction_data_collector( statistics_t::scale()),
   magnetic_disturbance(0.0f),
   automatic_magnetic_calibration(configuration(MAG_AUTO_CALIB)),
   automatic_earth_field_parameters(configuration(MAG_EARTH_AUTO)),
-  earth_induction_data_collector( MAG_SCALE)
+  heading_aiding( configuration)
 {
+  set_decimation( (unsigned)( sampling_time / FAST_SAMPLING_TIME + 0.5f));
+
   float inclination=configuration(INCLINATION);
   float declination=configuration(DECLINATION);
   expected_nav_induction[NORTH] = COS( inclination);
   expected_nav_induction[EAST]  = COS( inclination) * SIN( declination);
   expected_nav_induction[DOWN]  = SIN( inclination);
   update_magnetic_loop_gain(); // adapt to magnetic inclination
-  bool fail = compass_calibration.read_from_EEPROM();
+#if MAG_CONTINUOUS_CALIBRATION
+  for( unsigned i=0; i<3; ++i)
+    mag_calibration_estimator[i] = recursive_linear_fit_t<float>( MAG_RLS_FORGETTING_FACTOR);
+  magnetic_calibration_written = false;
+#endif
+#if DEFERRED_MAG_CALIBRATION
+  EEPROM_write_pending = false;
+#endif
+  bool fail = compass_calibration.read_from_configuration();
   assert( ! fail);
 }
 
+template <class pipeline>
 void
-AHRS_type::update (const float3vector &gyro,
+AHRS_t<pipeline>::update (const float3vector &gyro,
 		   const float3vector &acc,
 		   const float3vector &mag,
 		   const float3vector &GNSS_acceleration,
 		   float GNSS_heading,
 		   bool GNSS_heading_valid)
 {
-  if( GNSS_heading_valid)
+  if( heading_aiding_t::AVAILABLE && GNSS_heading_valid)
     update_diff_GNSS (gyro, acc, mag, GNSS_acceleration, GNSS_heading);
   else
     update_compass(gyro, acc, mag, GNSS_acceleration);
@@ -163,8 +194,9 @@ AHRS_type::update (const float3vector &gyro,
  *
  * Side-effect: create rotation matrices, NAV-acceleration, NAV-induction
  */
+template <class pipeline>
 void
-AHRS_type::update_attitude ( const float3vector &acc,
+AHRS_t<pipeline>::update_attitude ( const float3vector &acc,
 			     const float3vector &gyro,
 			     const float3vector &mag)
 {
@@ -178,28 +210,32 @@ AHRS_type::update_attitude ( const float3vector &acc,
 
   acceleration_nav_frame = body2nav * acc;
   induction_nav_frame 	 = body2nav * mag;
-  euler = attitude;
+  euler_valid = false;
 
   float3vector nav_rotation;
   nav_rotation = body2nav * gyro;
-  turn_rate_averager.respond( nav_rotation[DOWN]);
-
-  slip_angle_averager.respond( ATAN2( -acc.e[RIGHT], -acc.e[DOWN]));
-  nick_angle_averager.respond( ATAN2( +acc.e[FRONT], -acc.e[DOWN]));
-  G_load_averager.respond( acc.abs());
+  averagers.set_input( TURN_RATE,  nav_rotation[DOWN]);
+  averagers.set_input( SLIP_ANGLE, DISPLAY_ATAN2( -acc.e[RIGHT], -acc.e[DOWN])); // display data only
+  averagers.set_input( NICK_ANGLE, DISPLAY_ATAN2( +acc.e[FRONT], -acc.e[DOWN]));
+  averagers.set_input( G_LOAD,     acc.abs());
+  averagers.update();
   magnetic_disturbance = (induction_nav_frame - expected_nav_induction).abs();
 }
 
 /**
  * @brief  update attitude from IMU data D-GNSS compass
  */
+template <class pipeline>
 void
-AHRS_type::update_diff_GNSS (const float3vector &gyro,
+AHRS_t<pipeline>::update_diff_GNSS (const float3vector &gyro,
 			     const float3vector &acc,
 			     const float3vector &mag_sensor,
 			     const float3vector &GNSS_acceleration,
 			     float GNSS_heading)
 {
+#if DEFERRED_MAG_CALIBRATION
+  collect_deferred_results();
+#endif
   circle_state_t old_circle_state = circling_state;
   update_circling_state ();
 
@@ -212,18 +248,7 @@ AHRS_type::update_diff_GNSS (const float3vector &gyro,
   float3vector nav_acceleration = body2nav * acc;
   float3vector nav_induction    = body2nav * mag;
 
-  float heading_gnss_work = GNSS_heading	// correct for antenna alignment
-      + antenna_DOWN_correction  * SIN (euler.r)
-      - antenna_RIGHT_correction * COS (euler.r);
-
-  heading_gnss_work = heading_gnss_work - euler.y; // = heading difference D-GNSS - AHRS
-
-  if (heading_gnss_work > M_PI_F) // map into { -PI PI}
-    heading_gnss_work -= 2.0f * M_PI_F;
-  if (heading_gnss_work < -M_PI_F)
-    heading_gnss_work += 2.0f * M_PI_F;
-
-  heading_difference_AHRS_DGNSS = heading_gnss_work;
+  float heading_gnss_work = heading_aiding.heading_difference( GNSS_heading, get_roll(), get_yaw());
 
   nav_correction[NORTH] = - nav_acceleration.e[EAST]  + GNSS_acceleration.e[EAST];
   nav_correction[EAST]  = + nav_acceleration.e[NORTH] - GNSS_acceleration.e[NORTH];
@@ -250,9 +275,9 @@ AHRS_type::update_diff_GNSS (const float3vector &gyro,
   gyro_correction *= P_GAIN;
 
   if (circling_state == STRAIGHT_FLIGHT)
-      gyro_integrator += gyro_correction; // update integrator
+      gyro_integrator.axpy( (ftype)decimation, gyro_correction); // update integrator
 
-  gyro_correction = gyro_correction + gyro_integrator * I_GAIN;
+  gyro_correction.axpy( I_GAIN, gyro_integrator);
   update_attitude (acc, gyro + gyro_correction, mag);
 
   // only here we get fresh magnetic entropy
@@ -268,11 +293,15 @@ AHRS_type::update_diff_GNSS (const float3vector &gyro,
 /**
  * @brief  update attitude from IMU data and magnetometer
  */
+template <class pipeline>
 void
-AHRS_type::update_compass (const float3vector &gyro, const float3vector &acc,
+AHRS_t<pipeline>::update_compass (const float3vector &gyro, const float3vector &acc,
 			   const float3vector &mag_sensor,
 			   const float3vector &GNSS_acceleration)
 {
+#if DEFERRED_MAG_CALIBRATION
+  collect_deferred_results();
+#endif
   float3vector mag;
   if (compass_calibration.isCalibrationDone ()) // use calibration if available
     mag = compass_calibration.calibrate (mag_sensor);
@@ -305,7 +334,7 @@ AHRS_type::update_compass (const float3vector &gyro, const float3vector &acc,
 	nav_correction[DOWN] = magnetic_control_gain * mag_correction;
 	gyro_correction = body2nav.reverse_map (nav_correction);
 	gyro_correction *= P_GAIN;
-	gyro_integrator += gyro_correction; // update integrator
+	gyro_integrator.axpy( (ftype)decimation, gyro_correction); // update integrator
       }
       break;
       // *******************************************************************************************************
@@ -327,7 +356,7 @@ AHRS_type::update_compass (const float3vector &gyro, const float3vector &acc,
       break;
     }
 
-  gyro_correction = gyro_correction + gyro_integrator * I_GAIN;
+  gyro_correction.axpy( I_GAIN, gyro_integrator);
 
   // feed quaternion update with corrected sensor readings
   update_attitude (acc, gyro + gyro_correction, mag);
@@ -346,7 +375,8 @@ AHRS_type::update_compass (const float3vector &gyro, const float3vector &acc,
 /**
  * @brief  update attitude from IMU data NOT using magnetometer of D-GNSS
  */
-void AHRS_type::update_ACC_only (const float3vector &gyro, const float3vector &acc,
+template <class pipeline>
+void AHRS_t<pipeline>::update_ACC_only (const float3vector &gyro, const float3vector &acc,
 			   const float3vector &mag,
 			   const float3vector &GNSS_acceleration)
 {
@@ -370,17 +400,170 @@ void AHRS_type::update_ACC_only (const float3vector &gyro, const float3vector &a
   gyro_correction = body2nav.reverse_map (nav_correction);
   gyro_correction *= P_GAIN;
 
-  gyro_integrator += gyro_correction; // update integrator
-  gyro_correction = gyro_correction + gyro_integrator * I_GAIN; // use integrator
+  gyro_integrator.axpy( (ftype)decimation, gyro_correction); // update integrator
+  gyro_correction.axpy( I_GAIN, gyro_integrator); // use integrator
 
   // feed quaternion update with corrected sensor readings
   update_attitude(acc, gyro + gyro_correction, mag);
 }
 
-void AHRS_type::handle_magnetic_calibration ( char type)
+#if DEFERRED_MAG_CALIBRATION
+
+//! snapshot the collectors at the end of a circle, the evaluation is done by run_deferred_jobs()
+template <class pipeline>
+void AHRS_t<pipeline>::handle_magnetic_calibration ( char type)
+{
+  calibration_job_t *job = magnetic_calibration_job.prepare();
+  if( job == 0)
+    return; // previous job still running, the collectors keep their data for the next circle
+
+  job->kind = calibration_job_t::EVALUATE;
+  job->type = type;
+#if MAG_CONTINUOUS_CALIBRATION
+  job->calibration_written = magnetic_calibration_written; // done sample by sample, just report
+  magnetic_calibration_written = false;
+  job->have_mag_data = false;
+#else
+  job->calibration_written = false;
+  job->have_mag_data = compass_calibration.calibration_due ( mag_calibration_data_collector, (averagers.get_output( TURN_RATE) > 0.0f));
+  if( job->have_mag_data)
+    for( unsigned i=0; i<3; ++i)
+      {
+	job->mag_data[i] = mag_calibration_data_collector[i];
+	mag_calibration_data_collector[i].reset();
+      }
+#endif
+
+  job->have_induction_data = earth_induction_data_collector.data_valid ();
+  if( job->have_induction_data)
+    {
+      job->induction_data = earth_induction_data_collector;
+      earth_induction_data_collector.reset ();
+    }
+
+  if( job->have_mag_data || job->have_induction_data || job->calibration_written)
+    magnetic_calibration_job.submit();
+}
+
+template <class pipeline>
+bool AHRS_t<pipeline>::run_deferred_jobs( void)
+{
+  calibration_job_t *job = magnetic_calibration_job.get_submitted();
+  if( job == 0)
+    return false;
+
+  if( job->kind == calibration_job_t::PERSIST)
+    mag_compass_calibration_t::write_EEPROM( job->calibration, job->std_deviation);
+  else
+    {
+      if( job->have_mag_data)
+	job->calibration_improved = compass_calibration.evaluate( job->mag_data, statistics_t::scale(), job->calibration);
+      if( job->have_induction_data)
+	{
+	  job->induction_error = SQRT( job->induction_data.get_variance ());
+	  job->induction = job->induction_data.get_estimated_induction();
+	  job->induction.normalize();
+	}
+    }
+
+  magnetic_calibration_job.complete();
+  return true;
+}
+
+//! the values just stored into the configuration go to the EEPROM, the job slot is owned by the caller
+template <class pipeline>
+void AHRS_t<pipeline>::submit_EEPROM_write( calibration_job_t *job)
+{
+  EEPROM_write_pending = false;
+  if( ! compass_calibration.is_write_back_enabled())
+    {
+      magnetic_calibration_job.release();
+      return;
+    }
+  job->kind = calibration_job_t::PERSIST;
+  compass_calibration.get_stored_calibration( job->calibration, job->std_deviation);
+  magnetic_calibration_job.submit();
+}
+
+//! cheap if there is nothing to collect: apply results posted by run_deferred_jobs()
+template <class pipeline>
+void AHRS_t<pipeline>::collect_deferred_results( void)
+{
+  calibration_job_t *job = magnetic_calibration_job.get_completed();
+  if( job == 0)
+    {
+      if( EEPROM_write_pending && ( job = magnetic_calibration_job.prepare()) != 0)
+	submit_EEPROM_write( job);
+      return;
+    }
+
+  if( job->kind == calibration_job_t::PERSIST)
+    {
+      magnetic_calibration_job.release();
+      return;
+    }
+
+  bool calibration_changed = job->calibration_written;
+  bool write_EEPROM = false;
+
+  if( job->have_mag_data && job->calibration_improved && compass_calibration.apply_calibration( job->calibration))
+    if( compass_calibration.store_into_configuration() == false)
+      calibration_changed = write_EEPROM = true;
+  if( job->have_mag_data)
+    TRACE_EVENT( TRACE_MAG_CALIBRATION,
+		 ! job->calibration_improved ? TRACE_MAG_REJECTED : write_EEPROM ? TRACE_MAG_ACCEPTED : TRACE_MAG_UNCHANGED,
+		 trace_float( job->calibration_improved ? compass_calibration.get_variance_average() : 0.0f));
+
+  float induction_error = 0.0f;
+  if( job->have_induction_data)
+    {
+      induction_error = job->induction_error;
+      bool accepted = automatic_earth_field_parameters && ( induction_error < INDUCTION_STD_DEVIATION_LIMIT);
+      if ( accepted)
+	{
+	  expected_nav_induction = job->induction;
+	  update_magnetic_loop_gain(); // adapt to magnetic inclination
+	  calibration_changed = true;
+	}
+      TRACE_EVENT( TRACE_EARTH_INDUCTION, accepted, trace_float( induction_error));
+    }
+
+  if( calibration_changed && compass_calibration.is_write_back_enabled())
+    {
+      magnetic_induction_report_t magnetic_induction_report;
+      for( unsigned i=0; i<3; ++i)
+	magnetic_induction_report.calibration[i] = (compass_calibration.get_calibration())[i];
+
+      magnetic_induction_report.nav_induction=expected_nav_induction;
+      magnetic_induction_report.nav_induction_std_deviation = induction_error;
+
+      report_magnetic_calibration_has_changed( &magnetic_induction_report, job->type);
+    }
+
+  if( write_EEPROM || EEPROM_write_pending)
+    submit_EEPROM_write( job); // the slot is reused for the flash write
+  else
+    magnetic_calibration_job.release();
+}
+
+#else
+
+template <class pipeline>
+bool AHRS_t<pipeline>::run_deferred_jobs( void)
+{
+  return false;
+}
+
+template <class pipeline>
+void AHRS_t<pipeline>::handle_magnetic_calibration ( char type)
 {
+#if MAG_CONTINUOUS_CALIBRATION
+  bool calibration_changed = magnetic_calibration_written; // done sample by sample, just report here
+  magnetic_calibration_written = false;
+#else
   bool calibration_changed =
-      compass_calibration.set_calibration_if_changed ( mag_calibration_data_collector, MAG_SCALE, (turn_rate_averager.get_output () > 0.0f));
+      compass_calibration.set_calibration_if_changed ( mag_calibration_data_collector, statistics_t::scale(), (averagers.get_output( TURN_RATE) > 0.0f));
+#endif
 
   float induction_error = 0.0f;
 
@@ -388,17 +571,19 @@ void AHRS_type::handle_magnetic_calibration ( char type)
 	{
 	  induction_error = SQRT(earth_induction_data_collector.get_variance ());
 
-	  if ( automatic_earth_field_parameters && ( induction_error < INDUCTION_STD_DEVIATION_LIMIT))
+	  bool accepted = automatic_earth_field_parameters && ( induction_error < INDUCTION_STD_DEVIATION_LIMIT);
+	  if ( accepted)
 	    {
 	      expected_nav_induction = earth_induction_data_collector.get_estimated_induction();
 	      expected_nav_induction.normalize();
 	      update_magnetic_loop_gain(); // adapt to magnetic inclination
 	      calibration_changed = true;
 	    }
+	  TRACE_EVENT( TRACE_EARTH_INDUCTION, accepted, trace_float( induction_error));
 	  earth_induction_data_collector.reset ();
 	}
 
-  if( calibration_changed)
+  if( calibration_changed && compass_calibration.is_write_back_enabled())
     {
       magnetic_induction_report_t magnetic_induction_report;
       for( unsigned i=0; i<3; ++i)
@@ -410,3 +595,76 @@ void AHRS_type::handle_magnetic_calibration ( char type)
       report_magnetic_calibration_has_changed( &magnetic_induction_report, type);
     }
 }
+
+#endif
+
+template <class pipeline>
+void AHRS_t<pipeline>::save_state( state_t &state) const
+{
+  state.attitude = attitude;
+  state.circling_state = circling_state;
+  state.circling_counter = circling_counter;
+  state.nav_correction = nav_correction;
+  state.gyro_correction = gyro_correction;
+  state.gyro_integrator = gyro_integrator;
+  state.acceleration_nav_frame = acceleration_nav_frame;
+  state.induction_nav_frame = induction_nav_frame;
+  state.expected_nav_induction = expected_nav_induction;
+  state.control_body = control_body;
+  averagers.save_state( state.averagers);
+  for( unsigned i=0; i<3; ++i)
+    state.mag_calibration_data_collector[i] = mag_calibration_data_collector[i];
+  compass_calibration.save_state( state.compass_calibration);
+  earth_induction_data_collector.save_state( state.earth_induction_data_collector);
+#if DEFERRED_MAG_CALIBRATION
+  state.EEPROM_write_pending = EEPROM_write_pending;
+#endif
+#if MAG_CONTINUOUS_CALIBRATION
+  for( unsigned i=0; i<3; ++i)
+    state.mag_calibration_estimator[i] = mag_calibration_estimator[i];
+  state.magnetic_calibration_written = magnetic_calibration_written;
+#endif
+  state.magnetic_disturbance = magnetic_disturbance;
+  state.magnetic_control_gain = magnetic_control_gain;
+  state.automatic_magnetic_calibration = automatic_magnetic_calibration;
+  state.automatic_earth_field_parameters = automatic_earth_field_parameters;
+}
+
+template <class pipeline>
+void AHRS_t<pipeline>::restore_state( const state_t &state)
+{
+  attitude = state.attitude;
+  attitude.get_rotation_matrix( body2nav);
+  euler_valid = false;
+  circling_state = state.circling_state;
+  circling_counter = state.circling_counter;
+  nav_correction = state.nav_correction;
+  gyro_correction = state.gyro_correction;
+  gyro_integrator = state.gyro_integrator;
+  acceleration_nav_frame = state.acceleration_nav_frame;
+  induction_nav_frame = state.induction_nav_frame;
+  expected_nav_induction = state.expected_nav_induction;
+  control_body = state.control_body;
+  averagers.restore_state( state.averagers);
+  for( unsigned i=0; i<3; ++i)
+    mag_calibration_data_collector[i] = state.mag_calibration_data_collector[i];
+  compass_calibration.restore_state( state.compass_calibration);
+  earth_induction_data_collector.restore_state( state.earth_induction_data_collector);
+#if DEFERRED_MAG_CALIBRATION
+  EEPROM_write_pending = state.EEPROM_write_pending;
+#endif
+#if MAG_CONTINUOUS_CALIBRATION
+  for( unsigned i=0; i<3; ++i)
+    mag_calibration_estimator[i] = state.mag_calibration_estimator[i];
+  magnetic_calibration_written = state.magnetic_calibration_written;
+#endif
+  magnetic_disturbance = state.magnetic_disturbance;
+  magnetic_control_gain = state.magnetic_control_gain;
+  automatic_magnetic_calibration = state.automatic_magnetic_calibration;
+  automatic_earth_field_parameters = state.automatic_earth_field_parameters;
+}
+
+template class AHRS_t<default_pipeline_t>;
+#if DEVELOPMENT_ADDITIONS && PIPELINE_D_GNSS
+template class AHRS_t<magnetic_pipeline_t>; // shadow_AHRS_magnetic_t
+#endif
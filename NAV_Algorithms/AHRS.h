@@ -34,8 +34,9 @@
 #include "HP_LP_fusion.h"
 #include "induction_observer.h"
 #include "pt2.h"
-
-extern float3vector nav_induction;
+#include "pt2_bank.h"
+#include "deferred_job.h"
+#include "pipeline_policy.h"
 
 enum { ROLL, NICK, YAW};
 enum { FRONT, RIGHT, BOTTOM};
@@ -45,11 +46,49 @@ typedef enum  { STRAIGHT_FLIGHT, TRANSITION, CIRCLING} circle_state_t;
 
 typedef integrator<float, float3vector> vector3integrator;
 
-//! Attitude and heading reference system class
-class AHRS_type
+//! end-of-circle magnetic evaluation, snapshot in the AHRS tick, processed by AHRS_t::run_deferred_jobs()
+template <class statistics_t> class magnetic_calibration_job_t
+{
+public:
+  typedef typename statistics_t::mag_calibration_collector_t mag_calibration_collector_t;
+  typedef typename statistics_t::earth_induction_collector_t earth_induction_collector_t;
+
+  magnetic_calibration_job_t( void)
+    : induction_data( statistics_t::scale())
+  {}
+
+  enum { EVALUATE, PERSIST} kind;
+  char type; 			//!< 's' = D-GNSS, 'm' = magnetic AHRS
+  bool calibration_written; 	//!< continuous calibration: report pending
+  bool have_mag_data;
+  bool have_induction_data;
+  bool calibration_improved; 	//!< result
+  mag_calibration_collector_t mag_data[3];
+  earth_induction_collector_t induction_data;
+  calibration_t calibration[3];	//!< result or the values to be written into EEPROM
+  float3vector induction; 	//!< result, normalized
+  float induction_error; 	//!< result
+  float std_deviation; 		//!< to be written into EEPROM
+};
+
+/**
+ * @brief Attitude and heading reference system class
+ *
+ * pipeline = pipeline_configuration_t, see pipeline_policy.h.
+ * The member functions are instantiated in AHRS.cpp for default_pipeline_t
+ * and, with DEVELOPMENT_ADDITIONS, for magnetic_pipeline_t.
+ */
+template <class pipeline> class AHRS_t
 {
 public:
-	AHRS_type(float sampling_time);
+	typedef typename pipeline::heading_aiding_t heading_aiding_t;
+	typedef typename pipeline::statistics_t statistics_t;
+	typedef typename statistics_t::mag_calibration_collector_t mag_calibration_collector_t;
+	typedef typename statistics_t::compass_calibration_type mag_compass_calibration_t;
+	typedef typename statistics_t::earth_induction_collector_t earth_induction_collector_t;
+	typedef magnetic_calibration_job_t<statistics_t> calibration_job_t;
+
+	AHRS_t(float sampling_time, configuration_snapshot_t &configuration);
 	void attitude_setup( const float3vector & acceleration, const float3vector & induction);
 
 	void update( const float3vector &gyro, const float3vector &acc, const float3vector &mag,
@@ -58,16 +97,54 @@ public:
 		bool GNSS_heading_valid
 		);
 
+	//! change the update interval, e.g. for a FIFO burst of another length
+	void set_sampling_time( float sampling_time)
+	{
+	  Ts = sampling_time;
+	  Ts_div_2 = sampling_time / 2.0f;
+	}
+
+	/**
+	 * @brief one update per _decimation fast ticks, e.g. for the reduced rate idle mode
+	 *
+	 * The averagers, the circling counter and the attitude integrator are tuned per
+	 * fast tick and are rescaled here. P_GAIN acts on the rate and needs no scaling.
+	 */
+	void set_decimation( unsigned _decimation)
+	{
+	  decimation = _decimation ? _decimation : 1;
+	  averagers.configure( TURN_RATE,  ANGLE_F_BY_FS  * decimation);
+	  averagers.configure( SLIP_ANGLE, ANGLE_F_BY_FS  * decimation);
+	  averagers.configure( NICK_ANGLE, ANGLE_F_BY_FS  * decimation);
+	  averagers.configure( G_LOAD,     G_LOAD_F_BY_FS * decimation);
+	}
+
 	inline void set_from_euler( float r, float n, float y)
 	{
 		attitude.from_euler( r, n, y);
 		attitude.get_rotation_matrix( body2nav);
-		euler = attitude;
+		euler_valid = false;
 	}
+	//! euler angles, evaluated on demand only
 	inline eulerangle<ftype> get_euler(void) const
 	{
+		if( ! euler_valid)
+		  {
+		    euler = attitude;
+		    euler_valid = true;
+		  }
 		return euler;
 	}
+	//! cheap heading for high-rate consumers, equals get_euler().y
+	inline float get_yaw(void) const
+	{
+		return euler_valid ? euler.y : attitude.get_e2();
+	}
+	//! cheap roll angle for high-rate consumers, equals get_euler().r
+	inline float get_roll(void) const
+	{
+		return euler_valid ? euler.r : attitude.get_roll();
+	}
 	inline quaternion<ftype> get_attitude(void) const
 	{
 		return attitude;
@@ -136,22 +213,22 @@ public:
   float
   getSlipAngle () const
   {
-    return slip_angle_averager.get_output();
+    return averagers.get_output( SLIP_ANGLE);
   }
 
   float
   getNickAngle () const
   {
-    return nick_angle_averager.get_output();
+    return averagers.get_output( NICK_ANGLE);
   }
 
   float get_turn_rate( void ) const
   {
-    return turn_rate_averager.get_output();
+    return averagers.get_output( TURN_RATE);
   }
   float get_G_load( void ) const
   {
-    return G_load_averager.get_output();
+    return averagers.get_output( G_LOAD);
   }
 
   void update_compass(
@@ -165,7 +242,7 @@ public:
   float
   getHeadingDifferenceAhrsDgnss () const
   {
-    return heading_difference_AHRS_DGNSS;
+    return heading_aiding.get_heading_difference();
   }
 
   float getMagneticDisturbance () const
@@ -173,8 +250,26 @@ public:
     return magnetic_disturbance;
   }
 
+  //! control if magnetic calibration results are written into EEPROM and reported
+  void enable_calibration_write_back( bool enable)
+  {
+    compass_calibration.enable_write_back( enable);
+  }
+
+  /**
+   * @brief calibration evaluation and EEPROM writes, low priority context
+   *
+   * The results are picked up by the next AHRS update.
+   * @return true if a job has been processed
+   */
+  bool run_deferred_jobs( void);
+
 private:
   void handle_magnetic_calibration( char type);
+#if DEFERRED_MAG_CALIBRATION
+  void collect_deferred_results( void);
+  void submit_EEPROM_write( calibration_job_t *job);
+#endif
   void update_magnetic_loop_gain( void)
   {
     magnetic_control_gain = M_H_GAIN / SQRT( SQR(expected_nav_induction[EAST])+SQR(expected_nav_induction[NORTH]));
@@ -197,31 +292,74 @@ private:
   float3vector induction_nav_frame; 	//!< observed NAV induction
   float3vector expected_nav_induction;	//!< expected NAV induction
   float3matrix body2nav;
-  eulerangle<ftype> euler;
+  mutable eulerangle<ftype> euler; //!< cache, valid if euler_valid is set
+  mutable bool euler_valid;
   float3vector control_body;
   ftype Ts;
   ftype Ts_div_2;
-  unsigned circling_counter;
-  pt2<float,float> slip_angle_averager;
-  pt2<float,float> nick_angle_averager;
-  pt2<float,float> turn_rate_averager;
-  pt2<float,float> G_load_averager;
-#if MAG_HIGH_PRECISION
-  linear_least_square_fit<int64_t, float> mag_calibration_data_collector[3];
-  compass_calibration_t <int64_t, float> compass_calibration;
-  induction_observer_t <int64_t> earth_induction_data_collector;
-#else
-  linear_least_square_fit<float, float> mag_calibration_data_collector[3];
-  induction_observer_t <float> earth_induction_data_collector;
-  compass_calibration_t <float, float> compass_calibration;
+  unsigned circling_counter; //!< fast ticks
+  unsigned decimation; //!< fast ticks per update
+  enum { TURN_RATE, SLIP_ANGLE, NICK_ANGLE, G_LOAD, N_AVERAGERS};
+  pt2_bank<N_AVERAGERS> averagers; //!< turn rate, slip, nick, G-load updated together
+  mag_calibration_collector_t mag_calibration_data_collector[3];
+  mag_compass_calibration_t compass_calibration;
+  earth_induction_collector_t earth_induction_data_collector;
+#if DEFERRED_MAG_CALIBRATION
+  deferred_job_t<calibration_job_t> magnetic_calibration_job;
+  bool EEPROM_write_pending; //!< continuous calibration: slot was busy
+#endif
+#if MAG_CONTINUOUS_CALIBRATION
+  recursive_linear_fit_t<float> mag_calibration_estimator[3];
+  bool magnetic_calibration_written; //!< report pending for the end of the circle
 #endif
-  float antenna_DOWN_correction;  //!< slave antenna lower / DGNSS base length
-  float antenna_RIGHT_correction; //!< slave antenna more right / DGNSS base length
-  float heading_difference_AHRS_DGNSS;
   float magnetic_disturbance; //!< abs( observed_induction - expected_induction)
   float magnetic_control_gain; //!< declination-dependent magnetic control loop gain
   bool automatic_magnetic_calibration;
   bool automatic_earth_field_parameters;
+  heading_aiding_t heading_aiding; //!< no bytes of its own without D-GNSS, packed with the flags
+
+public:
+  /**
+   * @brief dynamic state for checkpoints
+   *
+   * Sampling time, filter coefficients and the configuration reference are not part of it,
+   * a calibration job pending in the deferred job slot is dropped.
+   */
+  class state_t
+  {
+  public:
+    quaternion<ftype> attitude;
+    circle_state_t circling_state;
+    unsigned circling_counter;
+    float3vector nav_correction;
+    float3vector gyro_correction;
+    float3vector gyro_integrator;
+    float3vector acceleration_nav_frame;
+    float3vector induction_nav_frame;
+    float3vector expected_nav_induction;
+    float3vector control_body;
+    typename pt2_bank<N_AVERAGERS>::state_t averagers;
+    mag_calibration_collector_t mag_calibration_data_collector[3];
+    typename mag_compass_calibration_t::state_t compass_calibration;
+    typename earth_induction_collector_t::state_t earth_induction_data_collector;
+#if DEFERRED_MAG_CALIBRATION
+    bool EEPROM_write_pending;
+#endif
+#if MAG_CONTINUOUS_CALIBRATION
+    recursive_linear_fit_t<float> mag_calibration_estimator[3];
+    bool magnetic_calibration_written;
+#endif
+    float magnetic_disturbance;
+    float magnetic_control_gain;
+    bool automatic_magnetic_calibration;
+    bool automatic_earth_field_parameters;
+  };
+
+  void save_state( state_t &state) const;
+  void restore_state( const state_t &state);
 };
 
+//! the AHRS of this firmware image
+typedef AHRS_t<default_pipeline_t> AHRS_type;
+
 #endif /* AHRS_H_ */
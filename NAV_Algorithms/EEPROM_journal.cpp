@@ -0,0 +1,146 @@
+/***********************************************************************//**
+ * @file		EEPROM_journal.cpp
+ * @brief		journaled, wear-levelled parameter store in flash
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "EEPROM_journal.h"
+#include "crc16.h"
+#include <string.h>
+
+EEPROM_journal_t::EEPROM_journal_t( flash_driver_t &_flash, unsigned _pages, unsigned page_size)
+  : flash( _flash),
+    pages( _pages),
+    slots( page_size / sizeof( EEPROM_journal_record_t)),
+    next_page( 0),
+    next_slot( 0),
+    erase_count( 0)
+{
+  memset( &committed, 0, sizeof( committed));
+  staged = committed;
+}
+
+bool EEPROM_journal_t::is_erased( const EEPROM_journal_record_t &record) const
+{
+  const uint32_t *word = (const uint32_t *)&record;
+  for( unsigned i = 0; i < RECORD_WORDS; ++i)
+    if( word[i] != 0xffffffff)
+      return false;
+  return true;
+}
+
+bool EEPROM_journal_t::is_valid( const EEPROM_journal_record_t &record) const
+{
+  return ( record.magic == EEPROM_journal_record_t::MAGIC)
+      && ( record.crc == crc16( (const uint8_t *)&record, sizeof( record) - sizeof( record.crc)));
+}
+
+bool EEPROM_journal_t::mount( void)
+{
+  const EEPROM_journal_record_t *newest = 0;
+  unsigned newest_page = 0;
+
+  for( unsigned page = 0; page < pages; ++page)
+    for( unsigned slot = 0; slot < slots; ++slot)
+      {
+	const EEPROM_journal_record_t *record = get_slot( page, slot);
+	if( is_valid( *record) && ( newest == 0 || (int32_t)( record->sequence - newest->sequence) > 0))
+	  {
+	    newest = record;
+	    newest_page = page;
+	  }
+      }
+
+  if( newest == 0)
+    {
+      memset( &committed, 0, sizeof( committed));
+      staged = committed;
+      next_page = 0;
+      next_slot = 0;
+      return true;
+    }
+
+  committed = *newest;
+  staged = committed;
+
+  // continue behind the last used slot of this page, torn records included
+  next_page = newest_page;
+  next_slot = slots;
+  while( next_slot > 0 && is_erased( *get_slot( next_page, next_slot - 1)))
+    --next_slot;
+  return false;
+}
+
+bool EEPROM_journal_t::read( EEPROM_PARAMETER_ID id, uint16_t &value) const
+{
+  if( (unsigned)id >= EEPROM_PARAMETER_ID_END || ( committed.available[id / 32] & ( 1u << ( id % 32))) == 0)
+    return true;
+  value = committed.value[id];
+  return false;
+}
+
+void EEPROM_journal_t::stage( EEPROM_PARAMETER_ID id, uint16_t value)
+{
+  if( (unsigned)id >= EEPROM_PARAMETER_ID_END)
+    return;
+  staged.available[id / 32] |= 1u << ( id % 32);
+  staged.value[id] = value;
+}
+
+void EEPROM_journal_t::rollback( void)
+{
+  staged = committed;
+}
+
+bool EEPROM_journal_t::commit( void)
+{
+  if( 0 == memcmp( staged.available, committed.available, sizeof( staged.available))
+      && 0 == memcmp( staged.value, committed.value, sizeof( staged.value)))
+    return false; // nothing changed, nothing written
+
+  if( next_slot >= slots)
+    {
+      next_page = ( next_page + 1) % pages;
+      next_slot = 0;
+    }
+  if( next_slot == 0)
+    {
+      ++erase_count;
+      if( flash.erase_page( next_page))
+	return true;
+    }
+
+  staged.sequence = committed.sequence + 1;
+  staged.magic = EEPROM_journal_record_t::MAGIC;
+  staged.crc = crc16( (const uint8_t *)&staged, sizeof( staged) - sizeof( staged.crc));
+
+  // the last word with magic and CRC completes the record
+  const uint32_t *words = (const uint32_t *)&staged;
+  unsigned slot = next_slot++;
+  bool error = flash.program( next_page, slot * RECORD_WORDS, words, RECORD_WORDS - 1)
+      || flash.program( next_page, slot * RECORD_WORDS + RECORD_WORDS - 1, words + RECORD_WORDS - 1, 1);
+
+  if( error || 0 != memcmp( get_slot( next_page, slot), &staged, sizeof( staged)))
+    return true; // the slot is lost, the staged set is retried with the next commit
+
+  committed = staged;
+  return false;
+}
@@ -0,0 +1,172 @@
+/***********************************************************************//**
+ * @file		EEPROM_journal.h
+ * @brief		journaled, wear-levelled parameter store in flash
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef EEPROM_JOURNAL_H_
+#define EEPROM_JOURNAL_H_
+
+#include "system_configuration.h"
+#include "persistent_data.h"
+#include <stdint.h>
+
+#ifndef EEPROM_JOURNAL
+#define EEPROM_JOURNAL 0 //!< if 1: parameters in EEPROM_journal_t records instead of the ST EEPROM emulation
+#endif
+
+// STM32F4 flash layout of the journal: the two 16 kB sectors of the ST EEPROM emulation
+#ifndef EEPROM_JOURNAL_BASE_ADDRESS
+#define EEPROM_JOURNAL_BASE_ADDRESS	0x08008000
+#define EEPROM_JOURNAL_FIRST_SECTOR	2
+#define EEPROM_JOURNAL_PAGES		2
+#define EEPROM_JOURNAL_PAGE_SIZE	0x4000
+#endif
+
+//! word-programmable flash with page erase, memory mapped for reading
+class flash_driver_t
+{
+public:
+  //! set all bits of the page, returns true on error
+  virtual bool erase_page( unsigned page) = 0;
+  //! program words into an erased area, returns true on error
+  virtual bool program( unsigned page, unsigned word_offset, const uint32_t *data, unsigned words) = 0;
+  virtual const uint32_t * get_page( unsigned page) const = 0;
+};
+
+/**
+ * @brief one complete parameter set in the EEPROM representation
+ *
+ * The last word carries magic and CRC and is programmed last:
+ * a record torn by a power loss is never taken as valid.
+ */
+class EEPROM_journal_record_t
+{
+public:
+  enum { MAGIC = 0x4c4a, VALUES = ( EEPROM_PARAMETER_ID_END + 1) & ~1};
+  uint32_t sequence; 		//!< increments with every commit, 0xffffffff = erased slot
+  uint32_t available[2]; 	//!< bit per EEPROM_PARAMETER_ID
+  uint16_t value[VALUES];	//!< EEPROM_data_t.u16 per EEPROM_PARAMETER_ID
+  uint16_t magic;
+  uint16_t crc;			//!< CRC16 of all preceding bytes
+};
+
+static_assert( EEPROM_PARAMETER_ID_END <= 64, "EEPROM_journal_record_t::available too small");
+static_assert( sizeof( EEPROM_journal_record_t) % sizeof( uint32_t) == 0, "journal record must be word aligned");
+
+/**
+ * @brief log-structured parameter store
+ *
+ * Parameters are staged in RAM and committed as one record with CRC appended
+ * to the journal, unchanged sets are not written at all.
+ * The records run through all pages round-robin, a page is erased just before
+ * it is reused, while the newest record stays intact in the previous page.
+ * After a power loss mount() finds the newest valid record: the last commit
+ * either is complete or is rolled back entirely.
+ */
+class EEPROM_journal_t
+{
+public:
+  EEPROM_journal_t( flash_driver_t &_flash, unsigned _pages = EEPROM_JOURNAL_PAGES, unsigned page_size = EEPROM_JOURNAL_PAGE_SIZE);
+
+  //! find the newest valid record, returns true if there is none (empty parameter set)
+  bool mount( void);
+
+  //! committed value, returns true if the parameter is not available
+  bool read( EEPROM_PARAMETER_ID id, uint16_t &value) const;
+
+  //! change a parameter in the staged set
+  void stage( EEPROM_PARAMETER_ID id, uint16_t value);
+
+  //! write the staged set if it differs from the committed one, returns true on error
+  bool commit( void);
+
+  //! discard staged changes
+  void rollback( void);
+
+  uint32_t get_sequence( void) const
+  {
+    return committed.sequence;
+  }
+
+  //! number of page erases since the constructor
+  unsigned get_erase_count( void) const
+  {
+    return erase_count;
+  }
+
+private:
+  enum { RECORD_WORDS = sizeof( EEPROM_journal_record_t) / sizeof( uint32_t)};
+  bool is_valid( const EEPROM_journal_record_t &record) const;
+  bool is_erased( const EEPROM_journal_record_t &record) const;
+  const EEPROM_journal_record_t * get_slot( unsigned page, unsigned slot) const
+  {
+    return (const EEPROM_journal_record_t *)( flash.get_page( page)) + slot;
+  }
+
+  flash_driver_t &flash;
+  unsigned pages;
+  unsigned slots; 	//!< records per page
+  unsigned next_page; 	//!< write position
+  unsigned next_slot;
+  unsigned erase_count;
+  EEPROM_journal_record_t committed;
+  EEPROM_journal_record_t staged;
+};
+
+#if UNIX == 1
+
+//! flash simulation for SIL and benchmarks
+template <unsigned PAGES, unsigned PAGE_SIZE> class RAM_flash_driver_t : public flash_driver_t
+{
+public:
+  RAM_flash_driver_t( void)
+  {
+    for( unsigned p = 0; p < PAGES; ++p)
+      erase_page( p);
+  }
+
+  bool erase_page( unsigned page) override
+  {
+    for( unsigned i = 0; i < PAGE_SIZE / sizeof( uint32_t); ++i)
+      memory[page][i] = 0xffffffff;
+    return false;
+  }
+
+  bool program( unsigned page, unsigned word_offset, const uint32_t *data, unsigned words) override
+  {
+    for( unsigned i = 0; i < words; ++i)
+      memory[page][word_offset + i] &= data[i]; // flash can only clear bits
+    return false;
+  }
+
+  const uint32_t * get_page( unsigned page) const override
+  {
+    return memory[page];
+  }
+
+private:
+  uint32_t memory[PAGES][PAGE_SIZE / sizeof( uint32_t)];
+};
+
+#endif
+
+#endif /* EEPROM_JOURNAL_H_ */
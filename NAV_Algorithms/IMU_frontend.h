@@ -0,0 +1,247 @@
+/***********************************************************************//**
+ * @file		IMU_frontend.h
+ * @brief		sensor mapping and dual IMU fusion with fault detection
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef IMU_FRONTEND_H_
+#define IMU_FRONTEND_H_
+
+#include "system_configuration.h"
+#include "NAV_tuning_parameters.h"
+#include "float3vector.h"
+#include "float3matrix.h"
+#include "event_trace.h"
+#include <math.h>
+
+#if IMU_FUSION && WITH_LOWCOST_SENSORS
+#define IMU_FRONTEND_VECTORS 6 //!< acc, gyro, mag of both IMUs
+#else
+#define IMU_FRONTEND_VECTORS 3
+#endif
+
+//! IMU_frontend_t::get_status() bits
+enum
+{
+  IMU_PRIMARY_ACC_FAULT		= 1 << 0,
+  IMU_PRIMARY_GYRO_FAULT	= 1 << 1,
+  IMU_PRIMARY_MAG_FAULT		= 1 << 2,
+  IMU_SECONDARY_ACC_FAULT	= 1 << 3,
+  IMU_SECONDARY_GYRO_FAULT	= 1 << 4,
+  IMU_SECONDARY_MAG_FAULT	= 1 << 5,
+  IMU_ACC_DISAGREEMENT		= 1 << 6, //!< secondary acc not used
+  IMU_GYRO_DISAGREEMENT		= 1 << 7  //!< secondary gyro not used
+};
+
+/**
+ * @brief rotates the sensor readings into the airframe and fuses both IMUs
+ *
+ * All vectors are mapped in one 3x3 * 3xN product on a column-major
+ * staging area, the loop over the vectors vectorizes.
+ * Single IMU: N = 3, the arithmetic equals three float3matrix products.
+ *
+ * Dual IMU (IMU_FUSION): acc and gyro are weighted means of both IMUs.
+ * A reading that is not finite, saturated or bit-identical for IMU_STUCK_LIMIT
+ * samples marks its sensor faulty, the other IMU is used alone.
+ * If both are healthy but the filtered difference exceeds the limit
+ * it cannot be told which one is wrong: the primary IMU is used alone.
+ * The magnetometers are not averaged as each one has its own calibration,
+ * the secondary one is a fallback only.
+ */
+class IMU_frontend_t
+{
+public:
+  enum { ACC, GYRO, MAG}; 			//!< sensor index
+  enum { PRIMARY = 0, SECONDARY = 3}; 	//!< vector index = IMU + sensor
+
+  IMU_frontend_t( void)
+    : status( 0)
+  {
+    for( unsigned k = 0; k < 3; ++k)
+      {
+	for( unsigned i = 0; i < IMU_FRONTEND_VECTORS; ++i)
+	  input[k][i] = output[k][i] = 0.0f;
+	for( unsigned col = 0; col < 3; ++col)
+	  mapping[k][col] = k == col ? 1.0f : 0.0f;
+      }
+#if IMU_FRONTEND_VECTORS == 6
+    for( unsigned i = 0; i < IMU_FRONTEND_VECTORS; ++i)
+      {
+	stuck_count[i] = 0;
+	for( unsigned k = 0; k < 3; ++k)
+	  last_input[k][i] = 0.0f;
+      }
+    disagreement[ACC] = disagreement[GYRO] = 0.0f;
+#endif
+  }
+
+  void set_mapping( const float3matrix &sensor_mapping)
+  {
+    for( unsigned row = 0; row < 3; ++row)
+      for( unsigned col = 0; col < 3; ++col)
+	mapping[row][col] = sensor_mapping.e[row][col];
+  }
+
+  //! stage a sensor frame vector, index = PRIMARY / SECONDARY + ACC / GYRO / MAG
+  void set_input( unsigned index, const float3vector &value)
+  {
+    input[0][index] = value.e[0];
+    input[1][index] = value.e[1];
+    input[2][index] = value.e[2];
+  }
+
+  //! map all staged vectors and fuse, once per AHRS sample
+  void update( void)
+  {
+    map();
+#if IMU_FRONTEND_VECTORS == 6
+    fuse();
+#else
+    for( unsigned sensor = ACC; sensor <= MAG; ++sensor)
+      fused[sensor] = get_mapped( PRIMARY + sensor);
+#endif
+  }
+
+  const float3vector &get_acc( void) const
+  {
+    return fused[ACC];
+  }
+  const float3vector &get_gyro( void) const
+  {
+    return fused[GYRO];
+  }
+  const float3vector &get_mag( void) const
+  {
+    return fused[MAG];
+  }
+
+  //! airframe coordinates of one input vector
+  float3vector get_mapped( unsigned index) const
+  {
+    float3vector v;
+    v.e[0] = output[0][index];
+    v.e[1] = output[1][index];
+    v.e[2] = output[2][index];
+    return v;
+  }
+
+  unsigned get_status( void) const
+  {
+    return status;
+  }
+
+private:
+  void map( void)
+  {
+    for( unsigned row = 0; row < 3; ++row)
+      for( unsigned i = 0; i < IMU_FRONTEND_VECTORS; ++i)
+	{
+	  float sum = 0.0f; // same summation order as float3matrix * float3vector
+	  sum += mapping[row][0] * input[0][i];
+	  sum += mapping[row][1] * input[1][i];
+	  sum += mapping[row][2] * input[2][i];
+	  output[row][i] = sum;
+	}
+  }
+
+#if IMU_FRONTEND_VECTORS == 6
+  //! true if the sensor reading is implausible
+  bool check_fault( unsigned index, float limit)
+  {
+    bool fault = false;
+    bool unchanged = true;
+    for( unsigned k = 0; k < 3; ++k)
+      {
+	float x = input[k][index];
+	if( ! isfinite( x) || fabsf( x) > limit)
+	  fault = true;
+	if( x != last_input[k][index])
+	  unchanged = false;
+	last_input[k][index] = x;
+      }
+    if( ! unchanged)
+      stuck_count[index] = 0;
+    else if( stuck_count[index] < IMU_STUCK_LIMIT)
+      ++stuck_count[index];
+    return fault || stuck_count[index] >= IMU_STUCK_LIMIT;
+  }
+
+  void fuse( void)
+  {
+    static const float limit[3] = { IMU_ACC_SATURATION, IMU_GYRO_SATURATION, INFINITY};
+    static const float disagreement_limit[2] = { IMU_ACC_DISAGREEMENT_LIMIT, IMU_GYRO_DISAGREEMENT_LIMIT};
+    unsigned new_status = 0;
+
+    for( unsigned sensor = ACC; sensor <= MAG; ++sensor)
+      {
+	bool primary_fault   = check_fault( PRIMARY   + sensor, limit[sensor]);
+	bool secondary_fault = check_fault( SECONDARY + sensor, limit[sensor]);
+	if( primary_fault)
+	  new_status |= IMU_PRIMARY_ACC_FAULT << sensor;
+	if( secondary_fault)
+	  new_status |= IMU_SECONDARY_ACC_FAULT << sensor;
+
+	if( primary_fault && secondary_fault)
+	  continue; // keep the last good value
+
+	float3vector primary   = get_mapped( PRIMARY   + sensor);
+	float3vector secondary = get_mapped( SECONDARY + sensor);
+	if( secondary_fault)
+	  fused[sensor] = primary;
+	else if( primary_fault)
+	  fused[sensor] = secondary;
+	else if( sensor == MAG)
+	  fused[sensor] = primary;
+	else
+	  {
+	    disagreement[sensor] += IMU_DISAGREEMENT_FILTER * ( ( primary - secondary).abs() - disagreement[sensor]);
+	    if( disagreement[sensor] > disagreement_limit[sensor])
+	      {
+		new_status |= IMU_ACC_DISAGREEMENT << sensor;
+		fused[sensor] = primary;
+	      }
+	    else
+	      {
+		fused[sensor] = primary * ( 1.0f - IMU_FUSION_SECONDARY_WEIGHT);
+		fused[sensor].axpy( IMU_FUSION_SECONDARY_WEIGHT, secondary);
+	      }
+	  }
+      }
+
+    if( new_status != status)
+      TRACE_EVENT( TRACE_IMU_STATUS, status, new_status);
+    status = new_status;
+  }
+#endif
+
+  alignas(16) float input[3][IMU_FRONTEND_VECTORS]; 	//!< sensor frame, component major
+  alignas(16) float output[3][IMU_FRONTEND_VECTORS];	//!< airframe
+  float mapping[3][3];
+  float3vector fused[3];
+#if IMU_FRONTEND_VECTORS == 6
+  float last_input[3][IMU_FRONTEND_VECTORS];
+  unsigned stuck_count[IMU_FRONTEND_VECTORS];
+  float disagreement[2]; //!< acc, gyro: filtered abs( primary - secondary)
+#endif
+  unsigned status;
+};
+
+#endif /* IMU_FRONTEND_H_ */
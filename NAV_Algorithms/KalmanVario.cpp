@@ -23,17 +23,70 @@
  **************************************************************************/
 
 #include <KalmanVario.h>
+#include "Kalman_gain_solver.h"
 
-ROM float KalmanVario_t::Gain[N][L]= //!< Kalman Gain for 100Hz sampling rate
+ROM KalmanVario_gain_t KalmanVario_t::default_gain=
     {
-	   0.022706480781195,   0.000238300640696,
-	   0.026080120255934,   0.008557096024865,
-	   0.012200483136450,   0.282217429952530,
-	  -0.011857330213848,   0.000264240373951
+	0.01f, 0.01f * 0.01f / 2.0f,
+	{ //!< Kalman Gain for 100Hz sampling rate
+	   { 0.022706480781195,   0.000238300640696},
+	   { 0.026080120255934,   0.008557096024865},
+	   { 0.012200483136450,   0.282217429952530},
+	   {-0.011857330213848,   0.000264240373951}
+	}
     };
 
+//! the default gain results from 1/9, 1e-6, 1/144 and 0.01, i.e. standard deviations 1/3, 1e-3, 1/12 and 0.1
+bool KalmanVario_gain_t::compute( float sampling_time,
+				  float acceleration_process_variance, float offset_process_variance,
+				  float altitude_measurement_variance, float acceleration_measurement_variance,
+				  float (*smoother_gain)[N])
+{
+  double T = sampling_time;
+  double vpa = acceleration_process_variance;
+
+  const double A[N][N]=
+    {
+      { 1, T, T*T/2, 0 },
+      { 0, 1, T,     0 },
+      { 0, 0, 1,     0 },
+      { 0, 0, 0,     1 }
+    };
+  const double C[L][N]=
+    {
+      { 1, 0, 0, 0 },
+      { 0, 0, 1, 1 }
+    };
+  const double Q[N][N]=
+    {
+      { T*T*T*T*T/20 * vpa, T*T*T*T/8 * vpa, T*T*T/6 * vpa, 0 },
+      { T*T*T*T/8    * vpa, T*T*T/3   * vpa, T*T/2   * vpa, 0 },
+      { T*T*T/6      * vpa, T*T/2     * vpa, T       * vpa, 0 },
+      { 0,                  0,               0,             offset_process_variance }
+    };
+  const double R[L][L]=
+    {
+      { altitude_measurement_variance, 0 },
+      { 0, acceleration_measurement_variance }
+    };
+
+  double P[N][N];
+  if( solve_steady_state_Kalman_filter<N,L>( A, C, Q, R, Gain, P))
+    return true; // error
+  if( smoother_gain && solve_steady_state_smoother_gain<N>( A, Q, P, smoother_gain))
+    return true;
+
+  Ta = sampling_time;
+  Ta_s_2 = sampling_time * sampling_time / 2.0f;
+  return false;
+}
+
 float KalmanVario_t::update( const float altitude, const float acceleration)
 {
+  const float Ta = gain->Ta;
+  const float Ta_s_2 = gain->Ta_s_2;
+  const float (&Gain)[N][L] = gain->Gain;
+
   // predict x[] by propagating it through the system model
   float x_est_0 = x[0] + Ta * x[1] + Ta_s_2 * x[2];
   float x_est_1 = x[1] + Ta * x[2];
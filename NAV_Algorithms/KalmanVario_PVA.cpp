@@ -23,17 +23,73 @@
  **************************************************************************/
 
 #include <KalmanVario_PVA.h>
+#include "Kalman_gain_solver.h"
 
-ROM float KalmanVario_PVA_t::Gain[N][L]= //!< Kalman Gain for 100Hz sampling rate
+ROM KalmanVario_PVA_gain_t KalmanVario_PVA_t::default_gain=
     {
-	   0.014624427147059,   0.008213518721222,  -0.000020792258296,
-	   0.018480417122749,   0.033924391681735,   0.006461499931904,
-	   0.014990634309386,   0.067156008467552,   0.612880095929483,
-	  -0.015011426567682,  -0.064284230720039,   0.006830749781626
+	0.01f, 0.01f * 0.01f / 2.0f,
+	{ //!< Kalman Gain for 100Hz sampling rate
+	   { 0.014624427147059,   0.008213518721222,  -0.000020792258296},
+	   { 0.018480417122749,   0.033924391681735,   0.006461499931904},
+	   { 0.014990634309386,   0.067156008467552,   0.612880095929483},
+	   {-0.015011426567682,  -0.064284230720039,   0.006830749781626}
+	}
     };
 
+//! the default gain results from 1.0, 1e-4, 0.01, 0.0225 and 0.01 (Filter_Design/Kalman_XVA_acc_offset.m)
+bool KalmanVario_PVA_gain_t::compute( float sampling_time,
+				      float acceleration_process_variance, float offset_process_variance,
+				      float altitude_measurement_variance, float velocity_measurement_variance,
+				      float acceleration_measurement_variance,
+				      float (*smoother_gain)[N])
+{
+  double T = sampling_time;
+  double vpa = acceleration_process_variance;
+
+  const double A[N][N]=
+    {
+      { 1, T, T*T/2, 0 },
+      { 0, 1, T,     0 },
+      { 0, 0, 1,     0 },
+      { 0, 0, 0,     1 }
+    };
+  const double C[L][N]=
+    {
+      { 1, 0, 0, 0 },
+      { 0, 1, 0, 0 },
+      { 0, 0, 1, 1 }
+    };
+  const double Q[N][N]=
+    {
+      { T*T*T*T*T/20 * vpa, T*T*T*T/8 * vpa, T*T*T/6 * vpa, 0 },
+      { T*T*T*T/8    * vpa, T*T*T/3   * vpa, T*T/2   * vpa, 0 },
+      { T*T*T/6      * vpa, T*T/2     * vpa, T       * vpa, 0 },
+      { 0,                  0,               0,             offset_process_variance }
+    };
+  const double R[L][L]=
+    {
+      { altitude_measurement_variance, 0, 0 },
+      { 0, velocity_measurement_variance, 0 },
+      { 0, 0, acceleration_measurement_variance }
+    };
+
+  double P[N][N];
+  if( solve_steady_state_Kalman_filter<N,L>( A, C, Q, R, Gain, P))
+    return true; // error
+  if( smoother_gain && solve_steady_state_smoother_gain<N>( A, Q, P, smoother_gain))
+    return true;
+
+  Ta = sampling_time;
+  Ta_s_2 = sampling_time * sampling_time / 2.0f;
+  return false;
+}
+
 float KalmanVario_PVA_t::update( const float altitude, const float velocity, const float acceleration)
 {
+  const float Ta = gain->Ta;
+  const float Ta_s_2 = gain->Ta_s_2;
+  const float (&Gain)[N][L] = gain->Gain;
+
   // predict x[] by propagating it through the system model
   float x_est_0 = x[0] + Ta * x[1] + Ta_s_2 * x[2];
   float x_est_1 = x[1] + Ta * x[2];
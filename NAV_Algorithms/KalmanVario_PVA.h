@@ -30,6 +30,34 @@
 #include <stdint.h>
 #include "system_configuration.h"
 
+//! sampling time and Kalman gain for KalmanVario_PVA_t
+class KalmanVario_PVA_gain_t
+{
+public:
+  enum
+  {
+    N = 4,  //!< size of state vector x = { altitude, vario, vertical-acceleration, acceleration-offset }
+    L = 3  //!< number of measurement channels = { altitude, vario, vertical_acceleration_measurement }
+  };
+
+  /**
+   * @brief compute steady-state gain from noise parameters
+   *
+   * variances in SI units, process variances refer to continuous white noise
+   * @param smoother_gain if given: receives the steady-state RTS smoother gain
+   * @return true on error
+   */
+  bool compute( float sampling_time,
+		float acceleration_process_variance, float offset_process_variance,
+		float altitude_measurement_variance, float velocity_measurement_variance,
+		float acceleration_measurement_variance,
+		float (*smoother_gain)[N] = 0);
+
+  float Ta; 		//!< sampling time
+  float Ta_s_2; 	//!< Ta * Ta / 2
+  float Gain[N][L]; 	//!< Kalman Gain
+};
+
 /**
  * @brief Kalman-filter-based sensor fusion observer
  *
@@ -44,26 +72,53 @@ private:
   // constants
   enum
   {
-    N = 4,  //!< size of state vector x = { altitude, vario, vertical-acceleration, acceleration-offset }
-    L = 3  //!< number of measurement channels = { altitude, vertical_acceleration_measurement }
+    N = KalmanVario_PVA_gain_t::N,
+    L = KalmanVario_PVA_gain_t::L
   };
-  static constexpr float Ta = 0.01f; 			//!< sampling rate
-  static constexpr float Ta_s_2 = Ta * Ta / 2.0f; 	//!< sampling rate
-  static ROM float Gain[N][L];				//!< Pre-computed Kalman Gain
 
   // variables
   float x[N];	//!< state vector: altitude, vario, acceleration, acceleration offset
+  const KalmanVario_PVA_gain_t *gain;
 
 public:
+  static ROM KalmanVario_PVA_gain_t default_gain; //!< Pre-computed Kalman Gain for 100 Hz
+
   typedef enum// state vector components
   {
     ALTITUDE, VARIO, ACCELERATION_OBSERVED, ACCELERATION_OFFSET
   }  state;
 
-  KalmanVario_PVA_t ( float _x=ZERO, float v=ZERO, float a=ZERO, float a_offset=ZERO)
-    : x{_x, v, a, a_offset}
+  KalmanVario_PVA_t ( float _x=ZERO, float v=ZERO, float a=ZERO, float a_offset=ZERO,
+		      const KalmanVario_PVA_gain_t &_gain = default_gain)
+    : x{_x, v, a, a_offset},
+      gain( &_gain)
   {}
 
+  //! use different sampling time and gain, the gain set must outlive the filter
+  void set_gain( const KalmanVario_PVA_gain_t &_gain)
+  {
+    gain = &_gain;
+  }
+
+  //! dynamic state for checkpoints, the gain set is not part of it
+  class state_t
+  {
+  public:
+    float x[N];
+  };
+
+  void save_state( state_t &state) const
+  {
+    for( unsigned i = 0; i < N; ++i)
+      state.x[i] = x[i];
+  }
+
+  void restore_state( const state_t &state)
+  {
+    for( unsigned i = 0; i < N; ++i)
+      x[i] = state.x[i];
+  }
+
   void reset(  const float altitude, const float acceleration_offset)
   {
     x[0] = altitude;
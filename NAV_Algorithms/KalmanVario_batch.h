@@ -0,0 +1,212 @@
+/***********************************************************************//**
+ * @file		KalmanVario_batch.h
+ * @brief		Kalman vario filters, K instances in structure-of-arrays layout
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef APPLICATION_KALMANVARIO_BATCH_H_
+#define APPLICATION_KALMANVARIO_BATCH_H_
+
+#include "KalmanVario.h"
+#include "KalmanVario_PVA.h"
+
+/**
+ * @brief K instances of KalmanVario_t updated in one pass
+ *
+ * The state vectors are stored component-wise (x0[K], x1[K], ...)
+ * so the loops over k vectorize.
+ * All filters share one gain set.
+ * Arithmetic is identical to KalmanVario_t::update,
+ * results are bit-identical given the same floating point contraction settings.
+ * Intended for offline sweeps, on the embedded target use KalmanVario_t.
+ */
+template <unsigned K> class KalmanVario_batch_t
+{
+public:
+  typedef KalmanVario_t::state state;
+
+  KalmanVario_batch_t ( float _x=ZERO, float v=ZERO, float a=ZERO, float a_offset=ZERO,
+		      const KalmanVario_gain_t &_gain = KalmanVario_t::default_gain)
+    : gain( &_gain)
+  {
+    for( unsigned k = 0; k < K; ++k)
+      {
+	x0[k] = _x;
+	x1[k] = v;
+	x2[k] = a;
+	x3[k] = a_offset;
+      }
+  }
+
+  void reset( unsigned k, const float altitude, const float acceleration_offset)
+  {
+    x0[k] = altitude;
+    x1[k] = 0.0f;
+    x2[k] = 0.0f;
+    x3[k] = acceleration_offset;
+  }
+
+  //! update all filters, vario[k] receives the velocity of filter k
+  void update( const float * __restrict altitude, const float * __restrict acceleration, float * __restrict vario)
+  {
+    const float Ta = gain->Ta;
+    const float Ta_s_2 = gain->Ta_s_2;
+    const float g00 = gain->Gain[0][0], g01 = gain->Gain[0][1];
+    const float g10 = gain->Gain[1][0], g11 = gain->Gain[1][1];
+    const float g20 = gain->Gain[2][0], g21 = gain->Gain[2][1];
+    const float g30 = gain->Gain[3][0], g31 = gain->Gain[3][1];
+
+    for( unsigned k = 0; k < K; ++k)
+      {
+	// predict x[] by propagating it through the system model
+	float x_est_0 = x0[k] + Ta * x1[k] + Ta_s_2 * x2[k];
+	float x_est_1 = x1[k] + Ta * x2[k];
+	float x_est_2 = x2[k];
+	float x_est_3 = x3[k];
+
+	float innovation_x = altitude[k]     - x_est_0;
+	float innovation_a = acceleration[k] - x_est_2 - x_est_3;
+
+	// x[] correction
+	x0[k] = x_est_0 + g00 * innovation_x + g01 * innovation_a;
+	x1[k] = x_est_1 + g10 * innovation_x + g11 * innovation_a;
+	x2[k] = x_est_2 + g20 * innovation_x + g21 * innovation_a;
+	x3[k] = x_est_3 + g30 * innovation_x + g31 * innovation_a;
+
+	vario[k] = x1[k];
+      }
+  }
+
+  float get_x( unsigned k, state index) const
+  {
+    switch( index)
+    {
+      case KalmanVario_t::ALTITUDE:
+	return x0[k];
+      case KalmanVario_t::VARIO:
+	return x1[k];
+      case KalmanVario_t::ACCELERATION_OBSERVED:
+	return x2[k];
+      case KalmanVario_t::ACCELERATION_OFFSET:
+	return x3[k];
+      default:
+	return x2[k] + x3[k]; // = acceleration minus offset
+    }
+  }
+
+private:
+  float x0[K]; //!< altitude
+  float x1[K]; //!< vario
+  float x2[K]; //!< acceleration
+  float x3[K]; //!< acceleration offset
+  const KalmanVario_gain_t *gain;
+};
+
+/**
+ * @brief K instances of KalmanVario_PVA_t updated in one pass
+ *
+ * Layout and accuracy as KalmanVario_batch_t.
+ */
+template <unsigned K> class KalmanVario_PVA_batch_t
+{
+public:
+  typedef KalmanVario_PVA_t::state state;
+
+  KalmanVario_PVA_batch_t ( float _x=ZERO, float v=ZERO, float a=ZERO, float a_offset=ZERO,
+		      const KalmanVario_PVA_gain_t &_gain = KalmanVario_PVA_t::default_gain)
+    : gain( &_gain)
+  {
+    for( unsigned k = 0; k < K; ++k)
+      {
+	x0[k] = _x;
+	x1[k] = v;
+	x2[k] = a;
+	x3[k] = a_offset;
+      }
+  }
+
+  void reset( unsigned k, const float altitude, const float acceleration_offset)
+  {
+    x0[k] = altitude;
+    x1[k] = 0.0f;
+    x2[k] = 0.0f;
+    x3[k] = acceleration_offset;
+  }
+
+  //! update all filters, vario[k] receives the velocity of filter k
+  void update( const float * __restrict altitude, const float * __restrict velocity,
+	       const float * __restrict acceleration, float * __restrict vario)
+  {
+    const float Ta = gain->Ta;
+    const float Ta_s_2 = gain->Ta_s_2;
+    const float g00 = gain->Gain[0][0], g01 = gain->Gain[0][1], g02 = gain->Gain[0][2];
+    const float g10 = gain->Gain[1][0], g11 = gain->Gain[1][1], g12 = gain->Gain[1][2];
+    const float g20 = gain->Gain[2][0], g21 = gain->Gain[2][1], g22 = gain->Gain[2][2];
+    const float g30 = gain->Gain[3][0], g31 = gain->Gain[3][1], g32 = gain->Gain[3][2];
+
+    for( unsigned k = 0; k < K; ++k)
+      {
+	// predict x[] by propagating it through the system model
+	float x_est_0 = x0[k] + Ta * x1[k] + Ta_s_2 * x2[k];
+	float x_est_1 = x1[k] + Ta * x2[k];
+	float x_est_2 = x2[k];
+	float x_est_3 = x3[k];
+
+	float innovation_x = altitude[k]     - x_est_0;
+	float innovation_v = velocity[k]     - x_est_1;
+	float innovation_a = acceleration[k] - x_est_2 - x_est_3;
+
+	// x[] correction
+	x0[k] = x_est_0 + g00 * innovation_x + g01 * innovation_v + g02 * innovation_a;
+	x1[k] = x_est_1 + g10 * innovation_x + g11 * innovation_v + g12 * innovation_a;
+	x2[k] = x_est_2 + g20 * innovation_x + g21 * innovation_v + g22 * innovation_a;
+	x3[k] = x_est_3 + g30 * innovation_x + g31 * innovation_v + g32 * innovation_a;
+
+	vario[k] = x1[k];
+      }
+  }
+
+  float get_x( unsigned k, state index) const
+  {
+    switch( index)
+    {
+      case KalmanVario_PVA_t::ALTITUDE:
+	return x0[k];
+      case KalmanVario_PVA_t::VARIO:
+	return x1[k];
+      case KalmanVario_PVA_t::ACCELERATION_OBSERVED:
+	return x2[k];
+      case KalmanVario_PVA_t::ACCELERATION_OFFSET:
+	return x3[k];
+      default:
+	return x2[k] + x3[k]; // = acceleration minus offset
+    }
+  }
+
+private:
+  float x0[K]; //!< altitude
+  float x1[K]; //!< vario
+  float x2[K]; //!< acceleration
+  float x3[K]; //!< acceleration offset
+  const KalmanVario_PVA_gain_t *gain;
+};
+
+#endif /* APPLICATION_KALMANVARIO_BATCH_H_ */
@@ -23,16 +23,65 @@
  **************************************************************************/
 
 #include <Kalman_V_A_Aoff_observer.h>
+#include "Kalman_gain_solver.h"
 
-ROM float Kalman_V_A_Aoff_observer_t::Gain[N][L]= //!< Kalman Gain for 100Hz sampling rate
+ROM Kalman_V_A_Aoff_gain_t Kalman_V_A_Aoff_observer_t::default_gain=
     {
-	   0.045525746461218,   0.005179336297606,
-	   0.102816402740272,   0.906791781469036,
-	  -0.097637066442666,   0.001591461803718
+	0.01f,
+	{ //!< Kalman Gain for 100Hz sampling rate
+	   { 0.045525746461218,   0.005179336297606},
+	   { 0.102816402740272,   0.906791781469036},
+	   {-0.097637066442666,   0.001591461803718}
+	}
     };
 
+//! the default gain results from 9.0, 1e-4, 0.01 and 0.01 (Filter_Design/Kalman_VA_acc_offset.m)
+bool Kalman_V_A_Aoff_gain_t::compute( float sampling_time,
+				      float acceleration_process_variance, float offset_process_variance,
+				      float velocity_measurement_variance, float acceleration_measurement_variance,
+				      float (*smoother_gain)[N])
+{
+  double T = sampling_time;
+  double vpa = acceleration_process_variance;
+
+  const double A[N][N]=
+    {
+      { 1, T, 0 },
+      { 0, 1, 0 },
+      { 0, 0, 1 }
+    };
+  const double C[L][N]=
+    {
+      { 1, 0, 0 },
+      { 0, 1, 1 }
+    };
+  const double Q[N][N]=
+    {
+      { T*T*T/3 * vpa, T*T/2 * vpa, 0 },
+      { T*T/2   * vpa, T     * vpa, 0 },
+      { 0,             0,           offset_process_variance }
+    };
+  const double R[L][L]=
+    {
+      { velocity_measurement_variance, 0 },
+      { 0, acceleration_measurement_variance }
+    };
+
+  double P[N][N];
+  if( solve_steady_state_Kalman_filter<N,L>( A, C, Q, R, Gain, P))
+    return true; // error
+  if( smoother_gain && solve_steady_state_smoother_gain<N>( A, Q, P, smoother_gain))
+    return true;
+
+  Ta = sampling_time;
+  return false;
+}
+
 void Kalman_V_A_Aoff_observer_t::update( const float velocity, const float acceleration)
 {
+  const float Ta = gain->Ta;
+  const float (&Gain)[N][L] = gain->Gain;
+
   // predict x[] by propagating it through the system model
   float x_est_0 = x[0] + Ta * x[1];
   float x_est_1 = x[1];
@@ -30,6 +30,32 @@
 #include <stdint.h>
 #include "system_configuration.h"
 
+//! sampling time and Kalman gain for Kalman_V_A_Aoff_observer_t
+class Kalman_V_A_Aoff_gain_t
+{
+public:
+  enum
+  {
+    N = 3,  //!< size of state vector x = { velocity, acceleration, acceleration-offset }
+    L = 2  //!< number of measurement channels = { velocity, acceleration_measurement }
+  };
+
+  /**
+   * @brief compute steady-state gain from noise parameters
+   *
+   * variances in SI units, process variances refer to continuous white noise
+   * @param smoother_gain if given: receives the steady-state RTS smoother gain
+   * @return true on error
+   */
+  bool compute( float sampling_time,
+		float acceleration_process_variance, float offset_process_variance,
+		float velocity_measurement_variance, float acceleration_measurement_variance,
+		float (*smoother_gain)[N] = 0);
+
+  float Ta; 		//!< sampling time
+  float Gain[N][L]; 	//!< Kalman Gain
+};
+
 /**
  * @brief Kalman-filter-based sensor fusion observer for horizontal movement
  *
@@ -43,25 +69,53 @@ private:
   // constants
   enum
   {
-    N = 3,  //!< size of state vector x = { altitude, vario, vertical-acceleration, acceleration-offset }
-    L = 2  //!< number of measurement channels = { altitude, vertical_acceleration_measurement }
+    N = Kalman_V_A_Aoff_gain_t::N,
+    L = Kalman_V_A_Aoff_gain_t::L
   };
-  static constexpr float Ta = 0.01f; 			//!< sampling rate
-  static ROM float Gain[N][L];				//!< Pre-computed Kalman Gain
 
   // variables
-  float x[N];	//!< state vector: altitude, vario, acceleration, acceleration offset
+  float x[N];	//!< state vector: velocity, acceleration, acceleration offset
+  const Kalman_V_A_Aoff_gain_t *gain;
 
 public:
+  static ROM Kalman_V_A_Aoff_gain_t default_gain; //!< Pre-computed Kalman Gain for 100 Hz
+
   typedef enum// state vector components
   {
     VELOCITY, ACCELERATION, ACCELERATION_OFFSET
   }  state;
 
-  Kalman_V_A_Aoff_observer_t ( float v=ZERO, float a=ZERO)
-    : x{ v, a, 0.0f}
+  Kalman_V_A_Aoff_observer_t ( float v=ZERO, float a=ZERO,
+			       const Kalman_V_A_Aoff_gain_t &_gain = default_gain)
+    : x{ v, a, 0.0f},
+      gain( &_gain)
   {}
 
+  //! use different sampling time and gain, the gain set must outlive the filter
+  void set_gain( const Kalman_V_A_Aoff_gain_t &_gain)
+  {
+    gain = &_gain;
+  }
+
+  //! dynamic state for checkpoints, the gain set is not part of it
+  class state_t
+  {
+  public:
+    float x[N];
+  };
+
+  void save_state( state_t &state) const
+  {
+    for( unsigned i = 0; i < N; ++i)
+      state.x[i] = x[i];
+  }
+
+  void restore_state( const state_t &state)
+  {
+    for( unsigned i = 0; i < N; ++i)
+      x[i] = state.x[i];
+  }
+
   void update( const float velocity, const float acceleration);
 
   inline float get_x( state index) const
@@ -23,15 +23,56 @@
  **************************************************************************/
 
 #include <Kalman_V_A_observer.h>
+#include "Kalman_gain_solver.h"
 
-ROM float Kalman_V_A_observer_t::Gain[N][L]= //!< Kalman Gain for 100Hz sampling rate
+ROM Kalman_V_A_gain_t Kalman_V_A_observer_t::default_gain=
     {
-	   0.002460426151335,   0.008147862943514,
-	   0.000527203519767,   0.011290372131367,
+	0.01f,
+	{ //!< Kalman Gain for 100Hz sampling rate
+	   { 0.002460426151335,   0.008147862943514},
+	   { 0.000527203519767,   0.011290372131367},
+	}
     };
 
+bool Kalman_V_A_gain_t::compute( float sampling_time, float acceleration_process_variance,
+				 float velocity_measurement_variance, float acceleration_measurement_variance)
+{
+  double T = sampling_time;
+  double vpa = acceleration_process_variance;
+
+  const double A[N][N]=
+    {
+      { 1, T },
+      { 0, 1 }
+    };
+  const double C[L][N]=
+    {
+      { 1, 0 },
+      { 0, 1 }
+    };
+  const double Q[N][N]=
+    {
+      { T*T*T/3 * vpa, T*T/2 * vpa },
+      { T*T/2   * vpa, T     * vpa }
+    };
+  const double R[L][L]=
+    {
+      { velocity_measurement_variance, 0 },
+      { 0, acceleration_measurement_variance }
+    };
+
+  if( solve_steady_state_Kalman_gain<N,L>( A, C, Q, R, Gain))
+    return true; // error
+
+  Ta = sampling_time;
+  return false;
+}
+
 float Kalman_V_A_observer_t::update( const float velocity, const float acceleration)
 {
+  const float Ta = gain->Ta;
+  const float (&Gain)[N][L] = gain->Gain;
+
   // predict x[] by propagating it through the system model
   float x_est_0 = x[0] + Ta * x[1];
   float x_est_1 = x[1];
@@ -30,6 +30,29 @@
 #include <stdint.h>
 #include "system_configuration.h"
 
+//! sampling time and Kalman gain for Kalman_V_A_observer_t
+class Kalman_V_A_gain_t
+{
+public:
+  enum
+  {
+    N = 2,  //!< size of state vector x = { velocity, acceleration }
+    L = 2  //!< number of measurement channels = { velocity, acceleration_measurement }
+  };
+
+  /**
+   * @brief compute steady-state gain from noise parameters
+   *
+   * variances in SI units, process variance refers to continuous white noise
+   * @return true on error
+   */
+  bool compute( float sampling_time, float acceleration_process_variance,
+		float velocity_measurement_variance, float acceleration_measurement_variance);
+
+  float Ta; 		//!< sampling time
+  float Gain[N][L]; 	//!< Kalman Gain
+};
+
 /**
  * @brief Kalman-filter-based sensor fusion observer for horizontal movement
  *
@@ -43,25 +66,34 @@ private:
   // constants
   enum
   {
-    N = 2,  //!< size of state vector x = { altitude, vario, vertical-acceleration, acceleration-offset }
-    L = 2  //!< number of measurement channels = { altitude, vertical_acceleration_measurement }
+    N = Kalman_V_A_gain_t::N,
+    L = Kalman_V_A_gain_t::L
   };
-  static constexpr float Ta = 0.01f; 			//!< sampling rate
-  static ROM float Gain[N][L];				//!< Pre-computed Kalman Gain
 
   // variables
-  float x[N];	//!< state vector: altitude, vario, acceleration, acceleration offset
+  float x[N];	//!< state vector: velocity, acceleration
+  const Kalman_V_A_gain_t *gain;
 
 public:
+  static ROM Kalman_V_A_gain_t default_gain; //!< Pre-computed Kalman Gain for 100 Hz
+
   typedef enum// state vector components
   {
     VELOCITY, ACCELERATION
   }  state;
 
-  Kalman_V_A_observer_t ( float v=ZERO, float a=ZERO)
-    : x{ v, a}
+  Kalman_V_A_observer_t ( float v=ZERO, float a=ZERO,
+			  const Kalman_V_A_gain_t &_gain = default_gain)
+    : x{ v, a},
+      gain( &_gain)
   {}
 
+  //! use different sampling time and gain, the gain set must outlive the filter
+  void set_gain( const Kalman_V_A_gain_t &_gain)
+  {
+    gain = &_gain;
+  }
+
   float update( const float velocity, const float acceleration);
 
   inline float get_x( state index) const
@@ -25,17 +25,73 @@
 #ifndef NAV_ALGORITHMS_NAV_TUNING_PARAMETERS_H_
 #define NAV_ALGORITHMS_NAV_TUNING_PARAMETERS_H_
 
-#define MINIMUM_MAG_CALIBRATION_SAMPLES 6000
+// sampling rates: all fast-loop filters, counters and decimators derive from FAST_SAMPLING_FREQUENCY
+// profiles: 100 Hz (default), 200 Hz, 400 Hz (define in system_configuration.h or on the command line)
+#ifndef FAST_SAMPLING_FREQUENCY
+#define FAST_SAMPLING_FREQUENCY 	100 	//!< IMU / AHRS loop rate / Hz
+#endif
+#define SLOW_SAMPLING_FREQUENCY 	10	//!< navigation / wind loop rate / Hz
+#define FAST_SAMPLING_TIME 		( 1.0f / FAST_SAMPLING_FREQUENCY)
+#define SLOW_SAMPLING_TIME 		( 1.0f / SLOW_SAMPLING_FREQUENCY)
+#define FAST_SLOW_DECIMATION		( FAST_SAMPLING_FREQUENCY / SLOW_SAMPLING_FREQUENCY)
+#define RATE_SCALE_100HZ		( 100.0f / FAST_SAMPLING_FREQUENCY) //!< for per-sample constants tuned @ 100 Hz
+
+#if ( FAST_SAMPLING_FREQUENCY % SLOW_SAMPLING_FREQUENCY) != 0
+#error FAST_SAMPLING_FREQUENCY must be a multiple of SLOW_SAMPLING_FREQUENCY
+#endif
+
+// IMU FIFO rate for the pre-integration, the AHRS consumes the increments at FAST_SAMPLING_FREQUENCY
+#ifndef IMU_SAMPLING_FREQUENCY
+#define IMU_SAMPLING_FREQUENCY		400	//!< IMU output data rate / Hz
+#endif
+#define IMU_SAMPLING_TIME		( 1.0f / IMU_SAMPLING_FREQUENCY)
+
+// 10 Hz work spread over the fast ticks, slot = fast tick within the slow cycle, see organizer_t::update_tick_slot()
+#ifndef TICK_SCHEDULER
+#define TICK_SCHEDULER			0	//!< if 1: one 10 Hz phase per fast tick instead of all phases in one tick
+#endif
+#define TICK_SLOT_ACTIVITY		0	//!< idle detection, suspends the following phases
+#define TICK_SLOT_WIND			1	//!< wind observers and averagers
+#define TICK_SLOT_AVERAGERS		2	//!< vario integrator, reported wind smoothing, after the wind phase
+#define TICK_SLOT_DENSITY		3	//!< QFF and density metering
+#define TICK_SLOT_OUTPUT		5	//!< suggested slot for the NMEA / CAN formatting of the firmware
+
+#if TICK_SLOT_ACTIVITY >= TICK_SLOT_WIND || TICK_SLOT_WIND >= TICK_SLOT_AVERAGERS || TICK_SLOT_OUTPUT >= FAST_SLOW_DECIMATION
+#error tick slots: activity < wind < averagers, all within one slow cycle
+#endif
+
+// dual IMU frontend, see IMU_frontend.h
+#ifndef IMU_FUSION
+#define IMU_FUSION			0	//!< if 1 and WITH_LOWCOST_SENSORS: weighted fusion of both IMUs with fault detection
+#endif
+#define IMU_FUSION_SECONDARY_WEIGHT	0.25f	//!< acc and gyro weight of the secondary IMU, about its relative inverse noise variance
+#define IMU_ACC_SATURATION		150.0f	//!< m/s^2, just below the 16 g sensor range
+#define IMU_GYRO_SATURATION		34.0f	//!< rad/s, just below 2000 deg/s
+#define IMU_STUCK_LIMIT			( FAST_SAMPLING_FREQUENCY / 2) //!< samples with a bit-identical reading = sensor fault
+#define IMU_ACC_DISAGREEMENT_LIMIT	2.0f	//!< m/s^2, filtered difference of both IMUs
+#define IMU_GYRO_DISAGREEMENT_LIMIT	0.05f	//!< rad/s, filtered difference of both IMUs
+#define IMU_DISAGREEMENT_FILTER		( 2.0f / FAST_SAMPLING_FREQUENCY) //!< first order low pass coefficient, 0.5 s
+
+#define MINIMUM_MAG_CALIBRATION_SAMPLES ( 60 * FAST_SAMPLING_FREQUENCY) //!< 60 s
 #define MAG_CALIBRATION_CHANGE_LIMIT 6.0e-4f //!< variance average of changes: 3 * { offset, scale }
 //this means an average change of all 6 parameters of 1 % STD-deviation (= 1e-4 variance)
 
-#define CIRCLE_LIMIT (10 * 100) //!< 10 * 1/100 s delay into / out of circling state
+#ifndef MAG_CONTINUOUS_CALIBRATION
+#define MAG_CONTINUOUS_CALIBRATION 0 //!< if 1: recursive magnetic calibration instead of evaluation after each circle
+#endif
+#define MAG_RLS_FORGETTING_FACTOR ( 1.0f - 1.0f / ( 120 * FAST_SAMPLING_FREQUENCY)) //!< 120 s window of circling data
+#define MAG_CALIBRATION_WRITE_INTERVAL ( 60 * FAST_SAMPLING_FREQUENCY) //!< min. samples between two EEPROM updates
+#ifndef DEFERRED_MAG_CALIBRATION
+#define DEFERRED_MAG_CALIBRATION 0 //!< if 1: calibration evaluation and EEPROM writes in AHRS_type::run_deferred_jobs(), to be called by a background task
+#endif
+
+#define CIRCLE_LIMIT (10 * FAST_SAMPLING_FREQUENCY) //!< 10 s delay into / out of circling state
 
 #define VARIO_USE_SQUARED_VELOCITY 1 // use squared absolute air velocity for speed-compensation
 
 // filters for CAN information (turn-coordinator, G-load ...)
-#define ANGLE_F_BY_FS  ( 1.0f / 0.5f / 100.0f) 			// 0.5s
-#define G_LOAD_F_BY_FS ( 1.0f / 0.25f / 100.0f) 		// 0.25s
+#define ANGLE_F_BY_FS  ( 1.0f / 0.5f / FAST_SAMPLING_FREQUENCY) 	// 0.5s
+#define G_LOAD_F_BY_FS ( 1.0f / 0.25f / FAST_SAMPLING_FREQUENCY) 	// 0.25s
 
 // variometer tuning parameters, will be written into EEPROM as defaults if no config-file is given
 #define DEFAULT_VARIO_TC       	2.0f
@@ -48,7 +104,7 @@
 // These parameters have been tuned for the flight-dynamics of gliders
 // and the use of the MTI high-precision IMU
 #define P_GAIN 0.03f			//!< Attitude controller: proportional gain
-#define I_GAIN 0.00006f 		//!< Attitude controller: integral gain
+#define I_GAIN ( 0.00006f * RATE_SCALE_100HZ) //!< Attitude controller: integral gain, integrator runs per sample
 #define H_GAIN 38.0f			//!< Attitude controller: horizontal gain
 #define M_H_GAIN 6.0f			//!< Attitude controller: horizontal gain magnetic
 #define CROSS_GAIN 0.05f		//!< Attitude controller: cross-product gain
@@ -56,24 +112,96 @@
 #define NAV_CORRECTION_LIMIT 5.0f	//!< limit for "low AHRS correcting variable"
 #define HIGH_TURN_RATE 8.0*M_PI/180.0f	//!< turn rate high limit
 #define LOW_TURN_RATE  4.0*M_PI/180.0f	//!< turn rate low limit
-#define SPEED_COMPENSATION_FUSIONER_FEEDBACK 0.992f // empirically tuned alpha
+#define SPEED_COMPENSATION_FUSIONER_FEEDBACK powf( 0.992f, RATE_SCALE_100HZ) //!< empirically tuned alpha @ 100 Hz, same time constant at other rates
+#define SPEED_COMPENSATION_INS_GNSS_BLEND 0.5f	//!< weight of INS-GNSS vs. Kalman speed compensation
+#ifndef WIND_DECIMATION_ORDER
+#define WIND_DECIMATION_ORDER		2	//!< 2: pt2, 4 or 6: sharper butterworth cascade, 0: linear phase FIR for the 100 -> 10 Hz wind decimation
+#endif
+#define WIND_FIR_TAPS			( 6 * FAST_SLOW_DECIMATION) 	//!< 0.6 s impulse response
+#define WIND_FIR_CUTOFF			( 0.15f / FAST_SLOW_DECIMATION) //!< Fc/Fs: 1.5 Hz, -6dB
+#define PRESSURE_FIR_TAPS		( 4 * FAST_SLOW_DECIMATION) 	//!< 0.4 s impulse response
+#define PRESSURE_FIR_CUTOFF		( 0.3f / FAST_SLOW_DECIMATION) 	//!< Fc/Fs: 3 Hz, -6dB
+
+#ifndef CIRCLE_FIT_WIND
+#define CIRCLE_FIT_WIND			1	//!< if 1: report the circle fit wind until the circling average has settled
+#endif
+#define CIRCLE_FIT_MINIMUM_TURN		( 120.0f * M_PI_F / 180.0f) //!< turn needed for a circle fit result
+#define CIRCLE_FIT_HANDOVER_TURN	( 4.0f * M_PI_F) //!< after two turns the circling average takes over
+#define CIRCLE_FIT_MINIMUM_RADIUS	10.0f	//!< m/s, implausible air speed below
+#define CIRCLE_FIT_MAXIMUM_RESIDUAL	1.0f	//!< m/s RMS radial error
+
+#ifndef IDLE_DETECTION
+#define IDLE_DETECTION			0	//!< if 1: reduced rate processing while resting on the ground
+#endif
+#define IDLE_DETECTION_TIME		( 60 * SLOW_SAMPLING_FREQUENCY) //!< 60 s of rest before entering idle mode
+#define IDLE_MAXIMUM_TAS		8.0f	//!< m/s, idle mode only below
+#define IDLE_WAKEUP_TAS			15.0f	//!< m/s, immediate return to full rate
+#define IDLE_WAKEUP_GNSS_SPEED		40.0f	//!< m/s, fallback if the pitot fails, above trailer speeds
+#define IDLE_MAXIMUM_TURN_RATE		0.1f	//!< rad/s
+#define IDLE_MAXIMUM_G_VARIANCE		0.25f	//!< (m/s^2)^2 G-load variance
+#define IDLE_DECIMATION			FAST_SLOW_DECIMATION //!< AHRS @ 10 Hz in idle mode
 
 #define CROSS_GAIN_ONLY			0 	//!< if 1: do not use induction to control attitude while circling
 #define DISABLE_CIRCLING_STATE		0	//!< for tests only: never use circling AHRS algorithm
 #define INDUCTION_STD_DEVIATION_LIMIT	0.03 	//!< results outperforming this number will be used further on
 
 #define MAG_HIGH_PRECISION		1
-#if MAG_HIGH_PRECISION
+
+#ifndef LOW_RAM_FOOTPRINT
+#define LOW_RAM_FOOTPRINT		0	//!< if 1: defaults below are chosen for minimum static RAM
+#endif
+
+#ifndef FLOAT_STATISTICS
+#define FLOAT_STATISTICS		LOW_RAM_FOOTPRINT	//!< if 1: float Welford statistics replace the 64-bit accumulators
+#endif
+
+#ifndef SOARING_SECTOR_COUNTER_TYPE
+#if LOW_RAM_FOOTPRINT
+#define SOARING_SECTOR_COUNTER_TYPE	uint16_t //!< samples per sector, at most one circle @ 10 Hz
+#else
+#define SOARING_SECTOR_COUNTER_TYPE	unsigned
+#endif
+#endif
+
+#ifndef RECURSIVE_DENSITY_OBSERVER
+#define RECURSIVE_DENSITY_OBSERVER	0	//!< if 1: continuous float RLS density / QFF estimation instead of the batch fit
+#endif
+
+#ifndef ISA_TEMPERATURE_MODEL
+#define ISA_TEMPERATURE_MODEL		0	//!< if 1: ISA table altitude, density from the ambient air temperature if available
+#endif
+#define ISA_TABLE_MIN_PRESSURE		30000.0f //!< Pa, about 9100 m ISA altitude
+#define ISA_TABLE_PRESSURE_STEP		2000.0f	//!< Pa, interpolation error < 0.4 m near sea level, < 3 m at 30000 Pa
+#define ISA_TABLE_SIZE			41	//!< up to 110000 Pa
+
+#ifndef REPLAY_FLUSH_DENORMALS
+#define REPLAY_FLUSH_DENORMALS		1	//!< if 1: host replay runs with FTZ / DAZ, see denormal.h
+#endif
+
+#if MAG_HIGH_PRECISION && ! FLOAT_STATISTICS
 #define MAG_SCALE			10000.0f //!< scale factor for high-precision integer statistics
 #else
 #define MAG_SCALE			1.0f
 #endif
 
-#define FAST_SAMPLING_REQUENCY 		100.0f
-#define FAST_SAMPLING_TIME 		0.01f
-#define SLOW_SAMPLING_REQUENCY 		10.0f
-#define SLOW_SAMPLING_TIME 		0.1f
+//! vario integrator and wind average are updated @ 10 Hz but their time-constants have been tuned with this base
+#define SOARING_AVERAGER_TIME_BASE	0.01f
 
 #define GRAVITY				9.81f
 
+#ifndef GNSS_LATENCY_COMPENSATION
+#define GNSS_LATENCY_COMPENSATION	0 //!< if 1: GNSS data are propagated from their epoch to the present IMU sample
+#endif
+#define DEFAULT_GNSS_LATENCY		0.07f //!< age of a GNSS solution when it is passed to update_GNSS_data() / s
+#define GNSS_HISTORY_LENGTH		( FAST_SAMPLING_FREQUENCY / 4) //!< IMU history covering up to 0.25 s of GNSS latency
+#define GNSS_PROPAGATION_LIMIT		( FAST_SAMPLING_FREQUENCY / 2) //!< no dead reckoning beyond 0.5 s without a new GNSS epoch
+
+#ifndef OUTPUT_SUBSCRIPTION_SLOTS
+#define OUTPUT_SUBSCRIPTION_SLOTS	4 //!< number of output consumers with individual field mask and rate
+#endif
+
+#ifndef SHADOW_ESTIMATOR_SLOTS
+#define SHADOW_ESTIMATOR_SLOTS		2 //!< number of shadow estimators a navigator can feed
+#endif
+
 #endif /* NAV_ALGORITHMS_NAV_TUNING_PARAMETERS_H_ */
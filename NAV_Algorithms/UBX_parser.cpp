@@ -0,0 +1,223 @@
+/***********************************************************************//**
+ * @file		UBX_parser.cpp
+ * @brief		resumable uBlox UBX stream parser decoding into coordinates_t
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "UBX_parser.h"
+#include "AHRS.h" // NORTH EAST DOWN
+#include "embedded_math.h"
+
+#define UBX_SYNC_1 		0xb5
+#define UBX_SYNC_2 		0x62
+#define UBX_CLASS_NAV 		0x01
+#define UBX_ID_PVT 		0x07
+#define UBX_ID_RELPOSNED 	0x3c
+
+#define PVT_GNSS_FIX_OK 	0x01 	//!< fix_flags
+#define RELPOS_HEADING_MASK 	0x013f 	//!< gnssFixOK diffSoln relPosValid carrSoln[2] isMoving relPosHeadingValid
+#define RELPOS_HEADING_VALID 	0x0137 	//!< ... with carrier solution fixed
+
+#define UBX_MAX_PAYLOAD 	1024 	//!< longer messages are taken as false sync
+
+#define METER_PER_DEGREE_E7 	0.0111319491f 	//!< latitude 1e-7 degrees -> m
+
+unsigned UBX_parser_t::feed( const uint8_t *data, unsigned size)
+{
+  unsigned result = 0;
+  const uint8_t *end = data + size;
+  while( data < end)
+    {
+      uint8_t byte = *data++;
+      switch( state)
+      {
+	case SYNC_1:
+	  if( byte == UBX_SYNC_1)
+	    state = SYNC_2;
+	  break;
+	case SYNC_2:
+	  state = byte == UBX_SYNC_2 ? CLASS : ( byte == UBX_SYNC_1 ? SYNC_2 : SYNC_1);
+	  break;
+	case CLASS:
+	  message_class = byte;
+	  ck_a = ck_b = byte;
+	  state = ID;
+	  break;
+	case ID:
+	  message_id = byte;
+	  ck_a += byte;
+	  ck_b += ck_a;
+	  state = LENGTH_1;
+	  break;
+	case LENGTH_1:
+	  length = byte;
+	  ck_a += byte;
+	  ck_b += ck_a;
+	  state = LENGTH_2;
+	  break;
+	case LENGTH_2:
+	  length |= byte << 8;
+	  ck_a += byte;
+	  ck_b += ck_a;
+	  if( length > UBX_MAX_PAYLOAD)
+	    {
+	      state = SYNC_1;
+	      break;
+	    }
+	  position = 0;
+	  store = message_class == UBX_CLASS_NAV &&
+	      ( ( message_id == UBX_ID_PVT       && length == sizeof( uBlox_pvt)        && ( accepted & UBX_NAV_PVT_DECODED)) ||
+		( message_id == UBX_ID_RELPOSNED && length == sizeof( uBlox_relpos_NED) && ( accepted & UBX_NAV_RELPOSNED_DECODED)));
+	  state = length ? PAYLOAD : CK_A;
+	  break;
+	case PAYLOAD:
+	  {
+	    --data; // take the whole available part of the payload in one go
+	    unsigned count = length - position;
+	    if( count > (unsigned)( end - data))
+	      count = end - data;
+	    uint8_t a = ck_a, b = ck_b;
+	    for( unsigned i = 0; i < count; ++i)
+	      {
+		a += data[i];
+		b += a;
+	      }
+	    ck_a = a;
+	    ck_b = b;
+	    if( store)
+	      for( unsigned i = 0; i < count; ++i)
+		payload.bytes[position + i] = data[i];
+	    data += count;
+	    position += count;
+	    if( position == length)
+	      state = CK_A;
+	  }
+	  break;
+	case CK_A:
+	  if( byte == ck_a)
+	    state = CK_B;
+	  else
+	    {
+	      ++checksum_errors;
+	      state = byte == UBX_SYNC_1 ? SYNC_2 : SYNC_1;
+	    }
+	  break;
+	case CK_B:
+	  if( byte == ck_b)
+	    {
+	      if( store)
+		result |= decode();
+	      state = SYNC_1;
+	    }
+	  else
+	    {
+	      ++checksum_errors;
+	      state = byte == UBX_SYNC_1 ? SYNC_2 : SYNC_1;
+	    }
+	  break;
+      }
+    }
+  return result;
+}
+
+unsigned UBX_parser_t::decode( void)
+{
+  if( message_id == UBX_ID_PVT)
+    {
+      decode_PVT( payload.pvt);
+      return UBX_NAV_PVT_DECODED;
+    }
+  decode_RELPOSNED( payload.relpos);
+  return UBX_NAV_RELPOSNED_DECODED;
+}
+
+void UBX_parser_t::decode_PVT( const uBlox_pvt &pvt)
+{
+  coordinates_t &c = coordinates;
+
+  c.year   = (uint8_t)( pvt.year - 2000);
+  c.month  = pvt.month;
+  c.day    = pvt.day;
+  c.hour   = pvt.hour;
+  c.minute = pvt.minute;
+  c.second = pvt.second;
+#if INCLUDING_NANO
+  c.nano   = pvt.nano;
+#endif
+  c.SATS_number = pvt.num_SV;
+
+  bool fix = pvt.fix_type >= FIX_3d && ( pvt.fix_flags & PVT_GNSS_FIX_OK);
+  if( ! fix)
+    {
+      c.sat_fix_type = SAT_FIX_NONE;
+      return;
+    }
+  c.sat_fix_type |= SAT_FIX;
+
+  c.latitude  = pvt.latitude  * 1e-7;
+  c.longitude = pvt.longitude * 1e-7;
+
+  if( latitude_reference == 0)
+    {
+      latitude_reference = pvt.latitude;
+      longitude_reference = pvt.longitude;
+      latitude_scale = COS( pvt.latitude * 1e-7f * M_PI_F / 180.0f) * METER_PER_DEGREE_E7;
+    }
+  c.position.e[NORTH] = (float)( pvt.latitude  - latitude_reference)  * METER_PER_DEGREE_E7;
+  c.position.e[EAST]  = (float)( pvt.longitude - longitude_reference) * latitude_scale;
+  c.position.e[DOWN]  = pvt.height * -1e-3f;
+  c.geo_sep_dm = (int16_t)( ( pvt.height_ellip - pvt.height) / 100);
+
+  float3vector velocity;
+  velocity.e[NORTH] = pvt.velocity[NORTH] * 1e-3f;
+  velocity.e[EAST]  = pvt.velocity[EAST]  * 1e-3f;
+  velocity.e[DOWN]  = pvt.velocity[DOWN]  * 1e-3f;
+
+  uint32_t delta_ms = pvt.iTOW - old_iTOW;
+  if( old_iTOW != 0 && delta_ms > 0 && delta_ms <= 1000) // velocity derivative across one epoch only
+    c.acceleration = ( velocity - c.velocity) * ( 1000.0f / delta_ms);
+  old_iTOW = pvt.iTOW;
+  c.velocity = velocity;
+
+  c.heading_motion = pvt.gTrack * 1e-5f;
+  c.speed_motion   = pvt.gSpeed * 1e-3f;
+  c.speed_acc      = pvt.sAcc * 1e-3f;
+}
+
+void UBX_parser_t::decode_RELPOSNED( const uBlox_relpos_NED &relpos)
+{
+  coordinates_t &c = coordinates;
+
+  c.relPosNED.e[NORTH] = relpos.relPosN * 0.01f + relpos.relPosHP_N * 1e-4f;
+  c.relPosNED.e[EAST]  = relpos.relPosE * 0.01f + relpos.relPosHP_E * 1e-4f;
+  c.relPosNED.e[DOWN]  = relpos.relPosD * 0.01f + relpos.relPosHP_D * 1e-4f;
+
+  if( ( relpos.flags & RELPOS_HEADING_MASK) == RELPOS_HEADING_VALID)
+    {
+      c.relPosHeading = relpos.relPosheading * ( 1e-5f * M_PI_F / 180.0f);
+      c.sat_fix_type |= SAT_HEADING;
+    }
+  else
+    {
+      c.relPosHeading = 0.0f;
+      c.sat_fix_type &= ~SAT_HEADING;
+    }
+}
@@ -0,0 +1,129 @@
+/***********************************************************************//**
+ * @file		UBX_parser.h
+ * @brief		resumable uBlox UBX stream parser decoding into coordinates_t
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef UBX_PARSER_H_
+#define UBX_PARSER_H_
+
+#include "GNSS.h"
+
+//! results of UBX_parser_t::feed()
+enum UBX_message_bits
+{
+  UBX_NAV_PVT_DECODED 		= 1,
+  UBX_NAV_RELPOSNED_DECODED 	= 2
+};
+
+/**
+ * @brief UBX state machine, consumes arbitrary chunks, e.g. straight from a USART DMA ring
+ *
+ * The Fletcher checksum is accumulated while the bytes arrive.
+ * Only the payload of NAV-PVT and NAV-RELPOSNED is kept, other messages are skipped.
+ * After a valid checksum the message is decoded into coordinates_t.
+ * D-GNSS: with GNSS_F9P_F9P both messages arrive interleaved on one stream,
+ * with GNSS_F9P_F9H a second instance parses the F9H stream
+ * using the same coordinates_t and accepting NAV-RELPOSNED only.
+ */
+class UBX_parser_t
+{
+public:
+  //! @param _accepted UBX_message_bits to be decoded
+  UBX_parser_t( coordinates_t &_coordinates, unsigned _accepted = UBX_NAV_PVT_DECODED | UBX_NAV_RELPOSNED_DECODED)
+    : coordinates( _coordinates),
+      accepted( _accepted),
+      state( SYNC_1),
+      message_class( 0),
+      message_id( 0),
+      length( 0),
+      position( 0),
+      ck_a( 0),
+      ck_b( 0),
+      store( false),
+      checksum_errors( 0),
+      latitude_reference( 0),
+      longitude_reference( 0),
+      latitude_scale( 0.0f),
+      old_iTOW( 0)
+  {}
+
+  //! consume size bytes, returns UBX_message_bits of all messages completed
+  unsigned feed( const uint8_t *data, unsigned size);
+
+  //! consume the new part of a DMA ring buffer from read_index up to write_index
+  unsigned feed_ring( const uint8_t *ring, unsigned ring_size, unsigned &read_index, unsigned write_index)
+  {
+    unsigned result = 0;
+    if( write_index < read_index) // wrapped
+      {
+	result = feed( ring + read_index, ring_size - read_index);
+	read_index = 0;
+      }
+    result |= feed( ring + read_index, write_index - read_index);
+    read_index = write_index;
+    return result;
+  }
+
+  //! new origin of the NED position at the next fix
+  void reset_reference( void)
+  {
+    latitude_reference = 0;
+  }
+
+  uint32_t get_checksum_errors( void) const
+  {
+    return checksum_errors;
+  }
+
+private:
+  enum parser_state { SYNC_1, SYNC_2, CLASS, ID, LENGTH_1, LENGTH_2, PAYLOAD, CK_A, CK_B};
+
+  unsigned decode( void);
+  void decode_PVT( const uBlox_pvt &pvt);
+  void decode_RELPOSNED( const uBlox_relpos_NED &relpos);
+
+  coordinates_t &coordinates;
+  unsigned accepted;
+  parser_state state;
+  uint8_t message_class;
+  uint8_t message_id;
+  uint16_t length;
+  uint16_t position;
+  uint8_t ck_a;
+  uint8_t ck_b;
+  bool store; //!< payload of a decoded message type
+  uint32_t checksum_errors;
+
+  int32_t latitude_reference;
+  int32_t longitude_reference;
+  float latitude_scale;
+  uint32_t old_iTOW;
+
+  union
+  {
+    uBlox_pvt pvt;
+    uBlox_relpos_NED relpos;
+    uint8_t bytes[sizeof( uBlox_pvt)];
+  } payload;
+};
+
+#endif /* UBX_PARSER_H_ */
@@ -0,0 +1,95 @@
+/***********************************************************************//**
+ * @file		activity_detector.h
+ * @brief		ground and idle detection for the reduced rate mode
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef ACTIVITY_DETECTOR_H_
+#define ACTIVITY_DETECTOR_H_
+
+#include "embedded_math.h"
+#include "NAV_tuning_parameters.h"
+
+/**
+ * @brief decides if the sensor is resting on the ground
+ *
+ * Idle after IDLE_DETECTION_TIME of low TAS, low turn rate and low G-load variance.
+ * Any violation ends the idle state at once. GNSS speed is not an idle criterion
+ * as the glider might be on its trailer, high GNSS speed only wakes up if the pitot fails.
+ * To be called @ 10 Hz.
+ */
+class activity_detector_t
+{
+public:
+  activity_detector_t( void)
+    : G_load_mean( GRAVITY),
+      G_load_variance( ZERO),
+      quiet_counter( 0),
+      idle( false)
+  {}
+
+  //! returns true if the idle state has changed
+  bool update( float TAS, float GNSS_speed, float G_load, float turn_rate)
+  {
+    float deviation = G_load - G_load_mean;
+    G_load_mean += G_VARIANCE_ALPHA * deviation;
+    G_load_variance += G_VARIANCE_ALPHA * ( deviation * deviation - G_load_variance);
+
+    bool moving = turn_rate > IDLE_MAXIMUM_TURN_RATE || turn_rate < - IDLE_MAXIMUM_TURN_RATE
+	|| G_load_variance > IDLE_MAXIMUM_G_VARIANCE
+	|| GNSS_speed > IDLE_WAKEUP_GNSS_SPEED;
+
+    // TAS hysteresis: enter idle below IDLE_MAXIMUM_TAS, leave above IDLE_WAKEUP_TAS
+    bool active = moving || TAS > ( idle ? IDLE_WAKEUP_TAS : IDLE_MAXIMUM_TAS);
+
+    bool was_idle = idle;
+    if( active)
+      {
+	quiet_counter = 0;
+	idle = false;
+      }
+    else if( quiet_counter < IDLE_DETECTION_TIME)
+      ++quiet_counter;
+    else
+      idle = true;
+
+    return idle != was_idle;
+  }
+
+  bool is_idle( void) const
+  {
+    return idle;
+  }
+
+  float get_G_load_variance( void) const
+  {
+    return G_load_variance;
+  }
+
+private:
+  static constexpr float G_VARIANCE_ALPHA = 0.05f; //!< 2 s time constant @ 10 Hz
+  float G_load_mean;
+  float G_load_variance;
+  unsigned quiet_counter;
+  bool idle;
+};
+
+#endif /* ACTIVITY_DETECTOR_H_ */
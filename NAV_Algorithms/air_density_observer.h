@@ -26,22 +26,34 @@
 #define AIR_DENSITY_OBSERVER_H_
 
 #include "Linear_Least_Square_Fit.h"
+#include "recursive_least_square_fit.h"
 #include "trigger.h"
+#include "NAV_tuning_parameters.h"
 
 #define DENSITY_MEASURMENT_COLLECTS_INTEGER 1
+#if FLOAT_STATISTICS
+typedef float evaluation_type;
+#else
 typedef double evaluation_type;
 typedef uint64_t measurement_type;
+#endif
 
 #define MAX_ALLOWED_VARIANCE	1e-9
 #define MINIMUM_ALTITUDE_RANGE	300.0f
 #define ALTITUDE_TRIGGER_HYSTERESIS 50.0f
 
+#define DENSITY_RLS_FORGETTING_FACTOR	0.9998f	//!< @ 10 Hz: effective window 500 s
+#define DENSITY_RLS_MAX_SLOPE_VARIANCE	1e-5f	//!< (Pa/m)^2, as MAX_ALLOWED_VARIANCE for the slope in Pa/cm
+#define DENSITY_RLS_MINIMUM_COUNT	600	//!< 1 minute before the first result
+
 //! this class maintains offset and slope of the air density measurement
 class air_data_result
 {
 public:
   air_data_result( void)
-    : valid( false)
+    : density_correction( 1.0f),
+      QFF( 0.0f),
+      valid( false)
   {}
   float density_correction;
   float QFF;
@@ -67,10 +79,116 @@ public:
 private:
 
   //    linear_least_square_fit<int64_t,evaluation_float_type> density_QFF_calculator;
+#if FLOAT_STATISTICS
+    linear_least_square_fit_welford< evaluation_type> density_QFF_calculator;
+#else
     linear_least_square_fit< measurement_type, evaluation_type> density_QFF_calculator;
+#endif
     float min_altitude;
     float max_altitude;
     trigger altitude_trigger;
 };
 
+//! ISA pressure altitude / m, T / 288.15 K = ( p / 101325 Pa) ^ ( R * 0.0065 / g)
+inline float ISA_pressure_altitude( float pressure)
+{
+  return 44330.77f * ( 1.0f - powf( pressure * ( 1.0f / 101325.0f), 0.190263f));
+}
+
+//! inverse of ISA_pressure_altitude()
+inline float ISA_pressure( float pressure_altitude)
+{
+  return 101325.0f * powf( 1.0f - pressure_altitude * ( 1.0f / 44330.77f), 5.25588f);
+}
+
+//! ISA air density / kg/m^3 at the given pressure
+inline float ISA_density( float pressure)
+{
+  return pressure / ( 287.058f * 288.15f * powf( pressure * ( 1.0f / 101325.0f), 0.190263f));
+}
+
+/**
+ * @brief continuous air density and QFF measurement
+ *
+ * Recursive float fit of the ISA pressure altitude over the MSL altitude
+ * with exponential forgetting, constant cost per sample.
+ * The slope is the ratio of the air density to the ISA density at the same pressure.
+ * Unlike pressure, the pressure altitude is linear in the altitude for any atmosphere
+ * with a standard lapse rate: a plain pressure fit is curved and the exponential
+ * window weighs the older, higher part of a descent more, that skew
+ * biased the density by 2 % on a 2700 m descent.
+ * Altitudes are taken relative to the first sample to keep the float fit well conditioned.
+ * A result is reported every sample as soon as the slope variance is small enough,
+ * so the density is available early and is tracked during long glides.
+ * Same interface as air_density_observer.
+ */
+class air_density_observer_recursive
+{
+public:
+  air_density_observer_recursive (void)
+  : density_QFF_calculator( DENSITY_RLS_FORGETTING_FACTOR),
+    reference_altitude( 0.0f),
+    reference_pressure_altitude( 0.0f),
+    mean_pressure( 0.0f),
+    have_reference( false)
+  {
+    density_QFF_calculator.limit_slope_covariance();
+  }
+
+  air_data_result feed_metering( float pressure, float MSL_altitude)
+  {
+    air_data_result air_data;
+    float pressure_altitude = ISA_pressure_altitude( pressure);
+
+    if( ! have_reference)
+      {
+	mean_pressure = pressure;
+	reference_pressure_altitude = pressure_altitude;
+	density_QFF_calculator.reset( 0.0f, 1.0f); // start with standard atmosphere
+	have_reference = true;
+      }
+
+    density_QFF_calculator.add_value( MSL_altitude - reference_altitude, pressure_altitude - reference_pressure_altitude);
+    mean_pressure += ( 1.0f - DENSITY_RLS_FORGETTING_FACTOR) * ( pressure - mean_pressure);
+
+    if( density_QFF_calculator.get_count() < DENSITY_RLS_MINIMUM_COUNT)
+      return air_data;
+
+    linear_least_square_result<float> result;
+    density_QFF_calculator.evaluate( result);
+
+    float density_at_mean_pressure = ISA_density( mean_pressure);
+    if( result.variance_slope * SQR( density_at_mean_pressure * GRAVITY) < DENSITY_RLS_MAX_SLOPE_VARIANCE)
+      {
+	// extrapolate to MSL altitude = 0
+	air_data.QFF = ISA_pressure( reference_pressure_altitude + result.y_offset - result.slope * reference_altitude);
+	float density = result.slope * density_at_mean_pressure;
+	float std_density = 1.0496346613e-5f * mean_pressure + 0.1671546011f;
+	air_data.density_correction = density / std_density;
+	air_data.valid = true;
+      }
+    return air_data;
+  }
+
+  void initialize( float altitude)
+  {
+    reference_altitude = altitude;
+    have_reference = false;
+  }
+
+  //! slope variance of the present fit, converted to pressure over altitude / (Pa/m)^2
+  float get_slope_variance( void) const
+  {
+    linear_least_square_result<float> result;
+    density_QFF_calculator.evaluate( result);
+    return result.variance_slope * SQR( ISA_density( mean_pressure) * GRAVITY);
+  }
+private:
+  recursive_linear_fit_t<float> density_QFF_calculator;
+  float reference_altitude;
+  float reference_pressure_altitude;
+  float mean_pressure; //!< exponential average with the fit window
+  bool have_reference;
+};
+
 #endif /* AIR_DENSITY_OBSERVER_H_ */
@@ -22,38 +22,29 @@ static ROM struct
 	float a[2] = { 239.15f, 299.15f };
 } PWS;
 
-/*! Routines for exponentiation */
-#define POT_2(x)		((x)*(x))
-#define POT_3(x)		((x)*(x)*(x))
-#define POT_4(x)		((x)*(x)*(x)*(x))
-#define POT_5(x)		((x)*(x)*(x)*(x)*(x))
-
 /**
  * Calculate the saturation vapor pressure as a function of temperature
  *
- * @param temperature Temperature in degree celsius.
+ * @param temperature Temperature in Kelvin.
  *
  * @return the saturation vapor pressure in Pa.
  */
 float atmosphere_t::calculateSaturationVaporPressure(float temp)
 {
+	unsigned range;
 	if (PWS.range1Begin <= temp && temp < PWS.range2Begin)
-	  {
-		return (PWS.s[0][0] + PWS.s[0][1] * ((temp - PWS.a[0]))
-				+ PWS.s[0][2] * POT_2((temp - PWS.a[0]))
-				+ PWS.s[0][3] * POT_3((temp - PWS.a[0]))
-				+ PWS.s[0][4] * POT_4((temp - PWS.a[0]))
-				+ PWS.s[0][5] * POT_5((temp - PWS.a[0])));
-	  }
+	  range = 0;
 	else if (PWS.range2Begin <= temp && temp <= PWS.rangeEnd)
-	  {
-		return (PWS.s[1][0] + PWS.s[1][1] * ((temp - PWS.a[1]))
-				+ PWS.s[1][2] * POT_2((temp - PWS.a[1]))
-				+ PWS.s[1][3] * POT_3((temp - PWS.a[1]))
-				+ PWS.s[1][4] * POT_4((temp - PWS.a[1]))
-				+ PWS.s[1][5] * POT_5((temp - PWS.a[1])));
-	  }
-	return 0.0f;
+	  range = 1;
+	else
+	  return 0.0f;
+
+	// Horner scheme
+	float x = temp - PWS.a[range];
+	float result = PWS.s[range][5];
+	for( int i = 4; i >= 0; --i)
+	  result = result * x + PWS.s[range][i];
+	return result;
 }
 
 /**
@@ -97,3 +88,45 @@ float atmosphere_t::calculateAirDensity(
 	float gasConst = calculateGasConstantHumAir(humidity, pressure, abs_temp);
 	return pressure / gasConst / temperature;
 }
+
+//! polynomial fits or ISA table, evaluated once per new pressure value
+void atmosphere_t::update_pressure_cache( void)
+{
+#if ISA_TEMPERATURE_MODEL
+  float position = ( pressure - ISA_TABLE_MIN_PRESSURE) * ( 1.0f / ISA_TABLE_PRESSURE_STEP);
+  if( ! ( position > 0.0f)) // NAN included
+    position = 0.0f;
+  else if( position > (float)( ISA_TABLE_SIZE - 1))
+    position = (float)( ISA_TABLE_SIZE - 1);
+  unsigned index = (unsigned)position;
+  if( index > ISA_TABLE_SIZE - 2)
+    index = ISA_TABLE_SIZE - 2;
+  float fraction = position - (float)index;
+
+  negative_altitude = ISA_TABLE.negative_altitude[index]
+     + fraction * ( ISA_TABLE.negative_altitude[index + 1] - ISA_TABLE.negative_altitude[index]);
+
+  if( have_ambient_air_data)
+    density_at_pressure = ( pressure - vapor_pressure_term) * recip_gas_constant_times_temperature;
+  else
+    density_at_pressure = ISA_TABLE.density[index]
+       + fraction * ( ISA_TABLE.density[index + 1] - ISA_TABLE.density[index]);
+#else
+  float tmp = 8.104381531e-4f * pressure;
+  negative_altitude = - tmp * tmp  + 0.20867299170f * pressure - 14421.43945f;
+  density_at_pressure = 1.0496346613e-5f * pressure + 0.1671546011f;
+#endif
+}
+
+#if ISA_TEMPERATURE_MODEL
+/**
+ * Prepare the humid air density for the pressure path:
+ * rho = p / ( R_humid * T) = ( p - phi * p_sat * ( 1 - R_dry / R_vapor)) / ( R_dry * T)
+ */
+void atmosphere_t::update_ambient_cache( void)
+{
+  float abs_temp = CELSIUS_TO_KELVIN_OFFSET + temperature;
+  vapor_pressure_term = humidity * calculateSaturationVaporPressure( abs_temp) * ONE_MINUS_RATIO_GAS_CONSTANTS;
+  recip_gas_constant_times_temperature = 1.0f / ( GAS_CONST_DRY_AIR * abs_temp);
+}
+#endif
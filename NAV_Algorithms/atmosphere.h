@@ -29,6 +29,11 @@
 #include "embedded_math.h"
 #include <air_density_observer.h>
 #include <pt2.h>
+#include "event_trace.h"
+#include "NAV_tuning_parameters.h"
+#if ISA_TEMPERATURE_MODEL
+#include "constexpr_math.h"
+#endif
 
 #define RECIP_STD_DENSITY_TIMES_2 1.632f
 
@@ -41,6 +46,35 @@
 /*! The offest for the conversion from degree celsius to kelvin */
 #define CELSIUS_TO_KELVIN_OFFSET 273.15f
 
+#if ISA_TEMPERATURE_MODEL
+
+//! ISA troposphere at equidistant pressure values, starting at ISA_TABLE_MIN_PRESSURE
+class ISA_table_t
+{
+public:
+  float negative_altitude[ISA_TABLE_SIZE];
+  float density[ISA_TABLE_SIZE];
+};
+
+//! T = 288.15 K - 0.0065 K/m * altitude, T / 288.15 K = ( p / 101325 Pa) ^ ( R * 0.0065 / g)
+constexpr ISA_table_t design_ISA_table( void)
+{
+  ISA_table_t result = {};
+  for( unsigned k = 0; k < ISA_TABLE_SIZE; ++k)
+    {
+      double pressure = ISA_TABLE_MIN_PRESSURE + k * ISA_TABLE_PRESSURE_STEP;
+      double temperature_ratio = constexpr_pow( pressure / 101325.0, 287.058 * 0.0065 / 9.80665);
+      result.negative_altitude[k] = (float)( - 288.15 / 0.0065 * ( 1.0 - temperature_ratio));
+      result.density[k] = (float)( pressure / ( 287.058 * 288.15 * temperature_ratio));
+    }
+  return result;
+}
+
+//! ROM table, computed at compile time
+constexpr ISA_table_t ISA_TABLE = design_ISA_table();
+
+#endif
+
 //! this class maintains instant atmosphere data like pressure, density etc
 class atmosphere_t
 {
@@ -49,13 +83,20 @@ public:
   :
     have_ambient_air_data(false),
     pressure ( p_abs),
+    negative_altitude( 0.0f),
+    density_at_pressure( 0.0f),
     temperature(20.0f),
     humidity( 0.0f),
     density_correction(1.0f),
     density_correction_averager(0.001f),
     QFF(101325)
+#if ISA_TEMPERATURE_MODEL
+    , vapor_pressure_term( 0.0f),
+    recip_gas_constant_times_temperature( 0.0f)
+#endif
   {
     density_correction_averager.settle(1.0f);
+    update_pressure_cache();
   }
   void update_density_correction( void)
   {
@@ -65,9 +106,13 @@ public:
   {
     density_QFF_calculator.initialize(altitude);
   }
+  //! the pressure-dependent values are computed here and only if the pressure has changed
   void set_pressure( float p_abs)
   {
+    if( p_abs == pressure)
+      return;
     pressure = p_abs;
+    update_pressure_cache();
   }
   float get_pressure( void) const
   {
@@ -75,12 +120,15 @@ public:
   }
   float get_density( void) const
   {
-    return  (1.0496346613e-5f * pressure + 0.1671546011f) * density_correction_averager.get_output();
+#if ISA_TEMPERATURE_MODEL
+    if( have_ambient_air_data)
+      return density_at_pressure; // measured temperature, no correction
+#endif
+    return density_at_pressure * density_correction_averager.get_output();
   }
   float get_negative_altitude( void) const
   {
-    float tmp = 8.104381531e-4f * pressure;
-    return - tmp * tmp  + 0.20867299170f * pressure - 14421.43945f;
+    return negative_altitude;
   }
   float get_TAS_from_dynamic_pressure( float dynamic_pressure) const
   {
@@ -95,10 +143,17 @@ public:
     this->temperature = temperature;
     this->humidity = humidity;
     have_ambient_air_data = true;
+#if ISA_TEMPERATURE_MODEL
+    update_ambient_cache();
+    update_pressure_cache();
+#endif
   }
   void disregard_ambient_air_data( void)
   {
     have_ambient_air_data = false;
+#if ISA_TEMPERATURE_MODEL
+    update_pressure_cache();
+#endif
   }
 
   float get_QFF () const
@@ -113,10 +168,15 @@ public:
 	{
 	  QFF = result.QFF;
 	  density_correction = result.density_correction;
+	  TRACE_EVENT( TRACE_AIR_DENSITY, trace_float( QFF), trace_float( density_correction));
 	}
     }
 
 private:
+  void update_pressure_cache( void);
+#if ISA_TEMPERATURE_MODEL
+  void update_ambient_cache( void);
+#endif
   float calculateGasConstantHumAir(
       float humidity, float pressure, float temperature);
   float calculateAirDensity(
@@ -124,12 +184,79 @@ private:
   float calculateSaturationVaporPressure(float temp);
   bool have_ambient_air_data;
   float pressure;
+  float negative_altitude;	//!< cached for pressure
+  float density_at_pressure;	//!< cached for pressure, without density correction
   float temperature;
   float humidity;
   float density_correction;
   pt2<float,float> density_correction_averager;
   float QFF;
+#if ISA_TEMPERATURE_MODEL
+  float vapor_pressure_term; //!< Pa, relative humidity * saturation vapor pressure * ( 1 - R_dry / R_vapor)
+  float recip_gas_constant_times_temperature; //!< 1 / ( R_dry * T)
+#endif
+#if RECURSIVE_DENSITY_OBSERVER
+  air_density_observer_recursive density_QFF_calculator;
+#else
   air_density_observer density_QFF_calculator;
+#endif
+
+public:
+  //! dynamic state for checkpoints, the density observer has no parameters of its own and is kept as a whole
+  class state_t
+  {
+  public:
+    bool have_ambient_air_data;
+    float pressure;
+    float negative_altitude;
+    float density_at_pressure;
+    float temperature;
+    float humidity;
+    float density_correction;
+    pt2<float,float>::state_t density_correction_averager;
+    float QFF;
+#if ISA_TEMPERATURE_MODEL
+    float vapor_pressure_term;
+    float recip_gas_constant_times_temperature;
+#endif
+    decltype( atmosphere_t::density_QFF_calculator) density_QFF_calculator;
+  };
+
+  void save_state( state_t &state) const
+  {
+    state.have_ambient_air_data = have_ambient_air_data;
+    state.pressure = pressure;
+    state.negative_altitude = negative_altitude;
+    state.density_at_pressure = density_at_pressure;
+    state.temperature = temperature;
+    state.humidity = humidity;
+    state.density_correction = density_correction;
+    density_correction_averager.save_state( state.density_correction_averager);
+    state.QFF = QFF;
+#if ISA_TEMPERATURE_MODEL
+    state.vapor_pressure_term = vapor_pressure_term;
+    state.recip_gas_constant_times_temperature = recip_gas_constant_times_temperature;
+#endif
+    state.density_QFF_calculator = density_QFF_calculator;
+  }
+
+  void restore_state( const state_t &state)
+  {
+    have_ambient_air_data = state.have_ambient_air_data;
+    pressure = state.pressure;
+    negative_altitude = state.negative_altitude;
+    density_at_pressure = state.density_at_pressure;
+    temperature = state.temperature;
+    humidity = state.humidity;
+    density_correction = state.density_correction;
+    density_correction_averager.restore_state( state.density_correction_averager);
+    QFF = state.QFF;
+#if ISA_TEMPERATURE_MODEL
+    vapor_pressure_term = state.vapor_pressure_term;
+    recip_gas_constant_times_temperature = state.recip_gas_constant_times_temperature;
+#endif
+    density_QFF_calculator = state.density_QFF_calculator;
+  }
 };
 
 #endif /* APPLICATION_ATMOSPHERE_H_ */
@@ -0,0 +1,84 @@
+/***********************************************************************//**
+ * @file		checkpoint.h
+ * @brief		state checkpoint for warm restart and replay seek
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <stdint.h>
+#include <type_traits>
+#include "crc16.h"
+
+#define CHECKPOINT_MAGIC	0x50434c4cUL 	//!< "LLCP"
+
+#ifndef CHECKPOINT_CAPACITY
+#define CHECKPOINT_CAPACITY	4096		//!< STM32F4 backup SRAM
+#endif
+
+class checkpoint_header_t
+{
+public:
+  uint32_t magic;
+  uint16_t layout;	//!< state layout version of the writer
+  uint16_t crc;		//!< CRC16 over the state record
+  uint32_t size;	//!< size of the state record
+};
+
+/**
+ * @brief dynamic algorithm state, to be placed in backup SRAM or kept in RAM
+ *
+ * The state record is a plain copy of the filter states, collected by the
+ * save_state() methods of the algorithm classes. Coefficients, gain tables
+ * and configuration references are not part of it, they are set up by the
+ * constructor of the object the checkpoint is restored into.
+ * The layout version must be incremented with every change of a state record.
+ */
+template <class state_type> class checkpoint_t
+{
+  static_assert( std::is_trivially_copyable<state_type>::value, "checkpoint state must be a plain record");
+public:
+  checkpoint_header_t header;
+  state_type state;
+};
+
+//! complete the header after the state record has been written
+template <class state_type>
+void seal_checkpoint( checkpoint_t<state_type> &checkpoint, uint16_t layout)
+{
+  checkpoint.header.magic = CHECKPOINT_MAGIC;
+  checkpoint.header.layout = layout;
+  checkpoint.header.size = sizeof( state_type);
+  checkpoint.header.crc = crc16( (const uint8_t *)&checkpoint.state, sizeof( state_type));
+}
+
+//! returns true if the checkpoint is not acceptable
+template <class state_type>
+bool check_checkpoint( const checkpoint_t<state_type> &checkpoint, uint16_t layout)
+{
+  const checkpoint_header_t &h = checkpoint.header;
+  if( h.magic != CHECKPOINT_MAGIC || h.layout != layout || h.size != sizeof( state_type))
+    return true;
+  return h.crc != crc16( (const uint8_t *)&checkpoint.state, sizeof( state_type));
+}
+
+#endif /* CHECKPOINT_H_ */
@@ -0,0 +1,183 @@
+/***********************************************************************//**
+ * @file		circle_wind_fit.h
+ * @brief		early wind from a circle fit of the GNSS ground velocity
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef CIRCLE_WIND_FIT_H_
+#define CIRCLE_WIND_FIT_H_
+
+#include <AHRS.h>
+#include "embedded_math.h"
+#include "NAV_tuning_parameters.h"
+
+/**
+ * @brief algebraic (Kasa) circle fit of the horizontal ground velocity while circling
+ *
+ * At constant air speed the ground velocity moves on a circle around the wind vector.
+ * x^2 + y^2 = A x + B y + C is a linear least square problem,
+ * the sums are updated in O(1) and the 3 * 3 normal equations are solved on request.
+ * Velocities are taken relative to a reference (the wind before circling)
+ * to keep the float sums well conditioned.
+ * A result is available after CIRCLE_FIT_MINIMUM_TURN, long before all sectors
+ * of the boxcar average have been filled.
+ */
+class circle_wind_fit_t
+{
+public:
+  circle_wind_fit_t( void)
+  {
+    reset( float3vector(), ZERO);
+  }
+
+  void reset( const float3vector &reference_wind, float heading)
+  {
+    reference_N = reference_wind.e[NORTH];
+    reference_E = reference_wind.e[EAST];
+    last_heading = heading;
+    turn = ZERO;
+    Sx = Sy = Sxx = Sxy = Syy = Sz = Sxz = Syz = Szz = ZERO;
+    n = 0;
+    valid = false;
+  }
+
+  //! feed ground velocity and heading in radians, @ 10 Hz
+  void update( const float3vector &ground_velocity, float heading)
+  {
+    float heading_change = heading - last_heading;
+    if( heading_change > M_PI_F)
+      heading_change -= 2.0f * M_PI_F;
+    else if( heading_change < -M_PI_F)
+      heading_change += 2.0f * M_PI_F;
+    turn += heading_change >= ZERO ? heading_change : -heading_change;
+    last_heading = heading;
+
+    float x = ground_velocity.e[NORTH] - reference_N;
+    float y = ground_velocity.e[EAST]  - reference_E;
+    float z = x * x + y * y;
+    Sx  += x;
+    Sy  += y;
+    Sxx += x * x;
+    Sxy += x * y;
+    Syy += y * y;
+    Sz  += z;
+    Sxz += x * z;
+    Syz += y * z;
+    Szz += z * z;
+    ++n;
+
+    if( turn >= CIRCLE_FIT_MINIMUM_TURN)
+      evaluate();
+  }
+
+  //! true if a plausible circle has been fitted
+  bool is_valid( void) const
+  {
+    return valid;
+  }
+
+  //! wind = circle center, DOWN component zero
+  float3vector get_wind( void) const
+  {
+    float3vector wind;
+    wind.e[NORTH] = center_N;
+    wind.e[EAST]  = center_E;
+    wind.e[DOWN]  = ZERO;
+    return wind;
+  }
+
+  //! circle radius = horizontal air speed / (m/s)
+  float get_radius( void) const
+  {
+    return radius;
+  }
+
+  //! RMS radial velocity error / (m/s), confidence measure
+  float get_residual( void) const
+  {
+    return residual;
+  }
+
+  //! accumulated turn since reset / rad
+  float get_turn( void) const
+  {
+    return turn;
+  }
+
+private:
+  void evaluate( void)
+  {
+    // normal equations M * { A, B, C} = r, solved by Cramer's rule
+    float N = (float)n;
+    float c00 = Syy * N   - Sy * Sy;
+    float c01 = Sy  * Sx  - Sxy * N;
+    float c02 = Sxy * Sy  - Syy * Sx;
+    float c11 = Sxx * N   - Sx * Sx;
+    float c12 = Sxy * Sx  - Sxx * Sy;
+    float c22 = Sxx * Syy - Sxy * Sxy;
+    float determinant = Sxx * c00 + Sxy * c01 + Sx * c02;
+    if( determinant <= ZERO)
+      {
+	valid = false;
+	return;
+      }
+    float inv_det = ONE / determinant;
+    float A = ( c00 * Sxz + c01 * Syz + c02 * Sz) * inv_det;
+    float B = ( c01 * Sxz + c11 * Syz + c12 * Sz) * inv_det;
+    float C = ( c02 * Sxz + c12 * Syz + c22 * Sz) * inv_det;
+
+    float cx = 0.5f * A;
+    float cy = 0.5f * B;
+    float r_square = C + cx * cx + cy * cy;
+    if( r_square < SQR( CIRCLE_FIT_MINIMUM_RADIUS))
+      {
+	valid = false;
+	return;
+      }
+
+    // sum of squared algebraic residuals z - A x - B y - C, expanded
+    float square_sum = Szz
+	+ A * A * Sxx + B * B * Syy + C * C * N
+	- 2.0f * ( A * Sxz + B * Syz + C * Sz)
+	+ 2.0f * ( A * B * Sxy + A * C * Sx + B * C * Sy);
+    if( square_sum < ZERO) // rounding
+      square_sum = ZERO;
+
+    radius = SQRT( r_square);
+    // algebraic residual = ( r + d)^2 - r^2 ~ 2 r d
+    residual = SQRT( square_sum / N) / ( 2.0f * radius);
+    center_N = reference_N + cx;
+    center_E = reference_E + cy;
+    valid = residual < CIRCLE_FIT_MAXIMUM_RESIDUAL;
+  }
+
+  float reference_N, reference_E;
+  float last_heading;
+  float turn;
+  float Sx, Sy, Sxx, Sxy, Syy, Sz, Sxz, Syz, Szz;
+  unsigned n;
+  float center_N, center_E;
+  float radius;
+  float residual;
+  bool valid;
+};
+
+#endif /* CIRCLE_WIND_FIT_H_ */
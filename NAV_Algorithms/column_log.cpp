@@ -0,0 +1,390 @@
+/***********************************************************************//**
+ * @file		column_log.cpp
+ * @brief		columnar flight log with delta + varint compression
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "embedded_memory.h"
+#include "column_log.h"
+#include "varint.h"
+
+#define LOG_CHANNEL_ENTRY( member, type) { #member, offsetof( observations_type, member), type },
+
+static ROM log_channel_t OBSERVATION_CHANNELS[] =
+  {
+    LOG_OBSERVATION_CHANNELS( LOG_CHANNEL_ENTRY)
+  };
+
+ROM log_schema_t OBSERVATIONS_LOG_SCHEMA =
+  {
+    OBSERVATION_CHANNELS,
+    sizeof( OBSERVATION_CHANNELS) / sizeof( log_channel_t),
+    sizeof( observations_type)
+  };
+
+#define OUTPUT_CHANNEL_ENTRY( member, type) { #member, offsetof( output_data_t, member), type },
+
+static ROM log_channel_t OUTPUT_CHANNELS[] =
+  {
+    LOG_OUTPUT_CHANNELS( OUTPUT_CHANNEL_ENTRY)
+  };
+
+ROM log_schema_t OUTPUT_LOG_SCHEMA =
+  {
+    OUTPUT_CHANNELS,
+    sizeof( OUTPUT_CHANNELS) / sizeof( log_channel_t),
+    sizeof( output_data_t)
+  };
+
+static ROM char LOG_MAGIC[8] = { 'L', 'A', 'R', 'U', 'S', 'L', 'O', 'G'};
+
+#define BLOCK_HEADER_SIZE 12
+
+// order-preserving integer keys, small value changes give small deltas
+
+inline uint32_t to_key( float value)
+{
+  uint32_t bits;
+  memcpy( &bits, &value, sizeof( bits));
+  return ( bits & 0x80000000u) ? ~bits : ( bits | 0x80000000u);
+}
+
+inline uint64_t to_key( double value)
+{
+  uint64_t bits;
+  memcpy( &bits, &value, sizeof( bits));
+  return ( bits & 0x8000000000000000ull) ? ~bits : ( bits | 0x8000000000000000ull);
+}
+
+inline uint32_t to_key( uint8_t value)  { return value;}
+inline uint32_t to_key( int16_t value)  { return (uint32_t)(int32_t)value;}
+inline uint32_t to_key( uint16_t value) { return value;}
+inline uint32_t to_key( int32_t value)  { return (uint32_t)value;}
+inline uint32_t to_key( uint32_t value) { return value;}
+
+inline void from_key( uint32_t key, float &value)
+{
+  uint32_t bits = ( key & 0x80000000u) ? ( key & 0x7fffffffu) : ~key;
+  memcpy( &value, &bits, sizeof( value));
+}
+
+inline void from_key( uint64_t key, double &value)
+{
+  uint64_t bits = ( key & 0x8000000000000000ull) ? ( key & 0x7fffffffffffffffull) : ~key;
+  memcpy( &value, &bits, sizeof( value));
+}
+
+inline void from_key( uint32_t key, uint8_t &value)  { value = (uint8_t)key;}
+inline void from_key( uint32_t key, int16_t &value)  { value = (int16_t)key;}
+inline void from_key( uint32_t key, uint16_t &value) { value = (uint16_t)key;}
+inline void from_key( uint32_t key, int32_t &value)  { value = (int32_t)key;}
+inline void from_key( uint32_t key, uint32_t &value) { value = key;}
+
+inline uint32_t zigzag_delta( uint32_t delta) { return zigzag_encode( (int32_t)delta);}
+inline uint64_t zigzag_delta( uint64_t delta) { return zigzag_encode( (int64_t)delta);}
+inline uint32_t inverse_zigzag( uint32_t code) { return (uint32_t)zigzag_decode( code);}
+inline uint64_t inverse_zigzag( uint64_t code) { return (uint64_t)zigzag_decode( code);}
+
+template <class value_type>
+static uint8_t * encode_column( const uint8_t *source, unsigned record_size, unsigned count, uint8_t *target)
+{
+  decltype( to_key( value_type())) previous = 0;
+  for( unsigned i = 0; i < count; ++i, source += record_size)
+    {
+      value_type value;
+      memcpy( &value, source, sizeof( value));
+      decltype( previous) key = to_key( value);
+      target = varint_encode( target, zigzag_delta( key - previous));
+      previous = key;
+    }
+  return target;
+}
+
+static void put_u16( uint8_t *target, uint16_t value)
+{
+  target[0] = (uint8_t)value;
+  target[1] = (uint8_t)( value >> 8);
+}
+
+static void put_u32( uint8_t *target, uint32_t value)
+{
+  put_u16( target, (uint16_t)value);
+  put_u16( target + 2, (uint16_t)( value >> 16));
+}
+
+static unsigned max_value_size( uint8_t type)
+{
+  return type == LOG_DOUBLE ? VARINT_MAX_SIZE_64 : VARINT_MAX_SIZE_32;
+}
+
+unsigned write_column_log_header( const log_schema_t &schema, unsigned block_records, uint8_t *target, unsigned capacity)
+{
+  unsigned size = sizeof( LOG_MAGIC) + 8;
+  for( unsigned i = 0; i < schema.channel_count; ++i)
+    size += 4 + strlen( schema.channels[i].name);
+  if( size > capacity)
+    return 0;
+
+  memcpy( target, LOG_MAGIC, sizeof( LOG_MAGIC));
+  uint8_t *p = target + sizeof( LOG_MAGIC);
+  put_u16( p, COLUMN_LOG_VERSION);
+  put_u16( p + 2, schema.channel_count);
+  put_u16( p + 4, schema.record_size);
+  put_u16( p + 6, (uint16_t)block_records);
+  p += 8;
+  for( unsigned i = 0; i < schema.channel_count; ++i)
+    {
+      const log_channel_t &channel = schema.channels[i];
+      unsigned length = strlen( channel.name);
+      p[0] = channel.type;
+      put_u16( p + 1, channel.offset);
+      p[3] = (uint8_t)length;
+      memcpy( p + 4, channel.name, length);
+      p += 4 + length;
+    }
+  return size;
+}
+
+unsigned column_log_block_capacity( const log_schema_t &schema, unsigned record_count)
+{
+  unsigned size = BLOCK_HEADER_SIZE + 4 * schema.channel_count;
+  for( unsigned i = 0; i < schema.channel_count; ++i)
+    size += record_count * max_value_size( schema.channels[i].type);
+  return size;
+}
+
+unsigned encode_column_log_block( const log_schema_t &schema, const uint8_t *records, unsigned record_count, uint8_t *target, unsigned capacity)
+{
+  unsigned header_size = BLOCK_HEADER_SIZE + 4 * schema.channel_count;
+  if( capacity < header_size)
+    return 0;
+  const uint8_t *limit = target + capacity;
+  uint8_t *p = target + header_size;
+
+  for( unsigned i = 0; i < schema.channel_count; ++i)
+    {
+      const log_channel_t &channel = schema.channels[i];
+      if( (unsigned)( limit - p) < record_count * max_value_size( channel.type))
+	return 0;
+
+      put_u32( target + BLOCK_HEADER_SIZE + 4 * i, p - target);
+      const uint8_t *source = records + channel.offset;
+      switch( channel.type)
+      {
+	case LOG_FLOAT:
+	  p = encode_column<float>( source, schema.record_size, record_count, p);
+	  break;
+	case LOG_DOUBLE:
+	  p = encode_column<double>( source, schema.record_size, record_count, p);
+	  break;
+	case LOG_UINT8:
+	  p = encode_column<uint8_t>( source, schema.record_size, record_count, p);
+	  break;
+	case LOG_INT16:
+	  p = encode_column<int16_t>( source, schema.record_size, record_count, p);
+	  break;
+	case LOG_UINT16:
+	  p = encode_column<uint16_t>( source, schema.record_size, record_count, p);
+	  break;
+	case LOG_INT32:
+	  p = encode_column<int32_t>( source, schema.record_size, record_count, p);
+	  break;
+	default:
+	  p = encode_column<uint32_t>( source, schema.record_size, record_count, p);
+	  break;
+      }
+    }
+
+  put_u32( target, COLUMN_LOG_BLOCK_MAGIC);
+  put_u32( target + 4, p - target);
+  put_u16( target + 8, (uint16_t)record_count);
+  put_u16( target + 10, schema.channel_count);
+  return p - target;
+}
+
+#if UNIX == 1
+
+static uint16_t get_u16( const uint8_t *source)
+{
+  return (uint16_t)( source[0] | ( source[1] << 8));
+}
+
+static uint32_t get_u32( const uint8_t *source)
+{
+  return get_u16( source) | ( (uint32_t)get_u16( source + 2) << 16);
+}
+
+template <class value_type>
+static bool decode_values( const uint8_t *source, const uint8_t *end, unsigned count, uint8_t *target, size_t stride)
+{
+  decltype( to_key( value_type())) key = 0;
+  for( unsigned i = 0; i < count; ++i, target += stride)
+    {
+      decltype( key) code;
+      if( varint_decode( source, end, code))
+	return true;
+      key += inverse_zigzag( code);
+      value_type value;
+      from_key( key, value);
+      memcpy( target, &value, sizeof( value));
+    }
+  return false;
+}
+
+bool column_log_reader_t::open( const uint8_t *data, size_t size)
+{
+  channels.clear();
+  blocks.clear();
+  record_count = 0;
+
+  if( size < sizeof( LOG_MAGIC) + 8 || memcmp( data, LOG_MAGIC, sizeof( LOG_MAGIC)) != 0)
+    return true;
+  const uint8_t *end = data + size;
+  const uint8_t *p = data + sizeof( LOG_MAGIC);
+  if( get_u16( p) != COLUMN_LOG_VERSION)
+    return true;
+  unsigned channel_count = get_u16( p + 2);
+  p += 8;
+
+  for( unsigned i = 0; i < channel_count; ++i)
+    {
+      if( end - p < 4 || end - p < 4 + p[3])
+	return true;
+      channel_info_t channel;
+      channel.type = p[0];
+      channel.offset = get_u16( p + 1);
+      channel.name.assign( (const char *)p + 4, p[3]);
+      if( channel.type > LOG_UINT32)
+	return true;
+      channels.push_back( channel);
+      p += 4 + p[3];
+    }
+
+  // index the blocks, a truncated last block is ignored
+  while( end - p >= BLOCK_HEADER_SIZE)
+    {
+      block_info_t block;
+      block.start = p;
+      block.size = get_u32( p + 4);
+      block.record_count = get_u16( p + 8);
+      if( get_u32( p) != COLUMN_LOG_BLOCK_MAGIC
+	  || get_u16( p + 10) != channel_count
+	  || block.size < BLOCK_HEADER_SIZE + 4 * channel_count)
+	return true;
+      if( block.size > (size_t)( end - p))
+	break;
+      block.first_record = record_count;
+      record_count += block.record_count;
+      blocks.push_back( block);
+      p += block.size;
+    }
+  return false;
+}
+
+int column_log_reader_t::find_channel( const char *name) const
+{
+  for( unsigned i = 0; i < channels.size(); ++i)
+    if( channels[i].name == name)
+      return i;
+  return -1;
+}
+
+bool column_log_reader_t::decode_column( const block_info_t &block, unsigned channel, uint8_t *target, size_t stride) const
+{
+  size_t begin = get_u32( block.start + BLOCK_HEADER_SIZE + 4 * channel);
+  size_t end = channel + 1 < channels.size() ? get_u32( block.start + BLOCK_HEADER_SIZE + 4 * ( channel + 1)) : block.size;
+  if( begin > end || end > block.size)
+    return true;
+
+  const uint8_t *source = block.start + begin;
+  const uint8_t *source_end = block.start + end;
+  unsigned count = block.record_count;
+  switch( channels[channel].type)
+  {
+    case LOG_FLOAT:
+      return decode_values<float>( source, source_end, count, target, stride);
+    case LOG_DOUBLE:
+      return decode_values<double>( source, source_end, count, target, stride);
+    case LOG_UINT8:
+      return decode_values<uint8_t>( source, source_end, count, target, stride);
+    case LOG_INT16:
+      return decode_values<int16_t>( source, source_end, count, target, stride);
+    case LOG_UINT16:
+      return decode_values<uint16_t>( source, source_end, count, target, stride);
+    case LOG_INT32:
+      return decode_values<int32_t>( source, source_end, count, target, stride);
+    default:
+      return decode_values<uint32_t>( source, source_end, count, target, stride);
+  }
+}
+
+bool column_log_reader_t::read_channel( unsigned channel, double *values) const
+{
+  if( channel >= channels.size())
+    return true;
+  uint8_t type = channels[channel].type;
+  std::vector<uint8_t> raw;
+  for( const block_info_t &block : blocks)
+    {
+      unsigned size = log_channel_size( type);
+      raw.resize( block.record_count * size);
+      if( decode_column( block, channel, raw.data(), size))
+	return true;
+      double *target = values + block.first_record;
+      for( unsigned i = 0; i < block.record_count; ++i)
+	{
+	  const uint8_t *source = raw.data() + i * size;
+	  switch( type)
+	  {
+	    case LOG_FLOAT:  { float v;    memcpy( &v, source, size); target[i] = v; } break;
+	    case LOG_DOUBLE: { double v;   memcpy( &v, source, size); target[i] = v; } break;
+	    case LOG_UINT8:  { target[i] = *source; } break;
+	    case LOG_INT16:  { int16_t v;  memcpy( &v, source, size); target[i] = v; } break;
+	    case LOG_UINT16: { uint16_t v; memcpy( &v, source, size); target[i] = v; } break;
+	    case LOG_INT32:  { int32_t v;  memcpy( &v, source, size); target[i] = v; } break;
+	    default:	     { uint32_t v; memcpy( &v, source, size); target[i] = v; } break;
+	  }
+	}
+    }
+  return false;
+}
+
+bool column_log_reader_t::read_records( const log_schema_t &schema, void *records) const
+{
+  for( unsigned i = 0; i < schema.channel_count; ++i)
+    {
+      const log_channel_t &member = schema.channels[i];
+      int channel = find_channel( member.name);
+      if( channel < 0)
+	continue;
+      if( channels[channel].type != member.type)
+	return true;
+      for( const block_info_t &block : blocks)
+	{
+	  uint8_t *target = (uint8_t *)records + block.first_record * schema.record_size + member.offset;
+	  if( decode_column( block, channel, target, schema.record_size))
+	    return true;
+	}
+    }
+  return false;
+}
+
+#endif
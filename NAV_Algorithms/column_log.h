@@ -0,0 +1,181 @@
+/***********************************************************************//**
+ * @file		column_log.h
+ * @brief		columnar flight log with delta + varint compression
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef COLUMN_LOG_H_
+#define COLUMN_LOG_H_
+
+#include "log_schema.h"
+#include "my_assert.h"
+#include <string.h>
+
+/*
+ * file layout, little endian:
+ *
+ * header:	"LARUSLOG", u16 version, u16 channel count, u16 record size, u16 records per block
+ *		per channel: u8 type, u16 offset, u8 name length, name (not terminated)
+ * blocks:	u32 COLUMN_LOG_BLOCK_MAGIC, u32 block size, u16 record count, u16 channel count,
+ *		u32 column offset[channel count] relative to the block start, columns
+ * column:	per record zigzag varint of the delta to the previous value,
+ *		floats are mapped to order-preserving integers first, the delta restarts in each block
+ */
+
+#define COLUMN_LOG_VERSION 	1
+#define COLUMN_LOG_BLOCK_MAGIC 	0x4b4c4231 	//!< "1BLK"
+
+#ifndef COLUMN_LOG_BLOCK_RECORDS
+#define COLUMN_LOG_BLOCK_RECORDS 50 	//!< 0.5s @ 100Hz, the writer keeps one block of raw records in RAM
+#endif
+
+//! write the schema header, returns its size or 0 if capacity is too small
+unsigned write_column_log_header( const log_schema_t &schema, unsigned block_records, uint8_t *target, unsigned capacity);
+
+/**
+ * @brief compress record_count records column by column into one block
+ * @return block size or 0 if capacity is too small
+ */
+unsigned encode_column_log_block( const log_schema_t &schema, const uint8_t *records, unsigned record_count, uint8_t *target, unsigned capacity);
+
+//! worst case block size
+unsigned column_log_block_capacity( const log_schema_t &schema, unsigned record_count);
+
+/**
+ * @brief streaming log writer for one record type
+ *
+ * Records are collected in RAM, each full block is compressed in one go
+ * into the buffer of the caller which then writes it to the SD card.
+ */
+template <class record_type, unsigned BLOCK_RECORDS = COLUMN_LOG_BLOCK_RECORDS> class column_log_writer_t
+{
+public:
+  column_log_writer_t( const log_schema_t &_schema)
+    : schema( _schema),
+      count( 0)
+  {
+    ASSERT( schema.record_size == sizeof( record_type));
+  }
+
+  unsigned write_header( uint8_t *target, unsigned capacity) const
+  {
+    return write_column_log_header( schema, BLOCK_RECORDS, target, capacity);
+  }
+
+  //! returns the size of the block completed in target, 0 while the block is being filled
+  unsigned append( const record_type &record, uint8_t *target, unsigned capacity)
+  {
+    memcpy( records + count * sizeof( record_type), &record, sizeof( record_type));
+    if( ++count < BLOCK_RECORDS)
+      return 0;
+    return flush( target, capacity);
+  }
+
+  //! compress the pending records into target, returns the block size, 0 if nothing pending
+  unsigned flush( uint8_t *target, unsigned capacity)
+  {
+    if( count == 0)
+      return 0;
+    unsigned size = encode_column_log_block( schema, records, count, target, capacity);
+    count = 0;
+    return size;
+  }
+
+private:
+  const log_schema_t &schema;
+  unsigned count;
+  uint8_t records[BLOCK_RECORDS * sizeof( record_type)];
+};
+
+#if UNIX == 1 // host only
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief reader for logs in memory, e.g. a mapped file
+ *
+ * open() parses the header and indexes the blocks without decompressing them.
+ * Channels are matched by name, so logs written with a different
+ * build configuration read into the present structures.
+ */
+class column_log_reader_t
+{
+public:
+  //! returns true on error: header or block structure
+  bool open( const uint8_t *data, size_t size);
+
+  size_t get_record_count( void) const
+  {
+    return record_count;
+  }
+
+  unsigned get_channel_count( void) const
+  {
+    return channels.size();
+  }
+
+  const char *get_channel_name( unsigned channel) const
+  {
+    return channels[channel].name.c_str();
+  }
+
+  //! channel index or -1 if the log does not contain the channel
+  int find_channel( const char *name) const;
+
+  //! decode one channel of all records, only this column is read in each block
+  bool read_channel( unsigned channel, double *values) const;
+
+  /**
+   * @brief decode all records into the layout given by schema
+   *
+   * Members not contained in the log are not written.
+   * @return true on error: corrupted data or type mismatch
+   */
+  bool read_records( const log_schema_t &schema, void *records) const;
+
+private:
+  typedef struct
+  {
+    std::string name;
+    uint8_t type;
+    uint16_t offset;
+  } channel_info_t;
+
+  typedef struct
+  {
+    const uint8_t *start;
+    size_t size;
+    size_t first_record;
+    unsigned record_count;
+  } block_info_t;
+
+  //! decode one column of a block into consecutive values of the channel type, stride bytes apart
+  bool decode_column( const block_info_t &block, unsigned channel, uint8_t *target, size_t stride) const;
+
+  std::vector<channel_info_t> channels;
+  std::vector<block_info_t> blocks;
+  size_t record_count;
+};
+
+#endif
+
+#endif /* COLUMN_LOG_H_ */
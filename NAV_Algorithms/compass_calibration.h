@@ -28,8 +28,10 @@
 #include "system_configuration.h"
 #include "float3vector.h"
 #include "Linear_Least_Square_Fit.h"
-#include "persistent_data.h"
+#include "recursive_least_square_fit.h"
+#include "configuration_snapshot.h"
 #include "NAV_tuning_parameters.h"
+#include "event_trace.h"
 
 //! maintain offset and slope data for one sensor axis
 class calibration_t
@@ -72,9 +74,12 @@ public:
 template <class sample_type, class evaluation_type> class compass_calibration_t
 {
 public:
-  compass_calibration_t( void)
-    : calibration_done( false),
-      completeness( HAVE_NONE)
+  compass_calibration_t( configuration_snapshot_t &_configuration)
+    : configuration( _configuration),
+      calibration_done( false),
+      write_back_enabled( true),
+      completeness( HAVE_NONE),
+      samples_since_write( 0)
   {}
 
   float3vector calibrate( const float3vector &in)
@@ -106,7 +111,36 @@ public:
   }
 
 
-  bool set_calibration_if_changed( linear_least_square_fit<sample_type, evaluation_type> mag_calibrator[3], float scale_factor, bool turning_right)
+  template <class collector_type>
+  bool set_calibration_if_changed( collector_type mag_calibrator[3], float scale_factor, bool turning_right)
+  {
+    if( ! calibration_due( mag_calibrator, turning_right))
+      return false;
+
+    calibration_t new_calibration[3];
+    bool improved = evaluate( mag_calibrator, scale_factor, new_calibration);
+    for (unsigned i = 0; i < 3; ++i)
+      mag_calibrator[i].reset();
+
+    if( ! improved)
+      {
+	TRACE_EVENT( TRACE_MAG_CALIBRATION, TRACE_MAG_REJECTED, trace_float( 0.0f));
+	return false;
+      }
+
+    if( apply_calibration( new_calibration))
+      {
+      write_into_EEPROM();
+      TRACE_EVENT( TRACE_MAG_CALIBRATION, TRACE_MAG_ACCEPTED, trace_float( get_variance_average()));
+      return true;
+      }
+    TRACE_EVENT( TRACE_MAG_CALIBRATION, TRACE_MAG_UNCHANGED, trace_float( get_variance_average()));
+    return false;
+  }
+
+  //! note the turn direction, true if left and right turns have been seen and there is enough data
+  template <class collector_type>
+  bool calibration_due( const collector_type mag_calibrator[3], bool turning_right)
   {
     if( turning_right)
       completeness |= HAVE_RIGHT;
@@ -116,19 +150,27 @@ public:
     if( false == (completeness == HAVE_BOTH))
       return false;
 
-    if( ( mag_calibrator[0].get_count() < MINIMUM_MAG_CALIBRATION_SAMPLES) )
-      return false;
+    return mag_calibrator[0].get_count() >= MINIMUM_MAG_CALIBRATION_SAMPLES;
+  }
 
-    // now we have enough entropy and evaluate our result
-    linear_least_square_result< float> new_calibration[3];
+  /**
+   * @brief least square fit evaluation, the expensive part
+   *
+   * Touches neither the calibration in use nor the configuration,
+   * to be run in the background with a copy of the collectors.
+   * @return true if the precision has improved
+   */
+  template <class collector_type>
+  bool evaluate( const collector_type mag_calibrator[3], float scale_factor, calibration_t new_calibration[3]) const
+  {
+    linear_least_square_result< float> result[3];
 
     float variance = 0;
     for (unsigned i = 0; i < 3; ++i)
       {
-	mag_calibrator[i].evaluate( new_calibration[i]);
-	variance += new_calibration[i].variance_offset / SQR( scale_factor);
-	variance += new_calibration[i].variance_slope;
-        mag_calibrator[i].reset();
+	mag_calibrator[i].evaluate( result[i]);
+	variance += result[i].variance_offset / SQR( scale_factor);
+	variance += result[i].variance_slope;
       }
 
     variance *= 0.1666666f; // gives us the mean value
@@ -139,18 +181,78 @@ public:
 #endif
 
     for (unsigned i = 0; i < 3; ++i)
-      calibration[i].refresh (
-	  new_calibration[i].y_offset / scale_factor,
-	  new_calibration[i].slope,
-	  new_calibration[i].variance_offset / SQR(scale_factor),
-	  new_calibration[i].variance_slope);
+      new_calibration[i].refresh (
+	  result[i].y_offset / scale_factor,
+	  result[i].slope,
+	  result[i].variance_offset / SQR(scale_factor),
+	  result[i].variance_slope);
+    return true;
+  }
+
+  //! use a new calibration, true if it differs significantly from the stored one
+  bool apply_calibration( const calibration_t new_calibration[3])
+  {
+    for (unsigned i = 0; i < 3; ++i)
+      calibration[i] = new_calibration[i];
+
+    return parameters_changed_significantly();
+  }
 
-    if( parameters_changed_significantly())
+  /**
+   * @brief continuous update from recursive estimators, to be called for every new sample
+   *
+   * The calibration in use follows the estimators as soon as their precision
+   * beats the stored one, the EEPROM is updated at most every MAG_CALIBRATION_WRITE_INTERVAL samples.
+   * @return true if a new calibration has been written
+   */
+  template <class estimator_type>
+  bool update_continuously( const estimator_type estimator[3])
+  {
+    if( samples_since_write < MAG_CALIBRATION_WRITE_INTERVAL)
+      ++samples_since_write;
+
+    if( estimator[0].get_count() < MINIMUM_MAG_CALIBRATION_SAMPLES)
+      return false;
+
+    linear_least_square_result< float> new_calibration[3];
+    float variance = 0;
+    for (unsigned i = 0; i < 3; ++i)
       {
-      write_into_EEPROM();
-      return true;
+	estimator[i].evaluate( new_calibration[i]);
+	variance += new_calibration[i].variance_offset + new_calibration[i].variance_slope;
       }
-    return false;
+    variance *= 0.1666666f; // gives us the mean value
+
+#if MAGNETIC_DECISION_OVERRIDE == 0
+    if( calibration_done && ( variance > SQR( configuration(MAG_STD_DEVIATION))))
+      return false; // not better than what we have
+#endif
+
+    for (unsigned i = 0; i < 3; ++i)
+      calibration[i].refresh( new_calibration[i]);
+    calibration_done = true;
+
+    if( ( samples_since_write < MAG_CALIBRATION_WRITE_INTERVAL) || ! parameters_changed_significantly())
+      return false;
+
+    samples_since_write = 0;
+#if DEFERRED_MAG_CALIBRATION
+    store_into_configuration(); // the EEPROM write is left to the background task
+#else
+    write_into_EEPROM();
+#endif
+    return true;
+  }
+
+  //! if disabled new calibrations are maintained in the configuration snapshot only (replay of many flights at once)
+  void enable_write_back( bool enable)
+  {
+    write_back_enabled = enable;
+  }
+
+  bool is_write_back_enabled( void) const
+  {
+    return write_back_enabled;
   }
 
   bool isCalibrationDone () const
@@ -184,38 +286,89 @@ public:
     return parameter_change_variance > MAG_CALIBRATION_CHANGE_LIMIT;
   }
 
-  void write_into_EEPROM (void) const
+  //! update the configuration snapshot and, if enabled, the EEPROM
+  void write_into_EEPROM (void)
   {
-    if( calibration_done == false)
+    if( store_into_configuration())
       return;
+    write_configuration_into_EEPROM();
+  }
 
-    EEPROM_initialize();
+  //! update the configuration snapshot, returns true on error (no calibration)
+  bool store_into_configuration (void)
+  {
+    if( calibration_done == false)
+      return true;
 
     float variance = 0.0f;
     for( unsigned i=0; i<3; ++i)
       {
-        write_EEPROM_value( (EEPROM_PARAMETER_ID)(MAG_X_OFF   + 2*i), calibration[i].offset);
-        write_EEPROM_value( (EEPROM_PARAMETER_ID)(MAG_X_SCALE + 2*i), calibration[i].scale);
+        configuration.set( (EEPROM_PARAMETER_ID)(MAG_X_OFF   + 2*i), calibration[i].offset);
+        configuration.set( (EEPROM_PARAMETER_ID)(MAG_X_SCALE + 2*i), calibration[i].scale);
         variance += calibration[i].variance;
       }
-    write_EEPROM_value(MAG_STD_DEVIATION, SQRT( variance / 6.0f));
+    configuration.set( MAG_STD_DEVIATION, SQRT( variance / 6.0f));
+    return false;
   }
 
-  bool read_from_EEPROM (void)
+  //! copy the stored calibration into the EEPROM if write back is enabled
+  void write_configuration_into_EEPROM (void) const
+  {
+    if( ! write_back_enabled)
+      return;
+
+    calibration_t stored[3];
+    float std_deviation;
+    get_stored_calibration( stored, std_deviation);
+    write_EEPROM( stored, std_deviation);
+  }
+
+  //! calibration as stored in the configuration snapshot
+  void get_stored_calibration( calibration_t stored[3], float &std_deviation) const
+  {
+    for( unsigned i=0; i<3; ++i)
+      {
+        stored[i].offset = configuration( (EEPROM_PARAMETER_ID)(MAG_X_OFF   + 2*i));
+        stored[i].scale  = configuration( (EEPROM_PARAMETER_ID)(MAG_X_SCALE + 2*i));
+      }
+    std_deviation = configuration( MAG_STD_DEVIATION);
+  }
+
+  //! flash write, slow: no access to the object, may run in the background with a copy of the data
+  static void write_EEPROM( const calibration_t stored[3], float std_deviation)
+  {
+    float value[EEPROM_PARAMETER_ID_END];
+    bool selected[EEPROM_PARAMETER_ID_END] = { false};
+
+    for( unsigned i=0; i<3; ++i)
+      {
+        value[MAG_X_OFF   + 2*i] = stored[i].offset;
+        value[MAG_X_SCALE + 2*i] = stored[i].scale;
+        selected[MAG_X_OFF   + 2*i] = selected[MAG_X_SCALE + 2*i] = true;
+      }
+    value[MAG_STD_DEVIATION] = std_deviation;
+    selected[MAG_STD_DEVIATION] = true;
+
+    write_all_EEPROM_values( value, selected); // one transaction
+  }
+
+  //! read calibration from the configuration snapshot
+  bool read_from_configuration (void)
   {
-    float variance;
     calibration_done = false;
-    if( true == read_EEPROM_value( MAG_STD_DEVIATION, variance))
+    if( ! configuration.is_available( MAG_STD_DEVIATION))
       return true; // error
-    variance = SQR( variance); // has been stored as STD DEV
+    float variance = SQR( configuration( MAG_STD_DEVIATION)); // has been stored as STD DEV
 
     for( unsigned i=0; i<3; ++i)
       {
-        if( true == read_EEPROM_value( (EEPROM_PARAMETER_ID)(MAG_X_OFF   + 2*i), calibration[i].offset))
+        if( ! configuration.is_available( (EEPROM_PARAMETER_ID)(MAG_X_OFF   + 2*i)))
   	    return true; // error
+        calibration[i].offset = configuration( (EEPROM_PARAMETER_ID)(MAG_X_OFF   + 2*i));
 
-        if( true == read_EEPROM_value( (EEPROM_PARAMETER_ID)(MAG_X_SCALE + 2*i), calibration[i].scale))
+        if( ! configuration.is_available( (EEPROM_PARAMETER_ID)(MAG_X_SCALE + 2*i)))
   	    return true; // error
+        calibration[i].scale = configuration( (EEPROM_PARAMETER_ID)(MAG_X_SCALE + 2*i));
 
         calibration[i].variance = variance;
       }
@@ -224,12 +377,43 @@ public:
     return false; // no error;
   }
 
+  //! dynamic state for checkpoints, the write back setting is not part of it
+  class state_t
+  {
+  public:
+    calibration_t calibration[3];
+    bool calibration_done;
+    unsigned completeness;
+    unsigned samples_since_write;
+  };
+
+  void save_state( state_t &state) const
+  {
+    for( unsigned i=0; i<3; ++i)
+      state.calibration[i] = calibration[i];
+    state.calibration_done = calibration_done;
+    state.completeness = completeness;
+    state.samples_since_write = samples_since_write;
+  }
+
+  void restore_state( const state_t &state)
+  {
+    for( unsigned i=0; i<3; ++i)
+      calibration[i] = state.calibration[i];
+    calibration_done = state.calibration_done;
+    completeness = state.completeness;
+    samples_since_write = state.samples_since_write;
+  }
+
+  configuration_snapshot_t &configuration;
   calibration_t calibration[3];
   bool calibration_done;
+  bool write_back_enabled; //!< write new calibration into EEPROM
 
 private:
   enum completeness_type { HAVE_NONE=0, HAVE_RIGHT=1, HAVE_LEFT=2, HAVE_BOTH=3};
   unsigned completeness; // bits from completeness_type
+  unsigned samples_since_write; //!< EEPROM rate limiter for update_continuously()
 };
 
 #endif /* COMPASS_CALIBRATION_H_ */
@@ -0,0 +1,100 @@
+/***********************************************************************//**
+ * @file		configuration_snapshot.h
+ * @brief		RAM copy of all configuration parameters
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef CONFIGURATION_SNAPSHOT_H_
+#define CONFIGURATION_SNAPSHOT_H_
+
+#include "persistent_data.h"
+
+/**
+ * @brief flat ID-indexed copy of all configuration parameters
+ *
+ * Resolved once from EEPROM and then passed by reference
+ * into the algorithm instances, so no EEPROM access is necessary
+ * after setup.
+ * Different instances may run on different parameter sets.
+ */
+class configuration_snapshot_t
+{
+public:
+  //! setup containing the default values of all parameters
+  configuration_snapshot_t( void)
+  {
+    for( unsigned i = 0; i < EEPROM_PARAMETER_ID_END; ++i)
+      {
+	value[i] = 0.0f;
+	available[i] = false;
+      }
+    for( const persistent_data_t *parameter = PERSISTENT_DATA; parameter < (PERSISTENT_DATA+PERSISTENT_DATA_ENTRIES); ++parameter )
+      value[parameter->id] = parameter->default_value;
+  }
+
+  //! resolve all parameters from EEPROM, parameters not found keep their present value
+  void read_from_EEPROM( void)
+  {
+    read_all_EEPROM_values( value, available);
+  }
+
+  //! write all available parameters back into EEPROM, returns true on error
+  bool write_into_EEPROM( void) const
+  {
+    return write_all_EEPROM_values( value, available);
+  }
+
+  float operator()( EEPROM_PARAMETER_ID id) const
+  {
+    return value[id];
+  }
+
+  //! true if the parameter has been found in EEPROM or has been set
+  bool is_available( EEPROM_PARAMETER_ID id) const
+  {
+    return available[id];
+  }
+
+  void set( EEPROM_PARAMETER_ID id, float data)
+  {
+    value[id] = data;
+    available[id] = true;
+  }
+
+private:
+  float value[EEPROM_PARAMETER_ID_END];
+  bool available[EEPROM_PARAMETER_ID_END];
+};
+
+//! the instance resolved from EEPROM on first use
+inline configuration_snapshot_t & EEPROM_configuration( void)
+{
+  static configuration_snapshot_t configuration;
+  static bool resolved = false;
+  if( ! resolved)
+    {
+      configuration.read_from_EEPROM();
+      resolved = true;
+    }
+  return configuration;
+}
+
+#endif /* CONFIGURATION_SNAPSHOT_H_ */
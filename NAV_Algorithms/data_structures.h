@@ -28,10 +28,20 @@
 #include "system_configuration.h"
 #include "AHRS.h"
 #include "GNSS.h"
+#include <stddef.h>
 
-#pragma pack(push, 1)
+#if UNIX == 1
+#define OUTPUT_DATA_ALIGNMENT	64	//!< output_data_t starts on a cache line boundary
+#else
+#define OUTPUT_DATA_ALIGNMENT	8	//!< Cortex-M4: no data cache, double alignment only
+#endif
 
-//! contains all calibrated data from the sensors
+/**
+ * @brief contains all calibrated data from the sensors
+ *
+ * The IMU data and the pressures read @ 100 Hz come first.
+ * The in-memory layout is naturally aligned, observations_record_t is the packed log layout.
+ */
 typedef struct
 {
   float3vector acc;   //XSENSE MTi1 IMU
@@ -65,8 +75,35 @@ typedef struct
   coordinates_t c;
 } observations_type;
 
-//! combination of all input and output data in one structure
+#if DEVELOPMENT_ADDITIONS
+//! comparison and diagnostic output, kept out of the cache lines of the results
 typedef struct
+{
+  float3vector nav_correction;
+  float3vector gyro_correction;
+
+  float3vector nav_acceleration_mag;
+  float3vector nav_induction_mag;
+  eulerangle<float> euler_magnetic;
+  quaternion<float> q_magnetic;
+
+  float3vector body_acc;
+  float3vector body_gyro;
+  float HeadingDifferenceAhrsDgnss;
+  float QFF;
+  float satfix;
+  float headwind;
+  float crosswind;
+  float inst_wind_N;
+  float inst_wind_E;
+  float inst_wind_corrected_N;
+  float inst_wind_corrected_E;
+  float speed_compensation[3];
+} output_diagnostics_t;
+#endif
+
+//! combination of all input and output data in one structure, results follow the inputs, output_record_t is the packed log layout
+typedef struct alignas( OUTPUT_DATA_ALIGNMENT)
 {
   measurement_data_t m;
   coordinates_t c;
@@ -95,31 +132,135 @@ typedef struct
   float3vector nav_induction_gnss;
 
 #if DEVELOPMENT_ADDITIONS
-  float3vector nav_correction;
-  float3vector gyro_correction;
+  output_diagnostics_t diagnostics;
+#endif
+} output_data_t;
 
-  float3vector nav_acceleration_mag;
-  float3vector nav_induction_mag;
-  eulerangle<float> euler_magnetic;
-  quaternion<float> q_magnetic;
+//! groups of output_data_t results, to be subscribed by the output consumers
+enum output_fields_t
+{
+  OUTPUT_AIRSPEED	= 1 << 0, //!< TAS, IAS
+  OUTPUT_ATTITUDE	= 1 << 1, //!< euler, q
+  OUTPUT_VARIO		= 1 << 2, //!< vario, vario_pressure, integrator_vario, vario_uncompensated
+  OUTPUT_WIND		= 1 << 3, //!< wind, wind_average
+  OUTPUT_FLIGHT_STATE	= 1 << 4, //!< speed compensation, effective vertical acceleration, circle mode, turn rate, slip and nick angle, G load
+  OUTPUT_AIR_DATA	= 1 << 5, //!< pressure_altitude, air_density
+  OUTPUT_MAGNETIC	= 1 << 6, //!< magnetic_disturbance, nav_induction_gnss
+  OUTPUT_DIAGNOSTICS	= 1 << 7, //!< DEVELOPMENT_ADDITIONS fields including shadow estimators
+  OUTPUT_ALL		= 0xff
+};
 
-  float3vector body_acc;
-  float3vector body_gyro;
-  float HeadingDifferenceAhrsDgnss;
-  float QFF;
-  float satfix;
-  float headwind;
-  float crosswind;
-  float inst_wind_N;
-  float inst_wind_E;
-  float inst_wind_corrected_N;
-  float inst_wind_corrected_E;
-  float speed_compensation[3];
+#pragma pack(push, 1)
 
-#endif
+//! observations_type as stored in the log files, no padding
+typedef struct
+{
+  measurement_data_t m;
+  coordinates_t c;
+} observations_record_t;
 
-} output_data_t;
+//! output_data_t as stored in the log files, byte-identical to the former packed output_data_t
+typedef struct
+{
+  measurement_data_t m;
+  coordinates_t c;
+  float IAS;
+  float TAS;
+  float vario_uncompensated;
+  float vario;
+  float vario_pressure;
+  float speed_compensation_TAS;
+  float speed_compensation_GNSS;
+  float integrator_vario;
+  float3vector wind;
+  float3vector wind_average;
+  uint32_t circle_mode;
+  quaternion<float> q;
+  eulerangle<float> euler;
+  float effective_vertical_acceleration;
+  float turn_rate;
+  float slip_angle;
+  float nick_angle;
+  float G_load;
+  float pressure_altitude;
+  float air_density;
+  float magnetic_disturbance;
+  float3vector nav_acceleration_gnss;
+  float3vector nav_induction_gnss;
+#if DEVELOPMENT_ADDITIONS
+  output_diagnostics_t diagnostics;
+#endif
+} output_record_t;
 
 #pragma pack(pop)
 
+// the in-memory structs are no longer packed: they must not contain padding the log layout lacks
+static_assert( sizeof( measurement_data_t) == sizeof( float) * ( 13 + 11 * WITH_LOWCOST_SENSORS + 2 * WITH_DENSITY_DATA),
+	       "log record layout changed");
+
+// offsets of the former packed output_data_t, relative to the first result
+#define OUTPUT_RECORD_RESULTS	( sizeof( measurement_data_t) + sizeof( coordinates_t))
+static_assert( offsetof( output_record_t, IAS) 		      == OUTPUT_RECORD_RESULTS
+	    && offsetof( output_record_t, wind) 	      == OUTPUT_RECORD_RESULTS + 32
+	    && offsetof( output_record_t, circle_mode) 	      == OUTPUT_RECORD_RESULTS + 56
+	    && offsetof( output_record_t, q) 		      == OUTPUT_RECORD_RESULTS + 60
+	    && offsetof( output_record_t, euler) 	      == OUTPUT_RECORD_RESULTS + 76
+	    && offsetof( output_record_t, pressure_altitude)  == OUTPUT_RECORD_RESULTS + 108
+	    && offsetof( output_record_t, nav_induction_gnss) == OUTPUT_RECORD_RESULTS + 132,
+	       "output log record layout changed");
+#if DEVELOPMENT_ADDITIONS
+static_assert( offsetof( output_record_t, diagnostics) == OUTPUT_RECORD_RESULTS + 144
+	    && offsetof( output_diagnostics_t, q_magnetic) == 60
+	    && offsetof( output_diagnostics_t, HeadingDifferenceAhrsDgnss) == 100
+	    && offsetof( output_diagnostics_t, speed_compensation) == 136
+	    && sizeof( output_record_t) == OUTPUT_RECORD_RESULTS + 144 + 148,
+	       "output log record layout changed");
+#else
+static_assert( sizeof( output_record_t) == OUTPUT_RECORD_RESULTS + 144, "output log record layout changed");
+#endif
+
+inline void to_record( const observations_type &observations, observations_record_t &record)
+{
+  record.m = observations.m;
+  record.c = observations.c;
+}
+
+inline void to_record( const output_data_t &output, output_record_t &record)
+{
+  record.m 				 = output.m;
+  record.c 				 = output.c;
+  record.IAS 				 = output.IAS;
+  record.TAS 				 = output.TAS;
+  record.vario_uncompensated 		 = output.vario_uncompensated;
+  record.vario 				 = output.vario;
+  record.vario_pressure 		 = output.vario_pressure;
+  record.speed_compensation_TAS 	 = output.speed_compensation_TAS;
+  record.speed_compensation_GNSS 	 = output.speed_compensation_GNSS;
+  record.integrator_vario 		 = output.integrator_vario;
+  record.wind 				 = output.wind;
+  record.wind_average 			 = output.wind_average;
+  record.circle_mode 			 = output.circle_mode;
+  record.q 				 = output.q;
+  record.euler 				 = output.euler;
+  record.effective_vertical_acceleration = output.effective_vertical_acceleration;
+  record.turn_rate 			 = output.turn_rate;
+  record.slip_angle 			 = output.slip_angle;
+  record.nick_angle 			 = output.nick_angle;
+  record.G_load 			 = output.G_load;
+  record.pressure_altitude 		 = output.pressure_altitude;
+  record.air_density 			 = output.air_density;
+  record.magnetic_disturbance 		 = output.magnetic_disturbance;
+  record.nav_acceleration_gnss 		 = output.nav_acceleration_gnss;
+  record.nav_induction_gnss 		 = output.nav_induction_gnss;
+#if DEVELOPMENT_ADDITIONS
+  record.diagnostics 			 = output.diagnostics;
+#endif
+}
+
+inline void from_record( const observations_record_t &record, observations_type &observations)
+{
+  observations.m = record.m;
+  observations.c = record.c;
+}
+
 #endif /* DATA_STRUCTURES_H_ */
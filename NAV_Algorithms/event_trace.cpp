@@ -0,0 +1,72 @@
+/***********************************************************************//**
+ * @file		event_trace.cpp
+ * @brief		binary event trace ring for algorithm state transitions
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "event_trace.h"
+#include "crc16.h"
+
+unsigned event_trace_t::drain( trace_event_t *target, unsigned max_count)
+{
+  if( max_count == 0)
+    return 0;
+
+  unsigned count = 0;
+  unsigned dropped = queue.get_dropped();
+  if( dropped != reported_drops)
+    {
+      trace_event_t lost = { read_cycle_counter(), TRACE_LOST_EVENTS, dropped - reported_drops, 0};
+      target[count++] = lost;
+      reported_drops = dropped;
+    }
+  return count + queue.pop( target + count, max_count - count);
+}
+
+#if WITH_EVENT_TRACE
+
+event_trace_t event_trace;
+
+unsigned encode_event_trace_frame( uint8_t *buffer, unsigned capacity)
+{
+  if( capacity < EVENT_TRACE_FRAME_SIZE)
+    return 0;
+
+  uint8_t packet[2 + EVENT_TRACE_FRAME_EVENTS * sizeof( trace_event_t) + 2];
+  trace_event_t events[EVENT_TRACE_FRAME_EVENTS];
+  unsigned count = event_trace.drain( events, EVENT_TRACE_FRAME_EVENTS);
+  if( count == 0)
+    return 0;
+
+  packet[0] = EVENT_TRACE_VERSION;
+  packet[1] = (uint8_t)count;
+  unsigned size = 2 + count * sizeof( trace_event_t);
+  memcpy( packet + 2, events, count * sizeof( trace_event_t));
+  uint16_t crc = crc16( packet, size);
+  packet[size++] = (uint8_t)crc;
+  packet[size++] = (uint8_t)( crc >> 8);
+
+  unsigned length = cobs_encode( packet, size, buffer);
+  buffer[length++] = 0; // frame delimiter
+  return length;
+}
+
+#endif
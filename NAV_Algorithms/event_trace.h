@@ -0,0 +1,141 @@
+/***********************************************************************//**
+ * @file		event_trace.h
+ * @brief		binary event trace ring for algorithm state transitions
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef EVENT_TRACE_H_
+#define EVENT_TRACE_H_
+
+#include "system_configuration.h"
+#include "profiling.h"
+#include "spsc_queue.h"
+#include "cobs.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifndef WITH_EVENT_TRACE
+#define WITH_EVENT_TRACE 0 //!< if 1: TRACE_EVENT() records into the event trace ring
+#endif
+
+#ifndef EVENT_TRACE_SIZE
+#define EVENT_TRACE_SIZE 64 //!< ring size, power of two, capacity is one less
+#endif
+
+#define EVENT_TRACE_VERSION 1 //!< frame layout
+
+/**
+ * @brief event ID, payload a, payload b
+ *
+ * Python/event_trace.py reads this table, keep one entry per line.
+ * New events are appended, IDs are part of the recorded data.
+ */
+#define TRACE_EVENTS( X) \
+  X( TRACE_CIRCLING_STATE,	"old_state",		"new_state") \
+  X( TRACE_MAG_CALIBRATION,	"result",		"float:variance") \
+  X( TRACE_EARTH_INDUCTION,	"accepted",		"float:std_deviation") \
+  X( TRACE_GNSS_FIX,		"old_fix_type",		"new_fix_type") \
+  X( TRACE_AIR_DENSITY,		"float:QFF",		"float:density_correction") \
+  X( TRACE_LOST_EVENTS,		"count",		"unused") \
+  X( TRACE_IMU_STATUS,		"old_status",		"new_status")
+
+#define TRACE_EVENT_ENUM( id, a, b) id,
+
+enum trace_event_id_t
+{
+  TRACE_EVENTS( TRACE_EVENT_ENUM)
+  TRACE_EVENT_COUNT
+};
+
+//! TRACE_MAG_CALIBRATION result
+enum { TRACE_MAG_REJECTED, TRACE_MAG_UNCHANGED, TRACE_MAG_ACCEPTED};
+
+//! one event, little endian as recorded
+typedef struct
+{
+  uint32_t timestamp; 	//!< read_cycle_counter()
+  uint32_t id;		//!< trace_event_id_t
+  uint32_t a;
+  uint32_t b;
+} trace_event_t;
+
+static_assert( sizeof( trace_event_t) == 16, "trace_event_t is part of the frame layout");
+
+//! float payload, bit pattern
+inline uint32_t trace_float( float value)
+{
+  uint32_t bits;
+  memcpy( &bits, &value, sizeof( bits));
+  return bits;
+}
+
+/**
+ * @brief ring of trace events, written by the algorithm task only
+ *
+ * Emitting is a timestamp and one queue push, a full ring drops the new event
+ * and the loss is reported by the next drain.
+ */
+class event_trace_t
+{
+public:
+  event_trace_t( void)
+    : reported_drops( 0)
+  {}
+
+  void emit( trace_event_id_t id, uint32_t a, uint32_t b)
+  {
+    trace_event_t event = { read_cycle_counter(), (uint32_t)id, a, b};
+    queue.push( event);
+  }
+
+  //! consumer side, a TRACE_LOST_EVENTS event reports dropped events, returns the number of events fetched
+  unsigned drain( trace_event_t *target, unsigned max_count);
+
+private:
+  spsc_queue<trace_event_t, EVENT_TRACE_SIZE> queue;
+  unsigned reported_drops; //!< consumer side
+};
+
+//! frame header: version, event count, events, CRC-16/CCITT over all that
+#define EVENT_TRACE_FRAME_EVENTS 	8
+#define EVENT_TRACE_FRAME_SIZE		( COBS_ENCODED_SIZE( 2 + EVENT_TRACE_FRAME_EVENTS * sizeof( trace_event_t) + 2) + 1)
+
+#if WITH_EVENT_TRACE
+
+extern event_trace_t event_trace;
+
+#define TRACE_EVENT( id, a, b) event_trace.emit( id, (uint32_t)( a), (uint32_t)( b))
+
+/**
+ * @brief drain up to EVENT_TRACE_FRAME_EVENTS into one COBS frame terminated by 0x00
+ *
+ * For serial output, CAN ( in chunks) or the log file.
+ * @return frame length, 0 if no events are pending or capacity < EVENT_TRACE_FRAME_SIZE
+ */
+unsigned encode_event_trace_frame( uint8_t *buffer, unsigned capacity);
+
+#else
+
+#define TRACE_EVENT( id, a, b) ((void)0)
+
+#endif
+
+#endif /* EVENT_TRACE_H_ */
@@ -29,7 +29,52 @@
 #define ONE_DIV_BY_GRAVITY_TIMES_2 0.0509684f
 #define RECIP_GRAVITY 0.1094f
 
-//! calculate instant windspeed and variometer data, update @ 100 Hz
+#if FAST_SAMPLING_FREQUENCY != 100
+
+#include "my_assert.h"
+
+// noise parameters reproducing the 100 Hz ROM gains, see KalmanVario*.cpp and Kalman_V_A_Aoff_observer.cpp
+
+static KalmanVario_gain_t make_KalmanVario_gain( void)
+{
+  KalmanVario_gain_t gain;
+  bool fail = gain.compute( FAST_SAMPLING_TIME, 1.0f / 9.0f, 1e-6f, 1.0f / 144.0f, 0.01f);
+  ASSERT( ! fail);
+  return gain;
+}
+
+static KalmanVario_PVA_gain_t make_KalmanVario_PVA_gain( void)
+{
+  KalmanVario_PVA_gain_t gain;
+  bool fail = gain.compute( FAST_SAMPLING_TIME, 1.0f, 1e-4f, 0.01f, 0.0225f, 0.01f);
+  ASSERT( ! fail);
+  return gain;
+}
+
+static Kalman_V_A_Aoff_gain_t make_Kalman_V_A_Aoff_gain( void)
+{
+  Kalman_V_A_Aoff_gain_t gain;
+  bool fail = gain.compute( FAST_SAMPLING_TIME, 9.0f, 1e-4f, 0.01f, 0.01f);
+  ASSERT( ! fail);
+  return gain;
+}
+
+void flight_observer_t::use_fast_sampling_gains( void)
+{
+  // computed once, shared by all instances
+  static const KalmanVario_gain_t 	KalmanVario_gain 	= make_KalmanVario_gain();
+  static const KalmanVario_PVA_gain_t 	KalmanVario_PVA_gain 	= make_KalmanVario_PVA_gain();
+  static const Kalman_V_A_Aoff_gain_t 	Kalman_V_A_Aoff_gain 	= make_Kalman_V_A_Aoff_gain();
+
+  KalmanVario_pressure.set_gain( KalmanVario_gain);
+  KalmanVario_GNSS.set_gain( KalmanVario_PVA_gain);
+  Kalman_v_a_observer_N.set_gain( Kalman_V_A_Aoff_gain);
+  Kalman_v_a_observer_E.set_gain( Kalman_V_A_Aoff_gain);
+}
+
+#endif
+
+//! calculate instant windspeed and variometer data, update @ FAST_SAMPLING_FREQUENCY
 void flight_observer_t::update_every_10ms (
     const float3vector &gnss_velocity,
     const float3vector &gnss_acceleration,
@@ -58,14 +103,13 @@ void flight_observer_t::update_every_10ms (
   else
     {
       // run the 100 Hz -> 10 Hz wind speed decimation filter
-      float3vector air_velocity = heading_vector * TAS;
-      windspeed_decimator_100Hz_10Hz.respond( gnss_velocity - air_velocity);
+      windspeed_decimator_100Hz_10Hz.respond( mul_add( heading_vector, -TAS, gnss_velocity));
 
       // The Kalman-filter-based un-compensated variometer in NED-system reports negative if *climbing* !
       vario_uncompensated_GNSS = - KalmanVario_GNSS.update ( GNSS_negative_altitude, gnss_velocity.e[DOWN], ahrs_acceleration.e[DOWN]);
 
       // INS-acceleration {scalar product *} GNSS-velocity = speed compensation type 1
-      air_velocity = gnss_velocity - wind_average;
+      float3vector air_velocity = gnss_velocity - wind_average;
       air_velocity.e[DOWN] = KalmanVario_GNSS.get_x( KalmanVario_PVA_t::VARIO);
 
       float3vector acceleration = ahrs_acceleration;
@@ -95,7 +139,9 @@ void flight_observer_t::update_every_10ms (
       speed_compensation_energy_3 = specific_energy_differentiator.respond(specific_energy);
 
       // blending of three mechanisms for speed-compensation
-      speed_compensation_GNSS = GNSS_INS_speedcomp_fusioner.respond( 0.5 * ( speed_compensation_INS_GNSS_1 + speed_compensation_kalman_2 ), speed_compensation_energy_3);
+      speed_compensation_GNSS = GNSS_INS_speedcomp_fusioner.respond(
+	  INS_GNSS_blend * speed_compensation_INS_GNSS_1 + ( ONE - INS_GNSS_blend) * speed_compensation_kalman_2,
+	  speed_compensation_energy_3);
 
       vario_averager_GNSS.respond( vario_uncompensated_GNSS + speed_compensation_GNSS);
     }
@@ -106,3 +152,54 @@ void flight_observer_t::reset(float pressure_negative_altitude, float GNSS_negat
   KalmanVario_GNSS.reset( GNSS_negative_altitude, -9.81f);
   KalmanVario_pressure.reset( pressure_negative_altitude, -9.81f);
 }
+
+void flight_observer_t::settle( void)
+{
+  vario_averager_pressure.settle( ZERO);
+  vario_averager_GNSS.settle( ZERO);
+  windspeed_decimator_100Hz_10Hz.settle( windspeed_decimator_100Hz_10Hz.get_output());
+}
+
+void flight_observer_t::save_state( state_t &state) const
+{
+  windspeed_decimator_100Hz_10Hz.save_state( state.windspeed_decimator_100Hz_10Hz);
+  vario_averager_pressure.save_state( state.vario_averager_pressure);
+  vario_averager_GNSS.save_state( state.vario_averager_GNSS);
+  kinetic_energy_differentiator.save_state( state.kinetic_energy_differentiator);
+  KalmanVario_GNSS.save_state( state.KalmanVario_GNSS);
+  KalmanVario_pressure.save_state( state.KalmanVario_pressure);
+  specific_energy_differentiator.save_state( state.specific_energy_differentiator);
+  Kalman_v_a_observer_N.save_state( state.Kalman_v_a_observer_N);
+  Kalman_v_a_observer_E.save_state( state.Kalman_v_a_observer_E);
+  GNSS_INS_speedcomp_fusioner.save_state( state.GNSS_INS_speedcomp_fusioner);
+  state.vario_uncompensated_pressure = vario_uncompensated_pressure;
+  state.speed_compensation_IAS = speed_compensation_IAS;
+  state.speed_compensation_GNSS = speed_compensation_GNSS;
+  state.vario_uncompensated_GNSS = vario_uncompensated_GNSS;
+  state.specific_energy = specific_energy;
+  state.speed_compensation_INS_GNSS_1 = speed_compensation_INS_GNSS_1;
+  state.speed_compensation_kalman_2 = speed_compensation_kalman_2;
+  state.speed_compensation_energy_3 = speed_compensation_energy_3;
+}
+
+void flight_observer_t::restore_state( const state_t &state)
+{
+  windspeed_decimator_100Hz_10Hz.restore_state( state.windspeed_decimator_100Hz_10Hz);
+  vario_averager_pressure.restore_state( state.vario_averager_pressure);
+  vario_averager_GNSS.restore_state( state.vario_averager_GNSS);
+  kinetic_energy_differentiator.restore_state( state.kinetic_energy_differentiator);
+  KalmanVario_GNSS.restore_state( state.KalmanVario_GNSS);
+  KalmanVario_pressure.restore_state( state.KalmanVario_pressure);
+  specific_energy_differentiator.restore_state( state.specific_energy_differentiator);
+  Kalman_v_a_observer_N.restore_state( state.Kalman_v_a_observer_N);
+  Kalman_v_a_observer_E.restore_state( state.Kalman_v_a_observer_E);
+  GNSS_INS_speedcomp_fusioner.restore_state( state.GNSS_INS_speedcomp_fusioner);
+  vario_uncompensated_pressure = state.vario_uncompensated_pressure;
+  speed_compensation_IAS = state.speed_compensation_IAS;
+  speed_compensation_GNSS = state.speed_compensation_GNSS;
+  vario_uncompensated_GNSS = state.vario_uncompensated_GNSS;
+  specific_energy = state.specific_energy;
+  speed_compensation_INS_GNSS_1 = state.speed_compensation_INS_GNSS_1;
+  speed_compensation_kalman_2 = state.speed_compensation_kalman_2;
+  speed_compensation_energy_3 = state.speed_compensation_energy_3;
+}
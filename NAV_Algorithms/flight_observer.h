@@ -35,36 +35,95 @@
 #include "windobserver.h"
 #include "NAV_tuning_parameters.h"
 #include "HP_LP_fusion.h"
+#include "configuration_snapshot.h"
 
 #if USE_HARDWARE_EEPROM	== 0
 #include "EEPROM_emulation.h"
 #endif
 
 #include "pt2.h"
+#include "pt2_cascade.h"
+#include "fir_decimator.h"
 #include "HP_LP_fusion.h"
 #include "delay_line.h"
 
+#if WIND_DECIMATION_ORDER > 2
+//! ROM design of the wind decimation filter
+constexpr cascade_coefficients_t<float, WIND_DECIMATION_ORDER / 2> WIND_DECIMATION_DESIGN
+  = design_butterworth<float, WIND_DECIMATION_ORDER>( FAST_SAMPLING_TIME);
+#elif WIND_DECIMATION_ORDER == 0
+//! ROM design of the wind decimation filter
+constexpr fir_coefficients_t<float, WIND_FIR_TAPS> WIND_DECIMATION_DESIGN
+  = design_fir_lowpass<float, WIND_FIR_TAPS>( WIND_FIR_CUTOFF);
+#endif
+
+//! tuning parameters of flight_observer_t
+class flight_observer_parameters_t
+{
+public:
+  flight_observer_parameters_t( const configuration_snapshot_t &configuration)
+  : vario_TC( configuration( VARIO_TC)),
+    vertical_energy_tuning_factor( configuration( VETF)),
+    fusioner_feedback( SPEED_COMPENSATION_FUSIONER_FEEDBACK),
+    INS_GNSS_blend( SPEED_COMPENSATION_INS_GNSS_BLEND)
+  {}
+
+  float vario_TC; 			//!< vario averager time constant / s
+  float vertical_energy_tuning_factor; 	//!< VETF
+  float fusioner_feedback; 		//!< HP / LP speed compensation fusion alpha
+  float INS_GNSS_blend; 		//!< weight of speed compensation 1, 1 - weight for speed compensation 2
+};
+
+//! all input data of flight_observer_t::update_every_10ms, can be recorded for later replay
+class flight_observer_input_t
+{
+public:
+  float3vector gnss_velocity;
+  float3vector gnss_acceleration;
+  float3vector ahrs_acceleration;
+  float3vector heading_vector;
+  float GNSS_altitude;
+  float pressure_altitude;
+  float TAS;
+  float IAS;
+  circle_state_t circle_state;
+  float3vector wind_average;
+  bool GNSS_fix_avaliable;
+};
+
 //! this class is responsible for all glider flight data
 class flight_observer_t
 {
 public:
-  flight_observer_t( void)
+  flight_observer_t( const configuration_snapshot_t &configuration)
+  : flight_observer_t( flight_observer_parameters_t( configuration))
+  {}
+
+  flight_observer_t( const flight_observer_parameters_t &parameters)
   :
-  vario_averager_pressure( FAST_SAMPLING_TIME / configuration( VARIO_TC)),
-  vario_averager_GNSS( FAST_SAMPLING_TIME / configuration( VARIO_TC)),
+#if WIND_DECIMATION_ORDER > 2 || WIND_DECIMATION_ORDER == 0
+  windspeed_decimator_100Hz_10Hz( WIND_DECIMATION_DESIGN),
+#else
   windspeed_decimator_100Hz_10Hz( FAST_SAMPLING_TIME),
+#endif
+  vario_averager_pressure( FAST_SAMPLING_TIME / parameters.vario_TC),
+  vario_averager_GNSS( FAST_SAMPLING_TIME / parameters.vario_TC),
   kinetic_energy_differentiator( 1.0f, FAST_SAMPLING_TIME),
-  speed_compensation_IAS( ZERO),
-  vario_uncompensated_GNSS( ZERO),
-  vario_uncompensated_pressure( ZERO),
   KalmanVario_GNSS( 0.0f, 0.0f, 0.0f, - GRAVITY),
   KalmanVario_pressure( 0.0f, 0.0f, 0.0f, - GRAVITY),
   specific_energy_differentiator( 1.0f, FAST_SAMPLING_TIME),
-  GNSS_INS_speedcomp_fusioner(SPEED_COMPENSATION_FUSIONER_FEEDBACK),
+  GNSS_INS_speedcomp_fusioner( parameters.fusioner_feedback),
+  vario_uncompensated_pressure( ZERO),
+  speed_compensation_IAS( ZERO),
+  speed_compensation_GNSS( 0.0F),
+  vario_uncompensated_GNSS( ZERO),
   specific_energy(0.0f),
-  vertical_energy_tuning_factor(configuration( VETF)),
-  speed_compensation_GNSS( 0.0F)
+  vertical_energy_tuning_factor( parameters.vertical_energy_tuning_factor),
+  INS_GNSS_blend( parameters.INS_GNSS_blend)
   {
+#if FAST_SAMPLING_FREQUENCY != 100
+    use_fast_sampling_gains();
+#endif
   };
 	void update_every_10ms
 	(
@@ -81,8 +140,18 @@ public:
 	    bool GNSS_fix_avaliable
 	);
 
+	void update_every_10ms( const flight_observer_input_t &in)
+	{
+	  update_every_10ms( in.gnss_velocity, in.gnss_acceleration, in.ahrs_acceleration, in.heading_vector,
+			     in.GNSS_altitude, in.pressure_altitude, in.TAS, in.IAS,
+			     in.circle_state, in.wind_average, in.GNSS_fix_avaliable);
+	}
+
 	void reset(float pressure_altitude, float GNSS_altitude);
 
+	//! restart the vario and wind filters without transient, e.g. after idle mode
+	void settle( void);
+
 	float get_pressure_altitude( void) const;
 
 	float get_speed_compensation( unsigned index) const
@@ -143,7 +212,17 @@ public:
 	}
 
 private:
+#if FAST_SAMPLING_FREQUENCY != 100
+	//! the ROM Kalman gains are designed for 100 Hz, compute gains for the fast sampling rate instead
+	void use_fast_sampling_gains( void);
+#endif
+#if WIND_DECIMATION_ORDER > 2
+	pt2_cascade<float3vector,float, WIND_DECIMATION_ORDER / 2> windspeed_decimator_100Hz_10Hz;
+#elif WIND_DECIMATION_ORDER == 0
+	fir_decimator<float3vector,float, WIND_FIR_TAPS, FAST_SLOW_DECIMATION> windspeed_decimator_100Hz_10Hz;
+#else
 	pt2<float3vector,float> windspeed_decimator_100Hz_10Hz;
+#endif
 
 	// filter systems for variometer
 	pt2<float,float> vario_averager_pressure;
@@ -163,10 +242,39 @@ private:
 	float vario_uncompensated_GNSS;
 	float specific_energy;
 	float vertical_energy_tuning_factor;
+	float INS_GNSS_blend;
 
 	float speed_compensation_INS_GNSS_1;
 	float speed_compensation_kalman_2;
 	float speed_compensation_energy_3;
+
+public:
+	//! dynamic state for checkpoints, the tuning parameters and gain sets are not part of it
+	class state_t
+	{
+	public:
+	  decltype( flight_observer_t::windspeed_decimator_100Hz_10Hz)::state_t windspeed_decimator_100Hz_10Hz;
+	  pt2<float,float>::state_t vario_averager_pressure;
+	  pt2<float,float>::state_t vario_averager_GNSS;
+	  differentiator<float,float>::state_t kinetic_energy_differentiator;
+	  KalmanVario_PVA_t::state_t KalmanVario_GNSS;
+	  KalmanVario_t::state_t KalmanVario_pressure;
+	  differentiator<float,float>::state_t specific_energy_differentiator;
+	  Kalman_V_A_Aoff_observer_t::state_t Kalman_v_a_observer_N;
+	  Kalman_V_A_Aoff_observer_t::state_t Kalman_v_a_observer_E;
+	  HP_LP_fusion <float, float>::state_t GNSS_INS_speedcomp_fusioner;
+	  float vario_uncompensated_pressure;
+	  float speed_compensation_IAS;
+	  float speed_compensation_GNSS;
+	  float vario_uncompensated_GNSS;
+	  float specific_energy;
+	  float speed_compensation_INS_GNSS_1;
+	  float speed_compensation_kalman_2;
+	  float speed_compensation_energy_3;
+	};
+
+	void save_state( state_t &state) const;
+	void restore_state( const state_t &state);
 };
 
 #endif /* FLIGHT_OBSERVER_H_ */
@@ -0,0 +1,108 @@
+/***********************************************************************//**
+ * @file		flight_observer_sweep.cpp
+ * @brief		parameter sweep for the flight observer on recorded flights
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+
+#include "flight_observer_sweep.h"
+
+#if UNIX == 1
+
+#include "replay_engine.h"
+#include "denormal.h"
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <thread>
+
+void flight_observer_sweep_t::record( const observations_type *observations, unsigned count,
+				      const configuration_snapshot_t &configuration)
+{
+#if REPLAY_FLUSH_DENORMALS
+  scoped_flush_denormals_t flush_denormals;
+#endif
+  replay_engine_t engine( configuration, false);
+  const flight_observer_input_t &input = engine.get_organizer().get_navigator().get_flight_observer_input();
+  output_data_t output;
+
+  inputs.reserve( inputs.size() + count);
+  for( unsigned i = 0; i < count; ++i)
+    {
+      engine.run( observations + i, &output, 1);
+      inputs.push_back( input);
+    }
+}
+
+float flight_observer_sweep_t::evaluate( const flight_observer_parameters_t &variant, unsigned begin, unsigned end) const
+{
+  end = std::min( end, (unsigned)inputs.size());
+  if( begin >= end)
+    return 0.0f;
+
+#if REPLAY_FLUSH_DENORMALS
+  scoped_flush_denormals_t flush_denormals;
+#endif
+
+  flight_observer_t observer( variant);
+  observer.reset( inputs[0].pressure_altitude, inputs[0].GNSS_altitude);
+
+  double sum = 0.0, sum_of_squares = 0.0;
+  for( unsigned i = 0; i < end; ++i)
+    {
+      observer.update_every_10ms( inputs[i]);
+      if( i >= begin)
+	{
+	  double vario = observer.get_vario_GNSS();
+	  sum += vario;
+	  sum_of_squares += vario * vario;
+	}
+    }
+
+  unsigned n = end - begin;
+  double variance = ( sum_of_squares - sum * sum / n) / n;
+  return (float)std::sqrt( std::max( variance, 0.0));
+}
+
+void flight_observer_sweep_t::evaluate( const flight_observer_parameters_t *variants, float *cost, unsigned number_of_variants,
+					unsigned begin, unsigned end, unsigned threads) const
+{
+  if( threads == 0)
+    threads = std::max( 1u, std::thread::hardware_concurrency());
+  threads = std::min( threads, number_of_variants);
+
+  std::atomic<unsigned> next_variant( 0);
+
+  auto worker = [&]( void)
+    {
+      for( unsigned i = next_variant++; i < number_of_variants; i = next_variant++)
+	cost[i] = evaluate( variants[i], begin, end);
+    };
+
+  std::vector<std::thread> pool;
+  for( unsigned i = 1; i < threads; ++i)
+    pool.emplace_back( worker);
+  worker(); // the calling thread takes part
+  for( std::thread &t : pool)
+    t.join();
+}
+
+#endif
@@ -0,0 +1,90 @@
+/***********************************************************************//**
+ * @file		flight_observer_sweep.h
+ * @brief		parameter sweep for the flight observer on recorded flights
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+
+#ifndef FLIGHT_OBSERVER_SWEEP_H_
+#define FLIGHT_OBSERVER_SWEEP_H_
+
+#include "system_configuration.h"
+
+#if UNIX == 1 // host only
+
+#include "data_structures.h"
+#include "configuration_snapshot.h"
+#include "AHRS.h"
+#include "flight_observer.h"
+#include <vector>
+
+/**
+ * @brief run one recorded flight through many flight observer variants
+ *
+ * The complete algorithm chain is run once,
+ * the flight observer inputs (AHRS, GNSS, air data) are cached.
+ * Afterwards every variant only runs the flight observer on the cached inputs.
+ */
+class flight_observer_sweep_t
+{
+public:
+  //! replay the flight through the complete algorithm chain and cache the flight observer inputs
+  void record( const observations_type *observations, unsigned count,
+	       const configuration_snapshot_t &configuration = EEPROM_configuration());
+
+  //! append one cached input, e.g. from a different source
+  void record( const flight_observer_input_t &input)
+  {
+    inputs.push_back( input);
+  }
+
+  unsigned get_sample_count( void) const
+  {
+    return inputs.size();
+  }
+
+  //! the cached inputs, e.g. for flight_smoother_t
+  const flight_observer_input_t *get_inputs( void) const
+  {
+    return inputs.data();
+  }
+
+  /**
+   * @brief evaluate all variants
+   *
+   * cost[i] = standard deviation of the GNSS vario of variant i
+   * within the samples [begin, end), which shall be a still air segment
+   *
+   * @param threads number of worker threads, 0 = one per CPU core
+   */
+  void evaluate( const flight_observer_parameters_t *variants, float *cost, unsigned number_of_variants,
+		 unsigned begin, unsigned end, unsigned threads = 0) const;
+
+  //! cost of one variant, see evaluate()
+  float evaluate( const flight_observer_parameters_t &variant, unsigned begin, unsigned end) const;
+
+private:
+  std::vector<flight_observer_input_t> inputs;
+};
+
+#endif
+
+#endif /* FLIGHT_OBSERVER_SWEEP_H_ */
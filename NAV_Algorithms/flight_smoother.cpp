@@ -0,0 +1,190 @@
+/***********************************************************************//**
+ * @file		flight_smoother.cpp
+ * @brief		forward-backward (RTS) smoother for post-flight reprocessing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "flight_smoother.h"
+
+#if UNIX == 1
+
+#include "Kalman_gain_solver.h"
+#include "denormal.h"
+
+flight_smoother_t::flight_smoother_t( const flight_smoother_parameters_t &p)
+  : valid( false),
+    samples( 0)
+{
+  const float T = p.sampling_time;
+
+  if( pressure_gain.compute( T, p.pressure_vario[0], p.pressure_vario[1], p.pressure_vario[2], p.pressure_vario[3],
+			     pressure_smoother.J))
+    return;
+  if( GNSS_gain.compute( T, p.GNSS_vario[0], p.GNSS_vario[1], p.GNSS_vario[2], p.GNSS_vario[3], p.GNSS_vario[4],
+			 GNSS_smoother.J))
+    return;
+  if( air_velocity_gain.compute( T, p.air_velocity[0], p.air_velocity[1], p.air_velocity[2], p.air_velocity[3],
+				 air_velocity_smoother.J))
+    return;
+
+  // instant wind: random walk observed with white noise
+  const double A[1][1] = {{ 1.0 }};
+  const double C[1][1] = {{ 1.0 }};
+  const double Q[1][1] = {{ p.wind_process_variance * T }};
+  const double R[1][1] = {{ p.wind_measurement_variance }};
+  double P[1][1];
+  float K[1][1];
+  if( solve_steady_state_Kalman_filter<1,1>( A, C, Q, R, K, P))
+    return;
+  if( solve_steady_state_smoother_gain<1>( A, Q, P, wind_smoother.J))
+    return;
+  wind_gain = K[0][0];
+
+  // system matrices as used by the update() functions
+  for( unsigned i = 0; i < 4; ++i)
+    for( unsigned j = 0; j < 4; ++j)
+      pressure_smoother.A[i][j] = GNSS_smoother.A[i][j] = i == j ? 1.0f : 0.0f;
+  pressure_smoother.A[0][1] = GNSS_smoother.A[0][1] = T;
+  pressure_smoother.A[0][2] = GNSS_smoother.A[0][2] = T * T / 2.0f;
+  pressure_smoother.A[1][2] = GNSS_smoother.A[1][2] = T;
+
+  for( unsigned i = 0; i < 3; ++i)
+    for( unsigned j = 0; j < 3; ++j)
+      air_velocity_smoother.A[i][j] = i == j ? 1.0f : 0.0f;
+  air_velocity_smoother.A[0][1] = T;
+
+  wind_smoother.A[0][0] = 1.0f;
+  valid = true;
+}
+
+void flight_smoother_t::process( const flight_observer_input_t *inputs, unsigned count, bool smooth)
+{
+  samples = count;
+  data.resize( (size_t)CHANNELS * count);
+  if( ! valid || count == 0)
+    return;
+
+#if REPLAY_FLUSH_DENORMALS
+  scoped_flush_denormals_t flush_denormals;
+#endif
+
+  forward( inputs);
+  if( smooth)
+    backward( inputs);
+}
+
+//! one pass over the recorded inputs, all filters, like flight_observer_t::update_every_10ms()
+void flight_smoother_t::forward( const flight_observer_input_t *inputs)
+{
+  KalmanVario_t pressure( 0.0f, 0.0f, 0.0f, - GRAVITY, pressure_gain);
+  KalmanVario_PVA_t GNSS( 0.0f, 0.0f, 0.0f, - GRAVITY, GNSS_gain);
+  Kalman_V_A_Aoff_observer_t north( ZERO, ZERO, air_velocity_gain);
+  Kalman_V_A_Aoff_observer_t east(  ZERO, ZERO, air_velocity_gain);
+  pressure.reset( inputs[0].pressure_altitude, -9.81f);
+  GNSS.reset( inputs[0].GNSS_altitude, -9.81f);
+
+  const float T = GNSS_smoother.A[0][1]; // sampling time
+  float wind[2] = { 0.0f, 0.0f};
+  bool wind_initialized = false;
+
+  float *x[CHANNELS];
+  for( unsigned c = 0; c < CHANNELS; ++c)
+    x[c] = channel( c);
+
+  for( unsigned k = 0; k < samples; ++k)
+    {
+      const flight_observer_input_t &in = inputs[k];
+
+      pressure.update( in.pressure_altitude, in.ahrs_acceleration.e[DOWN]);
+
+      if( in.GNSS_fix_avaliable)
+	{
+	  GNSS.update( in.GNSS_altitude, in.gnss_velocity.e[DOWN], in.ahrs_acceleration.e[DOWN]);
+	  north.update( in.gnss_velocity.e[NORTH] - in.wind_average.e[NORTH], in.ahrs_acceleration.e[NORTH]);
+	  east.update(  in.gnss_velocity.e[EAST]  - in.wind_average.e[EAST],  in.ahrs_acceleration.e[EAST]);
+
+	  for( unsigned i = NORTH; i <= EAST; ++i)
+	    {
+	      float instant_wind = in.gnss_velocity.e[i] - in.heading_vector.e[i] * in.TAS;
+	      wind[i] = wind_initialized ? wind[i] + wind_gain * ( instant_wind - wind[i]) : instant_wind;
+	    }
+	  wind_initialized = true;
+	}
+      else // coast on the acceleration: measurement = prediction, no innovation but on the acceleration
+	{
+	  typedef KalmanVario_PVA_t V;
+	  typedef Kalman_V_A_Aoff_observer_t O;
+	  GNSS.update( GNSS.get_x( V::ALTITUDE) + T * GNSS.get_x( V::VARIO) + T * T / 2.0f * GNSS.get_x( V::ACCELERATION_OBSERVED),
+		       GNSS.get_x( V::VARIO) + T * GNSS.get_x( V::ACCELERATION_OBSERVED),
+		       in.ahrs_acceleration.e[DOWN]);
+	  north.update( north.get_x( O::VELOCITY) + T * north.get_x( O::ACCELERATION), in.ahrs_acceleration.e[NORTH]);
+	  east.update(  east.get_x( O::VELOCITY)  + T * east.get_x( O::ACCELERATION),  in.ahrs_acceleration.e[EAST]);
+	}
+
+      for( unsigned i = 0; i < 4; ++i)
+	{
+	  x[PRESSURE_ALTITUDE + i][k] = pressure.get_x( (KalmanVario_t::state)i);
+	  x[GNSS_ALTITUDE + i][k]     = GNSS.get_x( (KalmanVario_PVA_t::state)i);
+	}
+      for( unsigned i = 0; i < 3; ++i)
+	{
+	  x[AIR_VELOCITY_NORTH + i][k] = north.get_x( (Kalman_V_A_Aoff_observer_t::state)i);
+	  x[AIR_VELOCITY_EAST  + i][k] = east.get_x(  (Kalman_V_A_Aoff_observer_t::state)i);
+	}
+      x[WIND_NORTH][k] = wind[NORTH];
+      x[WIND_EAST][k]  = wind[EAST];
+    }
+}
+
+//! RTS pass per filter, the wind per segment with fix
+void flight_smoother_t::backward( const flight_observer_input_t *inputs)
+{
+  float * const pressure[4] = { channel( PRESSURE_ALTITUDE), channel( PRESSURE_VARIO),
+				channel( PRESSURE_ACCELERATION), channel( PRESSURE_ACCELERATION_OFFSET)};
+  float * const GNSS[4] = { channel( GNSS_ALTITUDE), channel( GNSS_VARIO),
+			    channel( GNSS_ACCELERATION), channel( GNSS_ACCELERATION_OFFSET)};
+  float * const north[3] = { channel( AIR_VELOCITY_NORTH), channel( AIR_ACCELERATION_NORTH), channel( AIR_ACCELERATION_OFFSET_NORTH)};
+  float * const east[3]  = { channel( AIR_VELOCITY_EAST),  channel( AIR_ACCELERATION_EAST),  channel( AIR_ACCELERATION_OFFSET_EAST)};
+  float * const wind_north[1] = { channel( WIND_NORTH)};
+  float * const wind_east[1]  = { channel( WIND_EAST)};
+
+  // the GNSS and air velocity filters coast through outages: one pass over the whole flight
+  pressure_smoother.run( pressure, 0, samples);
+  GNSS_smoother.run( GNSS, 0, samples);
+  air_velocity_smoother.run( north, 0, samples);
+  air_velocity_smoother.run( east, 0, samples);
+
+  unsigned begin = 0;
+  while( begin < samples)
+    {
+      while( begin < samples && ! inputs[begin].GNSS_fix_avaliable)
+	++begin;
+      unsigned end = begin;
+      while( end < samples && inputs[end].GNSS_fix_avaliable)
+	++end;
+
+      wind_smoother.run( wind_north, begin, end);
+      wind_smoother.run( wind_east, begin, end);
+      begin = end;
+    }
+}
+
+#endif
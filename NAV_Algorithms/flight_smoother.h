@@ -0,0 +1,176 @@
+/***********************************************************************//**
+ * @file		flight_smoother.h
+ * @brief		forward-backward (RTS) smoother for post-flight reprocessing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef FLIGHT_SMOOTHER_H_
+#define FLIGHT_SMOOTHER_H_
+
+#include "system_configuration.h"
+
+#if UNIX == 1 // host only
+
+#include "flight_observer.h"
+#include "KalmanVario.h"
+#include "KalmanVario_PVA.h"
+#include "Kalman_V_A_Aoff_observer.h"
+#include <vector>
+
+/**
+ * @brief steady-state Rauch-Tung-Striebel backward pass
+ *
+ * States are stored component-wise, x[i][k] = component i of sample k.
+ * On entry the arrays hold the filtered states, on exit the smoothed states.
+ */
+template <unsigned N> class RTS_backward_pass_t
+{
+public:
+  float A[N][N]; //!< system matrix
+  float J[N][N]; //!< smoother gain
+
+  //! smooth samples [begin, end) in place, the last sample keeps the filtered state
+  void run( float * const x[N], unsigned begin, unsigned end) const
+  {
+    if( end - begin < 2)
+      return;
+
+    float next[N]; // smoothed state k+1
+    for( unsigned i = 0; i < N; ++i)
+      next[i] = x[i][end - 1];
+
+    for( unsigned k = end - 1; k-- > begin; )
+      {
+	float filtered[N], difference[N];
+	for( unsigned i = 0; i < N; ++i)
+	  filtered[i] = x[i][k];
+	for( unsigned i = 0; i < N; ++i)
+	  {
+	    float predicted = 0.0f;
+	    for( unsigned j = 0; j < N; ++j)
+	      predicted += A[i][j] * filtered[j];
+	    difference[i] = next[i] - predicted;
+	  }
+	for( unsigned i = 0; i < N; ++i)
+	  {
+	    float smoothed = filtered[i];
+	    for( unsigned j = 0; j < N; ++j)
+	      smoothed += J[i][j] * difference[j];
+	    next[i] = x[i][k] = smoothed;
+	  }
+      }
+  }
+};
+
+//! noise parameters, defaults reproduce the 100 Hz ROM gains, see flight_observer.cpp
+class flight_smoother_parameters_t
+{
+public:
+  flight_smoother_parameters_t( void)
+    : sampling_time( FAST_SAMPLING_TIME),
+      pressure_vario { 1.0f / 9.0f, 1e-6f, 1.0f / 144.0f, 0.01f},
+      GNSS_vario { 1.0f, 1e-4f, 0.01f, 0.0225f, 0.01f},
+      air_velocity { 9.0f, 1e-4f, 0.01f, 0.01f},
+      wind_process_variance( 0.01f),
+      wind_measurement_variance( 1.0f)
+  {}
+
+  float sampling_time;
+  float pressure_vario[4];	//!< see KalmanVario_gain_t::compute()
+  float GNSS_vario[5];		//!< see KalmanVario_PVA_gain_t::compute()
+  float air_velocity[4];	//!< see Kalman_V_A_Aoff_gain_t::compute()
+  float wind_process_variance; 	//!< (m/s)^2/s, random walk of the instant wind
+  float wind_measurement_variance; //!< (m/s)^2, GNSS velocity - TAS * heading
+};
+
+/**
+ * @brief zero-lag estimates for a complete recorded flight
+ *
+ * The vario, air velocity and wind filters of the flight observer run forward
+ * over all samples in one pass, the states are stored in one array per component.
+ * A backward RTS pass per filter turns them into smoothed estimates.
+ * Without GNSS fix the GNSS vario and air velocity filters coast on the acceleration,
+ * the wind estimate holds and each wind segment with fix is smoothed on its own.
+ *
+ * Sign conventions are the ones of the filter states: NED, altitude negative.
+ */
+class flight_smoother_t
+{
+public:
+  enum channel_t
+  {
+    PRESSURE_ALTITUDE, PRESSURE_VARIO, PRESSURE_ACCELERATION, PRESSURE_ACCELERATION_OFFSET,
+    GNSS_ALTITUDE, GNSS_VARIO, GNSS_ACCELERATION, GNSS_ACCELERATION_OFFSET,
+    AIR_VELOCITY_NORTH, AIR_ACCELERATION_NORTH, AIR_ACCELERATION_OFFSET_NORTH,
+    AIR_VELOCITY_EAST,  AIR_ACCELERATION_EAST,  AIR_ACCELERATION_OFFSET_EAST,
+    WIND_NORTH, WIND_EAST,
+    CHANNELS
+  };
+
+  flight_smoother_t( const flight_smoother_parameters_t &parameters = flight_smoother_parameters_t());
+
+  //! false if the gains could not be computed from the parameters
+  bool is_valid( void) const
+  {
+    return valid;
+  }
+
+  /**
+   * @brief forward and backward pass over a complete flight
+   * @param smooth false: forward pass only, the causal estimates
+   */
+  void process( const flight_observer_input_t *inputs, unsigned count, bool smooth = true);
+
+  const float *get( channel_t channel) const
+  {
+    return &data[ channel * samples];
+  }
+
+  unsigned get_sample_count( void) const
+  {
+    return samples;
+  }
+
+private:
+  void forward( const flight_observer_input_t *inputs);
+  void backward( const flight_observer_input_t *inputs);
+
+  float *channel( unsigned index)
+  {
+    return &data[ index * samples];
+  }
+
+  KalmanVario_gain_t pressure_gain;
+  KalmanVario_PVA_gain_t GNSS_gain;
+  Kalman_V_A_Aoff_gain_t air_velocity_gain;
+  float wind_gain;
+  RTS_backward_pass_t<4> pressure_smoother;
+  RTS_backward_pass_t<4> GNSS_smoother;
+  RTS_backward_pass_t<3> air_velocity_smoother;
+  RTS_backward_pass_t<1> wind_smoother;
+  bool valid;
+  unsigned samples;
+  std::vector<float> data; //!< CHANNELS arrays of samples values
+};
+
+#endif
+
+#endif /* FLIGHT_SMOOTHER_H_ */
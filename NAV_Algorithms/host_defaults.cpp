@@ -0,0 +1,70 @@
+/***********************************************************************//**
+ * @file		host_defaults.cpp
+ * @brief		host implementations of the platform hooks for stand-alone replay libraries
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "system_configuration.h"
+
+#if UNIX == 1
+
+/*
+ * The firmware and the host applications provide the EEPROM, CAN and
+ * system state hooks themselves. The replay library and the benchmarks
+ * have no such platform: the EEPROM reads the PERSISTENT_DATA defaults,
+ * writes and reports are dropped. Weak, so that a host application
+ * linking these sources keeps its own implementations.
+ */
+
+#include "persistent_data.h"
+#include "magnetic_induction_report.h"
+#include "generic_CAN_driver.h"
+
+__attribute__((weak)) uint32_t system_state;
+
+__attribute__((weak)) bool EEPROM_initialize( void)
+{
+  return false;
+}
+
+__attribute__((weak)) bool read_EEPROM_value( EEPROM_PARAMETER_ID id, float &value)
+{
+  const persistent_data_t *parameter = find_parameter_from_ID( id);
+  if( parameter == 0)
+    return true;
+  value = parameter->default_value;
+  return false;
+}
+
+__attribute__((weak)) bool write_EEPROM_value( EEPROM_PARAMETER_ID, float)
+{
+  return false;
+}
+
+__attribute__((weak)) void report_magnetic_calibration_has_changed( magnetic_induction_report_t *, char)
+{}
+
+__attribute__((weak)) bool CAN_send( const CANpacket &, unsigned)
+{
+  return true;
+}
+
+#endif
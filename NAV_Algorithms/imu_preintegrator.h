@@ -0,0 +1,139 @@
+/***********************************************************************//**
+ * @file		imu_preintegrator.h
+ * @brief		coning / sculling compensated IMU pre-integration
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef IMU_PREINTEGRATOR_H_
+#define IMU_PREINTEGRATOR_H_
+
+#include "float3vector.h"
+
+/**
+ * @brief accumulates high-rate gyro and accelerometer samples into increments
+ *
+ * Recursive two-sample algorithms after P. Savage, Strapdown Inertial
+ * Navigation Integration Algorithm Design, JGCD 1998:
+ * the delta angle carries the coning correction,
+ * the delta velocity the rotation and sculling corrections.
+ * The increments are expressed in the body frame at the start of the interval.
+ * The IMU FIFO can be read in bursts, the AHRS runs once per interval.
+ */
+class imu_preintegrator_t
+{
+public:
+  imu_preintegrator_t( void)
+    : interval( 0.0f),
+      samples( 0)
+  {}
+
+  //! add one sample: angular rate / rad/s, specific force / m/s^2, sample time / s
+  void add_sample( const float3vector &gyro, const float3vector &acc, float dt)
+  {
+    float3vector delta_alpha = gyro * dt;
+    float3vector delta_nu    = acc * dt;
+
+    // ( alpha_{l-1} + 1/6 delta_alpha_{l-1}), same for the velocity
+    float3vector alpha_mid = alpha;
+    alpha_mid.axpy( 1.0f / 6.0f, last_delta_alpha);
+    float3vector nu_mid = nu;
+    nu_mid.axpy( 1.0f / 6.0f, last_delta_nu);
+
+    coning.axpy(   0.5f, alpha_mid.vector_multiply( delta_alpha));
+    sculling.axpy( 0.5f, alpha_mid.vector_multiply( delta_nu) + nu_mid.vector_multiply( delta_alpha));
+
+    alpha += delta_alpha;
+    nu    += delta_nu;
+    last_delta_alpha = delta_alpha;
+    last_delta_nu    = delta_nu;
+    interval += dt;
+    ++samples;
+  }
+
+  //! add a FIFO burst sampled at a fixed rate
+  void add_samples( const float3vector *gyro, const float3vector *acc, unsigned count, float dt)
+  {
+    for( unsigned i = 0; i < count; ++i)
+      add_sample( gyro[i], acc[i], dt);
+  }
+
+  //! rotation vector of the interval / rad
+  float3vector get_delta_angle( void) const
+  {
+    return alpha + coning;
+  }
+
+  //! velocity increment of the interval / m/s, start-of-interval body frame
+  float3vector get_delta_velocity( void) const
+  {
+    float3vector rotation = alpha.vector_multiply( nu);
+    float3vector retv = nu + sculling;
+    retv.axpy( 0.5f, rotation);
+    return retv;
+  }
+
+  //! rate that rotates by the compensated delta angle within get_interval(), not the AHRS tick
+  float3vector get_mean_rate( void) const
+  {
+    return get_delta_angle() * ( 1.0f / interval);
+  }
+
+  //! mean specific force, rotated into the body frame at the end of the interval
+  float3vector get_mean_specific_force( void) const
+  {
+    float3vector delta_v = get_delta_velocity();
+    float3vector retv = delta_v - get_delta_angle().vector_multiply( delta_v);
+    return retv * ( 1.0f / interval);
+  }
+
+  float get_interval( void) const
+  {
+    return interval;
+  }
+
+  unsigned get_sample_count( void) const
+  {
+    return samples;
+  }
+
+  //! start the next interval, the last increment is kept for the 1/6 correction
+  void reset( void)
+  {
+    alpha.zero();
+    coning.zero();
+    nu.zero();
+    sculling.zero();
+    interval = 0.0f;
+    samples = 0;
+  }
+
+private:
+  float3vector alpha;		 //!< sum of the angle increments
+  float3vector coning;		 //!< coning correction
+  float3vector nu;		 //!< sum of the velocity increments
+  float3vector sculling;	 //!< sculling correction
+  float3vector last_delta_alpha; //!< previous angle increment
+  float3vector last_delta_nu;	 //!< previous velocity increment
+  float interval; 		 //!< accumulated sample time
+  unsigned samples;
+};
+
+#endif /* IMU_PREINTEGRATOR_H_ */
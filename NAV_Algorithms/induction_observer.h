@@ -10,7 +10,7 @@
 #include "mean_and_variance_finder.h"
 #include "float3vector.h"
 
-template <class sample_type> class induction_observer_t
+template <class sample_type, class finder_type = mean_and_variance_finder_t <sample_type> > class induction_observer_t
 {
 public:
   induction_observer_t( float _scale_factor)
@@ -57,11 +57,34 @@ public:
       }
     return sum * 0.1666666666f / scale_factor / scale_factor;
   }
+  //! dynamic state for checkpoints, the scale factor is not part of it
+  class state_t
+  {
+  public:
+    finder_type induction_observer_right[3];
+    finder_type induction_observer_left[3];
+  };
+  void save_state( state_t &state) const
+  {
+    for( unsigned i=0; i<3; ++i)
+      {
+	state.induction_observer_right[i] = induction_observer_right[i];
+	state.induction_observer_left[i] = induction_observer_left[i];
+      }
+  }
+  void restore_state( const state_t &state)
+  {
+    for( unsigned i=0; i<3; ++i)
+      {
+	induction_observer_right[i] = state.induction_observer_right[i];
+	induction_observer_left[i] = state.induction_observer_left[i];
+      }
+  }
 private:
   enum{ MINIMUM_SAMPLES = 10000};
   float scale_factor;
-  mean_and_variance_finder_t <sample_type> induction_observer_right[3];
-  mean_and_variance_finder_t <sample_type> induction_observer_left[3];
+  finder_type induction_observer_right[3];
+  finder_type induction_observer_left[3];
 };
 
 #endif /* NAV_ALGORITHMS_INDUCTION_OBSERVER_H_ */
@@ -0,0 +1,183 @@
+/***********************************************************************//**
+ * @file		log_schema.h
+ * @brief		self-describing channel tables of the logged structures
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef LOG_SCHEMA_H_
+#define LOG_SCHEMA_H_
+
+#include "system_configuration.h"
+#include "data_structures.h"
+#include <stddef.h>
+
+//! channel data type, stored in the log header
+enum log_channel_type_t
+{
+  LOG_FLOAT, LOG_DOUBLE, LOG_UINT8, LOG_INT16, LOG_UINT16, LOG_INT32, LOG_UINT32
+};
+
+//! one column of a log: a scalar member of the logged record
+typedef struct
+{
+  const char *name; 	//!< member path within the record, e.g. "m.acc.e[0]"
+  uint16_t offset; 	//!< byte offset within the record
+  uint8_t type; 	//!< log_channel_type_t
+} log_channel_t;
+
+//! layout of one record type
+typedef struct
+{
+  const log_channel_t *channels;
+  uint16_t channel_count;
+  uint16_t record_size;
+} log_schema_t;
+
+// observations_type channels, CHANNEL( member, type), one table per configuration option
+
+#define LOG_VECTOR_CHANNELS( CHANNEL, vector) \
+  CHANNEL( vector.e[0], LOG_FLOAT) CHANNEL( vector.e[1], LOG_FLOAT) CHANNEL( vector.e[2], LOG_FLOAT)
+
+#define LOG_MEASUREMENT_CHANNELS( CHANNEL) \
+  LOG_VECTOR_CHANNELS( CHANNEL, m.acc) \
+  LOG_VECTOR_CHANNELS( CHANNEL, m.gyro) \
+  LOG_VECTOR_CHANNELS( CHANNEL, m.mag) \
+  CHANNEL( m.pitot_pressure, LOG_FLOAT) \
+  CHANNEL( m.static_pressure, LOG_FLOAT) \
+  CHANNEL( m.static_sensor_temperature, LOG_FLOAT) \
+  CHANNEL( m.supply_voltage, LOG_FLOAT)
+
+#if WITH_LOWCOST_SENSORS
+#define LOG_LOWCOST_CHANNELS( CHANNEL) \
+  LOG_VECTOR_CHANNELS( CHANNEL, m.lowcost_acc) \
+  LOG_VECTOR_CHANNELS( CHANNEL, m.lowcost_gyro) \
+  LOG_VECTOR_CHANNELS( CHANNEL, m.lowcost_mag) \
+  CHANNEL( m.absolute_pressure, LOG_FLOAT) \
+  CHANNEL( m.absolute_sensor_temperature, LOG_FLOAT)
+#else
+#define LOG_LOWCOST_CHANNELS( CHANNEL)
+#endif
+
+#if WITH_DENSITY_DATA
+#define LOG_DENSITY_CHANNELS( CHANNEL) \
+  CHANNEL( m.outside_air_temperature, LOG_FLOAT) \
+  CHANNEL( m.outside_air_humidity, LOG_FLOAT)
+#else
+#define LOG_DENSITY_CHANNELS( CHANNEL)
+#endif
+
+#define LOG_COORDINATES_CHANNELS( CHANNEL) \
+  LOG_VECTOR_CHANNELS( CHANNEL, c.position) \
+  LOG_VECTOR_CHANNELS( CHANNEL, c.velocity) \
+  LOG_VECTOR_CHANNELS( CHANNEL, c.acceleration) \
+  CHANNEL( c.heading_motion, LOG_FLOAT) \
+  CHANNEL( c.speed_motion, LOG_FLOAT) \
+  LOG_VECTOR_CHANNELS( CHANNEL, c.relPosNED) \
+  CHANNEL( c.relPosHeading, LOG_FLOAT) \
+  CHANNEL( c.speed_acc, LOG_FLOAT) \
+  CHANNEL( c.latitude, LOG_DOUBLE) \
+  CHANNEL( c.longitude, LOG_DOUBLE) \
+  CHANNEL( c.year, LOG_UINT8) \
+  CHANNEL( c.month, LOG_UINT8) \
+  CHANNEL( c.day, LOG_UINT8) \
+  CHANNEL( c.hour, LOG_UINT8) \
+  CHANNEL( c.minute, LOG_UINT8) \
+  CHANNEL( c.second, LOG_UINT8) \
+  CHANNEL( c.SATS_number, LOG_UINT8) \
+  CHANNEL( c.sat_fix_type, LOG_UINT8) \
+  CHANNEL( c.geo_sep_dm, LOG_INT16)
+
+#if INCLUDING_NANO
+#define LOG_NANO_CHANNELS( CHANNEL) \
+  CHANNEL( c.nano, LOG_INT32)
+#else
+#define LOG_NANO_CHANNELS( CHANNEL)
+#endif
+
+//! all channels of observations_type in the present build configuration
+#define LOG_OBSERVATION_CHANNELS( CHANNEL) \
+  LOG_MEASUREMENT_CHANNELS( CHANNEL) \
+  LOG_LOWCOST_CHANNELS( CHANNEL) \
+  LOG_DENSITY_CHANNELS( CHANNEL) \
+  LOG_COORDINATES_CHANNELS( CHANNEL) \
+  LOG_NANO_CHANNELS( CHANNEL)
+
+//! schema of observations_type as compiled
+extern const log_schema_t OBSERVATIONS_LOG_SCHEMA;
+
+// output_data_t results, diagnostics excluded
+
+#define LOG_QUATERNION_CHANNELS( CHANNEL, q) \
+  CHANNEL( q.e[0], LOG_FLOAT) CHANNEL( q.e[1], LOG_FLOAT) CHANNEL( q.e[2], LOG_FLOAT) CHANNEL( q.e[3], LOG_FLOAT)
+
+#define LOG_RESULT_CHANNELS( CHANNEL) \
+  CHANNEL( IAS, LOG_FLOAT) \
+  CHANNEL( TAS, LOG_FLOAT) \
+  CHANNEL( vario_uncompensated, LOG_FLOAT) \
+  CHANNEL( vario, LOG_FLOAT) \
+  CHANNEL( vario_pressure, LOG_FLOAT) \
+  CHANNEL( speed_compensation_TAS, LOG_FLOAT) \
+  CHANNEL( speed_compensation_GNSS, LOG_FLOAT) \
+  CHANNEL( integrator_vario, LOG_FLOAT) \
+  LOG_VECTOR_CHANNELS( CHANNEL, wind) \
+  LOG_VECTOR_CHANNELS( CHANNEL, wind_average) \
+  CHANNEL( circle_mode, LOG_UINT32) \
+  LOG_QUATERNION_CHANNELS( CHANNEL, q) \
+  CHANNEL( euler.r, LOG_FLOAT) \
+  CHANNEL( euler.n, LOG_FLOAT) \
+  CHANNEL( euler.y, LOG_FLOAT) \
+  CHANNEL( effective_vertical_acceleration, LOG_FLOAT) \
+  CHANNEL( turn_rate, LOG_FLOAT) \
+  CHANNEL( slip_angle, LOG_FLOAT) \
+  CHANNEL( nick_angle, LOG_FLOAT) \
+  CHANNEL( G_load, LOG_FLOAT) \
+  CHANNEL( pressure_altitude, LOG_FLOAT) \
+  CHANNEL( air_density, LOG_FLOAT) \
+  CHANNEL( magnetic_disturbance, LOG_FLOAT) \
+  LOG_VECTOR_CHANNELS( CHANNEL, nav_acceleration_gnss) \
+  LOG_VECTOR_CHANNELS( CHANNEL, nav_induction_gnss)
+
+//! all channels of output_data_t: observations + results
+#define LOG_OUTPUT_CHANNELS( CHANNEL) \
+  LOG_OBSERVATION_CHANNELS( CHANNEL) \
+  LOG_RESULT_CHANNELS( CHANNEL)
+
+//! schema of output_data_t as compiled
+extern const log_schema_t OUTPUT_LOG_SCHEMA;
+
+//! bytes of one value
+inline unsigned log_channel_size( uint8_t type)
+{
+  switch( type)
+  {
+    case LOG_DOUBLE:
+      return 8;
+    case LOG_UINT8:
+      return 1;
+    case LOG_INT16:
+    case LOG_UINT16:
+      return 2;
+    default:
+      return 4;
+  }
+}
+
+#endif /* LOG_SCHEMA_H_ */
@@ -0,0 +1,68 @@
+/***********************************************************************//**
+ * @file		mapped_log.cpp
+ * @brief		memory-mapped flight logs with typed record views
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "mapped_log.h"
+
+#if UNIX == 1
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool mapped_file_t::open( const char *path)
+{
+  close();
+
+  int fd = ::open( path, O_RDONLY);
+  if( fd < 0)
+    return true;
+
+  struct stat status;
+  if( fstat( fd, &status) != 0 || status.st_size == 0)
+    {
+      ::close( fd);
+      return true;
+    }
+
+  void *mapping = mmap( 0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close( fd); // the mapping keeps the file referenced
+  if( mapping == MAP_FAILED)
+    return true;
+
+  madvise( mapping, status.st_size, MADV_SEQUENTIAL); // replay reads front to back
+  data = (const uint8_t *)mapping;
+  size = status.st_size;
+  return false;
+}
+
+void mapped_file_t::close( void)
+{
+  if( data)
+    munmap( (void *)data, size);
+  data = 0;
+  size = 0;
+}
+
+#endif
@@ -0,0 +1,196 @@
+/***********************************************************************//**
+ * @file		mapped_log.h
+ * @brief		memory-mapped flight logs with typed record views
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef MAPPED_LOG_H_
+#define MAPPED_LOG_H_
+
+#include "system_configuration.h"
+
+#if UNIX == 1 // host only
+
+#include "data_structures.h"
+#include "old_data_structures.h"
+#include <stddef.h>
+
+//! read-only mapping of a complete file, the OS page cache does the I/O
+class mapped_file_t
+{
+public:
+  mapped_file_t( void)
+    : data( 0),
+      size( 0)
+  {}
+
+  ~mapped_file_t( void)
+  {
+    close();
+  }
+
+  //! map file, returns true on error
+  bool open( const char *path);
+  void close( void);
+
+  const uint8_t *get_data( void) const
+  {
+    return data;
+  }
+
+  size_t get_size( void) const
+  {
+    return size;
+  }
+
+private:
+  mapped_file_t( const mapped_file_t &); // not copyable
+  mapped_file_t & operator =( const mapped_file_t &);
+
+  const uint8_t *data;
+  size_t size;
+};
+
+/**
+ * @brief raw log of packed records seen as an array, nothing is copied
+ *
+ * A trailing incomplete record is ignored.
+ */
+template <class record_type> class mapped_record_view_t
+{
+public:
+  mapped_record_view_t( const mapped_file_t &file)
+    : records( (const record_type *)file.get_data()),
+      count( file.get_size() / sizeof( record_type))
+  {}
+
+  size_t get_count( void) const
+  {
+    return count;
+  }
+
+  const record_type &operator []( size_t index) const
+  {
+    return records[index];
+  }
+
+  const record_type *begin( void) const
+  {
+    return records;
+  }
+
+  const record_type *end( void) const
+  {
+    return records + count;
+  }
+
+private:
+  const record_type *records;
+  size_t count;
+};
+
+/**
+ * @brief log in the observations_record_t layout seen as observations_type
+ *
+ * Records are copied into the aligned layout by from_record() when they are accessed.
+ */
+class observations_view_t
+{
+public:
+  observations_view_t( const mapped_file_t &file)
+    : view( file)
+  {}
+
+  size_t get_count( void) const
+  {
+    return view.get_count();
+  }
+
+  void get( size_t index, observations_type &target) const
+  {
+    from_record( view[index], target);
+  }
+
+  //! copy up to count records starting at first, returns the number of records copied
+  unsigned get( size_t first, observations_type *target, unsigned count) const
+  {
+    if( first >= get_count())
+      return 0;
+    if( count > get_count() - first)
+      count = get_count() - first;
+    for( unsigned i = 0; i < count; ++i)
+      get( first + i, target[i]);
+    return count;
+  }
+
+private:
+  mapped_record_view_t<observations_record_t> view;
+};
+
+/**
+ * @brief historic log in the old_input_data_t layout seen as observations_type
+ *
+ * Records are translated by new_format_from_old() when they are accessed,
+ * members unknown to the old layout are zero.
+ */
+class legacy_observations_view_t
+{
+public:
+  legacy_observations_view_t( const mapped_file_t &file)
+    : view( file)
+  {}
+
+  size_t get_count( void) const
+  {
+    return view.get_count();
+  }
+
+  void get( size_t index, observations_type &target) const
+  {
+    target = observations_type();
+    new_format_from_old( target.m, target.c, view[index]);
+  }
+
+  //! translate up to count records starting at first, returns the number of records translated
+  unsigned get( size_t first, observations_type *target, unsigned count) const
+  {
+    if( first >= get_count())
+      return 0;
+    if( count > get_count() - first)
+      count = get_count() - first;
+    for( unsigned i = 0; i < count; ++i)
+      get( first + i, target[i]);
+    return count;
+  }
+
+  //! untranslated access
+  const old_input_data_t &operator []( size_t index) const
+  {
+    return view[index];
+  }
+
+private:
+  mapped_record_view_t<old_input_data_t> view;
+};
+
+#endif
+
+#endif /* MAPPED_LOG_H_ */
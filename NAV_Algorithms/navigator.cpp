@@ -23,47 +23,121 @@
  **************************************************************************/
 
 #include <navigator.h>
+#include "event_trace.h"
 
 // to be called at 100 Hz
 void navigator_t::update_every_10ms (
     const float3vector &acc,
     const float3vector &mag,
-    const float3vector &gyro)
+    const float3vector &gyro,
+    float sampling_time)
 {
-  wind_obsolete = true;
+  PROFILE_STAGE( profiling, PROFILE_NAVIGATOR_10MS);
 
-  ahrs.update( gyro, acc, mag,
-	    GNSS_acceleration,
-	    GNSS_heading,
-	    GNSS_fix_type == (SAT_FIX | SAT_HEADING));
+#if IDLE_DETECTION
+  if( activity_detector.is_idle())
+    {
+      update_idle( acc, mag, gyro, sampling_time);
+      return;
+    }
+#endif
 
-#if DEVELOPMENT_ADDITIONS
-  ahrs_magnetic.update_compass(
-	  gyro, acc, mag,
-	  GNSS_acceleration);
-#endif
-  float3vector heading_vector;
-  heading_vector[NORTH] = ahrs.get_north ();
-  heading_vector[EAST]  = ahrs.get_east  ();
-  heading_vector[DOWN]  = ahrs.get_down  (); // todo: do we need this one ?
-
-  flight_observer.update_every_10ms (
-      GNSS_velocity,
-      GNSS_acceleration,
-      ahrs.get_nav_acceleration (),
-      heading_vector,
-      GNSS_negative_altitude,
-      atmosphere.get_negative_altitude(),
-      TAS,
-      IAS,
-      ahrs.get_circling_state(),
-      wind_average_observer.get_value(),
-      (GNSS_fix_type != 0)
-      );
+    {
+      PROFILE_STAGE( profiling, PROFILE_AHRS);
+      ahrs.set_sampling_time( sampling_time);
+      ahrs.update( gyro, acc, mag,
+		GNSS_acceleration,
+		GNSS_heading,
+		GNSS_fix_type == (SAT_FIX | SAT_HEADING));
+    }
+
+#if GNSS_LATENCY_COMPENSATION
+  propagate_GNSS_data();
+#endif
+
+  if( shadow_count)
+    {
+      PROFILE_STAGE( profiling, PROFILE_SHADOW_ESTIMATORS);
+      shadow_input_t shadow_input = { acc, mag, gyro, GNSS_acceleration, GNSS_heading,
+				      GNSS_fix_type == (SAT_FIX | SAT_HEADING)};
+      for( unsigned i = 0; i < shadow_count; ++i)
+	shadow[i]->feed( shadow_input);
+    }
+  flight_observer_input_t &in = flight_observer_input;
+  in.gnss_velocity		= GNSS_velocity;
+  in.gnss_acceleration		= GNSS_acceleration;
+  in.ahrs_acceleration		= ahrs.get_nav_acceleration ();
+  in.heading_vector[NORTH]	= ahrs.get_north ();
+  in.heading_vector[EAST]	= ahrs.get_east  ();
+  in.heading_vector[DOWN]	= ahrs.get_down  (); // todo: do we need this one ?
+  in.GNSS_altitude		= GNSS_negative_altitude;
+  in.pressure_altitude		= atmosphere.get_negative_altitude();
+  in.TAS			= TAS;
+  in.IAS			= IAS;
+  in.circle_state		= ahrs.get_circling_state();
+  in.wind_average		= wind_average_observer.get_value();
+  in.GNSS_fix_avaliable		= (GNSS_fix_type != 0);
+
+  PROFILE_STAGE( profiling, PROFILE_FLIGHT_OBSERVER);
+  flight_observer.update_every_10ms ( in);
 }
 
 void navigator_t::update_GNSS_data( const coordinates_t &coordinates)
 {
+#if GNSS_LATENCY_COMPENSATION
+  update_GNSS_data( coordinates, GNSS_latency);
+}
+
+//! map into { -PI PI}
+static inline float wrap_angle( float angle)
+{
+  if( angle > M_PI_F)
+    angle -= 2.0f * M_PI_F;
+  if( angle < -M_PI_F)
+    angle += 2.0f * M_PI_F;
+  return angle;
+}
+
+void navigator_t::propagate_GNSS_data( void)
+{
+  IMU_history_entry_t entry;
+  entry.acceleration = ahrs.get_nav_acceleration();
+  entry.acceleration.e[DOWN] += GRAVITY;
+  entry.yaw = ahrs.get_yaw();
+  float yaw_change = wrap_angle( entry.yaw - IMU_history.getPreviousAt( 0).yaw);
+  IMU_history.pushValue( entry);
+
+  if( GNSS_fix_type == SAT_FIX_NONE)
+    return;
+
+  // the receiver has stopped delivering: hold the last values instead of integrating IMU drift
+  if( GNSS_samples_since_epoch >= GNSS_PROPAGATION_LIMIT)
+    return;
+  ++GNSS_samples_since_epoch;
+
+  // dead reckoning from the last GNSS solution
+  GNSS_velocity = GNSS_velocity + entry.acceleration * FAST_SAMPLING_TIME;
+  GNSS_acceleration = GNSS_acceleration_at_epoch + entry.acceleration - IMU_acceleration_at_epoch;
+  if( AHRS_type::heading_aiding_t::AVAILABLE) // single antenna images skip the D-GNSS heading
+    GNSS_heading = wrap_angle( GNSS_heading + yaw_change);
+}
+
+void navigator_t::update_GNSS_data( const coordinates_t &coordinates, float age)
+{
+  uint64_t epoch_key = ( ( ( (uint64_t)coordinates.day * 24 + coordinates.hour) * 60 + coordinates.minute) * 60 + coordinates.second) * 1000000000ull
+#if INCLUDING_NANO
+      + (uint32_t)coordinates.nano
+#endif
+      ;
+  // without time stamp every call is taken as a new solution
+  if( coordinates.sat_fix_type != SAT_FIX_NONE && epoch_key != 0 && epoch_key == GNSS_epoch_key)
+    return; // same solution again, keep propagating
+  GNSS_epoch_key = epoch_key;
+  GNSS_samples_since_epoch = 0;
+#endif
+
+  if( coordinates.sat_fix_type != GNSS_fix_type)
+    TRACE_EVENT( TRACE_GNSS_FIX, GNSS_fix_type, coordinates.sat_fix_type);
   GNSS_fix_type = coordinates.sat_fix_type;
 
   if (coordinates.sat_fix_type == SAT_FIX_NONE) // presently no GNSS fix
@@ -81,22 +155,147 @@ void navigator_t::update_GNSS_data( const coordinates_t &coordinates)
       GNSS_heading = coordinates.relPosHeading;
       GNSS_negative_altitude = coordinates.position.e[DOWN];
       GNSS_speed = coordinates.speed_motion;
+
+#if GNSS_LATENCY_COMPENSATION
+      // match the IMU state of the GNSS epoch and propagate to the present sample
+      unsigned delay = (unsigned)( age * FAST_SAMPLING_FREQUENCY + 0.5f);
+      if( delay > GNSS_HISTORY_LENGTH - 1)
+	delay = GNSS_HISTORY_LENGTH - 1;
+
+      const IMU_history_entry_t *window = IMU_history.getWindow( delay);
+      for( unsigned i = 0; i < delay; ++i)
+	GNSS_velocity = GNSS_velocity + window[i].acceleration * FAST_SAMPLING_TIME;
+
+      const IMU_history_entry_t &at_epoch = IMU_history.getPreviousAt( delay);
+      const IMU_history_entry_t &now = IMU_history.getPreviousAt( 0);
+      GNSS_acceleration_at_epoch = coordinates.acceleration;
+      IMU_acceleration_at_epoch = at_epoch.acceleration;
+      GNSS_acceleration = GNSS_acceleration_at_epoch + now.acceleration - IMU_acceleration_at_epoch;
+      if( AHRS_type::heading_aiding_t::AVAILABLE && ( coordinates.sat_fix_type & SAT_HEADING))
+	GNSS_heading = wrap_angle( GNSS_heading + wrap_angle( now.yaw - at_epoch.yaw));
+#endif
     }
 }
 
+#if IDLE_DETECTION
+//! AHRS at reduced rate on averaged IMU data, ground compass calibration
+void navigator_t::update_idle( const float3vector &acc, const float3vector &mag, const float3vector &gyro, float sampling_time)
+{
+  idle_acc_sum  += acc;
+  idle_mag_sum  += mag;
+  idle_gyro_sum += gyro * sampling_time;
+  idle_interval += sampling_time;
+  if( ++idle_sample_count < IDLE_DECIMATION)
+    return;
+
+  const float scale = 1.0f / IDLE_DECIMATION;
+  float3vector mean_mag = idle_mag_sum * scale;
+    {
+      PROFILE_STAGE( profiling, PROFILE_AHRS);
+      ahrs.set_sampling_time( idle_interval);
+      ahrs.update( idle_gyro_sum * ( 1.0f / idle_interval), idle_acc_sum * scale, mean_mag,
+		GNSS_acceleration,
+		GNSS_heading,
+		GNSS_fix_type == (SAT_FIX | SAT_HEADING));
+    }
+  compass_ground_calibration.feed( mean_mag);
+
+  idle_acc_sum = idle_mag_sum = idle_gyro_sum = {0};
+  idle_interval = 0.0f;
+  idle_sample_count = 0;
+}
+
+void navigator_t::enter_idle( void)
+{
+  ahrs.set_decimation( IDLE_DECIMATION);
+  idle_acc_sum = idle_mag_sum = idle_gyro_sum = {0};
+  idle_interval = 0.0f;
+  idle_sample_count = 0;
+}
+
+//! seamless return to full rate: filters restart from the present state
+void navigator_t::leave_idle( void)
+{
+  ahrs.set_decimation( 1);
+  reset_altitude();
+  flight_observer.settle();
+  instant_wind_averager.settle( instant_wind_averager.get_output());
+  wind_average_observer.reset( wind_average_observer.get_value());
+}
+#endif
+
 // to be called at 10 Hz
 void navigator_t::update_every_100ms (const coordinates_t &coordinates)
+{
+  PROFILE_STAGE( profiling, PROFILE_NAVIGATOR_100MS);
+
+  if( update_activity())
+    return; // vario, wind and density suspended
+
+  update_density();
+  update_wind();
+  update_averagers();
+}
+
+#if TICK_SCHEDULER
+//! one phase of the 10 Hz work, slot 0 .. FAST_SLOW_DECIMATION - 1
+void navigator_t::update_tick_slot( unsigned slot)
+{
+  PROFILE_STAGE( profiling, PROFILE_NAVIGATOR_100MS);
+
+  switch( slot)
+  {
+    case TICK_SLOT_ACTIVITY:
+      update_activity();
+      break;
+    case TICK_SLOT_WIND:
+      if( ! is_suspended())
+	update_wind();
+      break;
+    case TICK_SLOT_AVERAGERS:
+      if( ! is_suspended())
+	update_averagers();
+      break;
+    case TICK_SLOT_DENSITY:
+      if( ! is_suspended())
+	update_density();
+      break;
+    default:
+      break;
+  }
+}
+#endif
+
+//! returns true if vario, wind and density are suspended
+bool navigator_t::update_activity( void)
+{
+#if IDLE_DETECTION
+  if( activity_detector.update( TAS, GNSS_speed, ahrs.get_G_load(), ahrs.get_turn_rate()))
+    {
+      if( activity_detector.is_idle())
+	enter_idle();
+      else
+	leave_idle();
+    }
+#endif
+  return is_suspended();
+}
+
+void navigator_t::update_density( void)
 {
   atmosphere.feed_QFF_density_metering(
 	air_pressure_resampler_100Hz_10Hz.get_output(),
 	flight_observer.get_filtered_GNSS_altitude());
 
   atmosphere.update_density_correction(); // here because of the 10 Hz call frequency
+}
 
+void navigator_t::update_wind( void)
+{
   instant_wind_averager.respond( flight_observer.get_instant_wind());
 
   wind_average_observer.update( flight_observer.get_instant_wind(), // do this here because of the update rate 10Hz
-				ahrs.get_euler ().y,
+				ahrs.get_yaw (),
 				ahrs.get_circling_state ());
 
   float3vector relative_wind_NAV  = flight_observer.get_instant_wind() - wind_average_observer.get_value();
@@ -105,7 +304,14 @@ void navigator_t::update_every_100ms (const coordinates_t &coordinates)
   if( ahrs.get_circling_state () == STRAIGHT_FLIGHT && old_circling_state == TRANSITION)
     relative_wind_observer.reset({0});
   else
-    relative_wind_observer.update(relative_wind_BODY, ahrs.get_euler ().y, ahrs.get_circling_state ());
+    relative_wind_observer.update(relative_wind_BODY, ahrs.get_yaw (), ahrs.get_circling_state ());
+
+#if CIRCLE_FIT_WIND
+  if( ahrs.get_circling_state () == TRANSITION && old_circling_state == STRAIGHT_FLIGHT) // turn may be starting
+    circle_wind_fit.reset( wind_average_observer.get_value(), ahrs.get_yaw ());
+  if( ahrs.get_circling_state () != STRAIGHT_FLIGHT && circle_wind_fit.get_turn() < CIRCLE_FIT_HANDOVER_TURN)
+    circle_wind_fit.update( GNSS_velocity, ahrs.get_yaw ());
+#endif
 
   if(( ahrs.get_circling_state () == CIRCLING))
     {
@@ -119,87 +325,224 @@ void navigator_t::update_every_100ms (const coordinates_t &coordinates)
   float3vector wind_correction_nav = ahrs.get_body2nav() * relative_wind_observer.get_value();
   wind_correction_nav.e[DOWN]=0.0f;
 
-  corrected_wind_averager.respond( flight_observer.get_instant_wind() - wind_correction_nav);
-  circling_wind_averager.update( flight_observer.get_instant_wind() - wind_correction_nav);
+  float3vector corrected_wind = flight_observer.get_instant_wind() - wind_correction_nav;
+  corrected_wind_averager.respond( corrected_wind);
+  circling_wind_averager.update( corrected_wind);
+}
 
+//! after update_wind()
+void navigator_t::update_averagers( void)
+{
   vario_integrator.update (flight_observer.get_vario_GNSS(), // here because of the update rate 10Hz
-			   ahrs.get_euler ().y,
+			   ahrs.get_yaw (),
 			   ahrs.get_circling_state ());
 
   old_circling_state = ahrs.get_circling_state ();
-  wind_obsolete = false;
+
+  // reported wind smoothening to avoid hard changes during transitions
+  last_wind = last_wind * 0.95f + report_instant_wind() * 0.05f;
+  last_wind_average = last_wind_average * 0.95f + report_average_wind() * 0.05f;
+#if DEVELOPMENT_ADDITIONS
+  last_headwind  = get_relative_wind().e[FRONT];
+  last_crosswind = get_relative_wind().e[RIGHT];
+#endif
 }
 
 //! copy all navigator data into output_data structure
-void navigator_t::report_data( output_data_t &d)
+uint32_t navigator_t::get_due_output_fields( void)
 {
-    d.TAS 			= TAS_averager.get_output();
-    d.IAS 			= IAS_averager.get_output();
+  if( subscription_count == 0)
+    return OUTPUT_ALL;
 
-    d.euler			= ahrs.get_euler();
-    d.q				= ahrs.get_attitude();
+  uint32_t fields = 0;
+  for( unsigned i = 0; i < subscription_count; ++i)
+    {
+      output_subscription_t &s = subscription[i];
+      if( s.countdown == 0)
+	{
+	  fields |= s.fields;
+	  s.countdown = s.divider;
+	}
+      --s.countdown;
+    }
+  return fields;
+}
 
-    d.vario			= flight_observer.get_vario_GNSS(); // todo pick one vario
-    d.vario_pressure		= flight_observer.get_vario_pressure();
-    d.integrator_vario		= vario_integrator.get_value();
-    d.vario_uncompensated 	= flight_observer.get_vario_uncompensated_GNSS();
+void navigator_t::report_data( output_data_t &d)
+{
+  uint32_t fields = get_due_output_fields();
 
-    if( ! wind_obsolete) // we have new wind information
-      {
-	// reported wind smoothening to avoid hard changes during transitions
-	    last_wind = d.wind			= last_wind * 0.95f + report_instant_wind() * 0.05f;
-	    last_wind_average = d.wind_average	= last_wind_average * 0.95f + report_average_wind() * 0.05f;
+  if( fields & OUTPUT_AIRSPEED)
+    {
+      d.TAS 			= TAS_averager.get_output();
+      d.IAS 			= IAS_averager.get_output();
+    }
 
-#if DEVELOPMENT_ADDITIONS
-	    last_headwind  = d.headwind 	= get_relative_wind().e[FRONT];
-	    last_crosswind = d.crosswind	= get_relative_wind().e[RIGHT];
-#endif
-      }
-    else // wind has not recently been updated
-      {
-	d.wind 		= last_wind;
-	d.wind_average	= last_wind_average;
+  if( fields & OUTPUT_ATTITUDE)
+    {
+      d.euler			= ahrs.get_euler();
+      d.q			= ahrs.get_attitude();
+    }
 
-#if DEVELOPMENT_ADDITIONS
-	d.headwind 	= last_headwind;
-	d.crosswind	= last_crosswind;
-#endif
-      }
+  if( fields & OUTPUT_VARIO)
+    {
+      d.vario			= flight_observer.get_vario_GNSS(); // todo pick one vario
+      d.vario_pressure		= flight_observer.get_vario_pressure();
+      d.integrator_vario	= vario_integrator.get_value();
+      d.vario_uncompensated 	= flight_observer.get_vario_uncompensated_GNSS();
+    }
+
+  if( fields & OUTPUT_WIND)
+    {
+      d.wind 			= last_wind;
+      d.wind_average		= last_wind_average;
+    }
 
-    d.speed_compensation_TAS 	= flight_observer.get_speed_compensation_IAS();
-    d.speed_compensation_GNSS 	= flight_observer.get_speed_compensation_GNSS();
-    d.effective_vertical_acceleration
+  if( fields & OUTPUT_FLIGHT_STATE)
+    {
+      d.speed_compensation_TAS 	= flight_observer.get_speed_compensation_IAS();
+      d.speed_compensation_GNSS = flight_observer.get_speed_compensation_GNSS();
+      d.effective_vertical_acceleration
 				= flight_observer.get_effective_vertical_acceleration();
 
-    d.circle_mode 		= ahrs.get_circling_state();
-    d.turn_rate			= ahrs.get_turn_rate();
-    d.slip_angle		= ahrs.getSlipAngle();
-    d.nick_angle		= ahrs.getNickAngle();
-    d.G_load			= ahrs.get_G_load();
-    d.pressure_altitude		= - atmosphere.get_negative_altitude();
-    d.magnetic_disturbance	= ahrs.getMagneticDisturbance();
-    d.air_density		= atmosphere.get_density();
-    d.nav_induction_gnss 	= ahrs.get_nav_induction();
+      d.circle_mode 		= ahrs.get_circling_state();
+      d.turn_rate		= ahrs.get_turn_rate();
+      d.slip_angle		= ahrs.getSlipAngle();
+      d.nick_angle		= ahrs.getNickAngle();
+      d.G_load			= ahrs.get_G_load();
+    }
+
+  if( fields & OUTPUT_AIR_DATA)
+    {
+      d.pressure_altitude	= - atmosphere.get_negative_altitude();
+      d.air_density		= atmosphere.get_density();
+    }
+
+  if( fields & OUTPUT_MAGNETIC)
+    {
+      d.magnetic_disturbance	= ahrs.getMagneticDisturbance();
+      d.nav_induction_gnss 	= ahrs.get_nav_induction();
+    }
 
 #if DEVELOPMENT_ADDITIONS
+  if( fields & OUTPUT_DIAGNOSTICS)
+    {
+      d.diagnostics.headwind 	= last_headwind;
+      d.diagnostics.crosswind	= last_crosswind;
+      d.diagnostics.QFF		= atmosphere.get_QFF();
+      d.diagnostics.nav_correction	= ahrs.get_nav_correction();
+      d.diagnostics.gyro_correction	= ahrs.get_gyro_correction();
+      d.nav_acceleration_gnss 	= ahrs.get_nav_acceleration();
+
+      d.diagnostics.HeadingDifferenceAhrsDgnss = ahrs.getHeadingDifferenceAhrsDgnss();
+      d.diagnostics.satfix		= (float)(d.c.sat_fix_type);
+      d.diagnostics.inst_wind_N		= flight_observer.get_instant_wind().e[NORTH];
+      d.diagnostics.inst_wind_E		= flight_observer.get_instant_wind().e[EAST];
+      d.diagnostics.inst_wind_corrected_N	= report_corrected_wind().e[NORTH];
+      d.diagnostics.inst_wind_corrected_E	= report_corrected_wind().e[EAST];
+      for( unsigned i=0; i<3; ++i)
+	d.diagnostics.speed_compensation[i]  = flight_observer.get_speed_compensation(i);
+    }
+#endif
+
+  if( fields & OUTPUT_DIAGNOSTICS)
+    for( unsigned i = 0; i < shadow_count; ++i)
+      shadow[i]->report_data( d);
+}
 
-    d.QFF			= atmosphere.get_QFF();
-    d.nav_correction		= ahrs.get_nav_correction();
-    d.gyro_correction		= ahrs.get_gyro_correction();
-    d.nav_acceleration_gnss 	= ahrs.get_nav_acceleration();
-
-    d.euler_magnetic		= ahrs_magnetic.get_euler();
-    d.q_magnetic		= ahrs_magnetic.get_attitude();
-    d.nav_acceleration_mag 	= ahrs_magnetic.get_nav_acceleration();
-    d.nav_induction_mag 	= ahrs_magnetic.get_nav_induction();
-
-    d.HeadingDifferenceAhrsDgnss = ahrs.getHeadingDifferenceAhrsDgnss();
-    d.satfix			= (float)(d.c.sat_fix_type);
-    d.inst_wind_N		= flight_observer.get_instant_wind().e[NORTH];
-    d.inst_wind_E		= flight_observer.get_instant_wind().e[EAST];
-    d.inst_wind_corrected_N	= report_corrected_wind().e[NORTH];
-    d.inst_wind_corrected_E	= report_corrected_wind().e[EAST];
-    for( unsigned i=0; i<3; ++i)
-      d.speed_compensation[i]  = flight_observer.get_speed_compensation(i);
+void navigator_t::save_state( state_t &state) const
+{
+  ahrs.save_state( state.ahrs);
+  atmosphere.save_state( state.atmosphere);
+  flight_observer.save_state( state.flight_observer);
+  air_pressure_resampler_100Hz_10Hz.save_state( state.air_pressure_resampler_100Hz_10Hz);
+  state.pitot_pressure = pitot_pressure;
+  state.TAS = TAS;
+  state.IAS = IAS;
+  state.GNSS_velocity = GNSS_velocity;
+  state.GNSS_speed = GNSS_speed;
+  state.GNSS_acceleration = GNSS_acceleration;
+  state.GNSS_heading = GNSS_heading;
+  state.GNSS_negative_altitude = GNSS_negative_altitude;
+  state.GNSS_fix_type = GNSS_fix_type;
+  vario_integrator.save_state( state.vario_integrator);
+  instant_wind_averager.save_state( state.instant_wind_averager);
+  wind_average_observer.save_state( state.wind_average_observer);
+  relative_wind_observer.save_state( state.relative_wind_observer);
+  corrected_wind_averager.save_state( state.corrected_wind_averager);
+  state.circling_wind_averager = circling_wind_averager;
+#if CIRCLE_FIT_WIND
+  state.circle_wind_fit = circle_wind_fit;
+#endif
+  TAS_averager.save_state( state.TAS_averager);
+  IAS_averager.save_state( state.IAS_averager);
+  state.old_circling_state = old_circling_state;
+  state.last_wind = last_wind;
+  state.last_wind_average = last_wind_average;
+  state.last_headwind = last_headwind;
+  state.last_crosswind = last_crosswind;
+#if IDLE_DETECTION
+  state.activity_detector = activity_detector;
+  state.compass_ground_calibration = compass_ground_calibration;
+  state.idle_acc_sum = idle_acc_sum;
+  state.idle_mag_sum = idle_mag_sum;
+  state.idle_gyro_sum = idle_gyro_sum;
+  state.idle_interval = idle_interval;
+  state.idle_sample_count = idle_sample_count;
+#endif
+#if GNSS_LATENCY_COMPENSATION
+  state.GNSS_epoch_key = GNSS_epoch_key;
+  state.GNSS_samples_since_epoch = GNSS_samples_since_epoch;
+  state.GNSS_acceleration_at_epoch = GNSS_acceleration_at_epoch;
+  state.IMU_acceleration_at_epoch = IMU_acceleration_at_epoch;
+#endif
+}
+
+void navigator_t::restore_state( const state_t &state)
+{
+  ahrs.restore_state( state.ahrs);
+  atmosphere.restore_state( state.atmosphere);
+  flight_observer.restore_state( state.flight_observer);
+  air_pressure_resampler_100Hz_10Hz.restore_state( state.air_pressure_resampler_100Hz_10Hz);
+  pitot_pressure = state.pitot_pressure;
+  TAS = state.TAS;
+  IAS = state.IAS;
+  GNSS_velocity = state.GNSS_velocity;
+  GNSS_speed = state.GNSS_speed;
+  GNSS_acceleration = state.GNSS_acceleration;
+  GNSS_heading = state.GNSS_heading;
+  GNSS_negative_altitude = state.GNSS_negative_altitude;
+  GNSS_fix_type = state.GNSS_fix_type;
+  vario_integrator.restore_state( state.vario_integrator);
+  instant_wind_averager.restore_state( state.instant_wind_averager);
+  wind_average_observer.restore_state( state.wind_average_observer);
+  relative_wind_observer.restore_state( state.relative_wind_observer);
+  corrected_wind_averager.restore_state( state.corrected_wind_averager);
+  circling_wind_averager = state.circling_wind_averager;
+#if CIRCLE_FIT_WIND
+  circle_wind_fit = state.circle_wind_fit;
+#endif
+  TAS_averager.restore_state( state.TAS_averager);
+  IAS_averager.restore_state( state.IAS_averager);
+  old_circling_state = state.old_circling_state;
+  last_wind = state.last_wind;
+  last_wind_average = state.last_wind_average;
+  last_headwind = state.last_headwind;
+  last_crosswind = state.last_crosswind;
+#if IDLE_DETECTION
+  activity_detector = state.activity_detector;
+  compass_ground_calibration = state.compass_ground_calibration;
+  idle_acc_sum = state.idle_acc_sum;
+  idle_mag_sum = state.idle_mag_sum;
+  idle_gyro_sum = state.idle_gyro_sum;
+  idle_interval = state.idle_interval;
+  idle_sample_count = state.idle_sample_count;
+  ahrs.set_decimation( activity_detector.is_idle() ? IDLE_DECIMATION : 1);
+#endif
+#if GNSS_LATENCY_COMPENSATION
+  GNSS_epoch_key = state.GNSS_epoch_key;
+  GNSS_samples_since_epoch = state.GNSS_samples_since_epoch;
+  GNSS_acceleration_at_epoch = state.GNSS_acceleration_at_epoch;
+  IMU_acceleration_at_epoch = state.IMU_acceleration_at_epoch;
 #endif
 }
@@ -34,48 +34,90 @@
 #include "flight_observer.h"
 #include "data_structures.h"
 #include "accumulating_averager.h"
+#include "profiling.h"
+#include "ringbuffer.h"
+#include "fir_decimator.h"
+#include "circle_wind_fit.h"
+#include "activity_detector.h"
+#include "compass_ground_calibration.h"
+#include "shadow_estimator.h"
+
+//! ROM design of the 100 Hz -> 10 Hz pressure decimation filter
+constexpr fir_coefficients_t<float, PRESSURE_FIR_TAPS> PRESSURE_DECIMATION_DESIGN
+  = design_fir_lowpass<float, PRESSURE_FIR_TAPS>( PRESSURE_FIR_CUTOFF);
+
+//! IMU-derived state of one fast sample, for the alignment of delayed GNSS data
+class IMU_history_entry_t
+{
+public:
+  float3vector acceleration; //!< NED kinematic acceleration (gravity removed)
+  float yaw;
+};
+
+//! field mask and rate of one output consumer
+class output_subscription_t
+{
+public:
+  uint32_t fields; 	//!< output_fields_t bits
+  unsigned divider; 	//!< served on every divider-th report_data() call
+  unsigned countdown;
+};
 
 //! organizes horizontal navigation, wind observation and variometer
 class navigator_t
 {
 public:
-  navigator_t (void)
-	:ahrs (0.01f),
-#if DEVELOPMENT_ADDITIONS
-	 ahrs_magnetic (0.01f),
-#endif
+  navigator_t ( configuration_snapshot_t &configuration = EEPROM_configuration())
+	:ahrs (FAST_SAMPLING_TIME, configuration),
 	 atmosphere (101325.0f),
+	 flight_observer( configuration),
+	 subscription_count( 0),
+	 shadow{ 0},
+	 shadow_count( 0),
+	 air_pressure_resampler_100Hz_10Hz( PRESSURE_DECIMATION_DESIGN),
+	 pitot_pressure(0.0f),
+	 TAS( 0.0f),
+	 IAS( 0.0f),
+	 GNSS_speed( 0.0f),
+	 GNSS_heading( 0.0f),
+	 GNSS_negative_altitude( ZERO),
+	 GNSS_fix_type( 0),
 	 vario_integrator( configuration( VARIO_INT_TC) < 0.25f
 	   ? configuration( VARIO_INT_TC) // normalized stop frequency given, old version
-	   : (FAST_SAMPLING_TIME / configuration( VARIO_INT_TC) ) ), // time-constant given, new version
-	 wind_average_observer( configuration( MEAN_WIND_TC) < 0.25f
-	   ? configuration( MEAN_WIND_TC)
-	   : (FAST_SAMPLING_TIME / configuration( MEAN_WIND_TC) ) ),
+	   : (SOARING_AVERAGER_TIME_BASE / configuration( VARIO_INT_TC) ) ), // time-constant given, new version
 	 instant_wind_averager( configuration( WIND_TC)  < 0.25f
 	   ? configuration( MEAN_WIND_TC) * 10.0f // WIND_TC designed for 100Hz but now used at 10 Hz
 	   : (SLOW_SAMPLING_TIME / configuration( MEAN_WIND_TC) ) ),
+	 wind_average_observer( configuration( MEAN_WIND_TC) < 0.25f
+	   ? configuration( MEAN_WIND_TC)
+	   : (SOARING_AVERAGER_TIME_BASE / configuration( MEAN_WIND_TC) ) ),
 	 relative_wind_observer( configuration( MEAN_WIND_TC) < 0.25f
 	   ? configuration( MEAN_WIND_TC) * 10.0f
 	   : (SLOW_SAMPLING_TIME / configuration( MEAN_WIND_TC) ) ),
 	 corrected_wind_averager( configuration( MEAN_WIND_TC)  < 0.25f
 	   ? configuration( MEAN_WIND_TC) * 10.0f
 	   : (SLOW_SAMPLING_TIME / configuration( MEAN_WIND_TC) ) ),
-	 air_pressure_resampler_100Hz_10Hz(0.04f), // f/fc = 80% * 0.5 * 0.1
-	 GNSS_negative_altitude( ZERO),
-	 TAS_averager(1.0f / 1.0f / 100.0f),
-	 IAS_averager(1.0f / 1.0f / 100.0f),
-	 pitot_pressure(0.0f),
-	 TAS( 0.0f),
-	 IAS( 0.0f),
-	 GNSS_heading( 0.0f),
-	 GNSS_fix_type( 0),
-	 GNSS_speed( 0.0f),
+	 TAS_averager( pt2<float,float>::design< 1, FAST_SAMPLING_FREQUENCY>()), // 1 s
+	 IAS_averager( pt2<float,float>::design< 1, FAST_SAMPLING_FREQUENCY>()),
 	 old_circling_state( STRAIGHT_FLIGHT),
-	 wind_obsolete( true),
 	 last_wind({0}),
 	 last_wind_average({0}),
 	 last_headwind(0.0f),
 	 last_crosswind(0.0f)
+#if IDLE_DETECTION
+	 , idle_acc_sum({0}),
+	 idle_mag_sum({0}),
+	 idle_gyro_sum({0}),
+	 idle_interval( 0.0f),
+	 idle_sample_count( 0)
+#endif
+#if GNSS_LATENCY_COMPENSATION
+	 , GNSS_latency( DEFAULT_GNSS_LATENCY),
+	 GNSS_epoch_key( 0),
+	 GNSS_samples_since_epoch( 0),
+	 GNSS_acceleration_at_epoch({0}),
+	 IMU_acceleration_at_epoch({0})
+#endif
 
   {};
 
@@ -101,8 +143,30 @@ public:
     atmosphere.disregard_ambient_air_data();
   }
 
+  /**
+   * @brief fill the subscribed results into d
+   *
+   * Without any subscription all results are reported on every call.
+   */
   void report_data( output_data_t &d);
 
+  /**
+   * @brief register an output consumer
+   * @param fields output_fields_t bits the consumer reads
+   * @param divider consumer rate = report_data() rate / divider
+   * @return true if all slots are in use
+   */
+  bool subscribe_output( uint32_t fields, unsigned divider = 1)
+  {
+    if( subscription_count >= OUTPUT_SUBSCRIPTION_SLOTS)
+      return true;
+    output_subscription_t &s = subscription[subscription_count++];
+    s.fields = fields;
+    s.divider = divider ? divider : 1;
+    s.countdown = 0;
+    return false;
+  }
+
   void set_from_add_mag ( const float3vector &acc, const float3vector &mag)
   {
     ahrs.attitude_setup(acc, mag);
@@ -154,9 +218,11 @@ public:
    * @brief update AHRS from IMU
    *
    * to be called @ 100 Hz, triggers all fast calculations,
-   * especially AHRS attitude data and fast flight-observer stuff
+   * especially AHRS attitude data and fast flight-observer stuff.
+   * sampling_time is the interval covered by the IMU data, the AHRS steps by it
    */
-  void update_every_10ms( const float3vector &acc, const float3vector &mag, const float3vector &gyro);
+  void update_every_10ms( const float3vector &acc, const float3vector &mag, const float3vector &gyro,
+			  float sampling_time = FAST_SAMPLING_TIME);
 
   /**
      * @brief slow update flight observer data
@@ -166,6 +232,16 @@ public:
      */
   void update_every_100ms( const coordinates_t &coordinates);
 
+#if TICK_SCHEDULER
+  /**
+     * @brief the update_every_100ms() work spread over the 10 ms ticks
+     *
+     * to be called @ 100 Hz with slot = tick % FAST_SLOW_DECIMATION,
+     * replaces update_every_100ms(), see TICK_SLOT_xxx
+     */
+  void update_tick_slot( unsigned slot);
+#endif
+
     /**
        * @brief update on new navigation data from GNSS
        *
@@ -174,20 +250,87 @@ public:
        */
   void update_GNSS_data( const coordinates_t &coordinates);
 
+#if GNSS_LATENCY_COMPENSATION
+  /**
+   * @brief update with GNSS data of known age
+   *
+   * The solution is matched against the IMU history of its own epoch
+   * and propagated to the present sample. Repeated calls with the same epoch are ignored.
+   * @param age time since the GNSS epoch / s
+   */
+  void update_GNSS_data( const coordinates_t &coordinates, float age);
+
+  //! typical age of the GNSS data used by update_GNSS_data( coordinates) / s
+  void set_GNSS_latency( float latency)
+  {
+    GNSS_latency = latency;
+  }
+#endif
+
   /**
    * @brief return aggregate flight observer
    */
-//  const flight_observer_t &get_flight_observer( void) const
-//    {
-//    return flight_observer;
-//    }
+  const flight_observer_t &get_flight_observer( void) const
+    {
+    return flight_observer;
+    }
+
+#if WITH_PROFILING
+  //! cycle count statistics of all stages
+  const profiling_report_t &get_profiling_report( void) const
+    {
+    return profiling;
+    }
+
+  void reset_profiling_report( void)
+    {
+    profiling.reset();
+    }
+#endif
+
+  //! most recent input of the flight observer
+  const flight_observer_input_t &get_flight_observer_input( void) const
+    {
+    return flight_observer_input;
+    }
 
   void set_attitude( float roll, float nick, float yaw)
   {
     ahrs.set_from_euler(roll, nick, yaw);
-#if DEVELOPMENT_ADDITIONS
-    ahrs_magnetic.set_from_euler(roll, nick, yaw);
-#endif
+    for( unsigned i = 0; i < shadow_count; ++i)
+      shadow[i]->set_attitude( roll, nick, yaw);
+  }
+
+  //! control if magnetic calibration results are written into EEPROM and reported
+  void enable_calibration_write_back( bool enable)
+  {
+    ahrs.enable_calibration_write_back( enable);
+    for( unsigned i = 0; i < shadow_count; ++i)
+      shadow[i]->enable_calibration_write_back( enable);
+  }
+
+  //! low priority context: calibration evaluation and EEPROM writes, true if a job has been processed
+  bool run_deferred_jobs( void)
+  {
+    bool processed = ahrs.run_deferred_jobs();
+    for( unsigned i = 0; i < shadow_count; ++i)
+      processed |= shadow[i]->run_deferred_jobs();
+    return processed;
+  }
+
+  /**
+   * @brief feed an alternative estimator with the inputs of the production AHRS
+   *
+   * The estimator must outlive the navigator, set_attitude() as well as
+   * enable_calibration_write_back() are forwarded from now on.
+   * @return true if all slots are in use
+   */
+  bool attach_shadow_estimator( shadow_estimator_t &estimator)
+  {
+    if( shadow_count >= SHADOW_ESTIMATOR_SLOTS)
+      return true;
+    shadow[shadow_count++] = &estimator;
+    return false;
   }
 
   float get_IAS( void) const
@@ -211,11 +354,30 @@ public:
   float3vector report_average_wind( void) const
   {
     if( ahrs.get_circling_state() == CIRCLING)
-      return circling_wind_averager.get_average();
+      {
+#if CIRCLE_FIT_WIND
+	if( circle_wind_fit.is_valid() && circle_wind_fit.get_turn() < CIRCLE_FIT_HANDOVER_TURN)
+	  return circle_wind_fit.get_wind(); // early wind during the first circles
+#endif
+	return circling_wind_averager.get_average();
+      }
     else
       return wind_average_observer.get_value();
   }
 
+#if IDLE_DETECTION
+  //! true while resting on the ground, output may be slowed down
+  bool is_idle( void) const
+  {
+    return activity_detector.is_idle();
+  }
+
+  const compass_ground_calibration_t &get_compass_ground_calibration( void) const
+  {
+    return compass_ground_calibration;
+  }
+#endif
+
   float3vector report_corrected_wind( void) const
   {
     return corrected_wind_averager.get_output();
@@ -225,12 +387,13 @@ private:
   AHRS_type 		ahrs;
   atmosphere_t 		atmosphere;
   flight_observer_t 	flight_observer;
+  flight_observer_input_t flight_observer_input;
+  output_subscription_t subscription[OUTPUT_SUBSCRIPTION_SLOTS];
+  unsigned subscription_count;
+  shadow_estimator_t *shadow[SHADOW_ESTIMATOR_SLOTS];
+  unsigned shadow_count;
 
-#if DEVELOPMENT_ADDITIONS
-  AHRS_type	ahrs_magnetic;
-#endif
-
-  pt2<float,float> air_pressure_resampler_100Hz_10Hz;
+  fir_decimator<float,float, PRESSURE_FIR_TAPS, FAST_SLOW_DECIMATION> air_pressure_resampler_100Hz_10Hz;
   float 	pitot_pressure;
   float 	TAS;
   float 	IAS;
@@ -248,16 +411,123 @@ private:
   soaring_flight_averager< float3vector, false, false> relative_wind_observer;
   pt2<float3vector,float> corrected_wind_averager;
   accumulating_averager < float3vector> circling_wind_averager;
+#if CIRCLE_FIT_WIND
+  circle_wind_fit_t circle_wind_fit;
+#endif
   pt2<float,float> TAS_averager;
   pt2<float,float> IAS_averager;
   circle_state_t old_circling_state;
 
-  // workaround for different sampling rates 10Hz and 100Hz
-  bool wind_obsolete; //!< wind has not been updated recently
+  //! output_fields_t bits due on this report_data() call
+  uint32_t get_due_output_fields( void);
+
+  // phases of the 10 Hz update
+  bool update_activity( void);
+  void update_density( void);
+  void update_wind( void);
+  void update_averagers( void);
+
+  //! vario, wind and density suspended while idle on ground
+  bool is_suspended( void) const
+  {
+#if IDLE_DETECTION
+    return activity_detector.is_idle();
+#else
+    return false;
+#endif
+  }
+
+  // reported wind, smoothened @ 10 Hz
   float3vector last_wind;
   float3vector last_wind_average;
   float last_headwind;
   float last_crosswind;
+#if WITH_PROFILING
+  profiling_report_t profiling;
+#endif
+#if IDLE_DETECTION
+  void update_idle( const float3vector &acc, const float3vector &mag, const float3vector &gyro, float sampling_time);
+  void enter_idle( void);
+  void leave_idle( void);
+
+  activity_detector_t activity_detector;
+  compass_ground_calibration_t compass_ground_calibration;
+  float3vector idle_acc_sum;
+  float3vector idle_mag_sum;
+  float3vector idle_gyro_sum; //!< angle increments / rad
+  float idle_interval;
+  unsigned idle_sample_count;
+#endif
+#if GNSS_LATENCY_COMPENSATION
+  void propagate_GNSS_data( void);
+
+  MirroredRingBuffer<IMU_history_entry_t, GNSS_HISTORY_LENGTH> IMU_history;
+  float GNSS_latency;
+  uint64_t GNSS_epoch_key; //!< time stamp of the last GNSS solution used
+  unsigned GNSS_samples_since_epoch; //!< dead reckoning steps since the last new solution
+  float3vector GNSS_acceleration_at_epoch;
+  float3vector IMU_acceleration_at_epoch;
+#endif
+
+public:
+  /**
+   * @brief dynamic state for checkpoints
+   *
+   * Tuning parameters, output subscriptions and shadow estimators are not part of it.
+   * With GNSS_LATENCY_COMPENSATION the IMU history is not saved,
+   * it has been refilled after GNSS_HISTORY_LENGTH samples.
+   */
+  class state_t
+  {
+  public:
+    AHRS_type::state_t ahrs;
+    atmosphere_t::state_t atmosphere;
+    flight_observer_t::state_t flight_observer;
+    decltype( navigator_t::air_pressure_resampler_100Hz_10Hz)::state_t air_pressure_resampler_100Hz_10Hz;
+    float pitot_pressure;
+    float TAS;
+    float IAS;
+    float3vector GNSS_velocity;
+    float GNSS_speed;
+    float3vector GNSS_acceleration;
+    float GNSS_heading;
+    float GNSS_negative_altitude;
+    unsigned GNSS_fix_type;
+    decltype( navigator_t::vario_integrator)::state_t vario_integrator;
+    pt2<float3vector,float>::state_t instant_wind_averager;
+    decltype( navigator_t::wind_average_observer)::state_t wind_average_observer;
+    decltype( navigator_t::relative_wind_observer)::state_t relative_wind_observer;
+    pt2<float3vector,float>::state_t corrected_wind_averager;
+    accumulating_averager < float3vector> circling_wind_averager;
+#if CIRCLE_FIT_WIND
+    circle_wind_fit_t circle_wind_fit;
+#endif
+    pt2<float,float>::state_t TAS_averager;
+    pt2<float,float>::state_t IAS_averager;
+    circle_state_t old_circling_state;
+    float3vector last_wind;
+    float3vector last_wind_average;
+    float last_headwind;
+    float last_crosswind;
+#if IDLE_DETECTION
+    activity_detector_t activity_detector;
+    compass_ground_calibration_t compass_ground_calibration;
+    float3vector idle_acc_sum;
+    float3vector idle_mag_sum;
+    float3vector idle_gyro_sum;
+    float idle_interval;
+    unsigned idle_sample_count;
+#endif
+#if GNSS_LATENCY_COMPENSATION
+    uint64_t GNSS_epoch_key;
+    unsigned GNSS_samples_since_epoch;
+    float3vector GNSS_acceleration_at_epoch;
+    float3vector IMU_acceleration_at_epoch;
+#endif
+  };
+
+  void save_state( state_t &state) const;
+  void restore_state( const state_t &state);
 };
 
 #endif /* NAVIGATORT_H_ */
@@ -28,12 +28,22 @@
 #include "data_structures.h"
 #include "navigator.h"
 #include "flight_observer.h"
+#include "checkpoint.h"
+#include "imu_preintegrator.h"
+#include "IMU_frontend.h"
 
 //! set of algorithms and data to be used by Larus flight sensor
 class organizer_t
 {
 public:
-  organizer_t( void)
+  typedef default_pipeline_t::IMU_source_t IMU_source_t; //!< primary or low-cost IMU
+
+  organizer_t( configuration_snapshot_t &_configuration = EEPROM_configuration())
+    : configuration( _configuration),
+      navigator( _configuration)
+#if TICK_SCHEDULER
+      , tick_slot( 0)
+#endif
   {
 
   }
@@ -50,6 +60,7 @@ public:
   		      configuration (SENS_TILT_NICK),
   		      configuration (SENS_TILT_YAW));
         q.get_rotation_matrix (sensor_mapping);
+        frontend.set_mapping( sensor_mapping);
       }
 
   }
@@ -84,6 +95,25 @@ public:
     navigator.feed_QFF_density_metering( output_data.m.static_pressure - QNH_offset, -output_data.c.position[DOWN]);
   }
 
+#if TICK_SCHEDULER
+  //! to be called every fast tick instead of update_every_100ms(), one 10 Hz phase per tick
+  void update_tick_slot( output_data_t & output_data)
+  {
+    navigator.update_tick_slot( tick_slot);
+    if( tick_slot == TICK_SLOT_DENSITY)
+      navigator.feed_QFF_density_metering( output_data.m.static_pressure - QNH_offset, -output_data.c.position[DOWN]);
+
+    if( ++tick_slot == FAST_SLOW_DECIMATION)
+      tick_slot = 0;
+  }
+
+  //! slot of the next update_tick_slot() call, firmware output formatting on TICK_SLOT_OUTPUT
+  unsigned get_tick_slot( void) const
+  {
+    return tick_slot;
+  }
+#endif
+
   void set_attitude ( float roll, float nick, float present_heading)
   {
     navigator.set_attitude ( roll, nick, present_heading);
@@ -95,23 +125,61 @@ public:
 
   void update_every_10ms( output_data_t & output_data)
   {
-    // rotate sensor coordinates into airframe coordinates
-#if USE_LOWCOST_IMU == 1
-    acc  = sensor_mapping * output_data.m.lowcost_acc;
-    mag  = sensor_mapping * output_data.m.lowcost_mag;
-    gyro = sensor_mapping * output_data.m.lowcost_gyro;
-#else
-    acc  = sensor_mapping * output_data.m.acc;
-    mag  = sensor_mapping * output_data.m.mag;
-    gyro = sensor_mapping * output_data.m.gyro;
+    frontend.set_input( IMU_frontend_t::PRIMARY + IMU_frontend_t::ACC,  IMU_source_t::acc(  output_data.m));
+    frontend.set_input( IMU_frontend_t::PRIMARY + IMU_frontend_t::GYRO, IMU_source_t::gyro( output_data.m));
+    frontend.set_input( IMU_frontend_t::PRIMARY + IMU_frontend_t::MAG,  IMU_source_t::mag(  output_data.m));
+
+    float sampling_time = FAST_SAMPLING_TIME;
+    if( preintegrator.get_sample_count() > 0) // FIFO samples available: use the compensated increments
+      {
+	frontend.set_input( IMU_frontend_t::PRIMARY + IMU_frontend_t::ACC,  preintegrator.get_mean_specific_force());
+	frontend.set_input( IMU_frontend_t::PRIMARY + IMU_frontend_t::GYRO, preintegrator.get_mean_rate());
+	sampling_time = preintegrator.get_interval(); // FIFO bursts need not match the tick
+	preintegrator.reset();
+      }
+
+#if IMU_FRONTEND_VECTORS == 6
+    frontend.set_input( IMU_frontend_t::SECONDARY + IMU_frontend_t::ACC,  IMU_source_t::secondary_t::acc(  output_data.m));
+    frontend.set_input( IMU_frontend_t::SECONDARY + IMU_frontend_t::GYRO, IMU_source_t::secondary_t::gyro( output_data.m));
+    frontend.set_input( IMU_frontend_t::SECONDARY + IMU_frontend_t::MAG,  IMU_source_t::secondary_t::mag(  output_data.m));
 #endif
 
+    // rotate sensor coordinates into airframe coordinates, fuse the IMUs
+    frontend.update();
+    acc  = frontend.get_acc();
+    gyro = frontend.get_gyro();
+    mag  = frontend.get_mag();
+
 #if DEVELOPMENT_ADDITIONS
-    output_data.body_acc  = acc;
-    output_data.body_gyro = gyro;
+    output_data.diagnostics.body_acc  = acc;
+    output_data.diagnostics.body_gyro = gyro;
 #endif
 
-    navigator.update_every_10ms (acc, mag, gyro);
+    navigator.update_every_10ms (acc, mag, gyro, sampling_time);
+  }
+
+  //! to be called from a low priority task, results are picked up by the next update_every_10ms()
+  bool run_deferred_jobs( void)
+  {
+    return navigator.run_deferred_jobs();
+  }
+
+  //! high-rate IMU sample in sensor coordinates, consumed by the next update_every_10ms()
+  void feed_IMU_sample( const float3vector &sensor_gyro, const float3vector &sensor_acc, float dt = IMU_SAMPLING_TIME)
+  {
+    preintegrator.add_sample( sensor_gyro, sensor_acc, dt);
+  }
+
+  //! IMU FIFO burst in sensor coordinates
+  void feed_IMU_burst( const float3vector *sensor_gyro, const float3vector *sensor_acc, unsigned count, float dt = IMU_SAMPLING_TIME)
+  {
+    preintegrator.add_samples( sensor_gyro, sensor_acc, count, dt);
+  }
+
+  //! IMU_frontend_t status bits, 0 = all sensors healthy
+  unsigned get_IMU_status( void) const
+  {
+    return frontend.get_status();
   }
 
   void report_data ( output_data_t &data)
@@ -119,6 +187,24 @@ public:
     navigator.report_data ( data);
   }
 
+  //! control if magnetic calibration results are written into EEPROM and reported
+  void enable_calibration_write_back( bool enable)
+  {
+    navigator.enable_calibration_write_back( enable);
+  }
+
+  //! register an output consumer, @return true if all slots are in use
+  bool subscribe_output( uint32_t fields, unsigned divider = 1)
+  {
+    return navigator.subscribe_output( fields, divider);
+  }
+
+  //! @return true if all slots are in use
+  bool attach_shadow_estimator( shadow_estimator_t &estimator)
+  {
+    return navigator.attach_shadow_estimator( estimator);
+  }
+
   void set_density_data( float temp, float humidity)
   {
     navigator.set_density_data( temp, humidity);
@@ -129,15 +215,98 @@ public:
     navigator.disregard_density_data();
   }
 
+#if WITH_PROFILING
+  const profiling_report_t &get_profiling_report( void) const
+  {
+    return navigator.get_profiling_report();
+  }
+
+  void reset_profiling_report( void)
+  {
+    navigator.reset_profiling_report();
+  }
+#endif
+
+#if IDLE_DETECTION
+  //! true while resting on the ground: output may be reduced to save power
+  bool is_idle( void) const
+  {
+    return navigator.is_idle();
+  }
+#endif
+
+  //! dynamic algorithm state, the sensor mapping and calibration come from the configuration
+  class state_t
+  {
+  public:
+    navigator_t::state_t navigator;
+#if TICK_SCHEDULER
+    unsigned tick_slot;
+#endif
+  };
+
+  //! increment with every change of a state record, the feature flags select optional members
+  enum { STATE_LAYOUT = 3
+    | ( IDLE_DETECTION << 8) | ( GNSS_LATENCY_COMPENSATION << 9) | ( CIRCLE_FIT_WIND << 10)
+    | ( DEFERRED_MAG_CALIBRATION << 11) | ( MAG_CONTINUOUS_CALIBRATION << 12) | ( TICK_SCHEDULER << 13)};
+
+  void save_state( state_t &state) const
+  {
+    navigator.save_state( state.navigator);
+#if TICK_SCHEDULER
+    state.tick_slot = tick_slot;
+#endif
+  }
+
+  void restore_state( const state_t &state)
+  {
+    navigator.restore_state( state.navigator);
+#if TICK_SCHEDULER
+    tick_slot = state.tick_slot;
+#endif
+  }
+
+  //! copy the dynamic algorithm state, e.g. periodically into backup SRAM
+  void save_checkpoint( checkpoint_t<state_t> &checkpoint) const
+  {
+    save_state( checkpoint.state);
+    seal_checkpoint( checkpoint, STATE_LAYOUT);
+  }
+
+  /**
+   * @brief warm restart from a checkpoint instead of initialize_after_first_measurement()
+   * @return true if the checkpoint has been rejected, start over then
+   */
+  bool restore_checkpoint( const checkpoint_t<state_t> &checkpoint)
+  {
+    if( check_checkpoint( checkpoint, STATE_LAYOUT))
+      return true;
+    restore_state( checkpoint.state);
+    return false;
+  }
+
+  const navigator_t &get_navigator( void) const
+  {
+    return navigator;
+  }
+
 private:
+  configuration_snapshot_t &configuration; //!< parameter set of this instance
   navigator_t navigator;
   float3vector acc; //!< acceleration in airframe system
   float3vector mag; //!< normalized magnetic induction in airframe system
   float3vector gyro; //!< rotation-rates in airframe system
   float3matrix sensor_mapping; //!< sensor -> airframe rotation matrix
+  imu_preintegrator_t preintegrator; //!< high-rate IMU samples, sensor frame
+  IMU_frontend_t frontend; //!< sensor mapping, dual IMU fusion
   float pitot_offset; //!< pitot pressure sensor offset
   float pitot_span;   //!< pitot pressure sensor span factor
   float QNH_offset;   //!< static pressure sensor offset
+#if TICK_SCHEDULER
+  unsigned tick_slot; //!< 0 .. FAST_SLOW_DECIMATION - 1
+#endif
 };
 
+static_assert( sizeof( checkpoint_t<organizer_t::state_t>) <= CHECKPOINT_CAPACITY, "algorithm state exceeds the backup SRAM");
+
 #endif /* ORGANIZER_H_ */
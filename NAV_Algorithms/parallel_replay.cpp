@@ -0,0 +1,73 @@
+/***********************************************************************//**
+ * @file		parallel_replay.cpp
+ * @brief		replay of many flights on a pool of worker threads
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "parallel_replay.h"
+
+#if UNIX == 1
+
+#include "replay_engine.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+void parallel_replay( flight_replay_job_t *jobs, unsigned number_of_jobs, unsigned threads)
+{
+  if( threads == 0)
+    threads = std::max( 1u, std::thread::hardware_concurrency());
+  threads = std::min( threads, number_of_jobs);
+
+  // longest flights first to minimize the tail when the queue runs empty
+  std::vector<unsigned> order( number_of_jobs);
+  for( unsigned i = 0; i < number_of_jobs; ++i)
+    order[i] = i;
+  std::stable_sort( order.begin(), order.end(),
+		    [jobs]( unsigned a, unsigned b){ return jobs[a].count > jobs[b].count;});
+
+  // resolve the EEPROM configuration before the workers start
+  const configuration_snapshot_t &default_configuration = EEPROM_configuration();
+
+  std::atomic<unsigned> next_job( 0);
+
+  auto worker = [&]( void)
+    {
+      for( unsigned i = next_job++; i < number_of_jobs; i = next_job++)
+	{
+	  flight_replay_job_t &job = jobs[order[i]];
+	  std::unique_ptr<replay_engine_t> engine(
+	      new replay_engine_t( job.configuration ? *job.configuration : default_configuration, false));
+	  engine->run( job.observations, job.output, job.count);
+	}
+    };
+
+  std::vector<std::thread> pool;
+  for( unsigned i = 1; i < threads; ++i)
+    pool.emplace_back( worker);
+  worker(); // the calling thread takes part
+  for( std::thread &t : pool)
+    t.join();
+}
+
+#endif
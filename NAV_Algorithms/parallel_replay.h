@@ -0,0 +1,61 @@
+/***********************************************************************//**
+ * @file		parallel_replay.h
+ * @brief		replay of many flights on a pool of worker threads
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef PARALLEL_REPLAY_H_
+#define PARALLEL_REPLAY_H_
+
+#include "system_configuration.h"
+
+#if UNIX == 1 // host only
+
+#include "data_structures.h"
+#include "configuration_snapshot.h"
+
+//! one flight to be replayed, output provided by the caller
+class flight_replay_job_t
+{
+public:
+  const observations_type *observations;
+  unsigned count; 	//!< number of records in observations and output
+  output_data_t *output;
+  const configuration_snapshot_t *configuration; //!< parameter set, 0 = EEPROM configuration
+};
+
+/**
+ * @brief replay flights in parallel, one independent organizer_t per flight
+ *
+ * Jobs are taken longest first from a shared queue,
+ * any idle worker picks the next one, so long and short flights balance out.
+ * Every instance works on its own copy of the configuration,
+ * so flights may be replayed with different parameter sets.
+ * During the replay no global state is written:
+ * magnetic calibration results are kept within the instance.
+ *
+ * @param threads number of worker threads, 0 = one per CPU core
+ */
+void parallel_replay( flight_replay_job_t *jobs, unsigned number_of_jobs, unsigned threads = 0);
+
+#endif
+
+#endif /* PARALLEL_REPLAY_H_ */
@@ -26,65 +26,235 @@
 #include "embedded_memory.h"
 #include "embedded_math.h"
 #include "persistent_data.h"
+#include "EEPROM_journal.h"
 
-ROM persistent_data_t PERSISTENT_DATA[]=
+ROM constexpr persistent_data_t PERSISTENT_DATA[]=
     {
-	{BOARD_ID, 	"Board_ID",		false, 0.0f, 0},	//! Board ID Hash to avoid board confusion
-
-	{SENS_TILT_ROLL,"SensTilt_Roll",	true,  0.0f, 0}, 	//! IMU Sensor tilt angle signed / degrees front right down frame
-	{SENS_TILT_NICK,"SensTilt_Nick",	true,  0.0f, 0}, 	//! IMU Sensor tilt angle signed
-	{SENS_TILT_YAW, "SensTilt_Yaw",		true,  0.0f, 0},  	//! IMU Sensor tilt angle signed
-
-	{PITOT_OFFSET,	"Pitot_Offset",		false,  0.0f, 0},	//! Pitot offset signed / Pa
-	{PITOT_SPAN, 	"Pitot_Span",		false,  1.0f, 0},	//! Pitot Span signed (around 1.0f)
-	{QNH_OFFSET, 	"QNH-delta",		false,  0.0f, 0},	//! Absolute pressure sensor offset signed / Pa
-
-	{MAG_X_OFF,	"Mag_X_Off",		false,  0.0f, 0},	//! Induction sensor x offset signed / ( 10.0f / 32768 )
-	{MAG_X_SCALE,	"Mag_X_Scale",		false,  1.0f, 0},	//! Induction sensor x gain signed ( scale-factor = 1.0f + value / 32768 )
-	{MAG_Y_OFF,	"Mag_Y_Off",		false,  0.0f, 0},	//! Induction sensor x offset signed / ( 10.0f / 32768 )
-	{MAG_Y_SCALE,	"Mag_Y_Scale", 		false,  1.0f, 0},	//! Induction sensor x gain signed ( scale-factor = 1.0f + value / 32768 )
-	{MAG_Z_OFF,	"Mag_Z_Off",		false,  0.0f, 0},	//! Induction sensor x offset signed / ( 10.0f / 32768 )
-	{MAG_Z_SCALE,	"Mag_Z_Scale",		false,  1.0f, 0},	//! Induction sensor x gain signed ( scale-factor = 1.0f + value / 32768 )
-	{MAG_STD_DEVIATION, "Mag_Calib_Err",	false,  1e-2f, 0},	//! Magnetic calibration STD deviation / ( 1 % / 65536 )
-	{MAG_AUTO_CALIB, "Mag_Auto_Calib",	false,  1.0f, 0},	//! Magnetic calibration adjusted automatically
-
-	{DECLINATION,	"Mag_Declination",	true,  0.05f, 0}, 	//! Magnetic declination (east positive) signed / ( 180° / 32768)
-	{INCLINATION,	"Mag_Inclination",	true,  1.13f, 0}, 	//! Magnetic inclination (down positive) signed / ( 180° / 32768)
-	{MAG_EARTH_AUTO, "Mag_Earth_Auto",	false,  0.0f, 0},	//! Earth magnetic field recognized automatically
-
-	{VARIO_TC,	"Vario_TC",		false, 2.0f, 0}, 	//! Vario time constant unsigned s / ( 100.0f / 65536 )
-	{VARIO_INT_TC,	"Vario_Int_TC",		false, 30.0f, 0},	//! Vario integrator time constant unsigned s / ( 100.0f / 65536 )
-	{WIND_TC,	"Wind_TC",		false, 5.0f, 0}, 	//! Wind fast time constant unsigned s / ( 100.0f / 65536 )
-	{MEAN_WIND_TC,	"Mean_Wind_TC",		false, 30.0f, 0},	//! Wind slow time constant unsigned s / ( 100.0f / 65536 )
-	{VETF,		"VrtclEnrgTuning",	false, 1.0f, 0},	//! Vertical Energy tuning factor s / ( 1.0f / 65536 )
-
-	{GNSS_CONFIGURATION, "GNSS_CONFIG",	false, 1.0f, 0},	//! type of GNSS system
-	{ANT_BASELENGTH, "ANT_BASELEN",		false, 1.0f, 0},	//! Slave DGNSS antenna baselength / mm
-	{ANT_SLAVE_DOWN, "ANT_SLAVE_DOWN",	false, 0.0f, 0},	//! Slave DGNSS antenna lower / mm
-	{ANT_SLAVE_RIGHT,"ANT_SLAVE_RIGHT",	false, 0.0f, 0},	//! Slave DGNSS antenna more right /mm
+	{BOARD_ID, 	"Board_ID",		false, 0.0f, 0, CODEC_INTEGER},	//! Board ID Hash to avoid board confusion
+
+	{SENS_TILT_ROLL,"SensTilt_Roll",	true,  0.0f, 0, CODEC_ANGLE}, 	//! IMU Sensor tilt angle signed / degrees front right down frame
+	{SENS_TILT_NICK,"SensTilt_Nick",	true,  0.0f, 0, CODEC_ANGLE}, 	//! IMU Sensor tilt angle signed
+	{SENS_TILT_YAW, "SensTilt_Yaw",		true,  0.0f, 0, CODEC_ANGLE},  	//! IMU Sensor tilt angle signed
+
+	{PITOT_OFFSET,	"Pitot_Offset",		false,  0.0f, 0, CODEC_SIGNED_INTEGER},	//! Pitot offset signed / Pa
+	{PITOT_SPAN, 	"Pitot_Span",		false,  1.0f, 0, CODEC_SPAN},	//! Pitot Span signed (around 1.0f)
+	{QNH_OFFSET, 	"QNH-delta",		false,  0.0f, 0, CODEC_SIGNED_INTEGER},	//! Absolute pressure sensor offset signed / Pa
+
+	{MAG_X_OFF,	"Mag_X_Off",		false,  0.0f, 0, CODEC_MAG_OFFSET},	//! Induction sensor x offset signed / ( 10.0f / 32768 )
+	{MAG_X_SCALE,	"Mag_X_Scale",		false,  1.0f, 0, CODEC_SPAN},	//! Induction sensor x gain signed ( scale-factor = 1.0f + value / 32768 )
+	{MAG_Y_OFF,	"Mag_Y_Off",		false,  0.0f, 0, CODEC_MAG_OFFSET},	//! Induction sensor x offset signed / ( 10.0f / 32768 )
+	{MAG_Y_SCALE,	"Mag_Y_Scale", 		false,  1.0f, 0, CODEC_SPAN},	//! Induction sensor x gain signed ( scale-factor = 1.0f + value / 32768 )
+	{MAG_Z_OFF,	"Mag_Z_Off",		false,  0.0f, 0, CODEC_MAG_OFFSET},	//! Induction sensor x offset signed / ( 10.0f / 32768 )
+	{MAG_Z_SCALE,	"Mag_Z_Scale",		false,  1.0f, 0, CODEC_SPAN},	//! Induction sensor x gain signed ( scale-factor = 1.0f + value / 32768 )
+	{MAG_STD_DEVIATION, "Mag_Calib_Err",	false,  1e-2f, 0, CODEC_STD_DEVIATION},	//! Magnetic calibration STD deviation / ( 1 % / 65536 )
+	{MAG_AUTO_CALIB, "Mag_Auto_Calib",	false,  1.0f, 0, CODEC_INTEGER},	//! Magnetic calibration adjusted automatically
+
+	{DECLINATION,	"Mag_Declination",	true,  0.05f, 0, CODEC_ANGLE}, 	//! Magnetic declination (east positive) signed / ( 180° / 32768)
+	{INCLINATION,	"Mag_Inclination",	true,  1.13f, 0, CODEC_ANGLE}, 	//! Magnetic inclination (down positive) signed / ( 180° / 32768)
+	{MAG_EARTH_AUTO, "Mag_Earth_Auto",	false,  0.0f, 0, CODEC_INTEGER},	//! Earth magnetic field recognized automatically
+
+	{VARIO_TC,	"Vario_TC",		false, 2.0f, 0, CODEC_TIME_CONSTANT}, 	//! Vario time constant unsigned s / ( 100.0f / 65536 )
+	{VARIO_INT_TC,	"Vario_Int_TC",		false, 30.0f, 0, CODEC_TIME_CONSTANT},	//! Vario integrator time constant unsigned s / ( 100.0f / 65536 )
+	{WIND_TC,	"Wind_TC",		false, 5.0f, 0, CODEC_TIME_CONSTANT}, 	//! Wind fast time constant unsigned s / ( 100.0f / 65536 )
+	{MEAN_WIND_TC,	"Mean_Wind_TC",		false, 30.0f, 0, CODEC_TIME_CONSTANT},	//! Wind slow time constant unsigned s / ( 100.0f / 65536 )
+	{VETF,		"VrtclEnrgTuning",	false, 1.0f, 0, CODEC_FRACTION},	//! Vertical Energy tuning factor s / ( 1.0f / 65536 )
+
+	{GNSS_CONFIGURATION, "GNSS_CONFIG",	false, 1.0f, 0, CODEC_INTEGER},	//! type of GNSS system
+	{ANT_BASELENGTH, "ANT_BASELEN",		false, 1.0f, 0, CODEC_MILLI},	//! Slave DGNSS antenna baselength / mm
+	{ANT_SLAVE_DOWN, "ANT_SLAVE_DOWN",	false, 0.0f, 0, CODEC_MILLI},	//! Slave DGNSS antenna lower / mm
+	{ANT_SLAVE_RIGHT,"ANT_SLAVE_RIGHT",	false, 0.0f, 0, CODEC_MILLI},	//! Slave DGNSS antenna more right /mm
+
+	{NMEA_RATE_VARIO, "NMEA_Vario_Hz",	false, 10.0f, 0, CODEC_RATE},	//! PLARV output rate / Hz, stored in 0.01 Hz units, 0 = off
+	{NMEA_RATE_ATTITUDE, "NMEA_Att_Hz",	false, 5.0f, 0, CODEC_RATE},	//! PLARA output rate
+	{NMEA_RATE_HEADING, "NMEA_Head_Hz",	false, 10.0f, 0, CODEC_RATE},	//! HCHDT output rate
+	{NMEA_RATE_WIND, "NMEA_Wind_Hz",	false, 10.0f, 0, CODEC_RATE},	//! PLARW instant wind output rate
+	{NMEA_RATE_MEAN_WIND, "NMEA_MeanWnd_Hz",false, 1.0f, 0, CODEC_RATE},	//! PLARW average wind output rate
+	{NMEA_RATE_HOUSEKEEPING, "NMEA_House_Hz",	false, 0.2f, 0, CODEC_RATE},	//! PLARB + PLARD output rate
     };
 
-ROM unsigned PERSISTENT_DATA_ENTRIES = sizeof(PERSISTENT_DATA) / sizeof(persistent_data_t);
+#define N_PERSISTENT_DATA ( sizeof(PERSISTENT_DATA) / sizeof(persistent_data_t))
 
-bool all_EEPROM_parameters_existing( void)
+ROM unsigned PERSISTENT_DATA_ENTRIES = N_PERSISTENT_DATA;
+
+//! dense map EEPROM_PARAMETER_ID -> index into PERSISTENT_DATA
+class parameter_index_t
 {
-  float dummy;
-  const persistent_data_t * parameter = PERSISTENT_DATA + 1; // skip BOARD_ID
-  while( parameter < PERSISTENT_DATA + PERSISTENT_DATA_ENTRIES)
+public:
+  enum { NOT_FOUND = 0xff};
+  uint8_t index[EEPROM_PARAMETER_ID_END];
+};
+
+constexpr parameter_index_t make_parameter_index( void)
+{
+  parameter_index_t table = {};
+  for( unsigned id = 0; id < EEPROM_PARAMETER_ID_END; ++id)
+    table.index[id] = parameter_index_t::NOT_FOUND;
+  for( unsigned i = 0; i < N_PERSISTENT_DATA; ++i)
+    table.index[PERSISTENT_DATA[i].id] = (uint8_t)i;
+  return table;
+}
+
+//! true if every ID in PERSISTENT_DATA is unique
+constexpr bool parameter_IDs_unique( void)
+{
+  for( unsigned i = 0; i < N_PERSISTENT_DATA; ++i)
+    for( unsigned k = i + 1; k < N_PERSISTENT_DATA; ++k)
+      if( PERSISTENT_DATA[i].id == PERSISTENT_DATA[k].id)
+	return false;
+  return true;
+}
+
+static_assert( N_PERSISTENT_DATA < parameter_index_t::NOT_FOUND, "parameter index exceeds uint8_t");
+static_assert( parameter_IDs_unique(), "duplicate ID in PERSISTENT_DATA");
+
+static ROM constexpr parameter_index_t PARAMETER_INDEX = make_parameter_index();
+
+//! linear conversion value <-> EEPROM_data_t, same arithmetic (and rounding) as the former switch per ID
+class EEPROM_codec_t
+{
+public:
+  enum { SIGNED=1, ROUND=2, WRAP_ANGLE=4, INVALID_TAG=8};
+  float read_divisor;	//!< value = raw / read_divisor * read_factor + offset
+  float read_factor;
+  float write_factor;	//!< raw = ( value - offset) * write_factor * write_factor_2 / write_divisor
+  float write_factor_2;
+  float write_divisor;
+  float offset;
+  float invalid_limit;	//!< INVALID_TAG: 0xffff for values outside [ 0, invalid_limit)
+  uint8_t flags;
+};
+
+ROM EEPROM_codec_t EEPROM_CODEC[] =
     {
-      if( true == read_EEPROM_value( parameter->id, dummy))
-	return false; // read error
-      ++parameter;
+	{ 1.0f,    1.0f,    1.0f,    1.0f,     1.0f,   0.0f, 0.0f,      EEPROM_codec_t::ROUND}, 	// CODEC_INTEGER
+	{ 1.0f,    1.0f,    1.0f,    1.0f,     1.0f,   0.0f, 0.0f,      EEPROM_codec_t::SIGNED},	// CODEC_SIGNED_INTEGER
+	{ 32768.0f, 1.0f,   32768.0f, 1.0f,    1.0f,   1.0f, 0.0f,      EEPROM_codec_t::SIGNED},	// CODEC_SPAN
+	{ 65536.0f, 1e-2f,  1e2f,    65536.0f, 1.0f,   0.0f, 0.009999f, EEPROM_codec_t::INVALID_TAG},	// CODEC_STD_DEVIATION
+	{ 3276.8f, 1.0f,    3276.8f, 1.0f,     1.0f,   0.0f, 0.0f,      EEPROM_codec_t::SIGNED},	// CODEC_MAG_OFFSET
+	{ 1.0f,    0.001f,  1000.0f, 1.0f,     1.0f,   0.0f, 0.0f,      EEPROM_codec_t::SIGNED},	// CODEC_MILLI
+	{ 32768.0f, M_PI_F, 32768.0f, 1.0f,    M_PI_F, 0.0f, 0.0f,      EEPROM_codec_t::SIGNED | EEPROM_codec_t::ROUND | EEPROM_codec_t::WRAP_ANGLE}, // CODEC_ANGLE
+	{ 655.36f, 1.0f,    655.36f, 1.0f,     1.0f,   0.0f, 0.0f,      0},				// CODEC_TIME_CONSTANT
+	{ 1.0f,    0.01f,   100.0f,  1.0f,     1.0f,   0.0f, 0.0f,      EEPROM_codec_t::ROUND},	// CODEC_RATE
+	{ 65536.0f, 1.0f,   65536.0f, 1.0f,    1.0f,   0.0f, 0.0f,      EEPROM_codec_t::ROUND},	// CODEC_FRACTION
+    };
+
+static_assert( sizeof( EEPROM_CODEC) / sizeof( EEPROM_codec_t) == CODEC_END, "EEPROM_CODEC does not match EEPROM_codec_id_t");
+
+bool EEPROM_encode( EEPROM_PARAMETER_ID id, float value, EEPROM_data_t &EEPROM_value)
+{
+  const persistent_data_t *parameter = find_parameter_from_ID( id);
+  if( parameter == 0)
+    return true; // error
+  const EEPROM_codec_t &codec = EEPROM_CODEC[parameter->codec];
+
+  if( ( codec.flags & EEPROM_codec_t::INVALID_TAG) && ( value >= codec.invalid_limit || value < 0.0f))
+    {
+      EEPROM_value.u16 = 0xffff;
+      return false;
+    }
+
+  if( codec.flags & EEPROM_codec_t::WRAP_ANGLE)
+    {
+      if( value < -M_PI_F)
+	value += 2.0f * M_PI_F;
+      if( value >= M_PI_F)
+	value -= 2 * M_PI_F;
     }
+
+  float raw = ( value - codec.offset) * codec.write_factor * codec.write_factor_2 / codec.write_divisor;
+  if( codec.flags & EEPROM_codec_t::ROUND)
+    raw = round( raw);
+
+  // saturate, the conversion truncates
+  bool is_signed = codec.flags & EEPROM_codec_t::SIGNED;
+  float minimum = is_signed ? -32768.0f : 0.0f;
+  float maximum = is_signed ?  32767.0f : 65535.0f;
+  if( raw < minimum)
+    raw = minimum;
+  if( raw > maximum)
+    raw = maximum;
+
+  if( is_signed)
+    EEPROM_value.i16 = (int16_t)raw;
+  else
+    EEPROM_value.u16 = (uint16_t)raw;
+  return false; // OK
+}
+
+bool EEPROM_decode( EEPROM_PARAMETER_ID id, EEPROM_data_t EEPROM_value, float &value)
+{
+  const persistent_data_t *parameter = find_parameter_from_ID( id);
+  if( parameter == 0)
+    return true; // error
+  const EEPROM_codec_t &codec = EEPROM_CODEC[parameter->codec];
+
+  float raw = ( codec.flags & EEPROM_codec_t::SIGNED) ? (float)(EEPROM_value.i16) : (float)(EEPROM_value.u16);
+  value = raw / codec.read_divisor * codec.read_factor + codec.offset;
+  return false; // OK
+}
+
+bool all_EEPROM_parameters_existing( void)
+{
+  float value[EEPROM_PARAMETER_ID_END];
+  bool available[EEPROM_PARAMETER_ID_END];
+  read_all_EEPROM_values( value, available);
+  for( const persistent_data_t * parameter = PERSISTENT_DATA + 1; // skip BOARD_ID
+      parameter < PERSISTENT_DATA + N_PERSISTENT_DATA; ++parameter)
+    if( ! available[parameter->id])
+	return false; // read error
   return true;
 }
 
 const persistent_data_t * find_parameter_from_ID( EEPROM_PARAMETER_ID id)
 {
-  for( const persistent_data_t *parameter = PERSISTENT_DATA; parameter < (PERSISTENT_DATA+PERSISTENT_DATA_ENTRIES); ++parameter )
-    if( parameter->id == id)
-      return parameter;
-  return 0;
+  if( (unsigned)id >= EEPROM_PARAMETER_ID_END)
+    return 0;
+  uint8_t index = PARAMETER_INDEX.index[id];
+  return index == parameter_index_t::NOT_FOUND ? 0 : PERSISTENT_DATA + index;
+}
+
+bool read_all_EEPROM_values( float value[EEPROM_PARAMETER_ID_END], bool available[EEPROM_PARAMETER_ID_END])
+{
+  bool error = false;
+  for( unsigned id = 0; id < EEPROM_PARAMETER_ID_END; ++id)
+    available[id] = false;
+  for( const persistent_data_t *parameter = PERSISTENT_DATA; parameter < (PERSISTENT_DATA+N_PERSISTENT_DATA); ++parameter )
+    {
+      float data;
+      if( read_EEPROM_value( parameter->id, data))
+	error = true;
+      else
+	{
+	  value[parameter->id] = data;
+	  available[parameter->id] = true;
+	}
+    }
+  return error;
+}
+
+#if UNIX != 1 && EEPROM_JOURNAL
+static bool EEPROM_transaction_open; //!< write_EEPROM_value() only stages
+static void begin_EEPROM_transaction( void);
+static bool commit_EEPROM_transaction( void);
+#else
+static void begin_EEPROM_transaction( void)
+{}
+static bool commit_EEPROM_transaction( void)
+{
+  return false;
+}
+#endif
+
+bool write_all_EEPROM_values( const float value[EEPROM_PARAMETER_ID_END], const bool selected[EEPROM_PARAMETER_ID_END])
+{
+  bool error = false;
+  EEPROM_initialize();
+  begin_EEPROM_transaction();
+  for( const persistent_data_t *parameter = PERSISTENT_DATA; parameter < (PERSISTENT_DATA+N_PERSISTENT_DATA); ++parameter )
+    if( selected[parameter->id])
+      error |= write_EEPROM_value( parameter->id, value[parameter->id]); // unchanged values are not rewritten
+  error |= commit_EEPROM_transaction(); // one journal record for all of them
+  return error;
 }
 
 #if UNIX != 1
@@ -97,115 +267,115 @@ const persistent_data_t * find_parameter_from_ID( EEPROM_PARAMETER_ID id)
 
 bool EEPROM_convert( EEPROM_PARAMETER_ID id, EEPROM_data_t & EEPROM_value, float & value , bool read )
 {
-  switch(id)
+  return read ? EEPROM_decode( id, EEPROM_value, value) : EEPROM_encode( id, value, EEPROM_value);
+}
+
+#if EEPROM_JOURNAL
+
+//! journal pages = consecutive flash sectors
+class STM32_flash_driver_t : public flash_driver_t
+{
+public:
+  bool erase_page( unsigned page) override
   {
-    case BOARD_ID:
-    case GNSS_CONFIGURATION:
-    case MAG_AUTO_CALIB:
-    case MAG_EARTH_AUTO:
-      if( read)
-	value = (float)(EEPROM_value.u16);
-      else
-	EEPROM_value.u16 = (uint16_t)round(value);
-      break;
-    case QNH_OFFSET:
-    case PITOT_OFFSET:
-      if( read)
-	value = ( float)(EEPROM_value.i16);
-      else
-	EEPROM_value.i16 = (int16_t)value;
-      break;
-    case PITOT_SPAN:
-    case MAG_X_SCALE:
-    case MAG_Y_SCALE:
-    case MAG_Z_SCALE:
-      if( read)
-	value = ( (float)(EEPROM_value.i16) / 32768.0f) + 1.0f;
-      else
-	{
-	  int ivalue = (int)((value - 1.0f) * 32768.0f);
-	  if( ivalue > 32767)
-	    ivalue = 32767;
-	  if( ivalue < -32768)
-	    ivalue = -32768;
-	  EEPROM_value.i16 = (int16_t)ivalue;
-	}
-      break;
-    case MAG_STD_DEVIATION:
-      if( read)
-	value = (float)(EEPROM_value.u16) / 65536.0f * 1e-2f;
-      else
-	{
-	  if( value >= 0.009999f || value < 0.0f)
-	    EEPROM_value.u16 = 0xffff;
-	  else
-	    EEPROM_value.u16 = (uint16_t)(value * 1e2f * 65536.0f);
-	}
-      break;
-    case MAG_X_OFF:
-    case MAG_Y_OFF:
-    case MAG_Z_OFF:
-      if( read)
-	value = ( (float)(EEPROM_value.i16) / 3276.8f);
-      else
-	EEPROM_value.i16 = (int16_t)(value * 3276.8f);
-      break;
-    case ANT_BASELENGTH: // max +/- 32.768 m
-    case ANT_SLAVE_DOWN:
-    case ANT_SLAVE_RIGHT:
-      if( read)
-	value = (float)(EEPROM_value.i16) * 0.001f;
-      else
-	EEPROM_value.i16 = (int16_t)(value * 1000.0f);
-      break;
-      break;
-    case DECLINATION:
-    case INCLINATION:
-    case SENS_TILT_ROLL:
-    case SENS_TILT_NICK:
-    case SENS_TILT_YAW:
-      if( read)
-	value = (float)(EEPROM_value.i16) / 32768.0f * M_PI_F;
-      else
-	{
-	  if( value < -M_PI_F)
-	    value += 2.0f * M_PI_F;
-	  if( value >= M_PI_F)
-	    value -= 2 * M_PI_F;
-	  int ivalue = round(value * 32768.0f / M_PI_F);
-	  if( ivalue >= 32768)
-	    ivalue = 32767;
-	  EEPROM_value.i16 = (int16_t)ivalue;
-	}
-      break;
-    case VARIO_TC:
-    case VARIO_INT_TC:
-    case WIND_TC:
-    case MEAN_WIND_TC:
-      if( read)
-	value = (float)(EEPROM_value.u16) / 655.36f;
-      else
-	EEPROM_value.u16 = (uint16_t)(value * 655.36f);
-      break;
-    case VETF:
-      if( read)
-	value = (float)(EEPROM_value.u16) / 65536.0f;
-      else
-	{
-	  unsigned uvalue = round( value * 65536.0f);
-	  if( uvalue >= 65536)
-	    uvalue = 65535;
-	  EEPROM_value.u16 = (uint16_t)uvalue;
-	}
-      break;
-    case EEPROM_PARAMETER_ID_END:
-    default:
-	return true; // error
-      break;
+    FLASH_EraseInitTypeDef erase;
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = EEPROM_JOURNAL_FIRST_SECTOR + page;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    uint32_t sector_error;
+    return HAL_OK != HAL_FLASHEx_Erase( &erase, &sector_error);
   }
-  return false; // OK
+
+  bool program( unsigned page, unsigned word_offset, const uint32_t *data, unsigned words) override
+  {
+    uint32_t address = EEPROM_JOURNAL_BASE_ADDRESS + page * EEPROM_JOURNAL_PAGE_SIZE + word_offset * sizeof( uint32_t);
+    for( unsigned i = 0; i < words; ++i, address += sizeof( uint32_t))
+      if( HAL_OK != HAL_FLASH_Program( FLASH_TYPEPROGRAM_WORD, address, data[i]))
+	return true;
+    return false;
+  }
+
+  const uint32_t * get_page( unsigned page) const override
+  {
+    return (const uint32_t *)( EEPROM_JOURNAL_BASE_ADDRESS + page * EEPROM_JOURNAL_PAGE_SIZE);
+  }
+};
+
+static STM32_flash_driver_t flash_driver;
+static EEPROM_journal_t journal( flash_driver);
+static bool journal_mounted;
+
+static void mount_journal( void)
+{
+  if( journal_mounted)
+    return;
+  journal.mount(); // an empty journal is no error, missing parameters are reported by read_EEPROM_value()
+  journal_mounted = true;
+}
+
+static void begin_EEPROM_transaction( void)
+{
+  EEPROM_transaction_open = true;
+}
+
+static bool commit_EEPROM_transaction( void)
+{
+  EEPROM_transaction_open = false;
+  return journal.commit();
 }
 
+bool lock_EEPROM( bool lockit)
+{
+  if( lockit)
+    return HAL_FLASH_Lock();
+
+  HAL_FLASH_Unlock();
+  mount_journal();
+  return HAL_OK;
+}
+
+bool write_EEPROM_value( EEPROM_PARAMETER_ID id, float value)
+{
+  EEPROM_data_t EEPROM_value;
+  if( EEPROM_encode( id, value, EEPROM_value))
+      return true; // error
+
+  mount_journal();
+  journal.stage( id, EEPROM_value.u16);
+  return EEPROM_transaction_open ? false : journal.commit(); // unchanged sets are not written
+}
+
+bool read_EEPROM_value( EEPROM_PARAMETER_ID id, float &value)
+{
+  EEPROM_data_t data;
+  mount_journal();
+  if( journal.read( id, data.u16))
+    return true;
+  return EEPROM_decode( id, data, value);
+}
+
+float configuration( EEPROM_PARAMETER_ID id)
+{
+  float value;
+  bool result = read_EEPROM_value( id, value);
+  ASSERT( result == false);
+  return value;
+}
+
+bool EEPROM_initialize( void)
+{
+  unsigned status;
+
+  status = HAL_FLASH_Unlock();
+  ASSERT(status == HAL_OK);
+
+  mount_journal();
+  return HAL_OK;
+}
+
+#else // ST EEPROM emulation
+
 bool lock_EEPROM( bool lockit)
 {
   if( lockit)
@@ -258,4 +428,6 @@ bool EEPROM_initialize( void)
   return HAL_OK;
 }
 
+#endif // EEPROM_JOURNAL
+
 #endif
@@ -79,9 +79,32 @@ enum EEPROM_PARAMETER_ID
   ANT_SLAVE_DOWN,
   ANT_SLAVE_RIGHT,
 
+  NMEA_RATE_VARIO=50, // PLARV
+  NMEA_RATE_ATTITUDE, // PLARA
+  NMEA_RATE_HEADING,  // HCHDT
+  NMEA_RATE_WIND,     // PLARW instant
+  NMEA_RATE_MEAN_WIND,// PLARW average
+  NMEA_RATE_HOUSEKEEPING, // PLARB, PLARD
+
   EEPROM_PARAMETER_ID_END // 1 behind last parameter ID
 };
 
+//! EEPROM representation of a parameter, index into EEPROM_CODEC
+enum EEPROM_codec_id_t
+{
+  CODEC_INTEGER,	//!< unsigned, rounded
+  CODEC_SIGNED_INTEGER,	//!< signed, truncated
+  CODEC_SPAN,		//!< 1.0 + value / 32768
+  CODEC_STD_DEVIATION,	//!< 1 % / 65536, 0xffff = invalid
+  CODEC_MAG_OFFSET,	//!< 10.0 / 32768
+  CODEC_MILLI,		//!< 0.001
+  CODEC_ANGLE,		//!< 180 degrees / 32768, wrapped into [-pi, pi)
+  CODEC_TIME_CONSTANT,	//!< 100 s / 65536
+  CODEC_RATE,		//!< 0.01 Hz
+  CODEC_FRACTION,	//!< 1.0 / 65536
+  CODEC_END
+};
+
 class persistent_data_t
 {
 public:
@@ -91,6 +114,7 @@ public:
   bool is_an_angle;
   float default_value;
   EEPROM_data_t value;
+  EEPROM_codec_id_t codec;
 };
 
 const persistent_data_t * find_parameter_from_ID( EEPROM_PARAMETER_ID id);
@@ -103,6 +127,16 @@ bool lock_EEPROM( bool lockit);
 bool EEPROM_initialize( void);
 bool all_EEPROM_parameters_existing( void);
 
+//! float -> EEPROM representation through the codec table, returns true on error (unknown ID)
+bool EEPROM_encode( EEPROM_PARAMETER_ID id, float value, EEPROM_data_t &EEPROM_value);
+//! EEPROM representation -> float, returns true on error (unknown ID)
+bool EEPROM_decode( EEPROM_PARAMETER_ID id, EEPROM_data_t EEPROM_value, float &value);
+
+//! read all parameters in one pass, arrays are indexed by EEPROM_PARAMETER_ID, returns true if any is missing
+bool read_all_EEPROM_values( float value[EEPROM_PARAMETER_ID_END], bool available[EEPROM_PARAMETER_ID_END]);
+//! write all selected parameters in one pass (one journal record if EEPROM_JOURNAL), returns true on error
+bool write_all_EEPROM_values( const float value[EEPROM_PARAMETER_ID_END], const bool selected[EEPROM_PARAMETER_ID_END]);
+
 extern const persistent_data_t PERSISTENT_DATA[];
 extern const unsigned PERSISTENT_DATA_ENTRIES;
 
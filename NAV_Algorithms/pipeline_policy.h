@@ -0,0 +1,230 @@
+/***********************************************************************//**
+ * @file		pipeline_policy.h
+ * @brief		compile-time configuration of the AHRS pipeline (policies)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef PIPELINE_POLICY_H_
+#define PIPELINE_POLICY_H_
+
+#include "system_configuration.h"
+#include "embedded_math.h"
+#include "float3vector.h"
+#include "compass_calibration.h"
+#include "induction_observer.h"
+#include "configuration_snapshot.h"
+#include "NAV_tuning_parameters.h"
+
+#ifndef PIPELINE_D_GNSS
+#define PIPELINE_D_GNSS 1 //!< if 0: single antenna GNSS image without D-GNSS heading aiding code and state
+#endif
+
+/**
+ * @brief D-GNSS heading aiding: antenna geometry and heading difference D-GNSS - AHRS
+ *
+ * Heading aiding policies provide AVAILABLE, heading_difference() and
+ * get_heading_difference(), the AHRS uses nothing else.
+ */
+class D_GNSS_heading_aiding_t
+{
+public:
+  enum { AVAILABLE = 1};
+
+  D_GNSS_heading_aiding_t( configuration_snapshot_t &configuration)
+    : antenna_DOWN_correction(  configuration( ANT_SLAVE_DOWN)  / configuration( ANT_BASELENGTH)),
+      antenna_RIGHT_correction( configuration( ANT_SLAVE_RIGHT) / configuration( ANT_BASELENGTH)),
+      heading_difference_AHRS_DGNSS( 0.0f)
+  {}
+
+  //! heading difference D-GNSS - AHRS, mapped into { -PI PI}
+  float heading_difference( float GNSS_heading, float roll, float yaw)
+  {
+    float difference = GNSS_heading	// correct for antenna alignment
+	+ antenna_DOWN_correction  * SIN (roll)
+	- antenna_RIGHT_correction * COS (roll);
+
+    difference = difference - yaw;
+
+    if (difference > M_PI_F) // map into { -PI PI}
+      difference -= 2.0f * M_PI_F;
+    if (difference < -M_PI_F)
+      difference += 2.0f * M_PI_F;
+
+    heading_difference_AHRS_DGNSS = difference;
+    return difference;
+  }
+
+  float get_heading_difference( void) const
+  {
+    return heading_difference_AHRS_DGNSS;
+  }
+
+private:
+  float antenna_DOWN_correction;  //!< slave antenna lower / DGNSS base length
+  float antenna_RIGHT_correction; //!< slave antenna more right / DGNSS base length
+  float heading_difference_AHRS_DGNSS;
+};
+
+//! single antenna GNSS: magnetic heading only, no state
+class no_heading_aiding_t
+{
+public:
+  enum { AVAILABLE = 0};
+
+  no_heading_aiding_t( configuration_snapshot_t &)
+  {}
+
+  float heading_difference( float, float, float)
+  {
+    return 0.0f;
+  }
+
+  float get_heading_difference( void) const
+  {
+    return 0.0f;
+  }
+};
+
+//! magnetic statistics: float accumulators
+class float_statistics_t
+{
+public:
+  typedef linear_least_square_fit<float, float> mag_calibration_collector_t;
+  typedef compass_calibration_t <float, float> compass_calibration_type;
+  typedef induction_observer_t <float> earth_induction_collector_t;
+
+  static float scale( void) //!< collector input scale
+  {
+    return 1.0f;
+  }
+};
+
+//! magnetic statistics: 64-bit integer accumulators, inputs scaled by 10000
+class integer_statistics_t
+{
+public:
+  typedef linear_least_square_fit<int64_t, float> mag_calibration_collector_t;
+  typedef compass_calibration_t <int64_t, float> compass_calibration_type;
+  typedef induction_observer_t <int64_t> earth_induction_collector_t;
+
+  static float scale( void)
+  {
+    return 10000.0f;
+  }
+};
+
+//! magnetic statistics: float Welford updates, small and numerically stable
+class welford_statistics_t
+{
+public:
+  typedef linear_least_square_fit_welford<float> mag_calibration_collector_t;
+  typedef compass_calibration_t <float, float> compass_calibration_type;
+  typedef induction_observer_t <float, mean_and_variance_welford_t<float> > earth_induction_collector_t;
+
+  static float scale( void)
+  {
+    return 1.0f;
+  }
+};
+
+class lowcost_IMU_t;
+
+//! IMU source: the primary IMU
+class main_IMU_t
+{
+public:
+  typedef lowcost_IMU_t secondary_t; //!< the other IMU for dual IMU fusion
+
+  template <class measurement_type> static const float3vector &acc( const measurement_type &m)
+  {
+    return m.acc;
+  }
+  template <class measurement_type> static const float3vector &mag( const measurement_type &m)
+  {
+    return m.mag;
+  }
+  template <class measurement_type> static const float3vector &gyro( const measurement_type &m)
+  {
+    return m.gyro;
+  }
+};
+
+//! IMU source: the low-cost IMU
+class lowcost_IMU_t
+{
+public:
+  typedef main_IMU_t secondary_t;
+
+  template <class measurement_type> static const float3vector &acc( const measurement_type &m)
+  {
+    return m.lowcost_acc;
+  }
+  template <class measurement_type> static const float3vector &mag( const measurement_type &m)
+  {
+    return m.lowcost_mag;
+  }
+  template <class measurement_type> static const float3vector &gyro( const measurement_type &m)
+  {
+    return m.lowcost_gyro;
+  }
+};
+
+/**
+ * @brief type parameters of the AHRS pipeline
+ *
+ * Each firmware image instantiates the pipeline it needs,
+ * code and state of the other variants are not compiled in.
+ */
+template <class heading_aiding, class statistics, class IMU_source> class pipeline_configuration_t
+{
+public:
+  typedef heading_aiding heading_aiding_t;
+  typedef statistics statistics_t;
+  typedef IMU_source IMU_source_t;
+};
+
+#if FLOAT_STATISTICS
+typedef welford_statistics_t default_statistics_t;
+#elif MAG_HIGH_PRECISION
+typedef integer_statistics_t default_statistics_t;
+#else
+typedef float_statistics_t default_statistics_t;
+#endif
+
+#if USE_LOWCOST_IMU == 1
+typedef lowcost_IMU_t default_IMU_source_t;
+#else
+typedef main_IMU_t default_IMU_source_t;
+#endif
+
+#if PIPELINE_D_GNSS
+typedef D_GNSS_heading_aiding_t default_heading_aiding_t;
+#else
+typedef no_heading_aiding_t default_heading_aiding_t;
+#endif
+
+//! the pipeline of this firmware image
+typedef pipeline_configuration_t< default_heading_aiding_t, default_statistics_t, default_IMU_source_t> default_pipeline_t;
+
+//! compass-only pipeline, same statistics and IMU
+typedef pipeline_configuration_t< no_heading_aiding_t, default_statistics_t, default_IMU_source_t> magnetic_pipeline_t;
+
+#endif /* PIPELINE_POLICY_H_ */
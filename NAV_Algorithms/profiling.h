@@ -0,0 +1,162 @@
+/***********************************************************************//**
+ * @file		profiling.h
+ * @brief		optional cycle-count instrumentation of the algorithm stages
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+
+#ifndef PROFILING_H_
+#define PROFILING_H_
+
+#include "system_configuration.h"
+#include <stdint.h>
+
+#ifndef WITH_PROFILING
+#define WITH_PROFILING 0 //!< if 1: measure cycle counts of all algorithm stages
+#endif
+
+//! instrumented algorithm stages
+enum profiling_stage_t
+{
+  PROFILE_NAVIGATOR_10MS, 	//!< complete navigator_t::update_every_10ms
+  PROFILE_AHRS, 		//!< AHRS_type::update
+  PROFILE_SHADOW_ESTIMATORS, 	//!< attached shadow estimators, e.g. the magnetic AHRS
+  PROFILE_FLIGHT_OBSERVER, 	//!< flight_observer_t::update_every_10ms
+  PROFILE_NAVIGATOR_100MS, 	//!< complete navigator_t::update_every_100ms
+  PROFILE_STAGES
+};
+
+#if UNIX == 1
+#if defined( __x86_64__) || defined( __i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+//! read free running cycle counter, wraps around after 2^32 cycles
+inline uint32_t read_cycle_counter( void)
+{
+#if UNIX == 1
+#if defined( __x86_64__) || defined( __i386__)
+  return (uint32_t)__rdtsc();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+#else
+  return *(volatile uint32_t *)0xE0001004; // DWT->CYCCNT
+#endif
+}
+
+//! enable the DWT cycle counter, to be called once at startup
+inline void initialize_cycle_counter( void)
+{
+#if UNIX != 1
+  *(volatile uint32_t *)0xE000EDFC |= 1 << 24; // CoreDebug->DEMCR |= TRCENA
+  *(volatile uint32_t *)0xE0001004 = 0;	       // DWT->CYCCNT
+  *(volatile uint32_t *)0xE0001000 |= 1;       // DWT->CTRL |= CYCCNTENA
+#endif
+}
+
+#if WITH_PROFILING
+
+//! min / max / mean statistics of one stage
+class profile_statistics_t
+{
+public:
+  profile_statistics_t( void)
+  {
+    reset();
+  }
+
+  void reset( void)
+  {
+    min = UINT32_MAX;
+    max = 0;
+    sum = 0;
+    count = 0;
+  }
+
+  void add( uint32_t cycles)
+  {
+    if( cycles < min)
+      min = cycles;
+    if( cycles > max)
+      max = cycles;
+    sum += cycles;
+    ++count;
+  }
+
+  uint32_t get_mean( void) const
+  {
+    return count ? (uint32_t)( sum / count) : 0;
+  }
+
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t count;
+};
+
+//! statistics for all stages
+class profiling_report_t
+{
+public:
+  void reset( void)
+  {
+    for( unsigned i = 0; i < PROFILE_STAGES; ++i)
+      stage[i].reset();
+  }
+
+  profile_statistics_t stage[PROFILE_STAGES];
+};
+
+//! measures the lifetime of the object
+class profile_scope_t
+{
+public:
+  profile_scope_t( profiling_report_t &_report, profiling_stage_t _stage)
+    : report( _report),
+      stage( _stage),
+      start( read_cycle_counter())
+  {}
+
+  ~profile_scope_t( void)
+  {
+    report.stage[stage].add( read_cycle_counter() - start); // unsigned arithmetic handles the wrap-around
+  }
+
+private:
+  profiling_report_t &report;
+  profiling_stage_t stage;
+  uint32_t start;
+};
+
+#define PROFILE_STAGE( report, stage) profile_scope_t profile_scope_##stage( report, stage)
+
+#else
+
+#define PROFILE_STAGE( report, stage)
+
+#endif
+
+#endif /* PROFILING_H_ */
@@ -0,0 +1,51 @@
+/***********************************************************************//**
+ * @file		ram_budget.cpp
+ * @brief		static RAM per subsystem, compile-time limits and report table
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "embedded_memory.h"
+#include "ram_budget.h"
+#include "organizer.h"
+
+#define RAM_BUDGET_LIST( ENTRY) \
+  ENTRY( "AHRS_type", 		AHRS_type, 					RAM_BUDGET_AHRS) \
+  ENTRY( "flight_observer_t", 	flight_observer_t, 				RAM_BUDGET_FLIGHT_OBSERVER) \
+  ENTRY( "atmosphere_t", 	atmosphere_t, 					RAM_BUDGET_ATMOSPHERE) \
+  ENTRY( "wind averager", 	soaring_flight_averager< float3vector COMMA true>, RAM_BUDGET_WIND_AVERAGER) \
+  ENTRY( "navigator_t", 	navigator_t, 					RAM_BUDGET_NAVIGATOR) \
+  ENTRY( "organizer_t", 	organizer_t, 					RAM_BUDGET_ORGANIZER)
+
+#define COMMA ,
+
+#define RAM_BUDGET_CHECK( name, type, budget) \
+  static_assert( ( budget) == 0 || sizeof( type) <= ( budget), name " exceeds its RAM budget");
+
+RAM_BUDGET_LIST( RAM_BUDGET_CHECK)
+
+#define RAM_BUDGET_ENTRY( name, type, budget) { name, sizeof( type), budget },
+
+ROM ram_budget_entry_t RAM_BUDGET_TABLE[] =
+  {
+    RAM_BUDGET_LIST( RAM_BUDGET_ENTRY)
+  };
+
+ROM unsigned RAM_BUDGET_ENTRIES = sizeof( RAM_BUDGET_TABLE) / sizeof( ram_budget_entry_t);
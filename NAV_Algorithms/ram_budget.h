@@ -0,0 +1,66 @@
+/***********************************************************************//**
+ * @file		ram_budget.h
+ * @brief		static RAM per subsystem, compile-time limits and report table
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef RAM_BUDGET_H_
+#define RAM_BUDGET_H_
+
+#include <stdint.h>
+
+/*
+ * RAM_BUDGET_<subsystem> may be defined in system_configuration.h or on the
+ * command line, the build fails if the subsystem grows beyond it.
+ * 0 = not checked.
+ */
+#ifndef RAM_BUDGET_AHRS
+#define RAM_BUDGET_AHRS			0
+#endif
+#ifndef RAM_BUDGET_FLIGHT_OBSERVER
+#define RAM_BUDGET_FLIGHT_OBSERVER	0
+#endif
+#ifndef RAM_BUDGET_ATMOSPHERE
+#define RAM_BUDGET_ATMOSPHERE		0
+#endif
+#ifndef RAM_BUDGET_WIND_AVERAGER
+#define RAM_BUDGET_WIND_AVERAGER	0
+#endif
+#ifndef RAM_BUDGET_NAVIGATOR
+#define RAM_BUDGET_NAVIGATOR		0
+#endif
+#ifndef RAM_BUDGET_ORGANIZER
+#define RAM_BUDGET_ORGANIZER		0
+#endif
+
+//! one line of the report
+typedef struct
+{
+  const char *name;
+  uint32_t size;  	//!< sizeof() in bytes
+  uint32_t budget; 	//!< configured limit, 0 = not checked
+} ram_budget_entry_t;
+
+//! sizes of the present build configuration, the navigator contains the smaller subsystems
+extern const ram_budget_entry_t RAM_BUDGET_TABLE[];
+extern const unsigned RAM_BUDGET_ENTRIES;
+
+#endif /* RAM_BUDGET_H_ */
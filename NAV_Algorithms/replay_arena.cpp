@@ -0,0 +1,80 @@
+/***********************************************************************//**
+ * @file		replay_arena.cpp
+ * @brief		many replay engines in one cache-aligned block, stepped sample-major
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "replay_arena.h"
+
+#if UNIX == 1
+
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <vector>
+
+replay_arena_t::replay_arena_t( unsigned _instances, const configuration_snapshot_t *configurations)
+  : memory( (uint8_t *)::operator new( (size_t)_instances * STRIDE, std::align_val_t( REPLAY_ARENA_ALIGNMENT))),
+    instances( _instances)
+{
+  const configuration_snapshot_t &default_configuration = EEPROM_configuration();
+  for( unsigned i = 0; i < instances; ++i)
+    new( memory + i * STRIDE) replay_engine_t( configurations ? configurations[i] : default_configuration, false);
+}
+
+replay_arena_t::~replay_arena_t( void)
+{
+  for( unsigned i = 0; i < instances; ++i)
+    get_engine( i).~replay_engine_t();
+  ::operator delete( memory, std::align_val_t( REPLAY_ARENA_ALIGNMENT));
+}
+
+void replay_arena_t::run_range( unsigned first, unsigned end, const observations_type *observations, unsigned count,
+				output_data_t *output, unsigned output_stride)
+{
+  for( unsigned sample = 0; sample < count; sample += REPLAY_ARENA_BLOCK)
+    {
+      unsigned block = std::min( count - sample, (unsigned)REPLAY_ARENA_BLOCK);
+      for( unsigned i = first; i < end; ++i)
+	get_engine( i).run( observations + sample, output + (size_t)i * output_stride + sample, block);
+    }
+}
+
+unsigned replay_arena_t::run( const observations_type *observations, unsigned count,
+			      output_data_t *output, unsigned output_stride, unsigned threads)
+{
+  if( threads == 0)
+    threads = std::max( 1u, std::thread::hardware_concurrency());
+  threads = std::max( 1u, std::min( threads, instances));
+
+  std::vector<std::thread> pool;
+  for( unsigned t = 1; t < threads; ++t)
+    pool.emplace_back( [=]( void)
+      {
+	run_range( instances * t / threads, instances * ( t + 1) / threads, observations, count, output, output_stride);
+      });
+  run_range( 0, instances / threads, observations, count, output, output_stride); // the calling thread takes part
+  for( std::thread &t : pool)
+    t.join();
+  return count;
+}
+
+#endif
@@ -0,0 +1,132 @@
+/***********************************************************************//**
+ * @file		replay_arena.h
+ * @brief		many replay engines in one cache-aligned block, stepped sample-major
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef REPLAY_ARENA_H_
+#define REPLAY_ARENA_H_
+
+#include "system_configuration.h"
+
+#if UNIX == 1 // host only
+
+#include "replay_engine.h"
+
+#define REPLAY_ARENA_ALIGNMENT	64	//!< host cache line, every instance starts on its own line
+
+#ifndef REPLAY_ARENA_BLOCK
+#define REPLAY_ARENA_BLOCK	REPLAY_DECIMATION //!< samples per instance and step, 1 = strictly sample-major
+#endif
+
+/**
+ * @brief parameter sweep over one flight with many replay engines
+ *
+ * All instances live in one allocation, padded to whole cache lines,
+ * instead of being scattered over the heap.
+ * run() advances every instance by a block of samples before the next block is read,
+ * so the observations are read once for all instances
+ * and the input may come from a stream, e.g. a parser queue.
+ * With several threads each one steps a contiguous range of instances.
+ */
+class replay_arena_t
+{
+public:
+  /**
+   * @param configurations one parameter set per instance, 0 = EEPROM configuration for all
+   * calibration results are never written back
+   */
+  replay_arena_t( unsigned instances, const configuration_snapshot_t *configurations = 0);
+  ~replay_arena_t( void);
+
+  replay_arena_t( const replay_arena_t &) = delete;
+  replay_arena_t & operator = ( const replay_arena_t &) = delete;
+
+  /**
+   * @brief advance all instances by count samples
+   *
+   * The output of instance i for observations[s] goes to output[i * output_stride + s],
+   * output_stride = total number of samples results in the larus_replay_sweep() layout.
+   * Can be called repeatedly with consecutive chunks of the flight.
+   *
+   * @param threads number of worker threads, 0 = one per CPU core
+   * @return number of samples processed per instance
+   */
+  unsigned run( const observations_type *observations, unsigned count,
+		output_data_t *output, unsigned output_stride, unsigned threads = 1);
+
+  /**
+   * @brief advance all instances by the records queued by a producer thread (e.g. a file parser)
+   * @return number of samples processed per instance, at most max_count
+   */
+  template <unsigned SIZE>
+  unsigned drain( spsc_queue<observations_type, SIZE> &queue, output_data_t *output, unsigned output_stride, unsigned max_count)
+  {
+    observations_type chunk[REPLAY_ARENA_BLOCK];
+    unsigned processed = 0;
+    while( processed < max_count)
+      {
+	unsigned wanted = max_count - processed;
+	unsigned count = queue.pop( chunk, wanted < REPLAY_ARENA_BLOCK ? wanted : REPLAY_ARENA_BLOCK);
+	if( count == 0)
+	  break;
+	run_range( 0, instances, chunk, count, output + processed, output_stride);
+	processed += count;
+      }
+    return processed;
+  }
+
+  unsigned get_instances( void) const
+  {
+    return instances;
+  }
+
+  //! distance between two instances in bytes
+  static unsigned get_stride( void)
+  {
+    return STRIDE;
+  }
+
+  replay_engine_t & get_engine( unsigned i)
+  {
+    return *(replay_engine_t *)( memory + i * STRIDE);
+  }
+
+  const replay_engine_t & get_engine( unsigned i) const
+  {
+    return *(const replay_engine_t *)( memory + i * STRIDE);
+  }
+
+private:
+  enum { STRIDE = ( sizeof( replay_engine_t) + REPLAY_ARENA_ALIGNMENT - 1) / REPLAY_ARENA_ALIGNMENT * REPLAY_ARENA_ALIGNMENT};
+  static_assert( alignof( replay_engine_t) <= REPLAY_ARENA_ALIGNMENT, "instance alignment");
+
+  //! instances [first, end) over all samples, block-wise
+  void run_range( unsigned first, unsigned end, const observations_type *observations, unsigned count,
+		  output_data_t *output, unsigned output_stride);
+
+  uint8_t *memory;
+  unsigned instances;
+};
+
+#endif
+
+#endif /* REPLAY_ARENA_H_ */
@@ -0,0 +1,164 @@
+/***********************************************************************//**
+ * @file		replay_c_api.cpp
+ * @brief		C interface of the replay engine for foreign language bindings (Python ctypes)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "replay_c_api.h"
+
+#if UNIX == 1
+
+#include "replay_engine.h"
+#include "parallel_replay.h"
+#include "log_schema.h"
+#include "segment_index.h"
+#include <math.h>
+#include <memory>
+#include <vector>
+
+static const log_schema_t *get_schema( unsigned schema)
+{
+  switch( schema)
+  {
+    case LARUS_OBSERVATIONS_SCHEMA:
+      return &OBSERVATIONS_LOG_SCHEMA;
+    case LARUS_OUTPUT_SCHEMA:
+      return &OUTPUT_LOG_SCHEMA;
+    default:
+      return 0;
+  }
+}
+
+//! EEPROM / default values overridden by the non-NaN entries of parameters
+static void setup_configuration( configuration_snapshot_t &configuration, const float *parameters)
+{
+  configuration = EEPROM_configuration();
+  if( parameters == 0)
+    return;
+  for( unsigned id = 0; id < EEPROM_PARAMETER_ID_END; ++id)
+    if( ! isnan( parameters[id]))
+      configuration.set( (EEPROM_PARAMETER_ID)id, parameters[id]);
+}
+
+unsigned larus_record_size( unsigned schema)
+{
+  const log_schema_t *s = get_schema( schema);
+  return s ? s->record_size : 0;
+}
+
+unsigned larus_record_alignment( unsigned schema)
+{
+  switch( schema)
+  {
+    case LARUS_OBSERVATIONS_SCHEMA:
+      return alignof( observations_type);
+    case LARUS_OUTPUT_SCHEMA:
+      return alignof( output_data_t);
+    default:
+      return 0;
+  }
+}
+
+unsigned larus_channel_count( unsigned schema)
+{
+  const log_schema_t *s = get_schema( schema);
+  return s ? s->channel_count : 0;
+}
+
+const char * larus_channel( unsigned schema, unsigned index, unsigned *offset, unsigned *type)
+{
+  const log_schema_t *s = get_schema( schema);
+  if( s == 0 || index >= s->channel_count)
+    return 0;
+  *offset = s->channels[index].offset;
+  *type = s->channels[index].type;
+  return s->channels[index].name;
+}
+
+unsigned larus_log_record_size( void)
+{
+  return sizeof( observations_record_t);
+}
+
+void larus_from_log_records( const void *records, unsigned count, void *observations)
+{
+  const observations_record_t *source = (const observations_record_t *)records;
+  observations_type *target = (observations_type *)observations;
+  for( unsigned i = 0; i < count; ++i)
+    from_record( source[i], target[i]);
+}
+
+unsigned larus_parameter_count( void)
+{
+  return EEPROM_PARAMETER_ID_END;
+}
+
+const char * larus_parameter_name( unsigned id)
+{
+  if( id >= EEPROM_PARAMETER_ID_END)
+    return 0;
+  const persistent_data_t *parameter = find_parameter_from_ID( (EEPROM_PARAMETER_ID)id);
+  return parameter ? parameter->mnemonic : 0;
+}
+
+float larus_parameter_default( unsigned id)
+{
+  if( id >= EEPROM_PARAMETER_ID_END)
+    return NAN;
+  return EEPROM_configuration()( (EEPROM_PARAMETER_ID)id);
+}
+
+unsigned larus_replay( const void *observations, unsigned count, void *output, const float *parameters)
+{
+  configuration_snapshot_t configuration;
+  setup_configuration( configuration, parameters);
+  std::unique_ptr<replay_engine_t> engine( new replay_engine_t( configuration, false));
+  return engine->run( (const observations_type *)observations, (output_data_t *)output, count);
+}
+
+unsigned larus_replay_sweep( const void *observations, unsigned count, void *output,
+			     const float *parameter_sets, unsigned sets, unsigned threads)
+{
+  std::vector<configuration_snapshot_t> configurations( sets);
+  std::vector<flight_replay_job_t> jobs( sets);
+  for( unsigned i = 0; i < sets; ++i)
+    {
+      setup_configuration( configurations[i], parameter_sets ? parameter_sets + i * EEPROM_PARAMETER_ID_END : 0);
+      jobs[i].observations = (const observations_type *)observations;
+      jobs[i].count = count;
+      jobs[i].output = (output_data_t *)output + i * count;
+      jobs[i].configuration = &configurations[i];
+    }
+  parallel_replay( jobs.data(), sets, threads);
+  return sets * count;
+}
+
+unsigned larus_segment_record_size( void)
+{
+  return sizeof( flight_segment_t);
+}
+
+unsigned larus_index_segments( const void *output, unsigned count, void *segments, unsigned capacity)
+{
+  return index_segments( (const output_data_t *)output, count, (flight_segment_t *)segments, capacity);
+}
+
+#endif
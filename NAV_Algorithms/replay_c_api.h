@@ -0,0 +1,108 @@
+/***********************************************************************//**
+ * @file		replay_c_api.h
+ * @brief		C interface of the replay engine for foreign language bindings (Python ctypes)
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef REPLAY_C_API_H_
+#define REPLAY_C_API_H_
+
+#include "system_configuration.h"
+
+#if UNIX == 1 // host only
+
+/*
+ * Records are passed as raw memory in the compiled layout of observations_type
+ * and output_data_t, the caller builds matching arrays from the schema functions.
+ * Nothing is copied or converted, the output arrays are written in place.
+ * Parameter sets are float arrays indexed by EEPROM_PARAMETER_ID,
+ * larus_parameter_count() entries each, NaN = keep the EEPROM / default value.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum larus_schema_t
+{
+  LARUS_OBSERVATIONS_SCHEMA, 	//!< observations_type
+  LARUS_OUTPUT_SCHEMA		//!< output_data_t
+};
+
+//! record size in bytes
+unsigned larus_record_size( unsigned schema);
+
+//! required alignment of the record arrays in bytes
+unsigned larus_record_alignment( unsigned schema);
+
+unsigned larus_channel_count( unsigned schema);
+
+//! name, byte offset and log_channel_type_t of one scalar channel, returns 0 if index is out of range
+const char * larus_channel( unsigned schema, unsigned index, unsigned *offset, unsigned *type);
+
+//! size of observations_record_t, the packed log layout
+unsigned larus_log_record_size( void);
+
+//! unpack count log records into observations_type records
+void larus_from_log_records( const void *records, unsigned count, void *observations);
+
+//! number of entries in a parameter set
+unsigned larus_parameter_count( void);
+
+//! mnemonic of the parameter or 0 if the ID is unused
+const char * larus_parameter_name( unsigned id);
+
+//! value used if the parameter set entry is NaN
+float larus_parameter_default( unsigned id);
+
+/**
+ * @brief replay one flight
+ * @param parameters parameter set or 0
+ * @return number of output records written
+ */
+unsigned larus_replay( const void *observations, unsigned count, void *output, const float *parameters);
+
+/**
+ * @brief replay one flight with sets parameter sets in parallel
+ *
+ * output holds sets * count records, flight replayed with set i starts at record i * count.
+ * @param threads number of worker threads, 0 = one per CPU core
+ * @return number of output records written
+ */
+unsigned larus_replay_sweep( const void *observations, unsigned count, void *output,
+			     const float *parameter_sets, unsigned sets, unsigned threads);
+
+//! size of flight_segment_t, the segment index record
+unsigned larus_segment_record_size( void);
+
+/**
+ * @brief flight phase segments of replayed output records
+ * @return number of flight_segment_t records written, at most capacity
+ */
+unsigned larus_index_segments( const void *output, unsigned count, void *segments, unsigned capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif /* REPLAY_C_API_H_ */
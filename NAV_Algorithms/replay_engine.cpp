@@ -0,0 +1,73 @@
+/***********************************************************************//**
+ * @file		replay_engine.cpp
+ * @brief		batch replay of recorded observations through organizer_t
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "replay_engine.h"
+#include "denormal.h"
+
+void replay_engine_t::process_sample( output_data_t &output_data)
+{
+  if( sample_counter == 0)
+    organizer.initialize_after_first_measurement( output_data);
+
+  organizer.on_new_pressure_data( output_data);
+
+  // GNSS data are replicated in every record, update_GNSS_data is idempotent
+  organizer.update_GNSS_data( output_data.c);
+
+  organizer.update_every_10ms( output_data);
+  organizer.run_deferred_jobs(); // background work done at once, results used by the next tick as on the target
+
+  if( sample_counter % REPLAY_DECIMATION == 0)
+    {
+#if WITH_DENSITY_DATA
+      if( output_data.m.outside_air_humidity > 0.0f) // true if outside air data are available
+	organizer.set_density_data( output_data.m.outside_air_temperature, output_data.m.outside_air_humidity);
+      else
+	organizer.disregard_density_data();
+#endif
+#if ! TICK_SCHEDULER
+      organizer.update_every_100ms( output_data);
+#endif
+    }
+#if TICK_SCHEDULER
+  organizer.update_tick_slot( output_data);
+#endif
+
+  organizer.report_data( output_data);
+  ++sample_counter;
+}
+
+unsigned replay_engine_t::run( const observations_type *observations, output_data_t *output, unsigned count)
+{
+#if REPLAY_FLUSH_DENORMALS
+  scoped_flush_denormals_t flush_denormals;
+#endif
+  for( const observations_type *end = observations + count; observations < end; ++observations, ++output)
+    {
+      output->m = observations->m;
+      output->c = observations->c;
+      process_sample( *output);
+    }
+  return count;
+}
@@ -0,0 +1,158 @@
+/***********************************************************************//**
+ * @file		replay_engine.h
+ * @brief		batch replay of recorded observations through organizer_t
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef REPLAY_ENGINE_H_
+#define REPLAY_ENGINE_H_
+
+#include "data_structures.h"
+#include "organizer.h"
+#include "spsc_queue.h"
+
+//! number of fast samples per slow update
+#define REPLAY_DECIMATION FAST_SLOW_DECIMATION
+
+/**
+ * @brief replay recorded observations through the complete algorithm chain
+ *
+ * Consumes observations_type records (sampled @ FAST_SAMPLING_FREQUENCY) and produces
+ * one output_data_t record per input record.
+ * The fast / slow loop scheduling is done internally.
+ * No memory is allocated, the caller provides the output array.
+ * run() may be called repeatedly to process a flight in chunks.
+ * With DEVELOPMENT_ADDITIONS the magnetic comparison AHRS is attached as shadow estimator.
+ */
+class replay_engine_t
+{
+public:
+  /**
+   * @param _configuration parameter set, copied into the instance
+   * @param calibration_write_back if false magnetic calibration results
+   *        are kept in RAM only and no global state is written
+   */
+  replay_engine_t( const configuration_snapshot_t &_configuration = EEPROM_configuration(), bool calibration_write_back = true)
+  : configuration( _configuration),
+    organizer( configuration),
+#if DEVELOPMENT_ADDITIONS
+    ahrs_magnetic( configuration),
+#endif
+    sample_counter( 0)
+  {
+#if DEVELOPMENT_ADDITIONS
+    organizer.attach_shadow_estimator( ahrs_magnetic); // full rate on the host
+#endif
+    organizer.initialize_before_measurement();
+    organizer.enable_calibration_write_back( calibration_write_back);
+  }
+
+  //! process count records, returns the number of records written
+  unsigned run( const observations_type *observations, output_data_t *output, unsigned count);
+
+  /**
+   * @brief process records queued by a producer thread (e.g. a file parser)
+   * @return number of records written, at most max_count
+   */
+  template <unsigned SIZE>
+  unsigned drain( spsc_queue<observations_type, SIZE> &queue, output_data_t *output, unsigned max_count)
+  {
+    observations_type chunk[REPLAY_DECIMATION];
+    unsigned processed = 0;
+    while( processed < max_count)
+      {
+	unsigned wanted = max_count - processed;
+	unsigned count = queue.pop( chunk, wanted < REPLAY_DECIMATION ? wanted : REPLAY_DECIMATION);
+	if( count == 0)
+	  break;
+	processed += run( chunk, output + processed, count);
+      }
+    return processed;
+  }
+
+  //! number of samples processed so far
+  unsigned get_sample_counter( void) const
+  {
+    return sample_counter;
+  }
+
+  //! replay position, algorithm state and the calibration results collected so far
+  class state_t
+  {
+  public:
+    configuration_snapshot_t configuration;
+    organizer_t::state_t organizer;
+#if DEVELOPMENT_ADDITIONS
+    shadow_AHRS_magnetic_t::state_t ahrs_magnetic;
+#endif
+    unsigned sample_counter;
+  };
+
+#if DEVELOPMENT_ADDITIONS
+  enum { STATE_LAYOUT = organizer_t::STATE_LAYOUT | 0x8000};
+#else
+  enum { STATE_LAYOUT = organizer_t::STATE_LAYOUT};
+#endif
+
+  //! save the replay position including the dynamic algorithm state
+  void save_checkpoint( checkpoint_t<state_t> &checkpoint) const
+  {
+    checkpoint.state.configuration = configuration;
+    organizer.save_state( checkpoint.state.organizer);
+#if DEVELOPMENT_ADDITIONS
+    ahrs_magnetic.save_state( checkpoint.state.ahrs_magnetic);
+#endif
+    checkpoint.state.sample_counter = sample_counter;
+    seal_checkpoint( checkpoint, STATE_LAYOUT);
+  }
+
+  //! seek to a checkpoint, also one written by another engine, returns true on error
+  bool restore_checkpoint( const checkpoint_t<state_t> &checkpoint)
+  {
+    if( check_checkpoint( checkpoint, STATE_LAYOUT))
+      return true;
+    configuration = checkpoint.state.configuration;
+    organizer.restore_state( checkpoint.state.organizer);
+#if DEVELOPMENT_ADDITIONS
+    ahrs_magnetic.restore_state( checkpoint.state.ahrs_magnetic);
+#endif
+    sample_counter = checkpoint.state.sample_counter;
+    return false;
+  }
+
+  const organizer_t &get_organizer( void) const
+  {
+    return organizer;
+  }
+
+private:
+  //! algorithm sequence for one fast sample, output_data has already been filled with m + c
+  void process_sample( output_data_t &output_data);
+
+  configuration_snapshot_t configuration; //!< private copy, modified by calibration results
+  organizer_t organizer;
+#if DEVELOPMENT_ADDITIONS
+  shadow_AHRS_magnetic_t ahrs_magnetic; //!< comparison output, not needed on the device
+#endif
+  unsigned sample_counter;
+};
+
+#endif /* REPLAY_ENGINE_H_ */
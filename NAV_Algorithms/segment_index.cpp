@@ -0,0 +1,102 @@
+/***********************************************************************//**
+ * @file		segment_index.cpp
+ * @brief		flight phase segment index, written while the flight proceeds
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "segment_index.h"
+
+void segment_indexer_t::start( const output_data_t &output, uint32_t sample)
+{
+  segment.first_sample = sample;
+  segment.end_sample = sample;
+  segment.version = SEGMENT_INDEX_VERSION;
+  segment.circle_state = (uint8_t)output.circle_mode;
+  segment.GNSS_fix = output.c.sat_fix_type;
+  segment.reserved = 0;
+  segment.altitude = output.pressure_altitude;
+  last_altitude = output.pressure_altitude;
+  samples = 0;
+  climb_sum = 0.0f;
+  wind_sum[NORTH] = wind_sum[EAST] = 0.0f;
+  open = true;
+}
+
+bool segment_indexer_t::update( const output_data_t &output, uint32_t sample, flight_segment_t &completed)
+{
+  bool closed = false;
+  if( open && ( output.circle_mode != segment.circle_state
+      || ( output.c.sat_fix_type & SAT_FIX) != ( segment.GNSS_fix & SAT_FIX)))
+    closed = finish( completed);
+
+  if( ! open)
+    start( output, sample);
+
+  ++samples;
+  climb_sum += output.integrator_vario;
+  wind_sum[NORTH] += output.wind.e[NORTH];
+  wind_sum[EAST]  += output.wind.e[EAST];
+  last_altitude = output.pressure_altitude;
+  return closed;
+}
+
+bool segment_indexer_t::finish( flight_segment_t &completed)
+{
+  if( ! open)
+    return false;
+
+  float recip_samples = 1.0f / (float)samples;
+  segment.end_sample = segment.first_sample + samples;
+  segment.duration = (float)samples * FAST_SAMPLING_TIME;
+  segment.mean_climb = climb_sum * recip_samples;
+  segment.altitude_gain = last_altitude - segment.altitude;
+  segment.wind[NORTH] = wind_sum[NORTH] * recip_samples;
+  segment.wind[EAST]  = wind_sum[EAST]  * recip_samples;
+
+  completed = segment;
+  open = false;
+  return true;
+}
+
+#if UNIX == 1
+
+unsigned index_segments( const output_data_t *output, unsigned count, flight_segment_t *segments, unsigned capacity)
+{
+  segment_indexer_t indexer;
+  unsigned written = 0;
+  for( unsigned i = 0; i < count && written < capacity; ++i)
+    if( indexer.update( output[i], i, segments[written]))
+      ++written;
+  if( written < capacity && indexer.finish( segments[written]))
+    ++written;
+  return written;
+}
+
+void find_segments( const flight_segment_t *segments, size_t count, circle_state_t circle_state,
+		    float min_climb, std::vector<unsigned> &selection)
+{
+  selection.clear();
+  for( size_t i = 0; i < count; ++i)
+    if( segments[i].circle_state == circle_state && segments[i].mean_climb >= min_climb)
+      selection.push_back( i);
+}
+
+#endif
@@ -0,0 +1,113 @@
+/***********************************************************************//**
+ * @file		segment_index.h
+ * @brief		flight phase segment index, written while the flight proceeds
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef SEGMENT_INDEX_H_
+#define SEGMENT_INDEX_H_
+
+#include "data_structures.h"
+#include "AHRS.h"
+
+#define SEGMENT_INDEX_VERSION 1
+
+/**
+ * @brief one flight phase: circle state and GNSS fix constant
+ *
+ * The index file is a plain array of these records, appended when a segment closes,
+ * read back with mapped_record_view_t<flight_segment_t>.
+ * Sample offsets refer to the observations log of the same flight.
+ */
+class flight_segment_t
+{
+public:
+  uint32_t first_sample;	//!< offset of the first sample in the log
+  uint32_t end_sample;		//!< one past the last sample
+  uint8_t version;		//!< SEGMENT_INDEX_VERSION
+  uint8_t circle_state;		//!< circle_state_t
+  uint8_t GNSS_fix;		//!< sat_fix_type at the start of the segment
+  uint8_t reserved;
+  float duration;		//!< s
+  float mean_climb;		//!< m/s, mean of integrator_vario
+  float altitude;		//!< m, pressure altitude at the start
+  float altitude_gain;		//!< m
+  float wind[2];		//!< m/s, NORTH, EAST mean of the wind estimate
+};
+
+static_assert( sizeof( flight_segment_t) == 36, "index file layout changed");
+
+/**
+ * @brief splits the output stream into flight segments
+ *
+ * Fed with every output record, e.g. by the logger or after replay_engine_t::run().
+ * A segment closes when the circle state or the GNSS fix changes,
+ * the aggregates are accumulated on the fly, nothing is buffered.
+ */
+class segment_indexer_t
+{
+public:
+  segment_indexer_t( void)
+    : open( false),
+      segment(),
+      samples( 0),
+      climb_sum( 0.0f),
+      wind_sum{ 0.0f, 0.0f},
+      last_altitude( 0.0f)
+  {}
+
+  /**
+   * @brief account one output record
+   * @return true if a segment has been closed and written to completed
+   */
+  bool update( const output_data_t &output, uint32_t sample, flight_segment_t &completed);
+
+  //! close the open segment at the end of the log, returns true if completed has been written
+  bool finish( flight_segment_t &completed);
+
+private:
+  void start( const output_data_t &output, uint32_t sample);
+
+  bool open;
+  flight_segment_t segment; //!< open segment, aggregates incomplete
+  uint32_t samples;
+  float climb_sum;
+  float wind_sum[2];
+  float last_altitude;
+};
+
+#if UNIX == 1 // host only
+
+#include <vector>
+
+/**
+ * @brief index whole flights in memory
+ * @return number of segments written to segments, at most capacity
+ */
+unsigned index_segments( const output_data_t *output, unsigned count, flight_segment_t *segments, unsigned capacity);
+
+//! indices of the segments with the given circle state and a mean climb of at least min_climb
+void find_segments( const flight_segment_t *segments, size_t count, circle_state_t circle_state,
+		    float min_climb, std::vector<unsigned> &selection);
+
+#endif
+
+#endif /* SEGMENT_INDEX_H_ */
@@ -0,0 +1,209 @@
+/***********************************************************************//**
+ * @file		shadow_estimator.h
+ * @brief		alternative estimators fed with the navigator inputs, off the hot path
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef SHADOW_ESTIMATOR_H_
+#define SHADOW_ESTIMATOR_H_
+
+#include "system_configuration.h"
+#include "AHRS.h"
+#include "data_structures.h"
+
+//! inputs of navigator_t::update_every_10ms, as seen by the production AHRS
+class shadow_input_t
+{
+public:
+  float3vector acc;
+  float3vector mag;
+  float3vector gyro;
+  float3vector GNSS_acceleration;
+  float GNSS_heading;
+  bool D_GNSS_available;
+};
+
+/**
+ * @brief interface for comparison estimators running beside the production algorithms
+ *
+ * Attached to navigator_t, which feeds every sample into the shadow.
+ * With decimation > 1 the shadow gets the mean of decimation samples at a
+ * correspondingly longer sampling time, on the device it is typically
+ * decimated or not attached at all, the replay engine runs it at full rate.
+ * The shadow writes its results into the output record only.
+ */
+class shadow_estimator_t
+{
+public:
+  shadow_estimator_t( unsigned _decimation = 1)
+    : decimation( _decimation ? _decimation : 1),
+      count( 0),
+      sum{ {0}, {0}, {0}, {0}, 0.0f, false}
+  {}
+
+  virtual ~shadow_estimator_t( void)
+  {}
+
+  //! called @ FAST_SAMPLING_FREQUENCY by the navigator
+  void feed( const shadow_input_t &input)
+  {
+    if( decimation == 1)
+      {
+	update( input, FAST_SAMPLING_TIME);
+	return;
+      }
+    sum.acc 		  = sum.acc + input.acc;
+    sum.mag 		  = sum.mag + input.mag;
+    sum.gyro 		  = sum.gyro + input.gyro;
+    sum.GNSS_acceleration = sum.GNSS_acceleration + input.GNSS_acceleration;
+    if( ++count < decimation)
+      return;
+
+    float scale = 1.0f / (float)decimation;
+    sum.acc 		  = sum.acc * scale;
+    sum.mag 		  = sum.mag * scale;
+    sum.gyro 		  = sum.gyro * scale;
+    sum.GNSS_acceleration = sum.GNSS_acceleration * scale;
+    sum.GNSS_heading	  = input.GNSS_heading; // angle: no averaging across the wrap-around
+    sum.D_GNSS_available  = input.D_GNSS_available;
+    update( sum, FAST_SAMPLING_TIME * decimation);
+
+    sum.acc = sum.mag = sum.gyro = sum.GNSS_acceleration = {0};
+    count = 0;
+  }
+
+  unsigned get_decimation( void) const
+  {
+    return decimation;
+  }
+
+  //! write comparison output fields, called @ SLOW_SAMPLING_FREQUENCY
+  virtual void report_data( output_data_t &d) const = 0;
+
+  //! roll, nick, yaw / rad, ignored by default
+  virtual void set_attitude( float, float, float)
+  {}
+
+  virtual void enable_calibration_write_back( bool)
+  {}
+
+  //! background work, see AHRS_type::run_deferred_jobs(), true if a job has been processed
+  virtual bool run_deferred_jobs( void)
+  {
+    return false;
+  }
+
+  //! dynamic state of the decimation for checkpoints
+  class state_t
+  {
+  public:
+    unsigned count;
+    shadow_input_t sum;
+  };
+
+  void save_state( state_t &state) const
+  {
+    state.count = count;
+    state.sum = sum;
+  }
+
+  void restore_state( const state_t &state)
+  {
+    count = state.count;
+    sum = state.sum;
+  }
+
+protected:
+  //! one (averaged) sample taken sampling_time after the previous one
+  virtual void update( const shadow_input_t &input, float sampling_time) = 0;
+
+private:
+  unsigned decimation;
+  unsigned count;
+  shadow_input_t sum;
+};
+
+#if DEVELOPMENT_ADDITIONS
+
+//! compass-only AHRS for comparison with the D-GNSS aided production AHRS
+class shadow_AHRS_magnetic_t : public shadow_estimator_t
+{
+public:
+  shadow_AHRS_magnetic_t( configuration_snapshot_t &configuration, unsigned decimation = 1)
+    : shadow_estimator_t( decimation),
+      ahrs( FAST_SAMPLING_TIME * ( decimation ? decimation : 1), configuration)
+  {}
+
+  void report_data( output_data_t &d) const override
+  {
+    d.diagnostics.euler_magnetic		= ahrs.get_euler();
+    d.diagnostics.q_magnetic		= ahrs.get_attitude();
+    d.diagnostics.nav_acceleration_mag 	= ahrs.get_nav_acceleration();
+    d.diagnostics.nav_induction_mag 	= ahrs.get_nav_induction();
+  }
+
+  void set_attitude( float roll, float nick, float yaw) override
+  {
+    ahrs.set_from_euler( roll, nick, yaw);
+  }
+
+  void enable_calibration_write_back( bool enable) override
+  {
+    ahrs.enable_calibration_write_back( enable);
+  }
+
+  bool run_deferred_jobs( void) override
+  {
+    return ahrs.run_deferred_jobs();
+  }
+
+  class state_t
+  {
+  public:
+    shadow_estimator_t::state_t decimation;
+    AHRS_t<magnetic_pipeline_t>::state_t ahrs;
+  };
+
+  void save_state( state_t &state) const
+  {
+    shadow_estimator_t::save_state( state.decimation);
+    ahrs.save_state( state.ahrs);
+  }
+
+  void restore_state( const state_t &state)
+  {
+    shadow_estimator_t::restore_state( state.decimation);
+    ahrs.restore_state( state.ahrs);
+  }
+
+protected:
+  void update( const shadow_input_t &input, float) override // sampling time fixed at construction
+  {
+    ahrs.update_compass( input.gyro, input.acc, input.mag, input.GNSS_acceleration);
+  }
+
+private:
+  AHRS_t<magnetic_pipeline_t> ahrs; //!< without D-GNSS state
+};
+
+#endif
+
+#endif /* SHADOW_ESTIMATOR_H_ */
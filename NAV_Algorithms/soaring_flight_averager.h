@@ -33,10 +33,16 @@
 #define ONE_DIV_2PI 0.159155f
 #define PI_TIMES_2 6.2832f
 
-//! template for an average filter for circling and straight flight
-template<class value_t, bool CLAMP_OUTPUT_FIRST_CIRCLE = false, bool SOFT_TAKEOFF = true>
+/**
+ * @brief template for an average filter for circling and straight flight
+ *
+ * While circling the output is the mean of the sector means.
+ * Running totals are maintained, so an update touches only the present sector.
+ */
+template<class value_t, bool CLAMP_OUTPUT_FIRST_CIRCLE = false, bool SOFT_TAKEOFF = true, unsigned N_SECTORS = 16>
   class soaring_flight_averager
   {
+    static_assert( N_SECTORS > 0 && N_SECTORS <= 32, "sector mask is 32 bits wide");
   public:
     soaring_flight_averager (float normalized_stop_frequency) :
 	active_state (STRAIGHT_FLIGHT),
@@ -44,11 +50,7 @@ template<class value_t, bool CLAMP_OUTPUT_FIRST_CIRCLE = false, bool SOFT_TAKEOF
 	present_output(0),
 	old_sector(0)
     {
-      for (unsigned index = 0; index < N_SECTORS; ++index)
-	  {
-	    sector_averages[index] = {0};
-	    sector_sample_count[index] = 0;
-	  }
+      clear_sectors();
     };
 
     const value_t & get_value (void) const
@@ -116,54 +118,106 @@ template<class value_t, bool CLAMP_OUTPUT_FIRST_CIRCLE = false, bool SOFT_TAKEOF
       if( old_sector != index) // on sector change
 	{
 	  old_sector = index;
+	  if( index == 0) // once per circle: get rid of accumulated rounding errors
+	    resynchronize_total();
+
 	  if( sector_sample_count[index] > 1) // if sector has been used in the circle before
 	    {
 	      // reset sector
+	      total_of_means -= sector_means[index];
+	      used_sector_mask &= ~( 1UL << index);
+	      --used_sectors;
 	      sector_sample_count[index] = 0;
 	      sector_averages[index] = {0};
+	      sector_means[index] = {0};
 	    }
 	}
 
+      if( sector_sample_count[index] == 0)
+	{
+	  used_sector_mask |= 1UL << index;
+	  ++used_sectors;
+	}
+      else
+	total_of_means -= sector_means[index];
+
       sector_averages[index] += current_value;
       ++ sector_sample_count[index];
+      sector_means[index] = sector_averages[index] * ( ONE / sector_sample_count[index]);
+      total_of_means += sector_means[index];
     }
 
     void reset( value_t value)
     {
       averager.settle(value);
+      clear_sectors();
+      present_output = value;
+    }
+
+    bool circle_completed (void) const
+    {
+      return used_sectors == N_SECTORS;
+    }
+
+    //! dynamic state for checkpoints, the sector means are recomputed on restore
+    class state_t
+    {
+    public:
+      circle_state_t active_state;
+      typename pt2<value_t, float>::state_t averager;
+      value_t present_output;
+      value_t total_of_means;
+      value_t sector_averages[N_SECTORS];
+      SOARING_SECTOR_COUNTER_TYPE sector_sample_count[N_SECTORS];
+      uint32_t used_sector_mask;
+      unsigned used_sectors;
+      unsigned old_sector;
+    };
+
+    void save_state( state_t &state) const
+    {
+      state.active_state = active_state;
+      averager.save_state( state.averager);
+      state.present_output = present_output;
+      state.total_of_means = total_of_means;
       for (unsigned i = 0; i < N_SECTORS; ++i)
 	{
-	  sector_averages[i] = {0};
-	  sector_sample_count[i] = 0;
+	  state.sector_averages[i] = sector_averages[i];
+	  state.sector_sample_count[i] = sector_sample_count[i];
 	}
-      present_output = value;
+      state.used_sector_mask = used_sector_mask;
+      state.used_sectors = used_sectors;
+      state.old_sector = old_sector;
     }
 
-    bool circle_completed (void) const
+    void restore_state( const state_t &state)
     {
-      for (unsigned index = 0; index < N_SECTORS; ++index)
-	if( sector_sample_count[index] == 0)
-	  return false;
-      return true;
+      active_state = state.active_state;
+      averager.restore_state( state.averager);
+      present_output = state.present_output;
+      total_of_means = state.total_of_means;
+      for (unsigned i = 0; i < N_SECTORS; ++i)
+	{
+	  sector_averages[i] = state.sector_averages[i];
+	  sector_sample_count[i] = state.sector_sample_count[i];
+	  if( sector_sample_count[i] == 0)
+	    sector_means[i] = {0};
+	  else
+	    sector_means[i] = sector_averages[i] * ( ONE / sector_sample_count[i]);
+	}
+      used_sector_mask = state.used_sector_mask;
+      used_sectors = state.used_sectors;
+      old_sector = state.old_sector;
     }
 
   private:
 
     value_t get_boxcar_average( void)
     {
-      value_t average = { 0 };
-
-      unsigned number_of_used_sectors = 0;
-      for (unsigned index = 0; index < N_SECTORS; ++index)
-	if( sector_sample_count[index] > 0)
-	  {
-	    average = average + sector_averages[index] * ( ONE / sector_sample_count[index]);
-	    ++number_of_used_sectors;
-	  }
-      if( number_of_used_sectors == 0)
+      if( used_sectors == 0)
 	return {0};
       else
-	return average * (1.0f / (float) number_of_used_sectors); // as division may not be implemented
+	return total_of_means * (1.0f / (float) used_sectors); // as division may not be implemented
     }
 
     unsigned find_sector_index( float heading)
@@ -179,17 +233,46 @@ template<class value_t, bool CLAMP_OUTPUT_FIRST_CIRCLE = false, bool SOFT_TAKEOF
       for (unsigned i = 0; i < N_SECTORS; ++i)
 	{
 	  sector_averages[i] = value;
+	  sector_means[i] = value;
 	  sector_sample_count[i] = 1;
 	}
+      used_sector_mask = ALL_SECTORS;
+      used_sectors = N_SECTORS;
+      resynchronize_total();
+    }
+
+    void clear_sectors( void)
+    {
+      for (unsigned i = 0; i < N_SECTORS; ++i)
+	{
+	  sector_averages[i] = {0};
+	  sector_means[i] = {0};
+	  sector_sample_count[i] = 0;
+	}
+      total_of_means = {0};
+      used_sector_mask = 0;
+      used_sectors = 0;
+    }
+
+    //! sum up the used sectors from scratch
+    void resynchronize_total( void)
+    {
+      total_of_means = {0};
+      for( uint32_t mask = used_sector_mask; mask != 0; mask &= mask - 1)
+	total_of_means += sector_means[__builtin_ctz( mask)];
     }
 
-    enum { N_SECTORS = 16};
+    static constexpr uint32_t ALL_SECTORS = N_SECTORS == 32 ? 0xffffffffUL : ( 1UL << N_SECTORS) - 1;
 
     circle_state_t active_state;
     pt2<value_t, float> averager; // IIR-averager for straight flight
     value_t present_output; // maintained to save computing time
-    value_t sector_averages[N_SECTORS]; // boxcar averager for circling flight
-    unsigned sector_sample_count[N_SECTORS]; // boxcar averager for circling flight
+    value_t sector_averages[N_SECTORS]; // boxcar averager for circling flight: sums
+    value_t sector_means[N_SECTORS]; // sector sum / sector sample count
+    value_t total_of_means; // sum of sector_means over the used sectors
+    SOARING_SECTOR_COUNTER_TYPE sector_sample_count[N_SECTORS]; // boxcar averager for circling flight
+    uint32_t used_sector_mask; // bit i set if sector i has samples
+    unsigned used_sectors;
     unsigned old_sector;
   };
 
@@ -27,6 +27,13 @@
 
 #include "float3vector.h"
 #include "AHRS.h"
+#include "NAV_tuning_parameters.h"
+
+//! square root rounded to the nearest integer, for compile-time constants
+constexpr unsigned rounded_sqrt( unsigned n, unsigned r = 0)
+{
+  return (2*r+1)*(2*r+1) > 4*n ? r : rounded_sqrt( n, r+1);
+}
 
 //! Specialized decimating filter for 3d wind data
 class wind_observer_t
@@ -35,8 +42,7 @@ public:
   wind_observer_t (float beta_design)
   : decimating_counter(DECIMATION)
   {
-//  beta_max = exp( - T_sample / Tau );
-    beta_max = 0.982f; // todo implement correct parameter setup
+    beta_max = ONE - ONE / DECIMATION; // time constant DECIMATION samples per stage, 0.982 @ 100 Hz
     stage_1_N = ZERO;
     stage_1_E = ZERO;
   }
@@ -73,15 +79,15 @@ public:
 	present_output.e[NORTH] = present_output.e[NORTH] * alpha_N + stage_1_N * beta_N;
 	present_output.e[EAST]  = present_output.e[EAST]  * alpha_E + stage_1_E * beta_E;
 	present_output.e[DOWN]  = present_output.e[DOWN]  * (ONE - beta_max) + stage_1_D * beta_max;
-      }
 
-    // catch denormalized data
-    if( !isnormal( present_output.e[EAST]) || !isnormal( present_output.e[NORTH]) || !isnormal( present_output.e[DOWN]))
-      present_output.e[NORTH] = present_output.e[EAST] = present_output.e[DOWN] = ZERO;
+	// catch denormalized data, only here the output changes
+	if( !isnormal( present_output.e[EAST]) || !isnormal( present_output.e[NORTH]) || !isnormal( present_output.e[DOWN]))
+	  present_output.e[NORTH] = present_output.e[EAST] = present_output.e[DOWN] = ZERO;
+      }
   }
 
  private:
-  enum { DECIMATION = 55}; // two stages -> decimation 1/100s -> 30 s; 55 = sqrt(3000)
+  enum { DECIMATION = rounded_sqrt( 30 * FAST_SAMPLING_FREQUENCY)}; // two stages -> decimation 1/fs -> 30 s; 55 = sqrt(3000) @ 100 Hz
   float stage_1_N; //!< North component filter feedback
   float stage_1_E; //!< East component filter feedback
   float stage_1_D; //!< Down component filter feedback
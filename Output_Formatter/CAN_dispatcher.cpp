@@ -0,0 +1,85 @@
+/***********************************************************************//**
+ * @file		CAN_dispatcher.cpp
+ * @brief		CAN receive side: ID-indexed dispatch table, parameter writes
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "CAN_dispatcher.h"
+#include "my_assert.h"
+#include <math.h>
+
+void CAN_dispatch_table_duplicate_ID( void)
+{
+  ASSERT( 0); // only reached by a table built at run time
+}
+
+bool CAN_parameter_receiver_t::receive( const CANpacket &packet)
+{
+  const CAN_parameter_write_t &frame = CAN_payload<CAN_parameter_write_t>( packet);
+  if( frame.id >= EEPROM_PARAMETER_ID_END
+      || find_parameter_from_ID( (EEPROM_PARAMETER_ID)frame.id) == 0
+      || ! isfinite( frame.value))
+    {
+      ++rejected;
+      return true;
+    }
+
+  pending.value[frame.id] = frame.value;
+  pending.selected[frame.id] = true;
+  any_pending = true;
+  if( frame.flags & CAN_PARAMETER_COMMIT)
+    commit_requested = true;
+  update();
+  return false;
+}
+
+void CAN_parameter_receiver_t::update( void)
+{
+  parameter_set_t *done = job.get_completed();
+  if( done)
+    {
+      commit_error = done->error;
+      job.release();
+    }
+
+  if( ! commit_requested || ! any_pending)
+    return;
+
+  parameter_set_t *set = job.prepare();
+  if( set == 0)
+    return; // previous set still being written, retried on the next call
+
+  *set = pending;
+  job.submit();
+  for( unsigned i = 0; i < EEPROM_PARAMETER_ID_END; ++i)
+    pending.selected[i] = false;
+  any_pending = commit_requested = false;
+}
+
+bool CAN_parameter_receiver_t::run_deferred_jobs( void)
+{
+  parameter_set_t *set = job.get_submitted();
+  if( set == 0)
+    return false;
+  set->error = write_all_EEPROM_values( set->value, set->selected); // one journal record
+  job.complete();
+  return true;
+}
@@ -0,0 +1,206 @@
+/***********************************************************************//**
+ * @file		CAN_dispatcher.h
+ * @brief		CAN receive side: ID-indexed dispatch table, parameter writes
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef CAN_DISPATCHER_H_
+#define CAN_DISPATCHER_H_
+
+#include "generic_CAN_driver.h"
+#include "spsc_queue.h"
+#include "deferred_job.h"
+#include "persistent_data.h"
+
+#define CAN_STANDARD_IDS	2048	//!< 11-bit identifiers
+
+#ifndef CAN_ID_PARAMETER_WRITE
+#define CAN_ID_PARAMETER_WRITE	0x120	//!< CAN_parameter_write_t
+#endif
+
+#define CAN_DRAIN_BATCH		8	//!< frames fetched from the RX FIFO in one go
+
+//! payload of a frame seen as payload_t, nothing is copied
+template <class payload_t> const payload_t & CAN_payload( const CANpacket &p)
+{
+  static_assert( sizeof( payload_t) <= 8, "CAN payload exceeds 8 bytes");
+  static_assert( alignof( payload_t) <= alignof( uint64_t), "CAN payload alignment");
+  return *(const payload_t *)p.data_b;
+}
+
+//! CAN_ID_PARAMETER_WRITE: one parameter, commit = write all collected parameters to EEPROM
+class CAN_parameter_write_t
+{
+public:
+  uint16_t id;		//!< EEPROM_PARAMETER_ID
+  uint8_t flags;	//!< CAN_PARAMETER_COMMIT
+  uint8_t reserved;
+  float value;		//!< physical value as configuration() returns it
+};
+
+#define CAN_PARAMETER_COMMIT	1 	//!< flags bit: last parameter of a set
+
+//! one ID of the dispatch table, handled if the frame carries at least min_dlc bytes
+template <class context_t> class CAN_receive_entry_t
+{
+public:
+  uint16_t id;
+  uint8_t min_dlc;
+  void ( *handler)( context_t &context, const CANpacket &packet);
+};
+
+//! not constexpr, a duplicate ID in a constexpr table does not compile
+void CAN_dispatch_table_duplicate_ID( void);
+
+/**
+ * @brief dispatch table keyed by the 11-bit ID
+ *
+ * Built at compile time from a list of entries, e.g.
+ * constexpr CAN_receive_entry_t<organizer_t> ENTRIES[] = { { 0x120, 8, &on_parameter}, ... };
+ * constexpr CAN_dispatcher_t<organizer_t, 2> DISPATCHER( ENTRIES);
+ * One table lookup per frame, the slot table occupies 2 kB ROM.
+ */
+template <class context_t, unsigned N> class CAN_dispatcher_t
+{
+  static_assert( N > 0 && N < 256, "1 .. 255 entries");
+public:
+  enum dispatch_result_t { HANDLED, UNKNOWN_ID, SHORT_FRAME};
+
+  constexpr CAN_dispatcher_t( const CAN_receive_entry_t<context_t> ( &_entries)[N])
+    : slot{},
+      entries{}
+  {
+    for( unsigned i = 0; i < N; ++i)
+      {
+	entries[i] = _entries[i];
+	uint16_t id = _entries[i].id & ( CAN_STANDARD_IDS - 1);
+	if( slot[id] != 0)
+	  CAN_dispatch_table_duplicate_ID();
+	slot[id] = i + 1;
+      }
+  }
+
+  dispatch_result_t dispatch( context_t &context, const CANpacket &packet) const
+  {
+    unsigned index = slot[packet.id & ( CAN_STANDARD_IDS - 1)];
+    if( index == 0 || packet.id >= CAN_STANDARD_IDS)
+      return UNKNOWN_ID;
+    const CAN_receive_entry_t<context_t> &entry = entries[index - 1];
+    if( packet.dlc < entry.min_dlc)
+      return SHORT_FRAME;
+    entry.handler( context, packet);
+    return HANDLED;
+  }
+
+  //! dispatch count frames, returns the number of frames handled
+  unsigned dispatch( context_t &context, const CANpacket *packets, unsigned count) const
+  {
+    unsigned handled = 0;
+    for( unsigned i = 0; i < count; ++i)
+      handled += dispatch( context, packets[i]) == HANDLED;
+    return handled;
+  }
+
+  /**
+   * @brief empty the RX FIFO filled by the CAN receive interrupt
+   * @return number of frames fetched, at most max_count
+   */
+  template <unsigned SIZE>
+  unsigned drain( context_t &context, spsc_queue<CANpacket, SIZE> &fifo, unsigned max_count = SIZE) const
+  {
+    CANpacket batch[CAN_DRAIN_BATCH];
+    unsigned fetched = 0;
+    while( fetched < max_count)
+      {
+	unsigned wanted = max_count - fetched;
+	unsigned count = fifo.pop( batch, wanted < CAN_DRAIN_BATCH ? wanted : CAN_DRAIN_BATCH);
+	if( count == 0)
+	  break;
+	dispatch( context, batch, count);
+	fetched += count;
+      }
+    return fetched;
+  }
+
+private:
+  uint8_t slot[CAN_STANDARD_IDS]; //!< entry index + 1, 0 = no handler
+  CAN_receive_entry_t<context_t> entries[N];
+};
+
+/**
+ * @brief collects parameter write frames, commits each set through write_all_EEPROM_values()
+ *
+ * receive() and update() run in the CAN / real-time task,
+ * the EEPROM write runs in run_deferred_jobs() of the background task,
+ * all parameters of one set go into one journal record.
+ */
+class CAN_parameter_receiver_t
+{
+public:
+  CAN_parameter_receiver_t( void)
+    : any_pending( false),
+      commit_requested( false),
+      commit_error( false),
+      rejected( 0)
+  {
+    for( unsigned i = 0; i < EEPROM_PARAMETER_ID_END; ++i)
+      pending.selected[i] = false;
+  }
+
+  //! handler for CAN_ID_PARAMETER_WRITE, returns true if the frame has been rejected
+  bool receive( const CANpacket &packet);
+
+  //! real-time side: submit a requested commit, collect the result of the last one
+  void update( void);
+
+  //! background side: returns true if a parameter set has been written
+  bool run_deferred_jobs( void);
+
+  //! true if the last commit has failed
+  bool get_commit_error( void) const
+  {
+    return commit_error;
+  }
+
+  //! frames with unknown parameter ID or invalid value
+  unsigned get_rejected( void) const
+  {
+    return rejected;
+  }
+
+private:
+  class parameter_set_t
+  {
+  public:
+    float value[EEPROM_PARAMETER_ID_END];
+    bool selected[EEPROM_PARAMETER_ID_END];
+    bool error;
+  };
+
+  parameter_set_t pending;
+  bool any_pending;
+  bool commit_requested;
+  bool commit_error;
+  unsigned rejected;
+  deferred_job_t<parameter_set_t> job;
+};
+
+#endif /* CAN_DISPATCHER_H_ */
@@ -0,0 +1,74 @@
+/***********************************************************************//**
+ * @file		CAN_gateway.cpp
+ * @brief		CAN-over-USART gateway v2: batched CAN frames, CRC16, COBS framing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "CAN_gateway.h"
+#include "crc16.h"
+
+unsigned CAN_gateway_encode( const CANpacket *p, unsigned count, uint8_t *buffer, unsigned capacity)
+{
+  if( count > CAN_GATEWAY_MAX_PACKETS || capacity < CAN_GATEWAY_FRAME_SIZE( count))
+    return 0;
+
+  uint8_t payload[CAN_GATEWAY_PAYLOAD_SIZE( CAN_GATEWAY_MAX_PACKETS)];
+  CAN_gateway_burst_t &burst = *(CAN_gateway_burst_t *)payload;
+  burst.version = CAN_GATEWAY_VERSION;
+  burst.count = (uint8_t)count;
+  for( unsigned i = 0; i < count; ++i)
+    {
+      CAN_gateway_entry_t &entry = burst.entry[i];
+      entry.id_dlc = (uint16_t)( ( p[i].id & 0x7ff) | ( p[i].dlc << 12));
+      for( unsigned k = 0; k < 8; ++k)
+	entry.data[k] = p[i].data_b[k];
+    }
+
+  unsigned size = CAN_GATEWAY_PAYLOAD_SIZE( count) - 2;
+  uint16_t crc = crc16( payload, size);
+  payload[size++] = (uint8_t)crc;
+  payload[size++] = (uint8_t)( crc >> 8);
+
+  unsigned length = cobs_encode( payload, size, buffer);
+  buffer[length++] = 0; // frame delimiter
+  return length;
+}
+
+bool CAN_gateway_decode( uint8_t *frame, unsigned size, const CAN_gateway_burst_t * &burst)
+{
+  unsigned length;
+  if( cobs_decode( frame, size, frame, length))
+    return true;
+  if( length < CAN_GATEWAY_PAYLOAD_SIZE( 0))
+    return true;
+
+  const CAN_gateway_burst_t *received = (const CAN_gateway_burst_t *)frame;
+  if( received->version != CAN_GATEWAY_VERSION
+      || received->count > CAN_GATEWAY_MAX_PACKETS
+      || length != CAN_GATEWAY_PAYLOAD_SIZE( received->count))
+    return true;
+
+  if( crc16( frame, length - 2) != ( frame[length - 2] | ( frame[length - 1] << 8)))
+    return true;
+
+  burst = received;
+  return false;
+}
@@ -0,0 +1,93 @@
+/***********************************************************************//**
+ * @file		CAN_gateway.h
+ * @brief		CAN-over-USART gateway v2: batched CAN frames, CRC16, COBS framing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef CAN_GATEWAY_H_
+#define CAN_GATEWAY_H_
+
+#include "generic_CAN_driver.h"
+#include "cobs.h"
+
+#define CAN_GATEWAY_VERSION	2 	//!< first payload byte, CAN_gateway_packet is version 1
+
+#ifndef CAN_GATEWAY_MAX_PACKETS
+#define CAN_GATEWAY_MAX_PACKETS	16 	//!< CAN frames per USART burst
+#endif
+
+#pragma pack(push, 1)
+
+//! one CAN frame within a gateway burst, read directly from the receive buffer
+class CAN_gateway_entry_t
+{
+public:
+  uint16_t get_id( void) const
+  {
+    return id_dlc & 0x7ff;
+  }
+  uint16_t get_dlc( void) const
+  {
+    return id_dlc >> 12;
+  }
+  void to_CANpacket( CANpacket &p) const
+  {
+    p.id = get_id();
+    p.dlc = get_dlc();
+    for( unsigned i = 0; i < 8; ++i)
+      p.data_b[i] = data[i];
+  }
+
+  uint16_t id_dlc; 	//!< little endian, bits 0..10 id, bits 12..15 dlc
+  uint8_t data[8];
+};
+
+//! payload of one frame before COBS encoding, followed by the CRC-16/CCITT
+typedef struct
+{
+  uint8_t version; 	//!< CAN_GATEWAY_VERSION
+  uint8_t count; 	//!< number of entries
+  CAN_gateway_entry_t entry[CAN_GATEWAY_MAX_PACKETS];
+} CAN_gateway_burst_t;
+
+#pragma pack(pop)
+
+//! payload size for count packets including the CRC
+#define CAN_GATEWAY_PAYLOAD_SIZE( count) ( 2 + ( count) * sizeof( CAN_gateway_entry_t) + 2)
+
+//! worst case frame size for count packets including the 0x00 delimiter
+#define CAN_GATEWAY_FRAME_SIZE( count) ( COBS_ENCODED_SIZE( CAN_GATEWAY_PAYLOAD_SIZE( count)) + 1)
+
+/**
+ * @brief pack up to CAN_GATEWAY_MAX_PACKETS CAN frames into one COBS frame terminated by 0x00
+ * @return frame length, 0 if count is too large or capacity < CAN_GATEWAY_FRAME_SIZE( count)
+ */
+unsigned CAN_gateway_encode( const CANpacket *p, unsigned count, uint8_t *buffer, unsigned capacity);
+
+/**
+ * @brief decode one frame (delimiter removed) in place within the receive buffer
+ *
+ * On success burst points into frame, the entries are not copied.
+ * @return true on error: framing, size, version or CRC
+ */
+bool CAN_gateway_decode( uint8_t *frame, unsigned size, const CAN_gateway_burst_t * &burst);
+
+#endif /* CAN_GATEWAY_H_ */
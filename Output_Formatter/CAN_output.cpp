@@ -25,7 +25,9 @@
 #include "system_configuration.h"
 #include "generic_CAN_driver.h"
 #include "CAN_output.h"
+#include "output_fields.h"
 #include "data_structures.h"
+#include "fast_math.h"
 #include "system_state.h"
 
 enum CAN_ID_SENSOR
@@ -46,116 +48,213 @@ enum CAN_ID_SENSOR
   c_CID_KSB_Vdd         = 0x112,    //!< unit16_t as voltage * 10
 };
 
+//! weak default: queue the packets one by one
+__attribute__((weak)) unsigned CAN_send_burst( const CANpacket *p, unsigned count)
+{
+  unsigned sent = 0;
+  for( unsigned i = 0; i < count; ++i)
+    if( CAN_send( p[i], 1))
+      ++sent;
+  return sent;
+}
+
+//! collects the due frames of one cycle for CAN_send_burst
+class CAN_burst_t
+{
+public:
+  CAN_burst_t( CAN_output_state_t &_state)
+  : state( _state),
+    count( 0)
+  {}
+
+  //! add packet, skipped if unchanged and suppression is active
+  void add( CAN_output_frame_t frame, const CANpacket &p)
+  {
+#if CAN_SUPPRESS_UNCHANGED
+    if( ( p.data_l == state.last_data[frame]) && ( state.unchanged[frame] < CAN_REFRESH_DIVIDER - 1))
+      {
+	++state.unchanged[frame];
+	return;
+      }
+    state.last_data[frame] = p.data_l;
+    state.unchanged[frame] = 0;
+#else
+    (void)frame;
+#endif
+    packet[count++] = p;
+  }
+
+  //! returns true if all packets have been accepted
+  bool send( void)
+  {
+    bool all_sent = CAN_send_burst( packet, count) == count;
+    count = 0;
+    return all_sent;
+  }
+
+  bool is_empty( void) const
+  {
+    return count == 0;
+  }
+
+private:
+  CAN_output_state_t &state;
+  CANpacket packet[CAN_OUTPUT_FRAMES];
+  unsigned count;
+};
+
+//! single channel firmware output
 void CAN_output ( const output_data_t &x)
 {
+  static CAN_output_state_t output_state;
+  CAN_output( x, system_state, output_state);
+}
+
+void CAN_output ( const output_data_t &x, uint32_t &state, CAN_output_state_t &output_state)
+{
+  bool medium = ( output_state.cycle % CAN_MEDIUM_RATE_DIVIDER) == 0;
+  bool slow   = ( output_state.cycle % CAN_SLOW_RATE_DIVIDER) == 0;
+  if( ++output_state.cycle >= CAN_MEDIUM_RATE_DIVIDER * CAN_SLOW_RATE_DIVIDER)
+    output_state.cycle = 0;
+
+  CAN_burst_t burst( output_state);
   CANpacket p;
 
+  // fast group ***************************************************************
+
   p.id=c_CAN_Id_EulerAngles;		// 0x101
   p.dlc=6;
-  p.data_sh[0] = (int16_t)(round(x.euler.r * 1000.0f)); 	// unit = 1/1000 RAD
-  p.data_sh[1] = (int16_t)(round(x.euler.n * 1000.0f));
-  p.data_sh[2] = (int16_t)(round(x.euler.y * 1000.0f));
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_Airspeed;		// 0x102
-  p.dlc=4;
-  p.data_sh[0] = (int16_t)(round(x.TAS * 3.6f)); 		// m/s -> km/h
-  p.data_sh[1] = (int16_t)(round(x.IAS * 3.6f)); 		// m/s -> km/h
-  CAN_send(p, 1);
+  p.data_l = 0;
+  p.data_sh[0] = (int16_t)(round(x.euler.r * OUTPUT_SCALE_ANGLE)); 	// unit = 1/1000 RAD
+  p.data_sh[1] = (int16_t)(round(x.euler.n * OUTPUT_SCALE_ANGLE));
+  p.data_sh[2] = (int16_t)(round(x.euler.y * OUTPUT_SCALE_ANGLE));
+  burst.add( CAN_FRAME_EULER, p);
 
   p.id=c_CAN_Id_Vario;			// 0x103
   p.dlc=4;
-  p.data_sh[0] = (int16_t)(round(x.vario * 1000.0f)); 		// mm/s
-  p.data_sh[1] = (int16_t)(round(x.integrator_vario * 1000.0f)); 	// mm/s
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_GPS_Date_Time;		// 0x104
-  p.dlc=6;
-  p.data_b[0] = x.c.year;
-  p.data_b[1] = x.c.month;
-  p.data_b[2] = x.c.day;
-  p.data_b[3] = x.c.hour;
-  p.data_b[4] = x.c.minute;
-  p.data_b[5] = x.c.second;
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_GPS_LatLon;		// 0x105
-  p.dlc=8;
-  p.data_sw[0] = (int32_t)(x.c.latitude * (double)1e7);
-  p.data_sw[1] = (int32_t)(x.c.longitude * (double)1e7);  //
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_GPS_Alt;		// 0x106
-  p.dlc=8;
-  p.data_sw[0] = (int32_t)(x.c.position.e[DOWN] * -1e3f);// in mm
-  p.data_sw[1] = x.c.geo_sep_dm; // geo separation in 1/10 m
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_GPS_Trk_Spd;		// 0x107
-  p.dlc=4;
-  p.data_sh[0] = (int16_t)(round(x.c.heading_motion * 17.4533f)); // 1/1000 rad
-  p.data_h[1] = (int16_t)(round(x.c.speed_motion * 3.6f));
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_Wind;			// 0x108
-  p.dlc =8;
-
-  float wind_direction = ATAN2( - x.wind.e[EAST], - x.wind.e[NORTH]);
-  if( wind_direction < 0.0f)
-    wind_direction += 6.2832f;
-  p.data_sh[0] = (int16_t)(round(wind_direction * 1000.0f)); // 1/1000 rad
-  p.data_h[1] = (int16_t)(round(SQRT( SQR(x.wind.e[EAST])+ SQR(x.wind.e[NORTH])) * 3.6f));
-
-  wind_direction = ATAN2( - x.wind_average.e[EAST], - x.wind_average.e[NORTH]);
-  if( wind_direction < 0.0f)
-    wind_direction += 6.2832f;
-  p.data_sh[2] = (int16_t)(round(wind_direction * 1000.0f)); // 1/1000 rad
-  p.data_h[3] = (int16_t)(round(SQRT( SQR(x.wind_average.e[EAST])+ SQR(x.wind_average.e[NORTH])) * 3.6f));
-
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_Atmosphere;		// 0x109
-  p.dlc=8;
-  p.data_w[0] = (uint32_t)(x.m.static_pressure);
-  p.data_w[1] = (uint32_t)(x.air_density * 1000.0f);
-  CAN_send(p, 1);
-
-  p.id=c_CAN_Id_GPS_Sats;		// 0x10a
-  p.dlc=2;
-  p.data_b[0] = x.c.SATS_number;
-  p.data_b[1] = x.c.sat_fix_type;
-  CAN_send(p, 1);
+  p.data_l = 0;
+  p.data_sh[0] = (int16_t)(round(x.vario * OUTPUT_SCALE_VARIO)); 		// mm/s
+  p.data_sh[1] = (int16_t)(round(x.integrator_vario * OUTPUT_SCALE_VARIO)); 	// mm/s
+  burst.add( CAN_FRAME_VARIO, p);
 
   p.id=c_CAN_Id_Acceleration;		// 0x10b
   p.dlc=7;
-  p.data_sh[0] = (int16_t)(round(x.G_load * 1000.0f));	// G-Belastung mm/s^2 nach oben pos.
-  p.data_sh[1] = (int16_t)(round(x.effective_vertical_acceleration * -1000.0f)); // mm/s^2
-  p.data_sh[2] = (int16_t)(round(x.vario_uncompensated * -1000.0f)); // mm/s
+  p.data_l = 0;
+  p.data_sh[0] = (int16_t)(round(x.G_load * OUTPUT_SCALE_ACCELERATION));	// G-Belastung mm/s^2 nach oben pos.
+  p.data_sh[1] = (int16_t)(round(x.effective_vertical_acceleration * - OUTPUT_SCALE_ACCELERATION)); // mm/s^2
+  p.data_sh[2] = (int16_t)(round(x.vario_uncompensated * - OUTPUT_SCALE_VARIO)); // mm/s
   p.data_sb[6] = (int8_t)(x.circle_mode);
-  CAN_send(p, 1);
-
-  p.id=c_CID_KSB_Vdd;			// 0x112
-  p.dlc=2;
-  p.data_h[0] = (uint16_t)(round(x.m.supply_voltage * 10.0f)); 	// 1/10 V
-  CAN_send(p, 1);
+  burst.add( CAN_FRAME_ACCELERATION, p);
 
   p.id=c_CAN_Id_TurnCoord;				// 0x10c
   p.dlc=6;
-  p.data_sh[0] = (int16_t)(round(x.slip_angle * 1000.0f));	// slip angle in radiant from body acceleration
-  p.data_sh[1] = (int16_t)(round(x.turn_rate  * 1000.0f)); 	// turn rate rad/s
-  p.data_sh[2] = (int16_t)(round(x.nick_angle * 1000.0f));	// nick angle in radiant from body acceleration
-  if( CAN_send(p, 1)) // check CAN for timeout this time
-    system_state |= CAN_OUTPUT_ACTIVE;
-  else
-    system_state &= ~CAN_OUTPUT_ACTIVE;
+  p.data_l = 0;
+  p.data_sh[0] = (int16_t)(round(x.slip_angle * OUTPUT_SCALE_ANGLE));	// slip angle in radiant from body acceleration
+  p.data_sh[1] = (int16_t)(round(x.turn_rate  * OUTPUT_SCALE_ANGLE)); 	// turn rate rad/s
+  p.data_sh[2] = (int16_t)(round(x.nick_angle * OUTPUT_SCALE_ANGLE));	// nick angle in radiant from body acceleration
+  burst.add( CAN_FRAME_TURN_COORDINATION, p);
+
+  // medium group *************************************************************
+
+  if( medium)
+    {
+      p.id=c_CAN_Id_Airspeed;		// 0x102
+      p.dlc=4;
+      p.data_l = 0;
+      p.data_sh[0] = (int16_t)(round(x.TAS * OUTPUT_SCALE_AIRSPEED)); 		// m/s -> km/h
+      p.data_sh[1] = (int16_t)(round(x.IAS * OUTPUT_SCALE_AIRSPEED)); 		// m/s -> km/h
+      burst.add( CAN_FRAME_AIRSPEED, p);
+
+      p.id=c_CAN_Id_GPS_LatLon;		// 0x105
+      p.dlc=8;
+      p.data_sw[0] = (int32_t)(x.c.latitude * OUTPUT_SCALE_LATLON);
+      p.data_sw[1] = (int32_t)(x.c.longitude * OUTPUT_SCALE_LATLON);  //
+      burst.add( CAN_FRAME_LAT_LON, p);
+
+      p.id=c_CAN_Id_GPS_Alt;		// 0x106
+      p.dlc=8;
+      p.data_sw[0] = (int32_t)(x.c.position.e[DOWN] * - OUTPUT_SCALE_ALTITUDE);// in mm
+      p.data_sw[1] = x.c.geo_sep_dm; // geo separation in 1/10 m
+      burst.add( CAN_FRAME_ALTITUDE, p);
+
+      p.id=c_CAN_Id_GPS_Trk_Spd;		// 0x107
+      p.dlc=4;
+      p.data_l = 0;
+      p.data_sh[0] = (int16_t)(round(x.c.heading_motion * OUTPUT_SCALE_TRACK)); // 1/1000 rad
+      p.data_h[1] = (int16_t)(round(x.c.speed_motion * OUTPUT_SCALE_AIRSPEED));
+      burst.add( CAN_FRAME_TRACK_SPEED, p);
+
+      p.id=c_CAN_Id_Wind;			// 0x108
+      p.dlc =8;
+
+      float wind_direction = DISPLAY_ATAN2( - x.wind.e[EAST], - x.wind.e[NORTH]);
+      if( wind_direction < 0.0f)
+	wind_direction += 6.2832f;
+      p.data_sh[0] = (int16_t)(round(wind_direction * OUTPUT_SCALE_ANGLE)); // 1/1000 rad
+      p.data_h[1] = (int16_t)(round(DISPLAY_SQRT( SQR(x.wind.e[EAST])+ SQR(x.wind.e[NORTH])) * OUTPUT_SCALE_AIRSPEED));
+
+      wind_direction = DISPLAY_ATAN2( - x.wind_average.e[EAST], - x.wind_average.e[NORTH]);
+      if( wind_direction < 0.0f)
+	wind_direction += 6.2832f;
+      p.data_sh[2] = (int16_t)(round(wind_direction * OUTPUT_SCALE_ANGLE)); // 1/1000 rad
+      p.data_h[3] = (int16_t)(round(DISPLAY_SQRT( SQR(x.wind_average.e[EAST])+ SQR(x.wind_average.e[NORTH])) * OUTPUT_SCALE_AIRSPEED));
+      burst.add( CAN_FRAME_WIND, p);
+
+      p.id=c_CAN_Id_Atmosphere;		// 0x109
+      p.dlc=8;
+      p.data_w[0] = (uint32_t)(x.m.static_pressure);
+      p.data_w[1] = (uint32_t)(x.air_density * OUTPUT_SCALE_DENSITY);
+      burst.add( CAN_FRAME_ATMOSPHERE, p);
+    }
+
+  // slow group ***************************************************************
+
+  if( slow)
+    {
+      p.id=c_CAN_Id_GPS_Date_Time;		// 0x104
+      p.dlc=6;
+      p.data_l = 0;
+      p.data_b[0] = x.c.year;
+      p.data_b[1] = x.c.month;
+      p.data_b[2] = x.c.day;
+      p.data_b[3] = x.c.hour;
+      p.data_b[4] = x.c.minute;
+      p.data_b[5] = x.c.second;
+      burst.add( CAN_FRAME_DATE_TIME, p);
+
+      p.id=c_CAN_Id_GPS_Sats;		// 0x10a
+      p.dlc=2;
+      p.data_l = 0;
+      p.data_b[0] = x.c.SATS_number;
+      p.data_b[1] = x.c.sat_fix_type;
+      burst.add( CAN_FRAME_SATS, p);
+
+      p.id=c_CID_KSB_Vdd;			// 0x112
+      p.dlc=2;
+      p.data_l = 0;
+      p.data_h[0] = (uint16_t)(round(x.m.supply_voltage * OUTPUT_SCALE_VOLTAGE)); 	// 1/10 V
+      burst.add( CAN_FRAME_VDD, p);
+    }
+
+  if( ! burst.is_empty())
+    {
+      if( burst.send()) // check CAN for timeout this time
+	state |= CAN_OUTPUT_ACTIVE;
+      else
+	state &= ~CAN_OUTPUT_ACTIVE;
+    }
 
 #ifndef GIT_TAG_DEC
 #define GIT_TAG_DEC 0xffffffff
 #endif
-  
-  p.id=c_CAN_Id_SystemState;				// 0x10d
-  p.dlc=8;
-  p.data_w[0] = system_state;
-  p.data_w[1] = GIT_TAG_DEC;
-  CAN_send(p, 1);
+
+  if( slow) // after the main burst, reporting its result
+    {
+      p.id=c_CAN_Id_SystemState;				// 0x10d
+      p.dlc=8;
+      p.data_w[0] = state;
+      p.data_w[1] = GIT_TAG_DEC;
+      burst.add( CAN_FRAME_SYSTEM_STATE, p);
+      burst.send();
+    }
 }
@@ -27,6 +27,55 @@
 
 #include "data_structures.h"
 
+#ifndef CAN_MEDIUM_RATE_DIVIDER
+#define CAN_MEDIUM_RATE_DIVIDER	2 	//!< airspeed, wind, atmosphere, GNSS position on every 2nd call
+#endif
+
+#ifndef CAN_SLOW_RATE_DIVIDER
+#define CAN_SLOW_RATE_DIVIDER	10 	//!< date, time, sats, supply voltage, system state on every 10th call
+#endif
+
+#ifndef CAN_SUPPRESS_UNCHANGED
+#define CAN_SUPPRESS_UNCHANGED	0 	//!< 1: frames with unchanged content are skipped
+#endif
+
+#define CAN_REFRESH_DIVIDER	10 	//!< unchanged frames are repeated on every n-th due cycle nevertheless
+
+//! output_data_t results read by CAN_output, for navigator_t::subscribe_output()
+#define CAN_OUTPUT_FIELDS ( OUTPUT_AIRSPEED | OUTPUT_ATTITUDE | OUTPUT_VARIO | OUTPUT_WIND | OUTPUT_FLIGHT_STATE | OUTPUT_AIR_DATA)
+
+//! frames sent by CAN_output
+enum CAN_output_frame_t
+{
+  CAN_FRAME_EULER, CAN_FRAME_VARIO, CAN_FRAME_ACCELERATION, CAN_FRAME_TURN_COORDINATION, // fast
+  CAN_FRAME_AIRSPEED, CAN_FRAME_LAT_LON, CAN_FRAME_ALTITUDE, CAN_FRAME_TRACK_SPEED,	// medium
+  CAN_FRAME_WIND, CAN_FRAME_ATMOSPHERE,
+  CAN_FRAME_DATE_TIME, CAN_FRAME_SATS, CAN_FRAME_VDD, CAN_FRAME_SYSTEM_STATE,		// slow
+  CAN_OUTPUT_FRAMES
+};
+
+//! rate group cycle counter and last frame contents of one CAN output channel
+class CAN_output_state_t
+{
+public:
+  CAN_output_state_t( void)
+    : cycle( 0)
+  {
+    for( unsigned i = 0; i < CAN_OUTPUT_FRAMES; ++i)
+      {
+	last_data[i] = 0;
+	unchanged[i] = CAN_REFRESH_DIVIDER; // send on first occasion
+      }
+  }
+  unsigned cycle;
+  uint64_t last_data[CAN_OUTPUT_FRAMES];
+  uint8_t unchanged[CAN_OUTPUT_FRAMES]; //!< number of suppressed frames in a row
+};
+
+//! single channel output, global system_state
 void CAN_output ( const output_data_t &);
 
+//! CAN output of one channel with its own state word and rate group state
+void CAN_output ( const output_data_t &, uint32_t &state, CAN_output_state_t &output_state);
+
 #endif /* SRC_CAN_OUTPUT_H_ */
@@ -25,6 +25,7 @@
 #include "NMEA_format.h"
 #include "ascii_support.h"
 #include "embedded_math.h"
+#include "fast_math.h"
 
 #define USE_PTAS1	0
 #define USE_MWV		0
@@ -44,87 +45,17 @@ ROM char HEX[]="0123456789ABCDEF";
 //! @param number value * 100
 char * to_ascii_2_decimals( int32_t number, char *s)
 {
-  if( number < 0)
-    {
-      *s++='-';
-      number = -number;
-    }
-  if( number >= 1000)
-    {
-      s = format_integer( s, number / 1000);
-      number %= 1000;
-    }
-  *s++=HEX[number / 100]; // format 1 digit plus exactly 2 decimals
-  *s++='.';
-  number %= 100;
-  *s++=HEX[number / 10];
-  *s++=HEX[number % 10];
-  *s=0;
-  return s;
+  return format_fixed_point( s, number, 2);
 }
 
 //! format an integer into ASCII with one decimal
 //! @param number value * 10
 char * to_ascii_1_decimal( int32_t number, char *s)
 {
-  if( number < 0)
-    {
-      *s++='-';
-      number = -number;
-    }
-  if( number >= 100)
-    {
-      s = format_integer( s, number / 100);
-      number %= 100;
-    }
-  *s++=HEX[number / 10]; // format exactly 1 decimal
-  *s++='.';
-  *s++=HEX[number % 10];
-  *s=0;
-  return s;
+  return format_fixed_point( s, number, 1);
 }
 
-//! append an angle in ASCII into a NMEA string
-char * angle_format ( double angle, char * p, char posc, char negc)
-{
-  bool pos = angle > 0.0f;
-  if (!pos)
-    angle = -angle;
-
-  int degree = (int) angle;
-
-  *p++ = degree / 10 + '0';
-  *p++ = degree % 10 + '0';
-
-  double minutes = (angle - (double) degree) * 60.0;
-  int min = (int) minutes;
-  *p++ = min / 10 + '0';
-  *p++ = min % 10 + '0';
-
-  *p++ = '.';
-
-  minutes -= min;
-  minutes *= 100000;
-  min = (int) (minutes + 0.5f);
-
-  p[4] = min % 10 + '0';
-  min /= 10;
-  p[3] = min % 10 + '0';
-  min /= 10;
-  p[2] = min % 10 + '0';
-  min /= 10;
-  p[1] = min % 10 + '0';
-  min /= 10;
-  p[0] = min % 10 + '0';
-
-  p += 5;
-
-  *p++ = ',';
-  *p++ = pos ? posc : negc;
-  return p;
-}
-
-char * format_GNSS_timestamp(const coordinates_t &coordinates, char *p)
+void format_GNSS_timestamp(const coordinates_t &coordinates, NMEA_writer_t &w)
 {
   unsigned hundredth_seconds;
   if( coordinates.nano < 0)
@@ -132,218 +63,175 @@ char * format_GNSS_timestamp(const coordinates_t &coordinates, char *p)
   else
       hundredth_seconds=coordinates.nano / 10000000;
 
-//  assert( hundredth_seconds < 100);
-
-  *p++ = (coordinates.hour)   / 10 + '0';
-  *p++ = (coordinates.hour)   % 10 + '0';
-  *p++ = (coordinates.minute) / 10 + '0';
-  *p++ = (coordinates.minute) % 10 + '0';
-  *p++ = (coordinates.second) / 10 + '0';
-  *p++ = (coordinates.second) % 10 + '0';
-  *p++ = '.';
-  *p++ = hundredth_seconds / 10 +'0';
-  *p++ = hundredth_seconds % 10 +'0';
-  *p++ = ',';
-
-  return p;
+  w.append_digits( coordinates.hour, 2);
+  w.append_digits( coordinates.minute, 2);
+  w.append_digits( coordinates.second, 2);
+  w.append( '.');
+  w.append_digits( hundredth_seconds, 2);
+  w.append( ',');
 }
 
 ROM char GPRMC[]="$GPRMC,";
 
 //! NMEA-format time, position, groundspeed, track data
-void format_RMC (const coordinates_t &coordinates, char *p)
+void format_RMC (const coordinates_t &coordinates, NMEA_writer_t &w)
 {
-  p = append_string( p, GPRMC);
-  p = format_GNSS_timestamp( coordinates, p);
+  w.begin( GPRMC);
+  format_GNSS_timestamp( coordinates, w);
 
-  *p++ = coordinates.sat_fix_type != 0 ? 'A' : 'V';
-  *p++ = ',';
+  w.append( coordinates.sat_fix_type != 0 ? 'A' : 'V');
+  w.append( ',');
 
-  p = angle_format (coordinates.latitude, p, 'N', 'S');
-  *p++ = ',';
+  w.append_angle( coordinates.latitude, 'N', 'S');
+  w.append( ',');
 
-  p = angle_format (coordinates.longitude, p, 'E', 'W');
-  *p++ = ',';
+  w.append_angle( coordinates.longitude, 'E', 'W');
+  w.append( ',');
 
   float value = coordinates.speed_motion * MPS_TO_NMPH;
 
-  //Clipping to realistic values for a glider. Some ASCII functions crash if given to high values. TODO: fix
+  //Clipping to realistic values for a glider, the field has a fixed width
   value = CLIP<float>(value, 0, (100.0 * MPS_TO_NMPH));
 
   unsigned knots = (unsigned)(value * 10.0f + 0.5f);
-  *p++ = knots / 1000 + '0';
-  knots %= 1000;
-  *p++ = knots / 100 + '0';
-  knots %= 100;
-  *p++ = knots / 10 + '0';
-  *p++ = '.';
-  *p++ = knots % 10 + '0';
-  *p++ = ',';
+  w.append_digits( knots / 10, 3);
+  w.append( '.');
+  w.append_digits( knots % 10, 1);
+  w.append( ',');
 
   float true_track = coordinates.heading_motion;
   if( true_track < 0.0f)
     true_track += 360.0f;
   int angle_10 = true_track * 10.0 + 0.5;
 
-  *p++ = angle_10 / 1000 + '0';
-  angle_10 %= 1000;
-  *p++ = angle_10 / 100 + '0';
-  angle_10 %= 100;
-  *p++ = angle_10 / 10 + '0';
-  *p++ = '.';
-  *p++ = angle_10 % 10 + '0';
-
-  *p++ = ',';
-
-  *p++ = (coordinates.day) / 10 + '0';
-  *p++ = (coordinates.day) % 10 + '0';
-  *p++ = (coordinates.month) / 10 + '0';
-  *p++ = (coordinates.month) % 10 + '0';
-  *p++ = ((coordinates.year)%100) / 10 + '0';
-  *p++ = ((coordinates.year)%100) % 10 + '0';
-
-  p=append_string( p, ",,,A");
-  *p = 0;
+  w.append_digits( angle_10 / 10, 3);
+  w.append( '.');
+  w.append_digits( angle_10 % 10, 1);
+  w.append( ',');
+
+  w.append_digits( coordinates.day, 2);
+  w.append_digits( coordinates.month, 2);
+  w.append_digits( coordinates.year % 100, 2);
+
+  w.append( ",,,A");
+  w.end();
 }
 
 ROM char GPGGA[]="$GPGGA,";
 
 //! NMEA-format position report, sat number and GEO separation
-char *format_GGA( const coordinates_t &coordinates, char *p)
+void format_GGA( const coordinates_t &coordinates, NMEA_writer_t &w)
 {
-  p = append_string( p, GPGGA);
-  p = format_GNSS_timestamp( coordinates, p);
+  w.begin( GPGGA);
+  format_GNSS_timestamp( coordinates, w);
 
-  p = angle_format (coordinates.latitude, p, 'N', 'S');
-  *p++ = ',';
+  w.append_angle( coordinates.latitude, 'N', 'S');
+  w.append( ',');
 
-  p = angle_format (coordinates.longitude, p, 'E', 'W');
-  *p++ = ',';
+  w.append_angle( coordinates.longitude, 'E', 'W');
+  w.append( ',');
 
-  *p++ = coordinates.sat_fix_type  >= 0 ? '1' : '0';
-  *p++ = ',';
+  w.append( coordinates.sat_fix_type  >= 0 ? '1' : '0');
+  w.append( ',');
 
-  *p++ = (coordinates.SATS_number) / 10 + '0';
-  *p++ = (coordinates.SATS_number) % 10 + '0';
-  *p++ = ',';
+  w.append_digits( coordinates.SATS_number, 2);
+  w.append( ',');
 
-  *p++ = '1'; // fake HDOP
-  *p++ = '.';
-  *p++ = '0';
-  *p++ = ',';
+  w.append( "1.0,"); // fake HDOP
 
   int32_t altitude_msl_dm = coordinates.position.e[DOWN] * -10.0f;
-  p = to_ascii_1_decimal( altitude_msl_dm, p);
-  *p++ = ',';
-  *p++ = 'M';
-  *p++ = ',';
+  w.append_1_decimal( altitude_msl_dm);
+  w.append( ",M,");
 
   int32_t geo_sep_10 = coordinates.geo_sep_dm;
-  p = to_ascii_1_decimal( geo_sep_10, p);
-  *p++ = ',';
-  *p++ = 'M';
-  *p++ = ','; // no DGPS
-  *p++ = ',';
-  *p++ = 0;
-
-  return p;
+  w.append_1_decimal( geo_sep_10);
+  w.append( ",M,,"); // no DGPS
+  w.end();
 }
 
 ROM char GPMWV[]="$GPMWV,";
 
 //! format wind reporting, standard  NMEA sequence
-char *format_MWV ( float wind_north, float wind_east, char *p)
+void format_MWV ( float wind_north, float wind_east, NMEA_writer_t &w)
 {
-  p = append_string( p, GPMWV);
+  w.begin( GPMWV);
 
-  //Clipping to realistic values for a glider. Some ASCII functions crash if given to high values. TODO: fix
+  //Clipping to realistic values for a glider
   wind_north = CLIP<float>(wind_north, -50.0, 50.0);
   wind_east = CLIP<float>(wind_east, -50.0, 50.0);
 
 //  wind_north = 3.0; // this setting reports 18km/h from 53 degrees
 //  wind_east = 4.0;
 
-  while (*p)
-    ++p;
-
-  float direction = ATAN2( -wind_east, -wind_north);
+  float direction = DISPLAY_ATAN2( -wind_east, -wind_north);
   if( direction < 0.0f)
     direction += 360.0f;
   int32_t angle_10 = round( direction * RAD_TO_DEGREE_10);
-  p=to_ascii_1_decimal( angle_10, p);
-  *p++ = ',';
-  *p++ = 'T'; // true direction
-  *p++ = ',';
+  w.append_1_decimal( angle_10);
+  w.append( ",T,"); // true direction
 
-  float value = SQRT( SQR( wind_north) + SQR( wind_east));
+  float value = DISPLAY_SQRT( SQR( wind_north) + SQR( wind_east));
 
   int32_t wind_10 = value * 10.0f;
-  p=to_ascii_1_decimal( wind_10, p);
-  *p++ = ',';
-  *p++ = 'M'; // m/s
-  *p++ = ',';
-  *p++ = 'A'; // valid
-  *p++ = 0;
-
-  return p;
+  w.append_1_decimal( wind_10);
+  w.append( ",M,A"); // m/s, valid
+  w.end();
 }
 
 #if USE_POV // the OpenVario way to do it ...
 
-ROM char POV[]="$POV";
+ROM char POV[]="$POV,";
 
 //! format the OpenVario sequence TAS, pressures and TEK variometer
 void format_POV( float TAS, float pabs, float pitot, float TEK_vario, float voltage,
-		 bool airdata_available, float humidity, float temperature, char *p)
+		 bool airdata_available, float humidity, float temperature, NMEA_writer_t &w)
 {
-  p = append_string( p, POV);
+  w.begin( POV);
 #if 1
-  p = append_string( p, ",E,");
-  p = to_ascii_2_decimals( round(TEK_vario * 100.0f), p);
+  w.append( "E,");
+  w.append_2_decimals( round(TEK_vario * 100.0f));
 
-  p = append_string( p, ",P,");
-  p = to_ascii_2_decimals( round( pabs), p); // static pressure, already in Pa = 100 hPa
+  w.append( ",P,");
+  w.append_2_decimals( round( pabs)); // static pressure, already in Pa = 100 hPa
 
   if( pitot < 0.0f)
     pitot = 0.0f;
-  p = append_string( p, ",R,");
-  p = to_ascii_2_decimals( round(pitot), p); // pitot pressure (difference) / Pa = 100hPa
+  w.append( ",R,");
+  w.append_2_decimals( round(pitot)); // pitot pressure (difference) / Pa = 100hPa
 
-  p = append_string( p, ",S,");
-  p = to_ascii_1_decimal( round(TAS * 36.0f), p); // m/s -> 1/10 km/h
+  w.append( ",S,");
+  w.append_1_decimal( round(TAS * 36.0f)); // m/s -> 1/10 km/h
+  w.append( ',');
 #endif
-  p = append_string( p, ",V,");
-  p = to_ascii_2_decimals( round(voltage * 100.0f), p);
+  w.append( "V,");
+  w.append_2_decimals( round(voltage * 100.0f));
 
   if( airdata_available)
     {
-      p = append_string( p, ",H,");
-      p = to_ascii_2_decimals( round(humidity * 100.0f), p);
+      w.append( ",H,");
+      w.append_2_decimals( round(humidity * 100.0f));
 
-      p = append_string( p, ",T,");
-      p = to_ascii_2_decimals( round(temperature * 100.0f), p);
+      w.append( ",T,");
+      w.append_2_decimals( round(temperature * 100.0f));
     }
 
-  *p = 0;
+  w.end();
 }
-
 #endif
 
 ROM char HCHDT[]="$HCHDT,";
 
 //! create HCHDM sentence to report true heading
-void format_HCHDT( float true_heading, char *p) // report magnetic heading
+void format_HCHDT( float true_heading, NMEA_writer_t &w) // report magnetic heading
 {
   int32_t heading = round(true_heading * 573.0f); // -> 1/10 degree
   if( heading < 0)
     heading += 3600;
 
-  p = append_string( p, HCHDT);
-  p = to_ascii_1_decimal( heading, p);
-  *p++ = ',';
-  *p++ = 'T';
-
-  *p = 0;
+  w.begin( HCHDT);
+  w.append_1_decimal( heading);
+  w.append( ",T");
+  w.end();
 }
 
 // ********* Larus-specific protocols *************************************
@@ -351,100 +239,99 @@ void format_HCHDT( float true_heading, char *p) // report magnetic heading
 
 ROM char PLARD[]="$PLARD,";
 
-void format_PLARD ( float density, char type, char *p)
+void format_PLARD ( float density, char type, NMEA_writer_t &w)
 {
-    p = append_string( p, PLARD);
-    p = to_ascii_2_decimals( round( density * 1e5f), p); // units = g / m^3, * 100 to get 2 decimals
-    *p++ = ',';
-    *p++ = type;
-    *p = 0;
+    w.begin( PLARD);
+    w.append_2_decimals( round( density * 1e5f)); // units = g / m^3, * 100 to get 2 decimals
+    w.append( ',');
+    w.append( type);
+    w.end();
 }
 
 ROM char PLARB[]="$PLARB,";
 
-void format_PLARB ( float voltage, char *p)
+void format_PLARB ( float voltage, NMEA_writer_t &w)
 {
-    p = append_string( p, PLARB);
-    p = to_ascii_2_decimals( round( voltage * 100.0f), p);
-    *p = 0;
+    w.begin( PLARB);
+    w.append_2_decimals( round( voltage * 100.0f));
+    w.end();
 }
 
 ROM char PLARA[]="$PLARA,";
 
-void format_PLARA ( float roll, float nick, float yaw, char *p)
+void format_PLARA ( float roll, float nick, float yaw, NMEA_writer_t &w)
 {
-    p = append_string( p, PLARA);
+    w.begin( PLARA);
 
-    p = to_ascii_1_decimal( round(roll * RAD_TO_DEGREE_10), p);
+    w.append_1_decimal( round(roll * RAD_TO_DEGREE_10));
 
-    p = append_string( p, ",");
-    p = to_ascii_1_decimal( round(nick * RAD_TO_DEGREE_10), p);
+    w.append( ',');
+    w.append_1_decimal( round(nick * RAD_TO_DEGREE_10));
 
     if( yaw < 0.0f)
         yaw += 6.2832f;
-    p = append_string( p, ",");
-    p = to_ascii_1_decimal( round(yaw * RAD_TO_DEGREE_10), p);
+    w.append( ',');
+    w.append_1_decimal( round(yaw * RAD_TO_DEGREE_10));
 
-    *p = 0;
+    w.end();
 }
 
 ROM char PLARW[]="$PLARW,";
 
 //! format wind reporting NMEA sequence
-void format_PLARW ( float wind_north, float wind_east, char windtype, char *p)
+void format_PLARW ( float wind_north, float wind_east, char windtype, NMEA_writer_t &w)
 {
-    p = append_string( p, PLARW);
+    w.begin( PLARW);
 
-    //Clipping to realistic values for a glider. Some ASCII functions crash if given to high values. TODO: fix
+    //Clipping to realistic values for a glider
     wind_north = CLIP<float>(wind_north, -50.0, 50.0);
     wind_east = CLIP<float>(wind_east, -50.0, 50.0);
     //wind_north = 3.0; // this setting reports 18km/h from 53 degrees
     //wind_east = 4.0;
 
     // report WHERE the wind the comes from, instead of our wind speed vector, so negative sign
-    float direction = ATAN2( -wind_east, -wind_north);
+    float direction = DISPLAY_ATAN2( -wind_east, -wind_north);
 
     // map to 0..359 degrees
     int angle = round( direction * RAD_TO_DEGREE);
     if( angle < 0)
         angle += 360;
-    p=format_integer( p, angle);
-    *p++ = ',';
+    w.append_integer( angle);
+    w.append( ',');
 
-    int speed = round( MPS_TO_KMPH * SQRT( SQR( wind_north) + SQR( wind_east)));
-    p=format_integer( p, speed);
-    *p++ = ',';
+    int speed = round( MPS_TO_KMPH * DISPLAY_SQRT( SQR( wind_north) + SQR( wind_east)));
+    w.append_integer( speed);
+    w.append( ',');
 
-    *p++ = windtype;
+    w.append( windtype);
 
-    p = append_string( p, ",A"); // always report "valid" for the moment
-    *p=0;
+    w.append( ",A"); // always report "valid" for the moment
+    w.end();
 }
 
 ROM char PLARV[]="$PLARV,";
 
 //! TEK vario, average vario, pressure altitude and speed (TAS)
-void format_PLARV ( float variometer, float avg_variometer, float pressure_altitude, float TAS, char *p)
+void format_PLARV ( float variometer, float avg_variometer, float pressure_altitude, float TAS, NMEA_writer_t &w)
 {
-  p = append_string( p, PLARV);
+  w.begin( PLARV);
 
-  //Clipping to realistic values for a glider. Some ASCII functions crash if given to high values. TODO: fix
+  //Clipping to realistic values for a glider
   variometer = CLIP<float>(variometer, -50.0, 50.0);
   avg_variometer = CLIP<float>(avg_variometer, -50.0, 50.0);
   TAS = CLIP<float>(TAS, 0, 100);
 
-  p=to_ascii_2_decimals( round( variometer * 100.0f), p);
-  *p++ = ',';
-
-  p=to_ascii_2_decimals( round( avg_variometer * 100.0f), p);
-  *p++ = ',';
+  w.append_2_decimals( round( variometer * 100.0f));
+  w.append( ',');
 
-  p=format_integer( p, round( pressure_altitude));
-  *p++ = ',';
+  w.append_2_decimals( round( avg_variometer * 100.0f));
+  w.append( ',');
 
-  p=format_integer( p, round( TAS * MPS_TO_KMPH));
+  w.append_integer( round( pressure_altitude));
+  w.append( ',');
 
-  *p++ = 0;
+  w.append_integer( round( TAS * MPS_TO_KMPH));
+  w.end();
 }
 
 #endif
@@ -484,51 +371,73 @@ char * NMEA_append_tail( char *p)
  	return p+5;
  }
 
+#if WITH_PROFILING
+ROM char PLARP[]="$PLARP,";
+
+//! diagnostic sentence: stage number, min, mean and max cycle count, number of samples
+void format_PLARP ( const profiling_report_t &report, profiling_stage_t stage, NMEA_writer_t &w)
+{
+  const profile_statistics_t &statistics = report.stage[stage];
+
+  w.begin( PLARP);
+  w.append_integer( stage);
+  w.append( ',');
+  w.append_integer( statistics.count ? (int32_t)statistics.min : 0);
+  w.append( ',');
+  w.append_integer( (int32_t)statistics.get_mean());
+  w.append( ',');
+  w.append_integer( (int32_t)statistics.max);
+  w.append( ',');
+  w.append_integer( (int32_t)statistics.count);
+  w.end();
+}
+#endif
+
 #if USE_PTAS1
 ROM char PTAS1[]="$PTAS1,";
 
-char *format_PTAS1 ( float vario, float avg_vario, float altitude, float TAS, char *p)
+void format_PTAS1 ( float vario, float avg_vario, float altitude, float TAS, NMEA_writer_t &w)
 {
   vario=CLIP(vario, -10.0f, 10.0f);
   avg_vario=CLIP(avg_vario, -10.0f, 10.0f);
 
-  p = append_string( p, PTAS1);
-
-  p=format_integer( round( vario * MPS_TO_NMPH * 10.0f + 200.0f), p);
-  *p++ = ',';
+  w.begin( PTAS1);
 
-  p=format_integer( round( avg_vario * MPS_TO_NMPH * 10.0f + 200.0f), p);
-  *p++ = ',';
+  w.append_integer( round( vario * MPS_TO_NMPH * 10.0f + 200.0f));
+  w.append( ',');
 
-  p=format_integer( round( altitude * METER_TO_FEET + 2000.0), p);
-  *p++ = ',';
+  w.append_integer( round( avg_vario * MPS_TO_NMPH * 10.0f + 200.0f));
+  w.append( ',');
 
-  p=format_integer( round( TAS * MPS_TO_NMPH), p);
+  w.append_integer( round( altitude * METER_TO_FEET + 2000.0));
+  w.append( ',');
 
-  *p++ = 0;
-  return p;
+  w.append_integer( round( TAS * MPS_TO_NMPH));
+  w.end();
 }
 #endif // USE_PTAS
 
 
-//! this procedure formats all our NMEA sequences
-void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA_buf)
+//! sentence selection: scheduler == 0 means all sentences
+static inline bool is_due( const NMEA_scheduler_t *scheduler, NMEA_sentence_t sentence)
 {
-  char *next = NMEA_buf.string;
+  return scheduler == 0 || scheduler->is_due( sentence);
+}
 
-  // NMEA-format time, position, groundspeed, track data
-  format_RMC ( output_data.c, next);
-  next = NMEA_append_tail ( next);
+static void format_NMEA_sentences( const output_data_t &output_data, NMEA_writer_t &w, const NMEA_scheduler_t *scheduler)
+{
+  if( scheduler == 0 || scheduler->is_new_fix())
+    {
+      // NMEA-format time, position, groundspeed, track data
+      format_RMC ( output_data.c, w);
 
-  // NMEA-format position report, sat number and GEO separation
-  format_GGA ( output_data.c, next);
-  next = NMEA_append_tail (next);
+      // NMEA-format position report, sat number and GEO separation
+      format_GGA ( output_data.c, w);
+    }
 
 #if USE_MWV
   // report wind, the standard way, redundant to PLARW
-  format_MWV (output_data.wind_average.e[NORTH], output_data.wind_average.e[EAST], next);
-  next = NMEA_append_tail (next);
-
+  format_MWV (output_data.wind_average.e[NORTH], output_data.wind_average.e[EAST], w);
 #endif
 
 #if USE_PTAS1
@@ -538,8 +447,7 @@ void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA
 		 output_data.integrator_vario,
 		 output_data.pressure_altitude,
 		 output_data.TAS,
-		 next);
-  next = NMEA_append_tail (next);
+		 w);
 #endif
 
 #if USE_POV // the OpenVario way to do it ...
@@ -547,51 +455,61 @@ void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA
 #if WITH_DENSITY_DATA
   format_POV( output_data.TAS, output_data.m.static_pressure, output_data.m.pitot_pressure, output_data.vario, output_data.m.supply_voltage,
   	      (output_data.m.outside_air_humidity > 0.0f), // true if outside air data are available
-  	      output_data.m.outside_air_humidity*100.0f, output_data.m.outside_air_temperature, next);
+  	      output_data.m.outside_air_humidity*100.0f, output_data.m.outside_air_temperature, w);
 #else
   format_POV( output_data.TAS, output_data.m.static_pressure, output_data.m.pitot_pressure, output_data.vario, output_data.m.supply_voltage,
-  	      false, 0.0f, 0.0f, next);
+  	      false, 0.0f, 0.0f, w);
 #endif
-  next = NMEA_append_tail (next);
 
 #endif
 
-  format_HCHDT( output_data.euler.y, next);
-  next = NMEA_append_tail (next);
+  if( is_due( scheduler, NMEA_HCHDT))
+    format_HCHDT( output_data.euler.y, w);
 
 #if USE_LARUS_NMEA_EXTENSIONS
 
   // aircraft attitude
-  format_PLARA(output_data.euler.r, output_data.euler.n, output_data.euler.y, next);
-  next = NMEA_append_tail(next);
+  if( is_due( scheduler, NMEA_PLARA))
+    format_PLARA(output_data.euler.r, output_data.euler.n, output_data.euler.y, w);
 
   // battery_voltage
-  format_PLARB( output_data.m.supply_voltage, next);
-  next = NMEA_append_tail(next);
+  if( is_due( scheduler, NMEA_PLARB))
+    format_PLARB( output_data.m.supply_voltage, w);
 
   // air density
-  format_PLARD( output_data.air_density, 'M', next); // todo: type presently a dummy
-  next = NMEA_append_tail(next);
+  if( is_due( scheduler, NMEA_PLARD))
+    format_PLARD( output_data.air_density, 'M', w); // todo: type presently a dummy
 
   // report instant and average total-energy-compensated variometer, pressure altitude, TAS
-  format_PLARV ( output_data.vario,
-		 output_data.integrator_vario,
-		 output_data.pressure_altitude,
-		 output_data.TAS,
-		 next);
-  next = NMEA_append_tail (next);
+  if( is_due( scheduler, NMEA_PLARV))
+    format_PLARV ( output_data.vario,
+		   output_data.integrator_vario,
+		   output_data.pressure_altitude,
+		   output_data.TAS,
+		   w);
 
   // instant wind
-  format_PLARW (output_data.wind.e[NORTH], output_data.wind.e[EAST], 'I', next);
-  next = NMEA_append_tail (next);
+  if( is_due( scheduler, NMEA_PLARW_INSTANT))
+    format_PLARW (output_data.wind.e[NORTH], output_data.wind.e[EAST], 'I', w);
 
   // average wind
-  format_PLARW (output_data.wind_average.e[NORTH], output_data.wind_average.e[EAST], 'A', next);
-  next = NMEA_append_tail (next);
+  if( is_due( scheduler, NMEA_PLARW_AVERAGE))
+    format_PLARW (output_data.wind_average.e[NORTH], output_data.wind_average.e[EAST], 'A', w);
 
 #endif
+}
 
-//  assert(   next - NMEA_buf.string < string_buffer_t::BUFLEN);
-  NMEA_buf.length = next - NMEA_buf.string;
+//! this procedure formats all our NMEA sequences
+void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA_buf)
+{
+  NMEA_writer_t w( NMEA_buf.string, string_buffer_t::BUFLEN);
+  format_NMEA_sentences( output_data, w, 0);
+  NMEA_buf.length = w.get_length();
 }
 
+void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA_buf, const NMEA_scheduler_t &scheduler)
+{
+  NMEA_writer_t w( NMEA_buf.string, string_buffer_t::BUFLEN);
+  format_NMEA_sentences( output_data, w, &scheduler);
+  NMEA_buf.length = w.get_length();
+}
@@ -7,6 +7,12 @@
 #define APPLICATION_NMEA_FORMAT_H_
 
 #include "data_structures.h"
+#include "profiling.h"
+#include "NMEA_writer.h"
+#include "NMEA_scheduler.h"
+
+//! output_data_t results read by format_NMEA_string, for navigator_t::subscribe_output()
+#define NMEA_OUTPUT_FIELDS ( OUTPUT_AIRSPEED | OUTPUT_ATTITUDE | OUTPUT_VARIO | OUTPUT_WIND | OUTPUT_AIR_DATA)
 
 //! contains a string including it's length
 class string_buffer_t
@@ -19,6 +25,8 @@ public:
 
 //! combine all data to be output to the NMEA port
 void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA_buf);
+//! output only the sentences that are due, scheduler.tick() has been called before
+void format_NMEA_string( const output_data_t &output_data, string_buffer_t &NMEA_buf, const NMEA_scheduler_t &scheduler);
 char * to_ascii_2_decimals( int32_t number, char *s);
 char * to_ascii_1_decimal( int32_t number, char *s);
 inline char * to_ascii_2_decimals( float32_t number, char *s)
@@ -29,8 +37,12 @@ inline char * to_ascii_1_decimal( float32_t number, char *s)
 {
   return to_ascii_1_decimal( (int32_t)( number + 0.5f), s);
 }
-void format_PLARV ( float variometer, float avg_variometer, float pressure_altitude, float TAS, char *p);
-void format_RMC (const coordinates_t &coordinates, char *p);
+void format_PLARV ( float variometer, float avg_variometer, float pressure_altitude, float TAS, NMEA_writer_t &w);
+void format_RMC (const coordinates_t &coordinates, NMEA_writer_t &w);
 char * NMEA_append_tail( char *p);
 
+#if WITH_PROFILING
+void format_PLARP ( const profiling_report_t &report, profiling_stage_t stage, NMEA_writer_t &w);
+#endif
+
 #endif /* APPLICATION_NMEA_FORMAT_H_ */
@@ -0,0 +1,142 @@
+/***********************************************************************//**
+ * @file		NMEA_scheduler.h
+ * @brief		per-sentence output rate scheduler for NMEA
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef NMEA_SCHEDULER_H_
+#define NMEA_SCHEDULER_H_
+
+#include "configuration_snapshot.h"
+#include "GNSS.h"
+
+#ifndef NMEA_REPORTING_FREQUENCY
+#define NMEA_REPORTING_FREQUENCY 10 //!< calls of format_NMEA_string per second
+#endif
+
+//! sentences with individual output rates
+enum NMEA_sentence_t
+{
+  NMEA_PLARV,
+  NMEA_PLARA,
+  NMEA_HCHDT,
+  NMEA_PLARW_INSTANT,
+  NMEA_PLARW_AVERAGE,
+  NMEA_PLARB,
+  NMEA_PLARD,
+  NMEA_SCHEDULED_SENTENCES
+};
+
+/**
+ * @brief decides which NMEA sentences are due on the present output cycle
+ *
+ * Each sentence gets an integer divider of the reporting frequency.
+ * Sentences with the same rate are spread over different cycles.
+ * RMC and GGA are due only when the GNSS time stamp has changed.
+ */
+class NMEA_scheduler_t
+{
+public:
+  NMEA_scheduler_t( float _call_frequency = NMEA_REPORTING_FREQUENCY)
+    : call_frequency( _call_frequency),
+      last_fix_time( NO_FIX_TIME),
+      new_fix( false)
+  {
+    for( unsigned i = 0; i < NMEA_SCHEDULED_SENTENCES; ++i)
+      {
+	divider[i] = 1;
+	countdown[i] = 0;
+	due[i] = false;
+      }
+  }
+
+  //! rates from the parameter set, 0.0 = sentence off
+  void configure( const configuration_snapshot_t &configuration)
+  {
+    set_rate( NMEA_PLARV,	  configuration( NMEA_RATE_VARIO));
+    set_rate( NMEA_PLARA,	  configuration( NMEA_RATE_ATTITUDE));
+    set_rate( NMEA_HCHDT,	  configuration( NMEA_RATE_HEADING));
+    set_rate( NMEA_PLARW_INSTANT, configuration( NMEA_RATE_WIND));
+    set_rate( NMEA_PLARW_AVERAGE, configuration( NMEA_RATE_MEAN_WIND));
+    set_rate( NMEA_PLARB,	  configuration( NMEA_RATE_HOUSEKEEPING));
+    set_rate( NMEA_PLARD,	  configuration( NMEA_RATE_HOUSEKEEPING));
+  }
+
+  //! rate in Hz, rounded to an integer divider of the call frequency
+  void set_rate( NMEA_sentence_t sentence, float rate)
+  {
+    if( rate <= 0.0f)
+      {
+	divider[sentence] = 0;
+	return;
+      }
+    float ratio = call_frequency / rate + 0.5f;
+    divider[sentence] = ratio < 1.0f ? 1 : ratio > 65535.0f ? 65535 : (uint16_t)ratio;
+    countdown[sentence] = sentence % divider[sentence]; // stagger sentences
+  }
+
+  //! to be called once per output cycle before is_due() / is_new_fix()
+  void tick( const coordinates_t &coordinates)
+  {
+    for( unsigned i = 0; i < NMEA_SCHEDULED_SENTENCES; ++i)
+      {
+	due[i] = false;
+	if( divider[i] == 0)
+	  continue;
+	if( countdown[i] == 0)
+	  {
+	    due[i] = true;
+	    countdown[i] = divider[i];
+	  }
+	--countdown[i];
+      }
+
+    uint32_t fix_time = ( ( coordinates.hour * 60UL + coordinates.minute) * 60UL + coordinates.second) * 100UL;
+#if INCLUDING_NANO
+    if( coordinates.nano > 0)
+      fix_time += coordinates.nano / 10000000;
+#endif
+    new_fix = fix_time != last_fix_time;
+    last_fix_time = fix_time;
+  }
+
+  bool is_due( NMEA_sentence_t sentence) const
+  {
+    return due[sentence];
+  }
+
+  //! true if the GNSS time stamp has changed since the last cycle
+  bool is_new_fix( void) const
+  {
+    return new_fix;
+  }
+
+private:
+  static constexpr uint32_t NO_FIX_TIME = 0xffffffff;
+  float call_frequency;
+  uint16_t divider[NMEA_SCHEDULED_SENTENCES]; //!< 0 = off
+  uint16_t countdown[NMEA_SCHEDULED_SENTENCES];
+  bool due[NMEA_SCHEDULED_SENTENCES];
+  uint32_t last_fix_time;
+  bool new_fix;
+};
+
+#endif /* NMEA_SCHEDULER_H_ */
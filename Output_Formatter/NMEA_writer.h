@@ -0,0 +1,221 @@
+/***********************************************************************//**
+ * @file		NMEA_writer.h
+ * @brief		bounded single-pass NMEA sentence writer
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef NMEA_WRITER_H_
+#define NMEA_WRITER_H_
+
+#include <stdint.h>
+#include "ascii_support.h"
+
+/**
+ * @brief appends NMEA sentences to a fixed buffer
+ *
+ * The checksum is accumulated while the characters are written,
+ * the text is never scanned again.
+ * A sentence that does not fit is removed completely,
+ * the buffer always contains complete sentences and a terminating zero.
+ */
+class NMEA_writer_t
+{
+public:
+  NMEA_writer_t( char *_buffer, unsigned capacity)
+    : buffer( _buffer),
+      next( _buffer),
+      limit( _buffer + capacity - 1), // reserve space for the terminating zero
+      sentence_start( _buffer),
+      checksum( 0),
+      sentence_overflow( false),
+      overflow( false)
+  {
+    *next = 0;
+  }
+
+  //! start a new sentence, header = "$XXXXX," the '$' is not part of the checksum
+  void begin( const char *header)
+  {
+    sentence_start = next;
+    sentence_overflow = false;
+    append( *header++);
+    checksum = 0;
+    append( header);
+  }
+
+  void append( char c)
+  {
+    if( next < limit)
+      {
+	*next++ = c;
+	checksum ^= c;
+      }
+    else
+      sentence_overflow = true;
+  }
+
+  void append( const char *s);
+
+  //! append n characters, capacity is checked once
+  void append( const char *s, unsigned n);
+
+  //! append exactly n decimal digits, leading zeros included
+  void append_digits( uint32_t value, unsigned n);
+  void append_integer( int32_t value);
+
+  //! @param number value * 10
+  void append_1_decimal( int32_t number);
+
+  //! @param number value * 100
+  void append_2_decimals( int32_t number);
+
+  //! angle in degrees as DDMM.MMMMM,H or DDDMM.MMMMM,H
+  void append_angle( double angle, char posc, char negc);
+
+  //! append "*XX\r\n", returns true if the sentence did not fit and has been dropped
+  bool end( void);
+
+  //! true if any sentence has been dropped
+  bool get_overflow( void) const
+  {
+    return overflow;
+  }
+
+  unsigned get_length( void) const
+  {
+    return next - buffer;
+  }
+
+  char * get_end( void) const
+  {
+    return next;
+  }
+
+private:
+  char *buffer;
+  char *next;
+  char *limit;
+  char *sentence_start;
+  uint8_t checksum;
+  bool sentence_overflow;
+  bool overflow;
+};
+
+inline void NMEA_writer_t::append( const char *s)
+{
+  // local copies: stores through char * could alias the members
+  char *p = next;
+  uint8_t sum = checksum;
+  while( *s)
+    {
+      if( p >= limit)
+	{
+	  sentence_overflow = true;
+	  break;
+	}
+      sum ^= *s;
+      *p++ = *s++;
+    }
+  next = p;
+  checksum = sum;
+}
+
+inline void NMEA_writer_t::append( const char *s, unsigned n)
+{
+  if( (unsigned)( limit - next) < n)
+    {
+      sentence_overflow = true;
+      return;
+    }
+  char *p = next;
+  uint8_t sum = checksum;
+  for( unsigned i = 0; i < n; ++i)
+    {
+      sum ^= s[i];
+      p[i] = s[i];
+    }
+  next = p + n;
+  checksum = sum;
+}
+
+inline void NMEA_writer_t::append_digits( uint32_t value, unsigned n)
+{
+  char digits[12];
+  append( digits, format_fixed_digits( digits, value, n) - digits);
+}
+
+inline void NMEA_writer_t::append_integer( int32_t value)
+{
+  char digits[12];
+  append( digits, format_integer( digits, value) - digits);
+}
+
+inline void NMEA_writer_t::append_1_decimal( int32_t number)
+{
+  char digits[14];
+  append( digits, format_fixed_point( digits, number, 1) - digits);
+}
+
+inline void NMEA_writer_t::append_2_decimals( int32_t number)
+{
+  char digits[14];
+  append( digits, format_fixed_point( digits, number, 2) - digits);
+}
+
+inline void NMEA_writer_t::append_angle( double angle, char posc, char negc)
+{
+  // one conversion into the GNSS resolution of 1e-7 degrees, integer arithmetic after that
+  bool pos = angle > 0.0;
+  uint32_t angle_e7 = (uint32_t)( ( pos ? angle : -angle) * 1e7 + 0.5);
+
+  uint32_t degree = angle_e7 / 10000000;
+  uint32_t minutes_e5 = ( ( angle_e7 % 10000000) * 6 + 5) / 10; // 60 * 1e5 / 1e7, rounded
+
+  char text[13]; // DDDMM.MMMMM,H
+  char *p = degree >= 100 ? format_fixed_digits( text, degree, 3) : format_2_digits( text, degree);
+  p = format_2_digits( p, minutes_e5 / 100000);
+  *p++ = '.';
+  p = format_fixed_digits( p, minutes_e5 % 100000, 5);
+  *p++ = ',';
+  *p++ = pos ? posc : negc;
+  append( text, p - text);
+}
+
+inline bool NMEA_writer_t::end( void)
+{
+  char tail[5];
+  tail[0] = '*';
+  tail[1] = "0123456789ABCDEF"[checksum >> 4];
+  tail[2] = "0123456789ABCDEF"[checksum & 0x0f];
+  tail[3] = '\r';
+  tail[4] = '\n';
+  append( tail, sizeof( tail));
+
+  if( sentence_overflow)
+    {
+      next = sentence_start; // drop the incomplete sentence
+      overflow = true;
+    }
+  *next = 0;
+  return sentence_overflow;
+}
+
+#endif /* NMEA_WRITER_H_ */
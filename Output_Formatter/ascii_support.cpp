@@ -133,14 +133,9 @@ char * my_ftoa( char * target, float value)
 
  	value *= 1000000.0f;
  	unsigned fractional_number = round( value);
- 	for( unsigned digit=0; digit<6; ++digit)
- 	  {
- 	    target[5-digit] = (char)(fractional_number % 10 + '0');
- 	    fractional_number /= 10;
- 	  }
- 	target+=6;
+ 	target = format_fixed_digits( target, fractional_number, 6);
  	*target++='e';
- 	return( my_itoa( target, (int)exponent));
+ 	return( format_integer( target, exponent));
  }
 
 void portable_ftoa ( char* res, float value, unsigned  no_of_decimals, unsigned res_len )
@@ -192,22 +187,30 @@ void portable_ftoa ( char* res, float value, unsigned  no_of_decimals, unsigned
 
 }
 
+ROM char DIGIT_PAIRS[200] =
+  {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+  };
+
+ROM uint32_t POWERS_OF_TEN[10] =
+  { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
 //! signed integer to ASCII returning the string end
 char * format_integer( char *s, int32_t value)
 {
   if( value < 0)
     {
       *s++='-';
-      return format_integer( s, -value);
-    }
-  if( value < 10)
-      *s++ = value + '0';
-    else
-    {
-      s = format_integer( s, value / 10);
-      *s++ = value % 10 + '0';
+      return format_unsigned( s, 0 - (uint32_t)value);
     }
-  *s=0;
-  return s;
+  return format_unsigned( s, (uint32_t)value);
 }
-
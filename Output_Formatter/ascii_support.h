@@ -41,13 +41,17 @@ extern "C"
 
 char* ftoa( char* Buffer, float Value);
 
+//! "00" "01" ... "99", two digits per table lookup
+extern const char DIGIT_PAIRS[200];
+
+//! exactly two digits of data % 100, no branches
 inline char * format_2_digits( char * target, uint32_t data)
 {
   data %= 100;
-  *target++ = (char)(data / 10 + '0');
-  *target++ = (char)(data % 10 + '0');
-  *target = 0; // just be sure string is terminated
-  return target;
+  target[0] = DIGIT_PAIRS[2 * data];
+  target[1] = DIGIT_PAIRS[2 * data + 1];
+  target[2] = 0; // just be sure string is terminated
+  return target + 2;
 }
 
 //! basically: kind of strcat returning the pointer to the string-end
@@ -69,6 +73,58 @@ inline void newline( char * &next)
 
 char * format_integer( char *target, int32_t value);
 
+extern const uint32_t POWERS_OF_TEN[10];
+
+//! write n digits backwards from end, two per step
+inline void format_digits_backwards( char *end, uint32_t value, unsigned n)
+{
+  for( ; n >= 2; n -= 2)
+    {
+      uint32_t pair = value % 100;
+      value /= 100;
+      end -= 2;
+      end[0] = DIGIT_PAIRS[2 * pair];
+      end[1] = DIGIT_PAIRS[2 * pair + 1];
+    }
+  if( n)
+    end[-1] = (char)( value % 10 + '0');
+}
+
+//! unsigned integer to ASCII returning the string end
+inline char * format_unsigned( char *target, uint32_t value)
+{
+  unsigned n = 1;
+  while( n < 10 && value >= POWERS_OF_TEN[n])
+    ++n;
+  target += n;
+  format_digits_backwards( target, value, n);
+  *target = 0;
+  return target;
+}
+
+//! exactly n <= 10 digits of value, leading zeros included
+inline char * format_fixed_digits( char *target, uint32_t value, unsigned n)
+{
+  target += n;
+  format_digits_backwards( target, value, n);
+  *target = 0;
+  return target;
+}
+
+//! number / 10^decimals with exactly "decimals" digits after the decimal point
+inline char * format_fixed_point( char *target, int32_t number, unsigned decimals)
+{
+  uint32_t magnitude = (uint32_t)number;
+  if( number < 0)
+    {
+      *target++ = '-';
+      magnitude = 0 - magnitude;
+    }
+  target = format_unsigned( target, magnitude / POWERS_OF_TEN[decimals]);
+  *target++ = '.';
+  return format_fixed_digits( target, magnitude % POWERS_OF_TEN[decimals], decimals);
+}
+
 #ifdef __cplusplus
  }
 #endif /* __cplusplus */
@@ -0,0 +1,79 @@
+/***********************************************************************//**
+ * @file		binary_telemetry.cpp
+ * @brief		compact binary telemetry: fixed-point fields, CRC16, COBS framing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "system_configuration.h"
+#include "binary_telemetry.h"
+#include "crc16.h"
+#include "embedded_math.h"
+#include <string.h>
+
+//! round to the nearest integer of the field type, float fields stay in single precision
+template <class type, class value_type> inline type to_fixed_point( value_type value)
+{
+  return (type)( value < (value_type)0 ? value - (value_type)0.5 : value + (value_type)0.5);
+}
+
+unsigned binary_telemetry_encoder_t::encode( const output_data_t &x, uint8_t *buffer, unsigned capacity)
+{
+  if( capacity < BINARY_TELEMETRY_FRAME_SIZE)
+    return 0;
+
+  binary_telemetry_packet_t packet;
+  packet.version = BINARY_TELEMETRY_VERSION;
+  packet.schema = BINARY_TELEMETRY_SCHEMA;
+  packet.sequence = sequence++;
+
+#define TELEMETRY_ENCODE( name, type, expression, scale) \
+  packet.record.name = to_fixed_point<type>( (expression) * ( scale));
+
+  TELEMETRY_FIELDS( TELEMETRY_ENCODE)
+
+  packet.crc = crc16( (const uint8_t *)&packet, sizeof( packet) - sizeof( packet.crc));
+
+  unsigned length = cobs_encode( (const uint8_t *)&packet, sizeof( packet), buffer);
+  buffer[length++] = 0; // frame delimiter
+  return length;
+}
+
+bool decode_binary_telemetry( uint8_t *frame, unsigned size, binary_telemetry_packet_t &packet)
+{
+  unsigned length;
+  if( cobs_decode( frame, size, frame, length))
+    return true;
+  if( length != sizeof( packet))
+    return true;
+  if( crc16( frame, length - sizeof( packet.crc)) != ( frame[length - 2] | ( frame[length - 1] << 8)))
+    return true;
+
+  memcpy( &packet, frame, sizeof( packet));
+  return ( packet.version != BINARY_TELEMETRY_VERSION) || ( packet.schema != BINARY_TELEMETRY_SCHEMA);
+}
+
+void binary_telemetry_to_physical( const binary_telemetry_record_t &record, float *values)
+{
+#define TELEMETRY_DECODE( name, type, expression, scale) \
+  values[TELEMETRY_##name] = (float)( record.name / (double)( scale));
+
+  TELEMETRY_FIELDS( TELEMETRY_DECODE)
+}
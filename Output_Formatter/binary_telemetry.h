@@ -0,0 +1,111 @@
+/***********************************************************************//**
+ * @file		binary_telemetry.h
+ * @brief		compact binary telemetry: fixed-point fields, CRC16, COBS framing
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef BINARY_TELEMETRY_H_
+#define BINARY_TELEMETRY_H_
+
+#include "data_structures.h"
+#include "output_fields.h"
+#include "cobs.h"
+
+#define BINARY_TELEMETRY_VERSION	1 	//!< header and framing layout
+
+//! output_data_t results in the TELEMETRY_FIELDS table, for navigator_t::subscribe_output()
+#define TELEMETRY_OUTPUT_FIELDS ( OUTPUT_AIRSPEED | OUTPUT_ATTITUDE | OUTPUT_VARIO | OUTPUT_WIND | OUTPUT_FLIGHT_STATE | OUTPUT_AIR_DATA)
+
+#define TELEMETRY_RECORD_MEMBER( name, type, expression, scale) type name;
+
+#pragma pack(push, 1)
+
+//! one record as transmitted, little endian
+typedef struct
+{
+  TELEMETRY_FIELDS( TELEMETRY_RECORD_MEMBER)
+} binary_telemetry_record_t;
+
+//! packet before COBS framing: header, record, CRC-16/CCITT over header and record
+typedef struct
+{
+  uint8_t version;	//!< BINARY_TELEMETRY_VERSION
+  uint16_t schema;	//!< BINARY_TELEMETRY_SCHEMA
+  uint8_t sequence;	//!< incremented per packet, detects lost packets
+  binary_telemetry_record_t record;
+  uint16_t crc;
+} binary_telemetry_packet_t;
+
+#pragma pack(pop)
+
+//! FNV-1a hash folded to 16 bits
+constexpr uint16_t schema_hash( const char *text)
+{
+  uint32_t hash = 2166136261u;
+  while( *text)
+    hash = ( hash ^ (uint8_t)*text++) * 16777619u;
+  return (uint16_t)( hash ^ ( hash >> 16));
+}
+
+#define TELEMETRY_SCHEMA_TEXT( name, type, expression, scale) #name ":" #type ":" #scale ";"
+
+//! identifies the field table, names, types and scaling
+constexpr uint16_t BINARY_TELEMETRY_SCHEMA = schema_hash( TELEMETRY_FIELDS( TELEMETRY_SCHEMA_TEXT));
+
+//! frame size including the 0x00 delimiter
+#define BINARY_TELEMETRY_FRAME_SIZE ( COBS_ENCODED_SIZE( sizeof( binary_telemetry_packet_t)) + 1)
+
+//! one frame for transmission, e.g. through output_channel_t
+class binary_telemetry_buffer_t
+{
+public:
+  uint8_t frame[BINARY_TELEMETRY_FRAME_SIZE];
+  uint32_t length;
+};
+
+//! binary alternative to the NMEA output
+class binary_telemetry_encoder_t
+{
+public:
+  binary_telemetry_encoder_t( void)
+    : sequence( 0)
+  {}
+
+  /**
+   * @brief write one COBS frame terminated by 0x00
+   * @return frame length or 0 if capacity < BINARY_TELEMETRY_FRAME_SIZE
+   */
+  unsigned encode( const output_data_t &x, uint8_t *buffer, unsigned capacity);
+
+private:
+  uint8_t sequence;
+};
+
+/**
+ * @brief decode one frame in place, delimiter already removed
+ * @return true on error: framing, size, version, schema or CRC
+ */
+bool decode_binary_telemetry( uint8_t *frame, unsigned size, binary_telemetry_packet_t &packet);
+
+//! convert the record back into the units and signs of the output_data_t expressions, values[TELEMETRY_FIELD_COUNT]
+void binary_telemetry_to_physical( const binary_telemetry_record_t &record, float *values);
+
+#endif /* BINARY_TELEMETRY_H_ */
@@ -36,10 +36,10 @@ public:
     dlc(_dlc),
     data_l(_data)
   {}
-  bool operator ==(const CANpacket&right)
+  bool operator ==(const CANpacket&right) const
     {
       return 	(id == right.id) &&
-		(dlc = right.dlc) &&
+		(dlc == right.dlc) &&
 		(data_l == right.data_l);
     }
   uint16_t id; 	//!< identifier
@@ -59,7 +59,7 @@ public:
 
 #pragma pack(push, 2)
 
-//! CAN packet tunneled through USART gateway
+//! CAN packet tunneled through USART gateway (version 1, CAN_gateway.h: batched version 2)
 class CAN_gateway_packet
 {
 public:
@@ -103,4 +103,8 @@ public:
 //! Global CAN send procedure
 bool CAN_send( const CANpacket &p, unsigned dummy);
 
+//! send count packets in one go, returns the number of packets accepted
+//! the default implementation uses CAN_send(), drivers may override it
+unsigned CAN_send_burst( const CANpacket *p, unsigned count);
+
 #endif /* GENERIC_CAN_DRIVER_H_ */
@@ -0,0 +1,109 @@
+/***********************************************************************//**
+ * @file		output_channel.h
+ * @brief		triple-buffered output channel for DMA transmission
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef OUTPUT_CHANNEL_H_
+#define OUTPUT_CHANNEL_H_
+
+#include <stdint.h>
+#include "triple_buffer.h"
+#include "system_state.h"
+
+#ifndef OUTPUT_STALL_LIMIT
+#define OUTPUT_STALL_LIMIT 10 	//!< consecutive overruns until the channel is reported as inactive
+#endif
+
+/**
+ * @brief output stream decoupled from the transmitter
+ *
+ * The algorithm task formats into get_buffer() and calls publish(),
+ * the DMA completion handler fetches the next buffer with next_transmission().
+ * The buffer in transmission is never overwritten.
+ * If the transmitter stalls, the active bit of the channel is cleared in system_state.
+ */
+template <class buffer_type> class output_channel_t
+{
+public:
+  //! @param _active_bit e.g. USART_2_OUTPUT_ACTIVE or BLUEZ_OUTPUT_ACTIVE
+  output_channel_t( uint32_t _active_bit)
+    : active_bit( _active_bit),
+      stalled( 0),
+      active( false)
+  {}
+
+  //! producer side: buffer to be formatted
+  buffer_type &get_buffer( void)
+  {
+    return buffers.get_back();
+  }
+
+  //! producer side: submit the formatted buffer, returns true if the transmitter did not keep up
+  bool publish( void)
+  {
+    bool overrun = buffers.publish();
+    if( overrun)
+      {
+	if( stalled < OUTPUT_STALL_LIMIT && ++stalled == OUTPUT_STALL_LIMIT)
+	  set_active( false);
+      }
+    else
+      {
+	stalled = 0;
+	set_active( true);
+      }
+    return overrun;
+  }
+
+  //! transmitter side: buffer to be sent next or 0 if nothing new is pending
+  const buffer_type *next_transmission( void)
+  {
+    if( buffers.acquire())
+      return 0;
+    return &buffers.get_front();
+  }
+
+  //! number of formatted buffers that have never been transmitted
+  uint32_t get_overruns( void) const
+  {
+    return buffers.get_overruns();
+  }
+
+private:
+  void set_active( bool state)
+  {
+    if( state == active)
+      return; // touch the shared state word only on changes
+    active = state;
+    if( state)
+      update_system_state_set( active_bit);
+    else
+      update_system_state_clear( active_bit);
+  }
+
+  triple_buffer_t<buffer_type> buffers;
+  uint32_t active_bit;
+  unsigned stalled; 	//!< consecutive overruns
+  bool active;
+};
+
+#endif /* OUTPUT_CHANNEL_H_ */
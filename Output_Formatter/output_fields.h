@@ -0,0 +1,87 @@
+/***********************************************************************//**
+ * @file		output_fields.h
+ * @brief		output unit scaling and field table shared by CAN and binary output
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#ifndef OUTPUT_FIELDS_H_
+#define OUTPUT_FIELDS_H_
+
+// physical unit -> transmitted integer unit
+#define OUTPUT_SCALE_ANGLE		1000.0f		//!< rad, rad/s -> 1/1000 rad, 1/1000 rad/s
+#define OUTPUT_SCALE_TRACK		17.4533f	//!< degrees -> 1/1000 rad
+#define OUTPUT_SCALE_AIRSPEED		3.6f		//!< m/s -> km/h
+#define OUTPUT_SCALE_VARIO		1000.0f		//!< m/s -> mm/s
+#define OUTPUT_SCALE_ACCELERATION	1000.0f		//!< m/s^2 -> mm/s^2
+#define OUTPUT_SCALE_WIND		100.0f		//!< m/s -> cm/s
+#define OUTPUT_SCALE_LATLON		1e7		//!< degrees -> 1e-7 degrees (double)
+#define OUTPUT_SCALE_ALTITUDE		1000.0f		//!< m -> mm
+#define OUTPUT_SCALE_DENSITY		1000.0f		//!< kg/m^3 -> g/m^3
+#define OUTPUT_SCALE_VOLTAGE		10.0f		//!< V -> 1/10 V
+#define OUTPUT_SCALE_UNITY		1.0f
+
+/**
+ * @brief table of the binary telemetry fields, expanded with FIELD( name, type, output_data_t expression, scale)
+ *
+ * Units and signs follow the CAN output.
+ * Append new fields at the end, any change modifies the schema hash.
+ */
+#define TELEMETRY_FIELDS( FIELD) \
+  FIELD( ROLL,			int16_t,  x.euler.r, 				OUTPUT_SCALE_ANGLE) \
+  FIELD( NICK,			int16_t,  x.euler.n, 				OUTPUT_SCALE_ANGLE) \
+  FIELD( YAW,			int16_t,  x.euler.y, 				OUTPUT_SCALE_ANGLE) \
+  FIELD( TAS,			int16_t,  x.TAS, 				OUTPUT_SCALE_AIRSPEED) \
+  FIELD( IAS,			int16_t,  x.IAS, 				OUTPUT_SCALE_AIRSPEED) \
+  FIELD( VARIO,			int16_t,  x.vario, 				OUTPUT_SCALE_VARIO) \
+  FIELD( VARIO_INTEGRATOR,	int16_t,  x.integrator_vario, 			OUTPUT_SCALE_VARIO) \
+  FIELD( VARIO_UNCOMPENSATED,	int16_t,  x.vario_uncompensated, 		- OUTPUT_SCALE_VARIO) \
+  FIELD( G_LOAD,		int16_t,  x.G_load, 				OUTPUT_SCALE_ACCELERATION) \
+  FIELD( VERTICAL_ACCELERATION,	int16_t,  x.effective_vertical_acceleration, 	- OUTPUT_SCALE_ACCELERATION) \
+  FIELD( SLIP_ANGLE,		int16_t,  x.slip_angle, 			OUTPUT_SCALE_ANGLE) \
+  FIELD( TURN_RATE,		int16_t,  x.turn_rate, 				OUTPUT_SCALE_ANGLE) \
+  FIELD( NICK_ANGLE,		int16_t,  x.nick_angle, 			OUTPUT_SCALE_ANGLE) \
+  FIELD( WIND_NORTH,		int16_t,  x.wind.e[NORTH], 			OUTPUT_SCALE_WIND) \
+  FIELD( WIND_EAST,		int16_t,  x.wind.e[EAST], 			OUTPUT_SCALE_WIND) \
+  FIELD( AVG_WIND_NORTH,	int16_t,  x.wind_average.e[NORTH], 		OUTPUT_SCALE_WIND) \
+  FIELD( AVG_WIND_EAST,		int16_t,  x.wind_average.e[EAST], 		OUTPUT_SCALE_WIND) \
+  FIELD( LATITUDE,		int32_t,  x.c.latitude, 			OUTPUT_SCALE_LATLON) \
+  FIELD( LONGITUDE,		int32_t,  x.c.longitude, 			OUTPUT_SCALE_LATLON) \
+  FIELD( ALTITUDE,		int32_t,  x.c.position.e[DOWN], 		- OUTPUT_SCALE_ALTITUDE) \
+  FIELD( GEO_SEPARATION,	int16_t,  x.c.geo_sep_dm, 			OUTPUT_SCALE_UNITY) \
+  FIELD( TRACK,			int16_t,  x.c.heading_motion, 			OUTPUT_SCALE_TRACK) \
+  FIELD( GROUND_SPEED,		uint16_t, x.c.speed_motion, 			OUTPUT_SCALE_AIRSPEED) \
+  FIELD( STATIC_PRESSURE,	uint32_t, x.m.static_pressure, 			OUTPUT_SCALE_UNITY) \
+  FIELD( AIR_DENSITY,		uint16_t, x.air_density, 			OUTPUT_SCALE_DENSITY) \
+  FIELD( SUPPLY_VOLTAGE,	uint16_t, x.m.supply_voltage, 			OUTPUT_SCALE_VOLTAGE) \
+  FIELD( SATS_NUMBER,		uint8_t,  x.c.SATS_number, 			OUTPUT_SCALE_UNITY) \
+  FIELD( SAT_FIX_TYPE,		uint8_t,  x.c.sat_fix_type, 			OUTPUT_SCALE_UNITY) \
+  FIELD( CIRCLE_MODE,		uint8_t,  x.circle_mode, 			OUTPUT_SCALE_UNITY)
+
+#define TELEMETRY_FIELD_ENUM( name, type, expression, scale) TELEMETRY_##name,
+
+//! field index, in transmission order
+enum telemetry_field_t
+{
+  TELEMETRY_FIELDS( TELEMETRY_FIELD_ENUM)
+  TELEMETRY_FIELD_COUNT
+};
+
+#endif /* OUTPUT_FIELDS_H_ */
@@ -0,0 +1,79 @@
+# @file    event_trace.py
+# @brief   decoder for the binary event trace frames, see NAV_Algorithms/event_trace.h
+# @author  Dr. Klaus Schaefer
+# @license This project is released under the GNU Public License GPL-3.0
+#
+# The event table is read from event_trace.h, no copy to keep in sync.
+#
+# usage:
+#   python3 event_trace.py trace.bin [ cycles_per_second]
+#   import event_trace as et
+#   for event in et.decode( open( "trace.bin", "rb").read()): ...
+
+import os
+import re
+import struct
+import sys
+
+EVENT_TRACE_VERSION = 1
+HEADER = os.path.join( os.path.dirname( os.path.abspath( __file__)), "..", "NAV_Algorithms", "event_trace.h")
+
+def load_events( path = HEADER):
+    """[ ( name, payload a, payload b)] in ID order, from the TRACE_EVENTS table"""
+    pattern = re.compile( r'^\s*X\(\s*(\w+)\s*,\s*"([^"]*)"\s*,\s*"([^"]*)"\s*\)')
+    with open( path) as header:
+        return [ m.groups() for m in map( pattern.match, header) if m]
+
+def crc16( data, crc = 0xffff):
+    """CRC-16/CCITT-FALSE as Generic_Algorithms/crc16.h"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range( 8):
+            crc = ( ( crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xffff
+    return crc
+
+def cobs_decode( frame):
+    """None if the frame is corrupt"""
+    out = bytearray()
+    i = 0
+    while i < len( frame):
+        code = frame[ i]
+        if code == 0 or i + code > len( frame) + 1:
+            return None
+        out += frame[ i + 1 : i + code]
+        i += code
+        if code < 0xff and i < len( frame):
+            out.append( 0)
+    return bytes( out)
+
+def _payload( kind, value):
+    if kind.startswith( "float:"):
+        return kind[ 6:], struct.unpack( "<f", struct.pack( "<I", value))[ 0]
+    return kind, value
+
+def decode( data, events = None):
+    """yield ( timestamp, name, { payload name: value}), frames with a bad CRC are skipped"""
+    events = events or load_events()
+    for frame in data.split( b"\0"):
+        packet = cobs_decode( frame)
+        if not packet or len( packet) < 4:
+            continue
+        if crc16( packet[ : -2]) != struct.unpack( "<H", packet[ -2 :])[ 0]:
+            continue
+        if packet[ 0] != EVENT_TRACE_VERSION or len( packet) != 4 + 16 * packet[ 1]:
+            continue
+        for timestamp, ident, a, b in struct.iter_unpack( "<IIII", packet[ 2 : -2]):
+            if ident >= len( events):
+                yield timestamp, "UNKNOWN_%d" % ident, { "a": a, "b": b}
+                continue
+            name, kind_a, kind_b = events[ ident]
+            yield timestamp, name, dict( ( _payload( kind_a, a), _payload( kind_b, b)))
+
+if __name__ == "__main__":
+    if len( sys.argv) < 2:
+        sys.exit( "usage: event_trace.py trace.bin [ cycles_per_second]")
+    clock = float( sys.argv[ 2]) if len( sys.argv) > 2 else 0.0
+    with open( sys.argv[ 1], "rb") as trace:
+        for timestamp, name, payload in decode( trace.read()):
+            time = "%12.6f" % ( timestamp / clock) if clock else "%10u" % timestamp
+            print( time, name, " ".join( "%s=%s" % item for item in payload.items()))
@@ -0,0 +1,181 @@
+# @file    larus_replay.py
+# @brief   NumPy binding of the Larus replay engine, zero-copy via ctypes
+# @author  Dr. Klaus Schaefer
+# @license This project is released under the GNU Public License GPL-3.0
+#
+# Build the shared library with
+#   cmake -DLARUS_BUILD_PYTHON_BINDING=ON ... && make larus_replay
+# and point LARUS_REPLAY_LIBRARY to it if it is not found next to this file.
+#
+# usage:
+#   import larus_replay as lr
+#   obs = lr.load_observations( "flight.f120")     # structured array, observations_type layout
+#   out = lr.replay( obs)                            # structured array, output_data_t layout
+#   out = lr.zeros( len( obs), lr.OUTPUT_DTYPE)      # own output arrays must be allocated with the record alignment
+#   sets = lr.parameter_sets( 3, { "Vario_TC": [0.5, 1.0, 2.0]})
+#   outs = lr.sweep( obs, sets)                      # shape ( 3, len( obs))
+#   seg = lr.segments( out)                          # structured array, flight_segment_t layout
+#   for s in lr.thermals( seg, 2.0): obs[ s["first_sample"] : s["end_sample"]] ...
+
+import ctypes
+import os
+import numpy as np
+
+OBSERVATIONS_SCHEMA = 0
+OUTPUT_SCHEMA = 1
+
+# log_channel_type_t -> numpy
+_CHANNEL_TYPES = [ np.float32, np.float64, np.uint8, np.int16, np.uint16, np.int32, np.uint32]
+
+def _load_library( path = None):
+    if path is None:
+        path = os.environ.get( "LARUS_REPLAY_LIBRARY",
+                               os.path.join( os.path.dirname( os.path.abspath( __file__)), "liblarus_replay.so"))
+    lib = ctypes.CDLL( path)
+    u = ctypes.c_uint
+    lib.larus_record_size.argtypes = [ u]
+    lib.larus_record_size.restype = u
+    lib.larus_record_alignment.argtypes = [ u]
+    lib.larus_record_alignment.restype = u
+    lib.larus_channel_count.argtypes = [ u]
+    lib.larus_channel_count.restype = u
+    lib.larus_channel.argtypes = [ u, u, ctypes.POINTER( u), ctypes.POINTER( u)]
+    lib.larus_channel.restype = ctypes.c_char_p
+    lib.larus_log_record_size.argtypes = []
+    lib.larus_log_record_size.restype = u
+    lib.larus_from_log_records.argtypes = [ ctypes.c_void_p, u, ctypes.c_void_p]
+    lib.larus_from_log_records.restype = None
+    lib.larus_parameter_count.argtypes = []
+    lib.larus_parameter_count.restype = u
+    lib.larus_parameter_name.argtypes = [ u]
+    lib.larus_parameter_name.restype = ctypes.c_char_p
+    lib.larus_parameter_default.argtypes = [ u]
+    lib.larus_parameter_default.restype = ctypes.c_float
+    lib.larus_replay.argtypes = [ ctypes.c_void_p, u, ctypes.c_void_p, ctypes.c_void_p]
+    lib.larus_replay.restype = u
+    lib.larus_replay_sweep.argtypes = [ ctypes.c_void_p, u, ctypes.c_void_p, ctypes.c_void_p, u, u]
+    lib.larus_replay_sweep.restype = u
+    lib.larus_segment_record_size.argtypes = []
+    lib.larus_segment_record_size.restype = u
+    lib.larus_index_segments.argtypes = [ ctypes.c_void_p, u, ctypes.c_void_p, u]
+    lib.larus_index_segments.restype = u
+    return lib
+
+_lib = _load_library()
+
+def _schema_dtype( schema):
+    """structured dtype with the offsets and the record size of the compiled library"""
+    names, formats, offsets = [], [], []
+    offset, channel_type = ctypes.c_uint(), ctypes.c_uint()
+    for i in range( _lib.larus_channel_count( schema)):
+        name = _lib.larus_channel( schema, i, ctypes.byref( offset), ctypes.byref( channel_type))
+        names.append( name.decode())
+        formats.append( _CHANNEL_TYPES[ channel_type.value])
+        offsets.append( offset.value)
+    return np.dtype( { "names": names, "formats": formats, "offsets": offsets,
+                       "itemsize": _lib.larus_record_size( schema)})
+
+OBSERVATIONS_DTYPE = _schema_dtype( OBSERVATIONS_SCHEMA)
+OUTPUT_DTYPE = _schema_dtype( OUTPUT_SCHEMA)
+# alignof() of the records, output_data_t is cache line aligned on the host
+_ALIGNMENT = { OBSERVATIONS_DTYPE: _lib.larus_record_alignment( OBSERVATIONS_SCHEMA),
+               OUTPUT_DTYPE: _lib.larus_record_alignment( OUTPUT_SCHEMA)}
+
+def zeros( shape, dtype):
+    """zeroed record array with the alignment the library requires, np.zeros guarantees 16 bytes only"""
+    alignment = _ALIGNMENT[ dtype]
+    count = int( np.prod( shape))
+    raw = np.zeros( count * dtype.itemsize + alignment, dtype = np.uint8)
+    start = -raw.ctypes.data % alignment
+    return raw[ start : start + count * dtype.itemsize].view( dtype).reshape( shape)
+
+# flight_segment_t, NAV_Algorithms/segment_index.h
+STRAIGHT_FLIGHT, TRANSITION, CIRCLING = range( 3)
+SEGMENT_DTYPE = np.dtype( [ ( "first_sample", np.uint32), ( "end_sample", np.uint32),
+                            ( "version", np.uint8), ( "circle_state", np.uint8),
+                            ( "GNSS_fix", np.uint8), ( "reserved", np.uint8),
+                            ( "duration", np.float32), ( "mean_climb", np.float32),
+                            ( "altitude", np.float32), ( "altitude_gain", np.float32),
+                            ( "wind", np.float32, 2)])
+if SEGMENT_DTYPE.itemsize != _lib.larus_segment_record_size():
+    raise ImportError( "flight_segment_t layout mismatch")
+
+def load_observations( path):
+    """raw log of observations_record_t, unpacked into the in-memory layout"""
+    size = _lib.larus_log_record_size()
+    raw = np.fromfile( path, dtype = np.uint8)
+    count = len( raw) // size # a trailing incomplete record is ignored
+    observations = zeros( count, OBSERVATIONS_DTYPE)
+    _lib.larus_from_log_records( raw.ctypes.data, count, observations.ctypes.data)
+    return observations
+
+def parameter_names():
+    """{ mnemonic: EEPROM_PARAMETER_ID}"""
+    names = {}
+    for i in range( _lib.larus_parameter_count()):
+        name = _lib.larus_parameter_name( i)
+        if name:
+            names[ name.decode()] = i
+    return names
+
+def parameter_sets( count, variations = {}):
+    """count sets, NaN = library default, variations = { mnemonic: [ value per set]}"""
+    sets = np.full( ( count, _lib.larus_parameter_count()), np.nan, dtype = np.float32)
+    ids = parameter_names()
+    for name, values in variations.items():
+        sets[ :, ids[ name]] = values
+    return sets
+
+def _check( array, dtype):
+    if array.dtype != dtype or not array.flags.c_contiguous:
+        raise ValueError( "array must be C contiguous with the library record layout")
+    if array.ctypes.data % _ALIGNMENT[ dtype]:
+        raise ValueError( "array must be %d byte aligned, use zeros()" % _ALIGNMENT[ dtype])
+
+def replay( observations, parameters = None, output = None):
+    """replay one flight, output preallocated or created"""
+    _check( observations, OBSERVATIONS_DTYPE)
+    if output is None:
+        output = zeros( len( observations), OUTPUT_DTYPE)
+    _check( output, OUTPUT_DTYPE)
+    if len( output) < len( observations):
+        raise ValueError( "output too short")
+    if parameters is not None:
+        parameters = np.ascontiguousarray( parameters, dtype = np.float32)
+        if parameters.shape != ( _lib.larus_parameter_count(),):
+            raise ValueError( "parameter set size mismatch")
+    _lib.larus_replay( observations.ctypes.data, len( observations), output.ctypes.data,
+                       None if parameters is None else parameters.ctypes.data)
+    return output
+
+def sweep( observations, sets, output = None, threads = 0):
+    """replay one flight with every parameter set in one native call, output shape ( sets, samples)"""
+    _check( observations, OBSERVATIONS_DTYPE)
+    sets = np.ascontiguousarray( sets, dtype = np.float32)
+    if sets.ndim != 2 or sets.shape[ 1] != _lib.larus_parameter_count():
+        raise ValueError( "parameter set size mismatch")
+    if output is None:
+        output = zeros( ( len( sets), len( observations)), OUTPUT_DTYPE)
+    _check( output, OUTPUT_DTYPE)
+    if output.shape != ( len( sets), len( observations)):
+        raise ValueError( "output shape mismatch")
+    _lib.larus_replay_sweep( observations.ctypes.data, len( observations), output.ctypes.data,
+                             sets.ctypes.data, len( sets), threads)
+    return output
+
+def segments( output, capacity = None):
+    """flight phase segments of one replayed flight"""
+    _check( output, OUTPUT_DTYPE)
+    if capacity is None:
+        capacity = max( 1, len( output) // 100) # at most one phase change per second
+    index = np.zeros( capacity, dtype = SEGMENT_DTYPE)
+    count = _lib.larus_index_segments( output.ctypes.data, len( output), index.ctypes.data, capacity)
+    return index[ : count]
+
+def load_segments( path):
+    """segment index file, written incrementally by the logger"""
+    return np.fromfile( path, dtype = SEGMENT_DTYPE)
+
+def thermals( index, min_climb = 0.0):
+    """circling segments with a mean climb of at least min_climb m/s"""
+    return index[ ( index[ "circle_state"] == CIRCLING) & ( index[ "mean_climb"] >= min_climb)]
@@ -0,0 +1,50 @@
+# @file    test_larus_replay_library.py
+# @brief   loads liblarus_replay.so and replays a short record block, no NumPy needed
+# @author  Dr. Klaus Schaefer
+# @license This project is released under the GNU Public License GPL-3.0
+#
+# usage:
+#   python3 test_larus_replay_library.py [ liblarus_replay.so]
+
+import ctypes
+import os
+import sys
+
+OBSERVATIONS_SCHEMA = 0
+OUTPUT_SCHEMA = 1
+SAMPLES = 250 # 2.5 s at 100 Hz, spans the 10 Hz work
+
+def aligned_buffer( size, alignment):
+    """ctypes buffer and the address of its first aligned byte"""
+    buffer = ctypes.create_string_buffer( size + alignment)
+    address = ctypes.addressof( buffer)
+    return buffer, address + ( -address) % alignment
+
+def main( path):
+    library = ctypes.CDLL( path, mode = os.RTLD_NOW) # fails on any unresolved symbol
+    u = ctypes.c_uint
+    for function in ( library.larus_record_size, library.larus_record_alignment, library.larus_channel_count):
+        function.argtypes = [ u]
+        function.restype = u
+    library.larus_parameter_count.restype = u
+    library.larus_replay.argtypes = [ ctypes.c_void_p, u, ctypes.c_void_p, ctypes.c_void_p]
+    library.larus_replay.restype = u
+
+    for schema in ( OBSERVATIONS_SCHEMA, OUTPUT_SCHEMA):
+        assert library.larus_record_size( schema) > 0
+        assert library.larus_channel_count( schema) > 0
+        alignment = library.larus_record_alignment( schema)
+        assert alignment and alignment & ( alignment - 1) == 0
+    assert library.larus_parameter_count() > 0
+
+    observations_keep, observations = aligned_buffer(
+        SAMPLES * library.larus_record_size( OBSERVATIONS_SCHEMA), library.larus_record_alignment( OBSERVATIONS_SCHEMA))
+    output_keep, output = aligned_buffer(
+        SAMPLES * library.larus_record_size( OUTPUT_SCHEMA), library.larus_record_alignment( OUTPUT_SCHEMA))
+    written = library.larus_replay( observations, SAMPLES, output, None)
+    assert written == SAMPLES, written
+    print( "liblarus_replay: loaded, %d records replayed" % written)
+
+if __name__ == "__main__":
+    main( sys.argv[ 1] if len( sys.argv) > 1 else
+          os.path.join( os.path.dirname( os.path.abspath( __file__)), "liblarus_replay.so"))
@@ -0,0 +1,149 @@
+/***********************************************************************//**
+ * @file		EEPROM_journal_test.cpp
+ * @brief		power loss at every flash write of a journal commit
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "EEPROM_journal.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_PAGES	2
+#define TEST_PAGE_SIZE	( 2 * sizeof( EEPROM_journal_record_t)) //!< two records per page: wrap-around after four commits
+#define TEST_COMMITS	12
+#define NO_CUT		0xffffffff
+
+//! test condition, independent of NDEBUG
+static void check( bool condition, const char *text, unsigned commit, unsigned cut)
+{
+  if( condition)
+    return;
+  printf( "EEPROM journal test failed: %s, commit %u, cut after %u flash operations\n", text, commit, cut);
+  exit( 1);
+}
+
+/**
+ * @brief RAM flash that loses power after a number of operations
+ *
+ * An erase counts as one operation, a program() call as one per word:
+ * the call is truncated where the power fails.
+ */
+class cut_flash_t : public RAM_flash_driver_t<TEST_PAGES, TEST_PAGE_SIZE>
+{
+public:
+  cut_flash_t( void)
+    : budget( NO_CUT)
+  {}
+
+  bool erase_page( unsigned page) override
+  {
+    if( budget == 0)
+      return true;
+    if( budget != NO_CUT)
+      --budget;
+    return RAM_flash_driver_t<TEST_PAGES, TEST_PAGE_SIZE>::erase_page( page);
+  }
+
+  bool program( unsigned page, unsigned word_offset, const uint32_t *data, unsigned words) override
+  {
+    unsigned written = budget < words ? budget : words;
+    RAM_flash_driver_t<TEST_PAGES, TEST_PAGE_SIZE>::program( page, word_offset, data, written);
+    if( budget != NO_CUT)
+      budget -= written;
+    return written < words;
+  }
+
+  unsigned budget; //!< remaining flash operations, NO_CUT = unlimited
+};
+
+//! parameter set number n, n = 0: empty set
+static uint16_t set_value( unsigned n, unsigned id)
+{
+  return (uint16_t)( n * 100 + id);
+}
+
+static void stage_set( EEPROM_journal_t &journal, unsigned n)
+{
+  for( unsigned id = 0; id < EEPROM_PARAMETER_ID_END; ++id)
+    journal.stage( (EEPROM_PARAMETER_ID)id, set_value( n, id));
+}
+
+//! the mounted journal holds exactly set n
+static bool holds_set( const EEPROM_journal_t &journal, unsigned n)
+{
+  for( unsigned id = 0; id < EEPROM_PARAMETER_ID_END; ++id)
+    {
+      uint16_t value;
+      bool missing = journal.read( (EEPROM_PARAMETER_ID)id, value);
+      if( n == 0 ? ! missing : ( missing || value != set_value( n, id)))
+	return false;
+    }
+  return true;
+}
+
+int main( void)
+{
+  cut_flash_t flash; // state after the last complete commit
+  unsigned cuts = 0;
+
+  for( unsigned n = 1; n <= TEST_COMMITS; ++n)
+    {
+      for( unsigned cut = 0; ; ++cut)
+	{
+	  cut_flash_t image = flash;
+	  EEPROM_journal_t journal( image, TEST_PAGES, TEST_PAGE_SIZE);
+	  journal.mount();
+	  check( holds_set( journal, n - 1), "previous set not found", n, cut);
+
+	  stage_set( journal, n);
+	  image.budget = cut;
+	  bool torn = journal.commit();
+	  image.budget = NO_CUT;
+	  if( ! torn)
+	    break; // the budget covered the complete commit
+
+	  // power up again: all or nothing
+	  EEPROM_journal_t restarted( image, TEST_PAGES, TEST_PAGE_SIZE);
+	  restarted.mount();
+	  check( holds_set( restarted, n - 1) || holds_set( restarted, n), "mixed parameter set", n, cut);
+
+	  // and the journal keeps working behind the torn record, with a set it has not seen
+	  stage_set( restarted, TEST_COMMITS + n);
+	  check( restarted.commit() == false, "commit after power loss", n, cut);
+	  EEPROM_journal_t recovered( image, TEST_PAGES, TEST_PAGE_SIZE);
+	  recovered.mount();
+	  check( holds_set( recovered, TEST_COMMITS + n), "set after power loss", n, cut);
+	  ++cuts;
+	}
+
+      EEPROM_journal_t journal( flash, TEST_PAGES, TEST_PAGE_SIZE);
+      journal.mount();
+      stage_set( journal, n);
+      check( journal.commit() == false, "commit", n, NO_CUT);
+      check( journal.commit() == false && journal.get_erase_count() == ( n % 2 ? 1 : 0), "unchanged set written", n, NO_CUT);
+    }
+
+  EEPROM_journal_t journal( flash, TEST_PAGES, TEST_PAGE_SIZE);
+  journal.mount();
+  check( holds_set( journal, TEST_COMMITS) && journal.get_sequence() == TEST_COMMITS, "final set", TEST_COMMITS, NO_CUT);
+  printf( "EEPROM journal: %u commits over %u pages, %u cut points, all or nothing\n", TEST_COMMITS, TEST_PAGES, cuts);
+  return 0;
+}
@@ -0,0 +1,105 @@
+/***********************************************************************//**
+ * @file		air_density_test.cpp
+ * @brief		recursive density observer against the batch observer on a descent
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "air_density_observer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define METERING_FREQUENCY	10	//!< Hz, as navigator_t::update_every_100ms()
+#define DENSITY_TOLERANCE	0.01f	//!< deviation from the batch result during the descent
+#define FINAL_TOLERANCE		0.003f	//!< deviation at the end of the descent
+#define QFF_TOLERANCE		30.0f	//!< Pa
+
+//! test condition, independent of NDEBUG
+static void check( bool condition, const char *text)
+{
+  if( condition)
+    return;
+  printf( "air density test failed: %s\n", text);
+  exit( 1);
+}
+
+//! standard lapse rate atmosphere, temperature_offset = 0 is ISA
+static float static_pressure( float altitude, float temperature_offset)
+{
+  float T0 = 288.15f + temperature_offset;
+  return 101325.0f * powf( 1.0f - 0.0065f * altitude / T0, 5.25588f);
+}
+
+/**
+ * @brief descent top -> bottom, followed by a short climb triggering the batch evaluation
+ * @return largest deviation of the recursive density correction from the batch result
+ */
+static float descent( float top, float bottom, float sink_rate, float temperature_offset)
+{
+  air_density_observer batch;
+  air_density_observer_recursive recursive;
+  batch.initialize( top);
+  recursive.initialize( top);
+
+  air_data_result batch_result, recursive_result;
+  float recursive_min = 2.0f, recursive_max = 0.0f;
+  unsigned descent_samples = (unsigned)(( top - bottom) / sink_rate * METERING_FREQUENCY);
+  unsigned noise = 1;
+  for( unsigned i = 0; i < descent_samples + 100 * METERING_FREQUENCY; ++i)
+    {
+      float altitude = i < descent_samples
+	  ? top - sink_rate * i / METERING_FREQUENCY
+	  : bottom + 1.0f * ( i - descent_samples) / METERING_FREQUENCY;
+      noise = noise * 1103515245u + 12345u;
+      float pressure = static_pressure( altitude, temperature_offset) + (float)( noise >> 16) * ( 2.0f / 65536.0f) - 1.0f;
+
+      air_data_result result = recursive.feed_metering( pressure, altitude);
+      if( result.valid && i < descent_samples)
+	{
+	  recursive_result = result;
+	  if( result.density_correction < recursive_min)
+	    recursive_min = result.density_correction;
+	  if( result.density_correction > recursive_max)
+	    recursive_max = result.density_correction;
+	}
+      result = batch.feed_metering( pressure, altitude);
+      if( result.valid)
+	batch_result = result;
+    }
+
+  check( batch_result.valid, "no batch result");
+  check( recursive_result.valid, "no recursive result");
+  check( fabsf( recursive_result.density_correction - batch_result.density_correction) < FINAL_TOLERANCE, "final density");
+  check( fabsf( recursive_result.QFF - static_pressure( 0.0f, temperature_offset)) < QFF_TOLERANCE, "QFF");
+
+  float deviation = fmaxf( recursive_max - batch_result.density_correction, batch_result.density_correction - recursive_min);
+  printf( "descent %.0f -> %.0f m, ISA %+.0f K: batch %.4f recursive %.4f .. %.4f\n",
+	  top, bottom, temperature_offset, batch_result.density_correction, recursive_min, recursive_max);
+  return deviation;
+}
+
+int main( void)
+{
+  check( descent( 3000.0f, 300.0f, 1.5f,   0.0f) < DENSITY_TOLERANCE, "density during ISA descent");
+  check( descent( 2000.0f, 500.0f, 1.0f,  15.0f) < DENSITY_TOLERANCE, "density during warm descent");
+  check( descent( 2500.0f, 800.0f, 0.8f, -10.0f) < DENSITY_TOLERANCE, "density during cold descent");
+  return 0;
+}
@@ -0,0 +1,102 @@
+/***********************************************************************//**
+ * @file		checkpoint_test.cpp
+ * @brief		checkpoint round trip: a restored engine continues bit-identically
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "flight_corpus.h"
+#include "replay_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECKPOINT_SAMPLE	( 150 * FAST_SAMPLING_FREQUENCY) //!< while thermalling
+#define COMPARED_SAMPLES	( 60 * FAST_SAMPLING_FREQUENCY)
+
+static bool same_results( const output_data_t &a, const output_data_t &b)
+{
+  return a.vario == b.vario && a.vario_uncompensated == b.vario_uncompensated
+      && a.integrator_vario == b.integrator_vario && a.TAS == b.TAS
+      && a.wind.e[0] == b.wind.e[0] && a.wind.e[1] == b.wind.e[1]
+      && a.wind_average.e[0] == b.wind_average.e[0] && a.wind_average.e[1] == b.wind_average.e[1]
+      && a.q.e[0] == b.q.e[0] && a.q.e[1] == b.q.e[1] && a.q.e[2] == b.q.e[2] && a.q.e[3] == b.q.e[3]
+      && a.circle_mode == b.circle_mode && a.air_density == b.air_density
+      && a.magnetic_disturbance == b.magnetic_disturbance;
+}
+
+//! test condition, independent of NDEBUG
+static void check( bool condition, const char *text)
+{
+  if( condition)
+    return;
+  printf( "checkpoint test failed: %s\n", text);
+  exit( 1);
+}
+
+int main( void)
+{
+  printf( "organizer checkpoint: %u bytes, capacity %u\n",
+	  (unsigned)sizeof( checkpoint_t<organizer_t::state_t>), (unsigned)CHECKPOINT_CAPACITY);
+
+  check( CHECKPOINT_SAMPLE + COMPARED_SAMPLES <= flight_corpus_t::get_size(), "corpus too short");
+  observations_type *corpus = new observations_type[flight_corpus_t::get_size()];
+  uint8_t *phase = new uint8_t[flight_corpus_t::get_size()];
+  flight_corpus_t().generate( corpus, phase);
+
+  output_data_t *reference = new output_data_t[COMPARED_SAMPLES];
+  output_data_t *restarted = new output_data_t[COMPARED_SAMPLES];
+  checkpoint_t<replay_engine_t::state_t> *checkpoint = new checkpoint_t<replay_engine_t::state_t>;
+
+  replay_engine_t *original = new replay_engine_t( EEPROM_configuration(), false);
+  output_data_t output;
+  for( unsigned i = 0; i < CHECKPOINT_SAMPLE; ++i)
+    original->run( corpus + i, &output, 1);
+  original->save_checkpoint( *checkpoint);
+  original->run( corpus + CHECKPOINT_SAMPLE, reference, COMPARED_SAMPLES);
+
+  replay_engine_t *copy = new replay_engine_t( EEPROM_configuration(), false);
+  check( copy->restore_checkpoint( *checkpoint) == false, "checkpoint rejected");
+  check( copy->get_sample_counter() == CHECKPOINT_SAMPLE, "replay position");
+  copy->run( corpus + CHECKPOINT_SAMPLE, restarted, COMPARED_SAMPLES);
+
+  for( unsigned i = 0; i < COMPARED_SAMPLES; ++i)
+    if( ! same_results( reference[i], restarted[i]))
+      {
+	printf( "restored engine differs at sample %u\n", CHECKPOINT_SAMPLE + i);
+	return 1;
+      }
+
+  // damaged or foreign checkpoints are rejected
+  checkpoint->header.layout ^= 1;
+  check( copy->restore_checkpoint( *checkpoint) == true, "foreign layout accepted");
+  checkpoint->header.layout ^= 1;
+  ((uint8_t *)&checkpoint->state)[sizeof( checkpoint->state) / 2] ^= 0x10;
+  check( copy->restore_checkpoint( *checkpoint) == true, "damaged checkpoint accepted");
+
+  printf( "checkpoint: %u samples identical after restore\n", COMPARED_SAMPLES);
+  delete original;
+  delete copy;
+  delete checkpoint;
+  delete [] reference;
+  delete [] restarted;
+  delete [] phase;
+  delete [] corpus;
+  return 0;
+}
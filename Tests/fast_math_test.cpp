@@ -0,0 +1,93 @@
+/***********************************************************************//**
+ * @file		fast_math_test.cpp
+ * @brief		error bounds of the fast_math.h approximations against libm
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "fast_math.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// error bounds documented in fast_math.h
+#define ATAN2_ERROR_BOUND	2.0e-6
+#define ASIN_ERROR_BOUND	3.0e-7
+#define SIN_COS_ERROR_BOUND	3.4e-6
+
+//! test condition, independent of NDEBUG
+static void check( bool condition, const char *text)
+{
+  if( condition)
+    return;
+  printf( "fast math test failed: %s\n", text);
+  exit( 1);
+}
+
+int main( void)
+{
+  double atan2_error = 0.0, asin_error = 0.0, sin_error = 0.0, cos_error = 0.0;
+
+  // all four quadrants, both axes and the origin
+  for( int i = -500; i <= 500; ++i)
+    for( int k = -500; k <= 500; ++k)
+      {
+	float y = i * 0.0137f;
+	float x = k * 0.0093f;
+	double error = fabs( fast_atan2f( y, x) - atan2( (double)y, (double)x));
+	if( error > M_PI) // branch cut at +/- PI
+	  error = fabs( error - 2.0 * M_PI);
+	if( error > atan2_error)
+	  atan2_error = error;
+      }
+
+  // asin on [-1, 1], sin and cos on [-2 PI, 2 PI]
+  for( int i = -100000; i <= 100000; ++i)
+    {
+      float x = i * 1e-5f;
+      double error = fabs( fast_asinf( x) - asin( (double)x));
+      if( error > asin_error)
+	asin_error = error;
+
+      x = i * (float)( 2.0 * M_PI * 1e-5);
+      error = fabs( fast_sinf( x) - sin( (double)x));
+      if( error > sin_error)
+	sin_error = error;
+      error = fabs( fast_cosf( x) - cos( (double)x));
+      if( error > cos_error)
+	cos_error = error;
+    }
+
+  bool sqrt_exact = true;
+  for( int i = 0; i <= 100000; ++i)
+    {
+      float x = i * 0.37f;
+      sqrt_exact = sqrt_exact && fast_sqrtf( x) == sqrtf( x);
+    }
+
+  printf( "fast_math max. error: atan2 %.2e asin %.2e sin %.2e cos %.2e\n",
+	  atan2_error, asin_error, sin_error, cos_error);
+  check( atan2_error <= ATAN2_ERROR_BOUND, "fast_atan2f");
+  check( asin_error <= ASIN_ERROR_BOUND, "fast_asinf");
+  check( sin_error <= SIN_COS_ERROR_BOUND, "fast_sinf");
+  check( cos_error <= SIN_COS_ERROR_BOUND, "fast_cosf");
+  check( sqrt_exact, "fast_sqrtf");
+  return 0;
+}
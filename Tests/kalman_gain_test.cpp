@@ -0,0 +1,75 @@
+/***********************************************************************//**
+ * @file		kalman_gain_test.cpp
+ * @brief		Riccati solver against the 100 Hz ROM gain tables
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "KalmanVario.h"
+#include "KalmanVario_PVA.h"
+#include "Kalman_V_A_Aoff_observer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define GAIN_TOLERANCE 1e-5f //!< relative, the tables have been computed in double precision
+
+//! test condition, independent of NDEBUG
+static void check( bool condition, const char *text)
+{
+  if( condition)
+    return;
+  printf( "Kalman gain test failed: %s\n", text);
+  exit( 1);
+}
+
+//! largest relative deviation of the computed gain from the ROM table
+template <int N, int L>
+static float deviation( const float (&computed)[N][L], const float (&table)[N][L])
+{
+  float worst = 0.0f;
+  for( int i = 0; i < N; ++i)
+    for( int k = 0; k < L; ++k)
+      worst = fmaxf( worst, fabsf( computed[i][k] / table[i][k] - 1.0f));
+  return worst;
+}
+
+int main( void)
+{
+  // noise parameters as documented at the compute() definitions
+  KalmanVario_gain_t vario;
+  check( vario.compute( 0.01f, 1.0f / 9.0f, 1e-6f, 1.0f / 144.0f, 0.01f) == false, "KalmanVario solver");
+  float vario_deviation = deviation( vario.Gain, KalmanVario_t::default_gain.Gain);
+
+  KalmanVario_PVA_gain_t PVA;
+  check( PVA.compute( 0.01f, 1.0f, 1e-4f, 0.01f, 0.0225f, 0.01f) == false, "KalmanVario_PVA solver");
+  float PVA_deviation = deviation( PVA.Gain, KalmanVario_PVA_t::default_gain.Gain);
+
+  Kalman_V_A_Aoff_gain_t V_A_Aoff;
+  check( V_A_Aoff.compute( 0.01f, 9.0f, 1e-4f, 0.01f, 0.01f) == false, "Kalman_V_A_Aoff solver");
+  float V_A_Aoff_deviation = deviation( V_A_Aoff.Gain, Kalman_V_A_Aoff_observer_t::default_gain.Gain);
+
+  printf( "relative gain deviation: KalmanVario %.1e, KalmanVario_PVA %.1e, Kalman_V_A_Aoff %.1e\n",
+	  vario_deviation, PVA_deviation, V_A_Aoff_deviation);
+  check( vario_deviation < GAIN_TOLERANCE, "KalmanVario gain");
+  check( PVA_deviation < GAIN_TOLERANCE, "KalmanVario_PVA gain");
+  check( V_A_Aoff_deviation < GAIN_TOLERANCE, "Kalman_V_A_Aoff gain");
+  return 0;
+}
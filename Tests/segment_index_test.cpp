@@ -0,0 +1,93 @@
+/***********************************************************************//**
+ * @file		segment_index_test.cpp
+ * @brief		flight segment index of a replayed corpus, built by a fresh indexer
+ * @author		Dr. Klaus Schaefer
+ * @copyright 		Copyright 2021 Dr. Klaus Schaefer. All rights reserved.
+ * @license 		This project is released under the GNU Public License GPL-3.0
+
+    <Larus Flight Sensor Firmware>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ **************************************************************************/
+
+#include "flight_corpus.h"
+#include "replay_engine.h"
+#include "segment_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_SEGMENTS 1000
+
+//! test condition, independent of NDEBUG
+static void check( bool condition, const char *text)
+{
+  if( condition)
+    return;
+  printf( "segment index test failed: %s\n", text);
+  exit( 1);
+}
+
+static bool plausible( const flight_segment_t &segment)
+{
+  return segment.version == SEGMENT_INDEX_VERSION
+      && segment.end_sample > segment.first_sample
+      && isfinite( segment.mean_climb) && fabsf( segment.mean_climb) < 20.0f
+      && isfinite( segment.altitude_gain) && fabsf( segment.altitude_gain) < 2000.0f
+      && isfinite( segment.wind[NORTH]) && fabsf( segment.wind[NORTH]) < 50.0f
+      && isfinite( segment.wind[EAST])  && fabsf( segment.wind[EAST])  < 50.0f;
+}
+
+int main( void)
+{
+  unsigned size = flight_corpus_t::get_size();
+  observations_type *corpus = new observations_type[size];
+  uint8_t *phase = new uint8_t[size];
+  flight_corpus_t().generate( corpus, phase);
+
+  output_data_t *output = new output_data_t[size];
+  replay_engine_t *engine = new replay_engine_t( EEPROM_configuration(), false);
+  engine->run( corpus, output, size);
+
+  flight_segment_t *segments = new flight_segment_t[MAX_SEGMENTS];
+  unsigned count = index_segments( output, size, segments, MAX_SEGMENTS);
+  check( count > 1 && count < MAX_SEGMENTS, "segment count");
+
+  // the segments cover the log without gaps
+  check( segments[0].first_sample == 0, "first segment");
+  check( segments[count - 1].end_sample == size, "last segment");
+  for( unsigned i = 0; i < count; ++i)
+    {
+      check( plausible( segments[i]), "segment aggregates");
+      check( i == 0 || segments[i].first_sample == segments[i - 1].end_sample, "gap between segments");
+      check( i == 0 || segments[i].circle_state != segments[i - 1].circle_state
+	     || ( segments[i].GNSS_fix & SAT_FIX) != ( segments[i - 1].GNSS_fix & SAT_FIX), "segment split without change");
+    }
+
+  // a single record gives one segment without altitude gain
+  flight_segment_t single;
+  segment_indexer_t indexer;
+  check( indexer.finish( single) == false, "empty indexer closed a segment");
+  check( indexer.update( output[size / 2], 0, single) == false, "first record closed a segment");
+  check( indexer.finish( single) == true, "segment not closed");
+  check( plausible( single) && single.altitude_gain == 0.0f && single.end_sample == 1, "single record segment");
+
+  printf( "segment index: %u segments\n", count);
+  delete engine;
+  delete [] segments;
+  delete [] output;
+  delete [] phase;
+  delete [] corpus;
+  return 0;
+}